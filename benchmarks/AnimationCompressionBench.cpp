@@ -0,0 +1,299 @@
+// Animation compression: memory and sampling cost of a synthetic motion
+// capture clip (60 nodes in a chain, 100 s at 60 Hz, translation, rotation
+// and scale channels plus two morph weights; some channels constant, some
+// stepped). The clip is sampled frame by frame, as playback does, by one
+// instance and by a crowd of instances spread over it, in three forms:
+//   source:   the imported float keys
+//   reduced:  compressAnimations() with quantization off (float keys)
+//   packed:   compressAnimations() with the default options
+// Every sampled value of the compressed forms must stay within twice the
+// per-stage error bounds of the source.
+//
+// Usage: AnimationCompressionBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Animation/AnimationPlayer.hpp"
+#include "Asset/AnimationCompressor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    const uint32_t kNodeCount = 60;
+    const uint32_t kCrowdSize = 16;
+    const float kFrameRate = 60.0f;
+
+    void appendKey(uint32_t node, AnimationPath path, float time, uint32_t key, std::vector<float>& values)
+    {
+        const float phase = static_cast<float>(node);
+        switch (path)
+        {
+            case AnimationPath::Translation:
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float drift = node % 3 == 0 ? static_cast<float>(key / 30) * 0.01f : 0.0f;
+                    values.push_back(node % 5 == 0 ? 1.0f : std::sin(time * (0.3f + 0.1f * c) + phase) * 2.0f + drift);
+                }
+                break;
+            case AnimationPath::Rotation:
+            {
+                const float angle = node % 4 == 0 ? 0.3f : std::sin(time * 0.5f + phase) * 2.5f;
+                const float s = std::sin(angle * 0.5f);
+                values.insert(values.end(), { 0.6f * s, 0.8f * s, 0.0f, std::cos(angle * 0.5f) });
+                break;
+            }
+            case AnimationPath::Scale:
+                for (int c = 0; c < 3; ++c)
+                {
+                    values.push_back(node % 2 ? 1.0f : 1.0f + 0.2f * std::sin(time + c));
+                }
+                break;
+            case AnimationPath::Weights:
+                values.push_back(0.5f + 0.5f * std::sin(time));
+                values.push_back(time < 50.0f ? 0.0f : 1.0f);
+                break;
+        }
+    }
+
+    ModelData makeCapture(uint32_t keyCount)
+    {
+        ModelData model;
+        for (uint32_t n = 0; n < kNodeCount; ++n)
+        {
+            NodeData node;
+            node.parent = static_cast<int32_t>(n) - 1;
+            if (n == 0)
+            {
+                node.morphWeightCount = 2;
+            }
+            model.nodes.push_back(node);
+        }
+        model.morphWeights.assign(2, 0.0f);
+
+        AnimationData clip;
+        clip.name = "capture";
+        clip.duration = static_cast<float>(keyCount - 1) / kFrameRate;
+        for (uint32_t n = 0; n < kNodeCount; ++n)
+        {
+            for (AnimationPath path : { AnimationPath::Translation, AnimationPath::Rotation, AnimationPath::Scale,
+                                        AnimationPath::Weights })
+            {
+                if (path == AnimationPath::Weights && n != 0)
+                {
+                    continue;
+                }
+                AnimationChannelData channel;
+                channel.node = static_cast<int32_t>(n);
+                channel.path = path;
+                channel.interpolation = n % 7 == 3 ? AnimationInterpolation::Step : AnimationInterpolation::Linear;
+                channel.firstKey = static_cast<uint32_t>(model.animationTimes.size());
+                channel.keyCount = keyCount;
+                channel.firstValue = static_cast<uint32_t>(model.animationValues.size());
+                for (uint32_t key = 0; key < keyCount; ++key)
+                {
+                    const float time = static_cast<float>(key) / kFrameRate;
+                    model.animationTimes.push_back(time);
+                    appendKey(n, path, time, key, model.animationValues);
+                }
+                model.animationChannels.push_back(channel);
+            }
+        }
+        clip.channelCount = static_cast<uint32_t>(model.animationChannels.size());
+        model.animations.push_back(clip);
+        return model;
+    }
+
+    // Angle between two rotations, in radians.
+    float rotationError(const float* a, const float* b)
+    {
+        const float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+        const float sign = dot < 0.0f ? -1.0f : 1.0f;
+        float distance = 0.0f;
+        for (int i = 0; i < 4; ++i)
+        {
+            distance += (a[i] - sign * b[i]) * (a[i] - sign * b[i]);
+        }
+        return 4.0f * std::asin(std::min(std::sqrt(distance) * 0.5f, 1.0f));
+    }
+
+    // Whether `compressed` samples within twice the bounds of `source` at
+    // every frame and between frames.
+    bool withinBounds(const ModelData& source, const ModelData& compressed, const AnimationCompressionOptions& options)
+    {
+        AnimationPose expected;
+        AnimationPose actual;
+        expected.bind(source, 0);
+        actual.bind(compressed, 0);
+        std::vector<float> expectedWeights(source.morphWeights.size());
+        std::vector<float> actualWeights(compressed.morphWeights.size());
+        const float duration = source.animations[0].duration;
+        for (float time = -0.1f; time <= duration + 0.1f; time += 0.5f / kFrameRate)
+        {
+            sampleAnimation(source, time, expected, expectedWeights.data());
+            sampleAnimation(compressed, time, actual, actualWeights.data());
+            for (size_t slot = 0; slot < expected.getSlotCount(); ++slot)
+            {
+                float expectedRotation[4];
+                float actualRotation[4];
+                for (int c = 0; c < 4; ++c)
+                {
+                    const AnimationPose::Component component = static_cast<AnimationPose::Component>(AnimationPose::kRotationX + c);
+                    expectedRotation[c] = expected.getComponent(component)[slot];
+                    actualRotation[c] = actual.getComponent(component)[slot];
+                }
+                if (rotationError(expectedRotation, actualRotation) > 2.0f * options.maxRotationError + 2e-4f)
+                {
+                    return false;
+                }
+                for (int c = 0; c < 3; ++c)
+                {
+                    const AnimationPose::Component translation = static_cast<AnimationPose::Component>(AnimationPose::kTranslationX + c);
+                    const AnimationPose::Component scale = static_cast<AnimationPose::Component>(AnimationPose::kScaleX + c);
+                    if (std::fabs(expected.getComponent(translation)[slot] - actual.getComponent(translation)[slot]) >
+                            2.0f * options.maxTranslationError + 1e-5f ||
+                        std::fabs(expected.getComponent(scale)[slot] - actual.getComponent(scale)[slot]) >
+                            2.0f * options.maxScaleError + 1e-5f)
+                    {
+                        return false;
+                    }
+                }
+            }
+            for (size_t w = 0; w < expectedWeights.size(); ++w)
+            {
+                if (std::fabs(expectedWeights[w] - actualWeights[w]) > options.maxWeightError + 1e-5f)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Plays a clip frame by frame on `instanceCount` poses spread evenly
+    // over it, the way a crowd plays one clip. Each block of frames keeps its
+    // best time over the repeats, which filters out preemption without
+    // favouring any part of the clip.
+    class ClipSampler
+    {
+    public:
+        static const uint32_t kBlockFrames = 64;
+
+        ClipSampler(const ModelData& model, uint32_t instanceCount)
+            : m_model(model),
+              m_poses(instanceCount),
+              m_weights(model.morphWeights.size()),
+              m_frameCount(static_cast<uint32_t>(model.animations[0].duration * kFrameRate) + 1),
+              m_blockSeconds(getBlockCount(), 1e30)
+        {
+            for (AnimationPose& pose : m_poses)
+            {
+                pose.bind(model, 0);
+            }
+        }
+
+        size_t getBlockCount() const { return (m_frameCount + kBlockFrames - 1) / kBlockFrames; }
+
+        void sampleBlock(size_t block)
+        {
+            const uint32_t firstFrame = static_cast<uint32_t>(block) * kBlockFrames;
+            const uint32_t endFrame = std::min(m_frameCount, firstFrame + kBlockFrames);
+            const double start = Bench::now();
+            for (uint32_t frame = firstFrame; frame < endFrame; ++frame)
+            {
+                for (size_t i = 0; i < m_poses.size(); ++i)
+                {
+                    const uint32_t instanceFrame = (frame + static_cast<uint32_t>(i * m_frameCount / m_poses.size())) % m_frameCount;
+                    sampleAnimation(m_model, static_cast<float>(instanceFrame) / kFrameRate, m_poses[i], m_weights.data());
+                }
+            }
+            Bench::keep(m_poses[0].getComponent(AnimationPose::kRotationW)[0]);
+            m_blockSeconds[block] = std::min(m_blockSeconds[block], Bench::now() - start);
+        }
+
+        double getMicrosecondsPerPose() const
+        {
+            double total = 0.0;
+            for (double seconds : m_blockSeconds)
+            {
+                total += seconds;
+            }
+            return total / (static_cast<double>(m_frameCount) * m_poses.size()) * 1e6;
+        }
+
+    private:
+        const ModelData& m_model;
+        std::vector<AnimationPose> m_poses;
+        std::vector<float> m_weights;
+        uint32_t m_frameCount;
+        std::vector<double> m_blockSeconds;
+    };
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const uint32_t keyCount = quick ? 300 : 6000;
+    const int repeats = quick ? 1 : 5;
+
+    const ModelData source = makeCapture(keyCount);
+    AnimationCompressionOptions options;
+
+    ModelData packed = source;
+    const double start = Bench::now();
+    const AnimationCompressionStats stats = compressAnimations(packed, options);
+    const double compressSeconds = Bench::now() - start;
+
+    AnimationCompressionOptions floatOptions = options;
+    floatOptions.quantize = false;
+    ModelData reduced = source;
+    const AnimationCompressionStats reducedStats = compressAnimations(reduced, floatOptions);
+
+    if (!withinBounds(source, packed, options) || !withinBounds(source, reduced, floatOptions))
+    {
+        std::printf("compressed samples exceed the error bounds\n");
+        return 1;
+    }
+
+    // Blocks alternate between the forms so drift in clock speed hits all of them
+    const ModelData* pForms[3] = { &source, &reduced, &packed };
+    std::vector<ClipSampler> samplers;
+    for (uint32_t instanceCount : { 1u, kCrowdSize })
+    {
+        for (const ModelData* pForm : pForms)
+        {
+            samplers.emplace_back(*pForm, instanceCount);
+        }
+    }
+    for (int r = 0; r < repeats; ++r)
+    {
+        for (size_t block = 0; block < samplers[0].getBlockCount(); ++block)
+        {
+            for (ClipSampler& sampler : samplers)
+            {
+                sampler.sampleBlock(block);
+            }
+        }
+    }
+
+    const AnimationCompressionStats* pStats[3] = { nullptr, &reducedStats, &stats };
+    const char* pNames[3] = { "source", "reduced", "packed" };
+    std::printf("%u nodes, %zu channels, %.0f s at %.0f Hz, us per pose (best of %d)\n", kNodeCount,
+                source.animationChannels.size(), source.animations[0].duration, kFrameRate, repeats);
+    std::printf("           keys        MB   1 instance  %u instances\n", kCrowdSize);
+    for (int f = 0; f < 3; ++f)
+    {
+        const uint64_t keys = pStats[f] ? pStats[f]->keysAfter : stats.keysBefore;
+        const uint64_t bytes = pStats[f] ? pStats[f]->bytesAfter : stats.bytesBefore;
+        std::printf("%-8s %8llu  %8.2f  %11.2f  %12.2f\n", pNames[f], static_cast<unsigned long long>(keys),
+                    Bench::toMB(bytes), samplers[f].getMicrosecondsPerPose(), samplers[3 + f].getMicrosecondsPerPose());
+    }
+    std::printf("packed: %u channels, %.1fx smaller, compressed in %.1f ms\n", stats.packedChannels,
+                static_cast<double>(stats.bytesBefore) / static_cast<double>(stats.bytesAfter), compressSeconds * 1e3);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace Bench
+    {
+        // Wall clock seconds since an arbitrary start.
+        inline double now()
+        {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // --quick shrinks a benchmark to a few milliseconds of work; ctest runs
+        // every benchmark that way so they keep building and running.
+        inline bool isQuick(int argc, char** argv)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                if (std::strcmp(argv[i], "--quick") == 0)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Keeps the compiler from discarding a result that is never read.
+        template <typename T>
+        inline void keep(const T& value)
+        {
+            asm volatile("" : : "r"(&value) : "memory");
+        }
+
+        inline double toMB(uint64_t bytes)
+        {
+            return static_cast<double>(bytes) / (1024.0 * 1024.0);
+        }
+
+        // Runs `pass` once and lowers `best` to its time if it was faster.
+        template <typename Pass>
+        inline void timeBest(double& best, const Pass& pass)
+        {
+            const double start = now();
+            pass();
+            best = std::min(best, now() - start);
+        }
+
+        // Best time of each pass over `repeats` rounds. Every round runs all
+        // the passes in turn, so drift in clock speed over the run hits them
+        // alike instead of favouring whichever ran in the fast stretch.
+        template <typename... Passes>
+        inline std::array<double, sizeof...(Passes)> bestSeconds(int repeats, const Passes&... passes)
+        {
+            std::array<double, sizeof...(Passes)> best;
+            best.fill(1e30);
+            for (int r = 0; r < repeats; ++r)
+            {
+                size_t i = 0;
+                (timeBest(best[i++], passes), ...);
+            }
+            return best;
+        }
+    } // namespace Bench
+} // namespace Pinnacle
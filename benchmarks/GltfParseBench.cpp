@@ -0,0 +1,234 @@
+// glTF JSON throughput: the streaming GltfParser against tinygltf, on a
+// generated text-heavy scene (named nodes in a hierarchy with TRS, one mesh
+// per ten nodes, four accessors per mesh with bounds, a few materials). The
+// document is written to a temporary directory next to its small .bin, so
+// both sides read real files:
+//   parse:  parseGltfJson() on the file's text vs LoadASCIIFromFile()
+//   import: GltfImporter::importFile() vs LoadASCIIFromFile() + importModel()
+// Both imports must produce the same node, primitive and vertex counts.
+//
+// Usage: GltfParseBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Asset/GltfImporter.hpp"
+#include "Asset/GltfParser.hpp"
+#include "Core/MappedFile.hpp"
+#include "tiny_gltf.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    // One triangle: positions, normals, UVs, then three 16-bit indices.
+    const uint32_t kPositionOffset = 0;
+    const uint32_t kNormalOffset = 36;
+    const uint32_t kTexCoordOffset = 72;
+    const uint32_t kIndexOffset = 96;
+    const uint32_t kBinSize = 104;
+
+    void appendf(std::string& text, const char* pFormat, ...) __attribute__((format(printf, 2, 3)));
+
+    void appendf(std::string& text, const char* pFormat, ...)
+    {
+        char buffer[512];
+        va_list args;
+        va_start(args, pFormat);
+        const int length = std::vsnprintf(buffer, sizeof(buffer), pFormat, args);
+        va_end(args);
+        text.append(buffer, static_cast<size_t>(std::min<int>(length, sizeof(buffer) - 1)));
+    }
+
+    std::string makeGltf(uint32_t nodeCount)
+    {
+        const uint32_t meshCount = std::max(1u, nodeCount / 10);
+        const uint32_t materialCount = 16;
+        std::string text;
+        text += "{\n  \"asset\": { \"version\": \"2.0\", \"generator\": \"GltfParseBench\" },\n";
+        appendf(text, "  \"buffers\": [ { \"uri\": \"bench.bin\", \"byteLength\": %u } ],\n", kBinSize);
+        appendf(text,
+                "  \"bufferViews\": [\n"
+                "    { \"buffer\": 0, \"byteOffset\": %u, \"byteLength\": 36 },\n"
+                "    { \"buffer\": 0, \"byteOffset\": %u, \"byteLength\": 36 },\n"
+                "    { \"buffer\": 0, \"byteOffset\": %u, \"byteLength\": 24 },\n"
+                "    { \"buffer\": 0, \"byteOffset\": %u, \"byteLength\": 6 }\n  ],\n",
+                kPositionOffset, kNormalOffset, kTexCoordOffset, kIndexOffset);
+
+        text += "  \"accessors\": [\n";
+        for (uint32_t m = 0; m < meshCount; ++m)
+        {
+            appendf(text,
+                    "    { \"bufferView\": 0, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", "
+                    "\"min\": [0.0, 0.0, 0.0], \"max\": [1.0, 1.0, 0.0], \"name\": \"mesh_%u_position\" },\n"
+                    "    { \"bufferView\": 1, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC3\", "
+                    "\"name\": \"mesh_%u_normal\" },\n"
+                    "    { \"bufferView\": 2, \"componentType\": 5126, \"count\": 3, \"type\": \"VEC2\", "
+                    "\"name\": \"mesh_%u_texcoord\" },\n"
+                    "    { \"bufferView\": 3, \"componentType\": 5123, \"count\": 3, \"type\": \"SCALAR\", "
+                    "\"name\": \"mesh_%u_indices\" }%s\n",
+                    m, m, m, m, m + 1 < meshCount ? "," : "");
+        }
+        text += "  ],\n  \"materials\": [\n";
+        for (uint32_t m = 0; m < materialCount; ++m)
+        {
+            appendf(text,
+                    "    { \"name\": \"material_%u\", \"pbrMetallicRoughness\": { \"baseColorFactor\": [%.3f, 0.5, 0.25, 1.0], "
+                    "\"metallicFactor\": 0.0, \"roughnessFactor\": %.3f }, \"doubleSided\": %s }%s\n",
+                    m, m / 16.0, 0.25 + m / 32.0, m % 2 ? "true" : "false", m + 1 < materialCount ? "," : "");
+        }
+        text += "  ],\n  \"meshes\": [\n";
+        for (uint32_t m = 0; m < meshCount; ++m)
+        {
+            appendf(text,
+                    "    { \"name\": \"mesh_%u\", \"primitives\": [ { \"attributes\": { \"POSITION\": %u, \"NORMAL\": %u, "
+                    "\"TEXCOORD_0\": %u }, \"indices\": %u, \"material\": %u } ] }%s\n",
+                    m, m * 4, m * 4 + 1, m * 4 + 2, m * 4 + 3, m % materialCount, m + 1 < meshCount ? "," : "");
+        }
+
+        // Node i's children are 8i + 1 ... 8i + 8: a shallow, wide hierarchy.
+        text += "  ],\n  \"nodes\": [\n";
+        for (uint32_t n = 0; n < nodeCount; ++n)
+        {
+            appendf(text, "    { \"name\": \"node_%u_%s\", \"translation\": [%.4f, %.4f, %.4f], "
+                          "\"rotation\": [0.0, 0.0, 0.3826834, 0.9238795], \"scale\": [1.0, 1.0, 1.0]",
+                    n, n % 10 == 0 ? "mesh" : "group", (n % 97) * 0.25, (n % 13) * 0.5, (n % 31) * -0.125);
+            if (n % 10 == 0)
+            {
+                appendf(text, ", \"mesh\": %u", (n / 10) % meshCount);
+            }
+            const uint32_t firstChild = 8 * n + 1;
+            if (firstChild < nodeCount)
+            {
+                text += ", \"children\": [";
+                for (uint32_t c = firstChild; c < std::min(firstChild + 8, nodeCount); ++c)
+                {
+                    appendf(text, c == firstChild ? "%u" : ", %u", c);
+                }
+                text += "]";
+            }
+            appendf(text, ", \"extras\": { \"layer\": \"layer_%u\", \"selectable\": true } }%s\n", n % 7,
+                    n + 1 < nodeCount ? "," : "");
+        }
+        text += "  ],\n  \"scenes\": [ { \"nodes\": [0] } ],\n  \"scene\": 0\n}\n";
+        return text;
+    }
+
+    std::vector<uint8_t> makeBin()
+    {
+        const float positions[9] = { 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+        const float normals[9] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f };
+        const float texCoords[6] = { 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f };
+        const uint16_t indices[3] = { 0, 1, 2 };
+        std::vector<uint8_t> bin(kBinSize, 0);
+        std::memcpy(bin.data() + kPositionOffset, positions, sizeof(positions));
+        std::memcpy(bin.data() + kNormalOffset, normals, sizeof(normals));
+        std::memcpy(bin.data() + kTexCoordOffset, texCoords, sizeof(texCoords));
+        std::memcpy(bin.data() + kIndexOffset, indices, sizeof(indices));
+        return bin;
+    }
+
+    bool writeFile(const std::filesystem::path& path, const void* pData, size_t size)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file.write(static_cast<const char*>(pData), static_cast<std::streamsize>(size));
+        return static_cast<bool>(file);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const uint32_t nodeCount = quick ? 2000 : 100000;
+    const int repeats = quick ? 1 : 5;
+
+    const std::string text = makeGltf(nodeCount);
+    const std::vector<uint8_t> bin = makeBin();
+    const std::filesystem::path directory =
+        makeTemporaryPath((std::filesystem::temp_directory_path() / "PinnacleGltfParseBench").string());
+    std::filesystem::create_directories(directory);
+    const std::string path = (directory / "bench.gltf").string();
+    if (!writeFile(path, text.data(), text.size()) || !writeFile(directory / "bench.bin", bin.data(), bin.size()))
+    {
+        std::printf("cannot write %s\n", path.c_str());
+        return 1;
+    }
+
+    // A failed pass clears `loaded` and keeps its error for the report.
+    bool loaded = true;
+    std::string error;
+    std::string warning;
+    ModelData streamingModel;
+    ModelData tinygltfModel;
+    const auto [streamingParse, tinygltfParse, streamingImport, tinygltfImport] = Bench::bestSeconds(repeats,
+        [&]()
+        {
+            MappedFile file;
+            GltfDocument document;
+            loaded = loaded && file.open(path) &&
+                     parseGltfJson(reinterpret_cast<const char*>(file.data()), file.size(), document, error);
+        },
+        [&]()
+        {
+            tinygltf::TinyGLTF loader;
+            tinygltf::Model model;
+            loaded = loaded && loader.LoadASCIIFromFile(&model, &error, &warning, path);
+        },
+        [&]()
+        {
+            GltfImporter importer;
+            streamingModel = ModelData();
+            if (loaded && !importer.importFile(path, streamingModel))
+            {
+                error = importer.getError();
+                loaded = false;
+            }
+        },
+        [&]()
+        {
+            tinygltf::TinyGLTF loader;
+            tinygltf::Model model;
+            GltfImporter importer;
+            tinygltfModel = ModelData();
+            loaded = loaded && loader.LoadASCIIFromFile(&model, &error, &warning, path);
+            if (loaded && !importer.importModel(model, tinygltfModel))
+            {
+                error = importer.getError();
+                loaded = false;
+            }
+        });
+    std::filesystem::remove_all(directory);
+
+    if (!loaded)
+    {
+        std::printf("load failed: %s\n", error.c_str());
+        return 1;
+    }
+    if (streamingModel.nodes.size() != tinygltfModel.nodes.size() ||
+        streamingModel.primitives.size() != tinygltfModel.primitives.size() ||
+        streamingModel.vertices.size() != tinygltfModel.vertices.size())
+    {
+        std::printf("imports disagree: %zu/%zu nodes, %zu/%zu primitives\n", streamingModel.nodes.size(),
+                    tinygltfModel.nodes.size(), streamingModel.primitives.size(), tinygltfModel.primitives.size());
+        return 1;
+    }
+
+    const double megabytes = Bench::toMB(text.size());
+    std::printf("%u nodes, %zu meshes, %.1f MB of JSON (best of %d)\n", nodeCount, streamingModel.meshes.size(), megabytes,
+                repeats);
+    std::printf("parse   streaming:         %8.2f ms  %7.1f MB/s\n", streamingParse * 1e3, megabytes / streamingParse);
+    std::printf("parse   tinygltf:          %8.2f ms  %7.1f MB/s  (%.1fx slower)\n", tinygltfParse * 1e3,
+                megabytes / tinygltfParse, tinygltfParse / streamingParse);
+    std::printf("import  importFile:        %8.2f ms\n", streamingImport * 1e3);
+    std::printf("import  tinygltf + import: %8.2f ms  (%.1fx slower)\n", tinygltfImport * 1e3,
+                tinygltfImport / streamingImport);
+    return 0;
+}
@@ -0,0 +1,114 @@
+// JobSystem scaling and overhead. Scaling runs the same CPU-bound batch
+// through parallelFor() capped at 1, 2, 4 ... threads and reports speedup
+// over one thread; overhead measures empty jobs queued from the main thread
+// and spawned from inside jobs that wait() on their children. Scaling stops
+// at the hardware thread count: past that the numbers only measure the OS
+// scheduler.
+//
+// Usage: JobSystemBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Core/JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    // About 10 µs of dependent arithmetic, no memory traffic.
+    float work(size_t item)
+    {
+        float x = static_cast<float>(item % 97) * 0.01f;
+        for (int i = 0; i < 2000; ++i)
+        {
+            x = x * 0.9999f + std::sqrt(x + 1.0f) * 0.001f;
+        }
+        return x;
+    }
+
+    void spawnTree(JobSystem& jobs, uint32_t fanout, uint32_t depth, std::atomic<uint32_t>& ran)
+    {
+        ran++;
+        if (depth == 0)
+        {
+            return;
+        }
+        JobCounter children;
+        for (uint32_t c = 0; c < fanout; ++c)
+        {
+            jobs.run([&jobs, fanout, depth, &ran]() { spawnTree(jobs, fanout, depth - 1, ran); }, &children);
+        }
+        jobs.wait(children);
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    const int repeats = quick ? 1 : 5;
+    JobSystem jobs(std::max(1u, hardwareThreads - 1));
+    std::printf("%u hardware threads, %u workers + caller\n", hardwareThreads, jobs.getWorkerCount());
+
+    const size_t itemCount = quick ? 256 : 8192;
+    std::vector<float> results(itemCount);
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < hardwareThreads; threads *= 2)
+    {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(hardwareThreads);
+    const uint32_t jobCount = quick ? 10000 : 1000000;
+    const uint32_t depth = quick ? 4 : 6;
+    std::atomic<uint32_t> ran{ 0 };
+
+    // Every round runs each measurement once so clock drift hits them alike
+    std::vector<double> scalingSeconds(threadCounts.size(), 1e30);
+    double flatSeconds = 1e30;
+    double treeSeconds = 1e30;
+    for (int r = 0; r < repeats; ++r)
+    {
+        for (size_t t = 0; t < threadCounts.size(); ++t)
+        {
+            Bench::timeBest(scalingSeconds[t], [&]()
+            {
+                jobs.parallelFor(itemCount, 4, [&](size_t i) { results[i] = work(i); }, threadCounts[t]);
+                Bench::keep(results[itemCount / 2]);
+            });
+        }
+        Bench::timeBest(flatSeconds, [&]()
+        {
+            JobCounter counter;
+            for (uint32_t i = 0; i < jobCount; ++i)
+            {
+                jobs.run([]() {}, &counter);
+            }
+            jobs.wait(counter);
+        });
+        // 8^6 leaves under inner jobs that each wait() on their children.
+        Bench::timeBest(treeSeconds, [&]()
+        {
+            ran = 0;
+            spawnTree(jobs, 8, depth, ran);
+        });
+    }
+
+    for (size_t t = 0; t < threadCounts.size(); ++t)
+    {
+        const double seconds = scalingSeconds[t];
+        std::printf("parallelFor %zu items, %2u threads: %8.2f ms  %5.2fx  %5.1f%% efficiency\n", itemCount, threadCounts[t],
+                    seconds * 1e3, scalingSeconds[0] / seconds, 100.0 * scalingSeconds[0] / seconds / threadCounts[t]);
+    }
+    std::printf("empty jobs from main:     %8.2f M jobs/s  %6.0f ns/job\n", jobCount / flatSeconds * 1e-6,
+                flatSeconds * 1e9 / jobCount);
+    std::printf("nested spawn + wait:      %8.2f M jobs/s  %6.0f ns/job  (%u jobs)\n", ran.load() / treeSeconds * 1e-6,
+                treeSeconds * 1e9 / ran.load(), ran.load());
+    return 0;
+}
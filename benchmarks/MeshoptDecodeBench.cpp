@@ -0,0 +1,446 @@
+// EXT_meshopt_compression decode throughput: a quantized terrain grid
+// (16-byte vertices: int16 position, octahedral int8 normal, uint16 UV)
+// is encoded with the vertex codec and the index codec v1, then decoded
+// with decodeMeshoptBufferView(), plain and with the octahedral filter on
+// the normals. The repo carries no encoder, so a minimal one lives here:
+// the vertex codec picks the smallest of the four byte-group encodings,
+// and the index codec follows the reference encoder's edge and vertex
+// FIFOs, so both streams are shaped like exporter output. Decoded data
+// must match the source exactly, up to the rotation of each triangle.
+//
+// Usage: MeshoptDecodeBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Asset/MeshoptDecoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    struct Vertex
+    {
+        int16_t position[4];
+        int8_t normal[4];
+        uint16_t texCoord[2];
+    };
+    static_assert(sizeof(Vertex) == 16, "Vertex must be tightly packed");
+
+    const size_t kByteGroupSize = 16;
+    const size_t kTailMinSize = 32;
+
+    uint8_t zigzag8(uint8_t delta)
+    {
+        return static_cast<uint8_t>(((delta & 0x80) ? 0xFF : 0x00) ^ (delta << 1));
+    }
+
+    // Encodes one 16-byte group in `bits` (0, 2, 4 or 8) per byte; values
+    // that do not fit escape to a literal byte.
+    void encodeBytesGroup(std::vector<uint8_t>& out, const uint8_t* pGroup, int bits)
+    {
+        if (bits == 0)
+        {
+            return;
+        }
+        if (bits == 8)
+        {
+            out.insert(out.end(), pGroup, pGroup + kByteGroupSize);
+            return;
+        }
+        const uint8_t escape = static_cast<uint8_t>((1 << bits) - 1);
+        const size_t packedStart = out.size();
+        out.resize(out.size() + kByteGroupSize * bits / 8, 0);
+        for (size_t i = 0; i < kByteGroupSize; ++i)
+        {
+            const uint8_t value = pGroup[i] >= escape ? escape : pGroup[i];
+            const int shift = 8 - bits - static_cast<int>(i * bits % 8);
+            out[packedStart + i * bits / 8] |= static_cast<uint8_t>(value << shift);
+        }
+        for (size_t i = 0; i < kByteGroupSize; ++i)
+        {
+            if (pGroup[i] >= escape)
+            {
+                out.push_back(pGroup[i]);
+            }
+        }
+    }
+
+    size_t getGroupSize(const uint8_t* pGroup, int bits)
+    {
+        if (bits == 0)
+        {
+            return std::all_of(pGroup, pGroup + kByteGroupSize, [](uint8_t value) { return value == 0; }) ? 0 : SIZE_MAX;
+        }
+        if (bits == 8)
+        {
+            return kByteGroupSize;
+        }
+        const uint8_t escape = static_cast<uint8_t>((1 << bits) - 1);
+        return kByteGroupSize * bits / 8 +
+               static_cast<size_t>(std::count_if(pGroup, pGroup + kByteGroupSize, [escape](uint8_t value) { return value >= escape; }));
+    }
+
+    void encodeBytes(std::vector<uint8_t>& out, const uint8_t* pData, size_t count)
+    {
+        const size_t headerStart = out.size();
+        out.resize(out.size() + (count / kByteGroupSize + 3) / 4, 0);
+        for (size_t i = 0; i < count; i += kByteGroupSize)
+        {
+            int bestLog2 = 3;
+            for (int bitsLog2 = 0; bitsLog2 < 3; ++bitsLog2)
+            {
+                if (getGroupSize(pData + i, bitsLog2 == 0 ? 0 : 1 << bitsLog2) < getGroupSize(pData + i, bestLog2 == 3 ? 8 : 1 << bestLog2))
+                {
+                    bestLog2 = bitsLog2;
+                }
+            }
+            const size_t group = i / kByteGroupSize;
+            out[headerStart + group / 4] |= static_cast<uint8_t>(bestLog2 << ((group % 4) * 2));
+            encodeBytesGroup(out, pData + i, bestLog2 == 0 ? 0 : 1 << bestLog2);
+        }
+    }
+
+    // Vertex codec v0: per block, each byte lane as zigzag deltas from the
+    // previous vertex; the tail holds the first vertex.
+    std::vector<uint8_t> encodeVertices(const uint8_t* pVertices, size_t count, size_t vertexSize)
+    {
+        std::vector<uint8_t> out(1, 0xA0);
+        const size_t blockSize = std::min<size_t>((8192 / vertexSize) & ~(kByteGroupSize - 1), 256);
+        std::vector<uint8_t> last(pVertices, pVertices + vertexSize);
+        uint8_t deltas[256];
+        for (size_t offset = 0; offset < count; offset += blockSize)
+        {
+            const size_t blockCount = std::min(blockSize, count - offset);
+            const size_t alignedCount = (blockCount + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+            for (size_t k = 0; k < vertexSize; ++k)
+            {
+                std::memset(deltas, 0, sizeof(deltas));
+                uint8_t previous = last[k];
+                for (size_t i = 0; i < blockCount; ++i)
+                {
+                    const uint8_t value = pVertices[(offset + i) * vertexSize + k];
+                    deltas[i] = zigzag8(static_cast<uint8_t>(value - previous));
+                    previous = value;
+                }
+                encodeBytes(out, deltas, alignedCount);
+            }
+            std::memcpy(last.data(), pVertices + (offset + blockCount - 1) * vertexSize, vertexSize);
+        }
+        out.resize(out.size() + std::max(vertexSize, kTailMinSize) - vertexSize, 0);
+        out.insert(out.end(), pVertices, pVertices + vertexSize);
+        return out;
+    }
+
+    void encodeIndex(std::vector<uint8_t>& data, uint32_t index, uint32_t& last)
+    {
+        const uint32_t delta = index - last;
+        uint32_t value = (delta << 1) ^ (0u - (delta >> 31));
+        last = index;
+        while (value >= 128)
+        {
+            data.push_back(static_cast<uint8_t>((value & 127) | 128));
+            value >>= 7;
+        }
+        data.push_back(static_cast<uint8_t>(value));
+    }
+
+    // Index codec v1, as the reference encoder writes it.
+    std::vector<uint8_t> encodeTriangles(const std::vector<uint32_t>& indices)
+    {
+        static const uint8_t kAuxTable[16] = { 0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xA9, 0x86,
+                                               0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00 };
+        const int maxFifoCode = 13;
+        uint32_t edges[16][2];
+        uint32_t vertices[16];
+        std::memset(edges, 0xFF, sizeof(edges));
+        std::memset(vertices, 0xFF, sizeof(vertices));
+        size_t edgeOffset = 0;
+        size_t vertexOffset = 0;
+        auto pushEdge = [&](uint32_t a, uint32_t b)
+        {
+            edges[edgeOffset][0] = a;
+            edges[edgeOffset][1] = b;
+            edgeOffset = (edgeOffset + 1) & 15;
+        };
+        auto pushVertex = [&](uint32_t v)
+        {
+            vertices[vertexOffset] = v;
+            vertexOffset = (vertexOffset + 1) & 15;
+        };
+        auto findVertex = [&](uint32_t v)
+        {
+            for (int i = 0; i < 16; ++i)
+            {
+                if (vertices[(vertexOffset - 1 - i) & 15] == v)
+                {
+                    return i;
+                }
+            }
+            return -1;
+        };
+
+        std::vector<uint8_t> codes;
+        std::vector<uint8_t> data;
+        uint32_t next = 0;
+        uint32_t last = 0;
+        for (size_t t = 0; t < indices.size(); t += 3)
+        {
+            const uint32_t triangle[3] = { indices[t], indices[t + 1], indices[t + 2] };
+            int edgeMatch = -1;
+            int rotation = 0;
+            for (int i = 0; i < 16 && edgeMatch < 0; ++i)
+            {
+                const uint32_t* pEdge = edges[(edgeOffset - 1 - i) & 15];
+                for (int r = 0; r < 3; ++r)
+                {
+                    if (pEdge[0] == triangle[r] && pEdge[1] == triangle[(r + 1) % 3])
+                    {
+                        edgeMatch = i;
+                        rotation = r;
+                        break;
+                    }
+                }
+            }
+
+            if (edgeMatch >= 0 && edgeMatch < 15)
+            {
+                const uint32_t a = triangle[rotation];
+                const uint32_t b = triangle[(rotation + 1) % 3];
+                const uint32_t c = triangle[(rotation + 2) % 3];
+                const int fifo = findVertex(c);
+                int vertexCode = fifo >= 1 && fifo < maxFifoCode ? fifo : c == next ? (next++, 0) : 15;
+                if (vertexCode == 15 && c + 1 == last)
+                {
+                    vertexCode = 13;
+                    last = c;
+                }
+                else if (vertexCode == 15 && c == last + 1)
+                {
+                    vertexCode = 14;
+                    last = c;
+                }
+                codes.push_back(static_cast<uint8_t>((edgeMatch << 4) | vertexCode));
+                if (vertexCode == 15)
+                {
+                    encodeIndex(data, c, last);
+                }
+                if (vertexCode == 0 || vertexCode >= maxFifoCode)
+                {
+                    pushVertex(c);
+                }
+                pushEdge(c, b);
+                pushEdge(a, c);
+                continue;
+            }
+
+            rotation = triangle[1] == next ? 1 : triangle[2] == next ? 2 : 0;
+            const uint32_t a = triangle[rotation];
+            const uint32_t b = triangle[(rotation + 1) % 3];
+            const uint32_t c = triangle[(rotation + 2) % 3];
+            const int fifoB = findVertex(b);
+            const int fifoC = findVertex(c);
+            const int codeA = a == next ? (next++, 0) : 15;
+            const int codeB = fifoB >= 0 && fifoB < 14 ? fifoB + 1 : b == next ? (next++, 0) : 15;
+            const int codeC = fifoC >= 0 && fifoC < 14 ? fifoC + 1 : c == next ? (next++, 0) : 15;
+            const uint8_t aux = static_cast<uint8_t>((codeB << 4) | codeC);
+            const uint8_t* pFound = std::find(kAuxTable, kAuxTable + 14, aux);
+            if (codeA == 0 && pFound != kAuxTable + 14)
+            {
+                codes.push_back(static_cast<uint8_t>(0xF0 | (pFound - kAuxTable)));
+            }
+            else
+            {
+                codes.push_back(static_cast<uint8_t>(codeA == 15 ? 0xFF : 0xFE));
+                data.push_back(aux);
+            }
+            if (codeA == 15)
+            {
+                encodeIndex(data, a, last);
+            }
+            if (codeB == 15)
+            {
+                encodeIndex(data, b, last);
+            }
+            if (codeC == 15)
+            {
+                encodeIndex(data, c, last);
+            }
+            pushVertex(a);
+            if (codeB == 0 || codeB == 15)
+            {
+                pushVertex(b);
+            }
+            if (codeC == 0 || codeC == 15)
+            {
+                pushVertex(c);
+            }
+            pushEdge(b, a);
+            pushEdge(c, b);
+            pushEdge(a, c);
+        }
+
+        std::vector<uint8_t> out(1, 0xE1);
+        out.insert(out.end(), codes.begin(), codes.end());
+        out.insert(out.end(), data.begin(), data.end());
+        out.insert(out.end(), kAuxTable, kAuxTable + 16);
+        return out;
+    }
+
+    // Row-major grid triangles, vertices renumbered in first-use order as
+    // a vertex fetch optimizer leaves them.
+    void makeGrid(uint32_t size, std::vector<Vertex>& outVertices, std::vector<uint32_t>& outIndices)
+    {
+        std::vector<uint32_t> gridIndices;
+        for (uint32_t y = 0; y + 1 < size; ++y)
+        {
+            for (uint32_t x = 0; x + 1 < size; ++x)
+            {
+                const uint32_t v0 = y * size + x;
+                const uint32_t v1 = v0 + 1;
+                const uint32_t v2 = v0 + size;
+                const uint32_t v3 = v2 + 1;
+                gridIndices.insert(gridIndices.end(), { v0, v2, v1, v1, v2, v3 });
+            }
+        }
+        std::vector<uint32_t> remap(size * size, UINT32_MAX);
+        outVertices.resize(size * size);
+        uint32_t next = 0;
+        outIndices.clear();
+        for (uint32_t index : gridIndices)
+        {
+            if (remap[index] == UINT32_MAX)
+            {
+                const float x = static_cast<float>(index % size);
+                const float y = static_cast<float>(index / size);
+                const float height = std::sin(x * 0.05f) * std::cos(y * 0.07f);
+                const float nx = -std::cos(x * 0.05f) * std::cos(y * 0.07f) * 0.05f;
+                const float ny = std::sin(x * 0.05f) * std::sin(y * 0.07f) * 0.07f;
+                const float length = std::sqrt(nx * nx + ny * ny + 1.0f);
+                Vertex& vertex = outVertices[next];
+                vertex.position[0] = static_cast<int16_t>(x * 16.0f);
+                vertex.position[1] = static_cast<int16_t>(height * 2048.0f);
+                vertex.position[2] = static_cast<int16_t>(y * 16.0f);
+                vertex.position[3] = 0;
+                // Octahedral: xy on the octahedron, z carries the scale (127).
+                const float sum = std::fabs(nx) + std::fabs(ny) + 1.0f;
+                vertex.normal[0] = static_cast<int8_t>(std::lround(nx / length / (sum / length) * 127.0f));
+                vertex.normal[1] = static_cast<int8_t>(std::lround(ny / length / (sum / length) * 127.0f));
+                vertex.normal[2] = 127;
+                vertex.normal[3] = 0;
+                vertex.texCoord[0] = static_cast<uint16_t>(x * 65535.0f / (size - 1));
+                vertex.texCoord[1] = static_cast<uint16_t>(y * 65535.0f / (size - 1));
+                remap[index] = next++;
+            }
+            outIndices.push_back(remap[index]);
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const uint32_t gridSize = quick ? 64 : 1024;
+    const int repeats = quick ? 1 : 10;
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    makeGrid(gridSize, vertices, indices);
+    const size_t vertexBytes = vertices.size() * sizeof(Vertex);
+    const size_t triangleCount = indices.size() / 3;
+
+    const std::vector<uint8_t> encodedVertices =
+        encodeVertices(reinterpret_cast<const uint8_t*>(vertices.data()), vertices.size(), sizeof(Vertex));
+    const std::vector<uint8_t> encodedIndices = encodeTriangles(indices);
+
+    // Normals alone, as a separate view so the octahedral filter applies.
+    std::vector<uint8_t> normals(vertices.size() * 4);
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        std::memcpy(&normals[i * 4], vertices[i].normal, 4);
+    }
+    const std::vector<uint8_t> encodedNormals = encodeVertices(normals.data(), vertices.size(), 4);
+
+    GltfMeshoptCompression vertexView;
+    vertexView.mode = GltfMeshoptCompression::Mode::Attributes;
+    vertexView.count = vertices.size();
+    vertexView.byteStride = sizeof(Vertex);
+    GltfMeshoptCompression normalView = vertexView;
+    normalView.byteStride = 4;
+    normalView.filter = GltfMeshoptCompression::Filter::Octahedral;
+    GltfMeshoptCompression indexView;
+    indexView.mode = GltfMeshoptCompression::Mode::Triangles;
+    indexView.count = indices.size();
+    indexView.byteStride = 4;
+
+    std::vector<uint8_t> decodedVertices(vertexBytes);
+    std::vector<uint8_t> decodedNormals(normals.size());
+    std::vector<uint32_t> decodedIndices(indices.size());
+    bool decoded = true;
+    const auto [vertexSeconds, normalSeconds, indexSeconds] = Bench::bestSeconds(repeats,
+        [&]()
+        {
+            decoded &= decodeMeshoptBufferView(vertexView, encodedVertices.data(), encodedVertices.size(),
+                                               decodedVertices.data());
+        },
+        [&]()
+        {
+            decoded &= decodeMeshoptBufferView(normalView, encodedNormals.data(), encodedNormals.size(),
+                                               decodedNormals.data());
+        },
+        [&]()
+        {
+            decoded &= decodeMeshoptBufferView(indexView, encodedIndices.data(), encodedIndices.size(),
+                                               reinterpret_cast<uint8_t*>(decodedIndices.data()));
+        });
+
+    if (!decoded)
+    {
+        std::printf("decode failed\n");
+        return 1;
+    }
+    // The index codec keeps each triangle's winding but may rotate it.
+    bool trianglesMatch = true;
+    for (size_t t = 0; t < indices.size() && trianglesMatch; t += 3)
+    {
+        const uint32_t* pSource = &indices[t];
+        const uint32_t* pDecoded = &decodedIndices[t];
+        trianglesMatch = false;
+        for (int r = 0; r < 3; ++r)
+        {
+            trianglesMatch |= pDecoded[0] == pSource[r] && pDecoded[1] == pSource[(r + 1) % 3] && pDecoded[2] == pSource[(r + 2) % 3];
+        }
+    }
+    if (std::memcmp(decodedVertices.data(), vertices.data(), vertexBytes) != 0 || !trianglesMatch)
+    {
+        std::printf("decoded data does not match the source\n");
+        return 1;
+    }
+    // The filter renormalizes to unit length; every normal must come back so.
+    for (size_t i = 0; i < vertices.size(); ++i)
+    {
+        const int8_t* pNormal = reinterpret_cast<const int8_t*>(&decodedNormals[i * 4]);
+        const float length = std::sqrt(static_cast<float>(pNormal[0] * pNormal[0] + pNormal[1] * pNormal[1] + pNormal[2] * pNormal[2]));
+        if (std::fabs(length - 127.0f) > 1.5f)
+        {
+            std::printf("filtered normal %zu has length %.1f\n", i, length);
+            return 1;
+        }
+    }
+
+    std::printf("%zu vertices (%zu bytes each), %zu triangles (best of %d)\n", vertices.size(), sizeof(Vertex), triangleCount,
+                repeats);
+    std::printf("vertex codec:        %6.2f MB -> %6.2f MB  %7.2f ms  %7.1f MB/s decoded\n", Bench::toMB(vertexBytes),
+                Bench::toMB(encodedVertices.size()), vertexSeconds * 1e3, Bench::toMB(vertexBytes) / vertexSeconds);
+    std::printf("normals + octahedral:%6.2f MB -> %6.2f MB  %7.2f ms  %7.1f MB/s decoded\n", Bench::toMB(normals.size()),
+                Bench::toMB(encodedNormals.size()), normalSeconds * 1e3, Bench::toMB(normals.size()) / normalSeconds);
+    std::printf("index codec v1:      %6.2f MB -> %6.2f MB  %7.2f ms  %7.1f M triangles/s\n",
+                Bench::toMB(indices.size() * 4), Bench::toMB(encodedIndices.size()), indexSeconds * 1e3,
+                triangleCount / indexSeconds * 1e-6);
+    return 0;
+}
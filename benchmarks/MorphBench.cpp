@@ -0,0 +1,233 @@
+// Morph target blending throughput on a configurator-style primitive: many
+// targets, each moving one local region of the mesh, and only a few
+// weighted at a time. Every frame animates one of the four active weights.
+// The frame is blended three ways:
+//   dense:       glTF's own layout, a delta for every vertex of every
+//                target, each weighted target added over all vertices
+//   full:        the sparse deltas of the active targets, with every vertex
+//                reset to rest first (no change tracking)
+//   incremental: MorphedPrimitive::update(), rebuilding only the span of
+//                the target whose weight changed
+// After the run, the incremental vertices must match the dense blend.
+//
+// Usage: MorphBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Animation/MorphTargets.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    const uint32_t kActiveTargets[4] = { 0, 5, 11, 17 };
+
+    // Position, normal and texture coordinates as eight consecutive floats.
+    float* getComponents(ModelVertex& vertex)
+    {
+        static_assert(sizeof(ModelVertex) == 8 * sizeof(float), "ModelVertex is eight floats");
+        return reinterpret_cast<float*>(&vertex);
+    }
+
+    const float* getComponents(const ModelVertex& vertex)
+    {
+        return reinterpret_cast<const float*>(&vertex);
+    }
+
+    // The weights of frame `frame`: four active targets, one of them moving.
+    void setWeights(uint32_t frame, std::vector<float>& weights)
+    {
+        std::fill(weights.begin(), weights.end(), 0.0f);
+        for (uint32_t a = 0; a < 4; ++a)
+        {
+            weights[kActiveTargets[a] % weights.size()] = 0.25f * static_cast<float>(a + 1);
+        }
+        const uint32_t moving = kActiveTargets[frame % 4] % weights.size();
+        weights[moving] = 0.5f + 0.4f * std::sin(static_cast<float>(frame) * 0.1f);
+    }
+
+    // One primitive of `vertexCount` vertices with `targetCount` targets, each
+    // moving every other vertex of a `regionSize` region.
+    void makeModel(uint32_t vertexCount, uint32_t targetCount, uint32_t regionSize, ModelData& model,
+                   std::vector<std::vector<ModelVertex>>& dense)
+    {
+        model.vertices.resize(vertexCount);
+        for (uint32_t v = 0; v < vertexCount; ++v)
+        {
+            ModelVertex& vertex = model.vertices[v];
+            vertex.position[0] = static_cast<float>(v % 256) * 0.01f;
+            vertex.position[1] = static_cast<float>(v / 256) * 0.01f;
+            vertex.position[2] = 0.0f;
+            vertex.normal[0] = 0.0f;
+            vertex.normal[1] = 0.0f;
+            vertex.normal[2] = 1.0f;
+            vertex.texCoords[0] = vertex.position[0];
+            vertex.texCoords[1] = vertex.position[1];
+        }
+
+        PrimitiveData primitive;
+        primitive.vertexCount = vertexCount;
+        primitive.morphTargetCount = targetCount;
+        model.primitives.push_back(primitive);
+
+        dense.assign(targetCount, std::vector<ModelVertex>(vertexCount, ModelVertex()));
+        for (uint32_t t = 0; t < targetCount; ++t)
+        {
+            MorphTargetData target;
+            target.firstDelta = static_cast<uint32_t>(model.morphDeltas.size());
+            const uint32_t regionStart = static_cast<uint32_t>((t * 7919ull) % (vertexCount - regionSize));
+            for (uint32_t v = regionStart; v < regionStart + regionSize; v += 2)
+            {
+                ModelVertex delta = ModelVertex();
+                delta.position[2] = 0.05f * static_cast<float>((v + t) % 17);
+                delta.normal[0] = 0.01f * static_cast<float>(t % 5);
+                delta.texCoords[1] = 0.001f;
+                model.morphDeltas.push_back(delta);
+                model.morphDeltaVertices.push_back(v);
+                target.deltaBounds.expand(delta.position);
+                dense[t][v] = delta;
+            }
+            target.deltaCount = static_cast<uint32_t>(model.morphDeltas.size()) - target.firstDelta;
+            model.morphTargets.push_back(target);
+        }
+    }
+
+    void blendDense(const ModelData& model, const std::vector<std::vector<ModelVertex>>& dense, const float* pWeights,
+                    ModelVertex* pOut)
+    {
+        const size_t vertexCount = model.vertices.size();
+        std::memcpy(pOut, model.vertices.data(), vertexCount * sizeof(ModelVertex));
+        for (size_t t = 0; t < dense.size(); ++t)
+        {
+            const float weight = pWeights[t];
+            if (weight == 0.0f)
+            {
+                continue;
+            }
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                float* pVertex = getComponents(pOut[v]);
+                const float* pDelta = getComponents(dense[t][v]);
+                for (int c = 0; c < 8; ++c)
+                {
+                    pVertex[c] += weight * pDelta[c];
+                }
+            }
+        }
+    }
+
+    void blendFull(const ModelData& model, const float* pWeights, ModelVertex* pOut)
+    {
+        const PrimitiveData& primitive = model.primitives[0];
+        std::memcpy(pOut, model.vertices.data(), primitive.vertexCount * sizeof(ModelVertex));
+        for (uint32_t t = 0; t < primitive.morphTargetCount; ++t)
+        {
+            if (pWeights[t] != 0.0f)
+            {
+                accumulateMorphTarget(model, model.morphTargets[t], pWeights[t], 0, primitive.vertexCount, pOut);
+            }
+        }
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const uint32_t vertexCount = quick ? 8192 : 65536;
+    const uint32_t targetCount = quick ? 24 : 48;
+    const uint32_t regionSize = vertexCount / 16;
+    const uint32_t frameCount = quick ? 8 : 200;
+    const int repeats = quick ? 1 : 5;
+
+    ModelData model;
+    std::vector<std::vector<ModelVertex>> dense;
+    makeModel(vertexCount, targetCount, regionSize, model, dense);
+
+    std::vector<float> weights(targetCount);
+    std::vector<ModelVertex> denseVertices(vertexCount);
+    std::vector<ModelVertex> fullVertices(vertexCount);
+
+    MorphedPrimitive morphed;
+    morphed.bind(model, 0);
+    setWeights(frameCount - 1, weights);
+    morphed.update(model, weights.data());
+    uint64_t rebuiltVertices = 0;
+    const auto [denseSeconds, fullSeconds, incrementalSeconds, unchangedSeconds] = Bench::bestSeconds(repeats,
+        [&]()
+        {
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                setWeights(frame, weights);
+                blendDense(model, dense, weights.data(), denseVertices.data());
+                Bench::keep(denseVertices[0]);
+            }
+        },
+        [&]()
+        {
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                setWeights(frame, weights);
+                blendFull(model, weights.data(), fullVertices.data());
+                Bench::keep(fullVertices[0]);
+            }
+        },
+        [&]()
+        {
+            rebuiltVertices = 0;
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                setWeights(frame, weights);
+                rebuiltVertices += morphed.update(model, weights.data()).vertexCount;
+                Bench::keep(morphed.getVertices()[0]);
+            }
+        },
+        [&]()
+        {
+            // Runs after the incremental pass, on the weights it ended with
+            for (uint32_t frame = 0; frame < frameCount; ++frame)
+            {
+                Bench::keep(morphed.update(model, weights.data()));
+            }
+        });
+
+    // The loops above all end on the weights of the last frame
+    float difference = 0.0f;
+    for (uint32_t v = 0; v < vertexCount; ++v)
+    {
+        for (int c = 0; c < 8; ++c)
+        {
+            const float expected = getComponents(denseVertices[v])[c];
+            difference = std::max(difference, std::fabs(getComponents(morphed.getVertices()[v])[c] - expected));
+            difference = std::max(difference, std::fabs(getComponents(fullVertices[v])[c] - expected));
+        }
+    }
+    if (difference > 1e-5f)
+    {
+        std::printf("morphed vertices differ from the dense blend by %g\n", difference);
+        return 1;
+    }
+
+    uint64_t activeDeltas = 0;
+    for (uint32_t a = 0; a < 4; ++a)
+    {
+        activeDeltas += model.morphTargets[kActiveTargets[a] % targetCount].deltaCount;
+    }
+    const double frames = static_cast<double>(frameCount);
+    std::printf("%u vertices, %u targets of %u deltas, 4 active, %u frames (best of %d)\n", vertexCount, targetCount,
+                model.morphTargets[0].deltaCount, frameCount, repeats);
+    std::printf("dense:        %9.1f us/frame  %8.1f M vertices/s\n", denseSeconds / frames * 1e6,
+                static_cast<double>(vertexCount) * 4 * frames / denseSeconds / 1e6);
+    std::printf("full:         %9.1f us/frame  %8.1f M deltas/s  (%.1fx)\n", fullSeconds / frames * 1e6,
+                static_cast<double>(activeDeltas) * frames / fullSeconds / 1e6, denseSeconds / fullSeconds);
+    std::printf("incremental:  %9.1f us/frame  %8.0f vertices rebuilt/frame  (%.1fx)\n",
+                incrementalSeconds / frames * 1e6, static_cast<double>(rebuiltVertices) / frames,
+                denseSeconds / incrementalSeconds);
+    std::printf("unchanged:    %9.3f us/frame\n", unchangedSeconds / frames * 1e6);
+    return 0;
+}
@@ -0,0 +1,207 @@
+// Traversal of a 1M-node scene: the shared_ptr ownership the scene layer
+// used to have (Scene -> shared_ptr<Model> -> shared_ptr<Node> ->
+// shared_ptr<Mesh> -> shared_ptr<Material>, getMaterial() returning a
+// shared_ptr by value) against SlotMap storage with handles. The scene
+// classes themselves hold Metal objects, so both layouts are mirrored here
+// with plain structs of the same shape; the slot map side uses the real
+// SlotMap. Each pass visits every node's meshes and reads their material,
+// as a draw list build would.
+//
+// Usage: SceneTraversalBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Core/SlotMap.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    const uint32_t kMaterialCount = 1024;
+
+    namespace Shared
+    {
+        struct Material
+        {
+            float baseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        };
+
+        struct Mesh
+        {
+            uint32_t indexCount = 0;
+            std::shared_ptr<Material> pMaterial;
+
+            std::shared_ptr<Material> getMaterial() const { return pMaterial; }
+        };
+
+        struct Node
+        {
+            float transformation[16] = {};
+            std::vector<std::shared_ptr<Mesh>> meshes;
+        };
+
+        struct Model
+        {
+            std::vector<std::shared_ptr<Node>> nodes;
+        };
+    } // namespace Shared
+
+    namespace Handles
+    {
+        struct Material
+        {
+            float baseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        };
+
+        struct Mesh
+        {
+            uint32_t indexCount = 0;
+            Handle<Material> material;
+        };
+
+        struct Node
+        {
+            float transformation[16] = {};
+            std::vector<Handle<Mesh>> meshes;
+        };
+    } // namespace Handles
+
+    double traverse(const std::vector<std::shared_ptr<Shared::Model>>& models)
+    {
+        double sum = 0.0;
+        for (const std::shared_ptr<Shared::Model>& pModel : models)
+        {
+            for (const std::shared_ptr<Shared::Node>& pNode : pModel->nodes)
+            {
+                for (const std::shared_ptr<Shared::Mesh>& pMesh : pNode->meshes)
+                {
+                    const std::shared_ptr<Shared::Material> pMaterial = pMesh->getMaterial();
+                    sum += pNode->transformation[12] * pMaterial->baseColorFactor[0] + pMesh->indexCount;
+                }
+            }
+        }
+        return sum;
+    }
+
+    double traverse(const SlotMap<Handles::Node>& nodes, const SlotMap<Handles::Mesh>& meshes,
+                    const SlotMap<Handles::Material>& materials)
+    {
+        double sum = 0.0;
+        for (const Handles::Node& node : nodes)
+        {
+            for (Handle<Handles::Mesh> meshHandle : node.meshes)
+            {
+                const Handles::Mesh* pMesh = meshes.get(meshHandle);
+                const Handles::Material* pMaterial = materials.get(pMesh->material);
+                sum += node.transformation[12] * pMaterial->baseColorFactor[0] + pMesh->indexCount;
+            }
+        }
+        return sum;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const uint32_t nodeCount = quick ? 20000 : 1000000;
+    const uint32_t modelCount = 100;
+    const int repeats = quick ? 2 : 10;
+    std::mt19937 random(42);
+
+    // Shared: objects allocated in a shuffled order, as loads and unloads
+    // interleave over a session, so neighbours in a node list are not
+    // neighbours in memory.
+    std::vector<std::shared_ptr<Shared::Material>> sharedMaterials;
+    for (uint32_t m = 0; m < kMaterialCount; ++m)
+    {
+        sharedMaterials.push_back(std::make_shared<Shared::Material>());
+    }
+    std::vector<std::shared_ptr<Shared::Node>> sharedNodes(nodeCount);
+    std::vector<uint32_t> order(nodeCount);
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), random);
+    for (uint32_t i : order)
+    {
+        std::shared_ptr<Shared::Node> pNode = std::make_shared<Shared::Node>();
+        pNode->transformation[12] = static_cast<float>(i % 7);
+        std::shared_ptr<Shared::Mesh> pMesh = std::make_shared<Shared::Mesh>();
+        pMesh->indexCount = 3 * (i % 5);
+        pMesh->pMaterial = sharedMaterials[i % kMaterialCount];
+        pNode->meshes.push_back(pMesh);
+        sharedNodes[i] = pNode;
+    }
+    std::vector<std::shared_ptr<Shared::Model>> sharedModels;
+    for (uint32_t m = 0; m < modelCount; ++m)
+    {
+        std::shared_ptr<Shared::Model> pModel = std::make_shared<Shared::Model>();
+        for (uint32_t i = m; i < nodeCount; i += modelCount)
+        {
+            pModel->nodes.push_back(sharedNodes[i]);
+        }
+        sharedModels.push_back(pModel);
+    }
+    sharedNodes.clear();
+
+    // Handles: the same scene in slot maps, then churned (a tenth of the
+    // nodes removed and re-added) so slots and dense order no longer match.
+    SlotMap<Handles::Material> materials;
+    SlotMap<Handles::Mesh> meshes;
+    SlotMap<Handles::Node> nodes;
+    std::vector<Handle<Handles::Material>> materialHandles;
+    for (uint32_t m = 0; m < kMaterialCount; ++m)
+    {
+        materialHandles.push_back(materials.insert(Handles::Material()));
+    }
+    std::vector<Handle<Handles::Node>> nodeHandles;
+    auto addNode = [&](uint32_t i)
+    {
+        Handles::Mesh mesh;
+        mesh.indexCount = 3 * (i % 5);
+        mesh.material = materialHandles[i % kMaterialCount];
+        Handles::Node node;
+        node.transformation[12] = static_cast<float>(i % 7);
+        node.meshes.push_back(meshes.insert(mesh));
+        return nodes.insert(std::move(node));
+    };
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        nodeHandles.push_back(addNode(i));
+    }
+    std::vector<uint32_t> churned(order.begin(), order.begin() + nodeCount / 10);
+    for (uint32_t i : churned)
+    {
+        meshes.remove(nodes.get(nodeHandles[i])->meshes[0]);
+        nodes.remove(nodeHandles[i]);
+    }
+    for (uint32_t i : churned)
+    {
+        nodeHandles[i] = addNode(i);
+    }
+
+    const double sharedSum = traverse(sharedModels);
+    const double handleSum = traverse(nodes, meshes, materials);
+    if (sharedSum != handleSum)
+    {
+        std::printf("traversals disagree: %g vs %g\n", sharedSum, handleSum);
+        return 1;
+    }
+
+    const auto [sharedSeconds, handleSeconds] =
+        Bench::bestSeconds(repeats, [&]() { Bench::keep(traverse(sharedModels)); },
+                           [&]() { Bench::keep(traverse(nodes, meshes, materials)); });
+    std::printf("%u nodes in %u models, one mesh each, %u materials (best of %d passes)\n", nodeCount, modelCount,
+                kMaterialCount, repeats);
+    std::printf("shared_ptr graph: %8.2f ms  %6.2f ns/node\n", sharedSeconds * 1e3, sharedSeconds * 1e9 / nodeCount);
+    std::printf("slot map handles: %8.2f ms  %6.2f ns/node  (%.1fx faster)\n", handleSeconds * 1e3,
+                handleSeconds * 1e9 / nodeCount, sharedSeconds / handleSeconds);
+    return 0;
+}
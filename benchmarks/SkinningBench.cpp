@@ -0,0 +1,192 @@
+// CPU skinning throughput: skinVertices() on a generated mesh of vertices
+// with four weighted joints each (64 joints, rotations plus translations),
+// against a plain scalar blend of the same matrices. The vectorized path
+// runs once on the calling thread and once split across the job system in
+// fixed-size ranges, the way the renderer's CPU fallback spreads draws.
+// Every skinned position and normal must match the scalar reference.
+//
+// Usage: SkinningBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Animation/Skinning.hpp"
+#include "Core/JobSystem.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    const uint32_t kJointCount = 64;
+    const size_t kRangeSize = 16384;
+
+    uint32_t nextRandom(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    void makeMesh(size_t count, std::vector<ModelVertex>& vertices, std::vector<SkinVertex>& skin)
+    {
+        uint32_t state = 1;
+        vertices.resize(count);
+        skin.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            ModelVertex& vertex = vertices[i];
+            const float angle = static_cast<float>(i % 1024) * (6.2831853f / 1024.0f);
+            vertex.position[0] = std::cos(angle);
+            vertex.position[1] = static_cast<float>(i / 1024) * 0.01f;
+            vertex.position[2] = std::sin(angle);
+            vertex.normal[0] = std::cos(angle);
+            vertex.normal[1] = 0.0f;
+            vertex.normal[2] = std::sin(angle);
+            vertex.texCoords[0] = angle;
+            vertex.texCoords[1] = vertex.position[1];
+
+            // Four distinct neighbouring joints, weights summing to 65535
+            const uint32_t firstJoint = nextRandom(state) % (kJointCount - 3);
+            uint32_t remaining = 65535;
+            for (int k = 0; k < 4; ++k)
+            {
+                skin[i].joints[k] = static_cast<uint16_t>(firstJoint + k);
+                const uint32_t weight = k == 3 ? remaining : nextRandom(state) % (remaining / 2 + 1);
+                skin[i].weights[k] = static_cast<uint16_t>(weight);
+                remaining -= weight;
+            }
+        }
+    }
+
+    // Column-major rotation about y followed by a translation.
+    std::vector<float> makeJointMatrices()
+    {
+        std::vector<float> matrices(kJointCount * 16, 0.0f);
+        for (uint32_t j = 0; j < kJointCount; ++j)
+        {
+            float* pMatrix = &matrices[j * 16];
+            const float angle = static_cast<float>(j) * 0.05f;
+            pMatrix[0] = std::cos(angle);
+            pMatrix[2] = -std::sin(angle);
+            pMatrix[5] = 1.0f;
+            pMatrix[8] = std::sin(angle);
+            pMatrix[10] = std::cos(angle);
+            pMatrix[12] = static_cast<float>(j) * 0.1f;
+            pMatrix[13] = static_cast<float>(j % 8) * -0.05f;
+            pMatrix[15] = 1.0f;
+        }
+        return matrices;
+    }
+
+    // The straightforward blend: one joint matrix at a time, component by component.
+    void skinScalar(const ModelVertex* pVertices, const SkinVertex* pSkin, size_t count, const float* pJointMatrices,
+                    ModelVertex* pOut)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            const ModelVertex& vertex = pVertices[i];
+            float position[3] = { 0.0f, 0.0f, 0.0f };
+            float normal[3] = { 0.0f, 0.0f, 0.0f };
+            for (int k = 0; k < 4; ++k)
+            {
+                const float weight = pSkin[i].weights[k] / 65535.0f;
+                const float* pMatrix = pJointMatrices + pSkin[i].joints[k] * 16;
+                for (int c = 0; c < 3; ++c)
+                {
+                    position[c] += weight * (pMatrix[c] * vertex.position[0] + pMatrix[4 + c] * vertex.position[1] +
+                                             pMatrix[8 + c] * vertex.position[2] + pMatrix[12 + c]);
+                    normal[c] += weight * (pMatrix[c] * vertex.normal[0] + pMatrix[4 + c] * vertex.normal[1] +
+                                           pMatrix[8 + c] * vertex.normal[2]);
+                }
+            }
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (int c = 0; c < 3; ++c)
+            {
+                pOut[i].position[c] = position[c];
+                pOut[i].normal[c] = length > 0.0f ? normal[c] / length : 0.0f;
+            }
+            pOut[i].texCoords[0] = vertex.texCoords[0];
+            pOut[i].texCoords[1] = vertex.texCoords[1];
+        }
+    }
+
+    float maxDifference(const std::vector<ModelVertex>& a, const std::vector<ModelVertex>& b)
+    {
+        float difference = 0.0f;
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                difference = std::max(difference, std::fabs(a[i].position[c] - b[i].position[c]));
+                difference = std::max(difference, std::fabs(a[i].normal[c] - b[i].normal[c]));
+            }
+            for (int c = 0; c < 2; ++c)
+            {
+                difference = std::max(difference, std::fabs(a[i].texCoords[c] - b[i].texCoords[c]));
+            }
+        }
+        return difference;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const size_t vertexCount = quick ? 20000 : 1000000;
+    const int repeats = quick ? 1 : 10;
+
+    std::vector<ModelVertex> vertices;
+    std::vector<SkinVertex> skin;
+    makeMesh(vertexCount, vertices, skin);
+    const std::vector<float> jointMatrices = makeJointMatrices();
+
+    std::vector<ModelVertex> reference(vertexCount);
+    std::vector<ModelVertex> skinned(vertexCount);
+    std::vector<ModelVertex> parallel(vertexCount);
+
+    JobSystem jobs;
+    const size_t rangeCount = (vertexCount + kRangeSize - 1) / kRangeSize;
+    const auto [scalarSeconds, simdSeconds, parallelSeconds] = Bench::bestSeconds(repeats,
+        [&]()
+        {
+            skinScalar(vertices.data(), skin.data(), vertexCount, jointMatrices.data(), reference.data());
+            Bench::keep(reference[vertexCount - 1]);
+        },
+        [&]()
+        {
+            skinVertices(vertices.data(), skin.data(), vertexCount, jointMatrices.data(), skinned.data());
+            Bench::keep(skinned[vertexCount - 1]);
+        },
+        [&]()
+        {
+            jobs.parallelFor(rangeCount, 1, [&](size_t range)
+            {
+                const size_t first = range * kRangeSize;
+                const size_t count = std::min(kRangeSize, vertexCount - first);
+                skinVertices(vertices.data() + first, skin.data() + first, count, jointMatrices.data(),
+                             parallel.data() + first);
+            });
+            Bench::keep(parallel[vertexCount - 1]);
+        });
+
+    const float simdDifference = maxDifference(skinned, reference);
+    const float parallelDifference = maxDifference(parallel, reference);
+    if (simdDifference > 1e-4f || parallelDifference > 1e-4f)
+    {
+        std::printf("skinned vertices differ from the scalar reference by %g / %g\n", simdDifference, parallelDifference);
+        return 1;
+    }
+
+    const double millions = static_cast<double>(vertexCount) / 1e6;
+    const unsigned int threadCount = jobs.getWorkerCount() + 1;
+    std::printf("%zu vertices, %u joints, 4 influences each (best of %d)\n", vertexCount, kJointCount, repeats);
+    std::printf("scalar:                  %8.2f ms  %7.1f M vertices/s\n", scalarSeconds * 1e3, millions / scalarSeconds);
+    std::printf("skinVertices:            %8.2f ms  %7.1f M vertices/s  (%.2fx)\n", simdSeconds * 1e3,
+                millions / simdSeconds, scalarSeconds / simdSeconds);
+    std::printf("skinVertices, %2u threads: %7.2f ms  %7.1f M vertices/s  (%.2fx)\n", threadCount, parallelSeconds * 1e3,
+                millions / parallelSeconds, scalarSeconds / parallelSeconds);
+    return 0;
+}
@@ -0,0 +1,158 @@
+// Simulation benchmark for TextureStreamer: a camera flies down a street of
+// textured panels; every frame requests the materials within view distance
+// and runs update(). Reports how much of the scene's texture data stays
+// resident, how often requests are met and what update() costs.
+//
+// Usage: TextureStreamerBench [--quick]
+
+#include "BenchUtil.hpp"
+
+#include "Renderer/TextureStreamer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    const uint32_t kTexturesPerMaterial = 3; // Base color, normal, metallic-roughness
+    const float kSpacing = 4.0f;             // Between panels along the street
+    const float kViewDistance = 120.0f;
+
+    // BC7-sized mip chain down to 1x1.
+    void addTexture(ModelData& model, uint32_t side)
+    {
+        TextureData texture;
+        texture.format = TextureFormat::BC7Srgb;
+        texture.width = side;
+        texture.height = side;
+        texture.firstMip = static_cast<uint32_t>(model.textureMips.size());
+        for (uint32_t size = side; ; size /= 2)
+        {
+            TextureMipData mip;
+            mip.width = size;
+            mip.height = size;
+            mip.size = static_cast<uint64_t>((size + 3) / 4) * ((size + 3) / 4) * 16;
+            model.textureMips.push_back(mip);
+            ++texture.mipCount;
+            if (size == 1)
+            {
+                break;
+            }
+        }
+        model.textures.push_back(texture);
+    }
+
+    // One 2x2 unit panel per material, UVs spanning the whole texture.
+    ModelData makeStreet(uint32_t materialCount)
+    {
+        ModelData model;
+        for (uint32_t m = 0; m < materialCount; ++m)
+        {
+            MaterialData material;
+            const uint32_t first = static_cast<uint32_t>(model.textures.size());
+            for (uint32_t t = 0; t < kTexturesPerMaterial; ++t)
+            {
+                addTexture(model, t == 0 ? 2048 : 1024);
+            }
+            material.baseColorTexture = static_cast<int32_t>(first);
+            material.normalTexture = static_cast<int32_t>(first + 1);
+            material.metallicRoughnessTexture = static_cast<int32_t>(first + 2);
+            model.materials.push_back(material);
+
+            PrimitiveData primitive;
+            primitive.vertexOffset = static_cast<uint32_t>(model.vertices.size());
+            primitive.vertexCount = 4;
+            primitive.indexOffset = static_cast<uint32_t>(model.indices.size());
+            primitive.indexCount = 6;
+            primitive.material = static_cast<int32_t>(m);
+            const float corners[4][2] = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, 1 } };
+            for (const auto& corner : corners)
+            {
+                ModelVertex vertex = {};
+                vertex.position[0] = corner[0] * 2.0f;
+                vertex.position[1] = corner[1] * 2.0f;
+                vertex.normal[2] = 1.0f;
+                vertex.texCoords[0] = corner[0];
+                vertex.texCoords[1] = corner[1];
+                model.vertices.push_back(vertex);
+            }
+            for (uint32_t index : { 0u, 1u, 2u, 0u, 2u, 3u })
+            {
+                model.indices.push_back(index);
+            }
+            model.primitives.push_back(primitive);
+        }
+        return model;
+    }
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const bool quick = Bench::isQuick(argc, argv);
+    const uint32_t materialCount = quick ? 64 : 2048;
+    const uint32_t frameCount = quick ? 60 : 2000;
+    const uint64_t budget = quick ? (16ull << 20) : (256ull << 20);
+
+    const ModelData model = makeStreet(materialCount);
+    uint64_t totalBytes = 0;
+    for (const TextureMipData& mip : model.textureMips)
+    {
+        totalBytes += mip.size;
+    }
+
+    TextureStreamer streamer;
+    streamer.setBudget(budget);
+    streamer.setUploadBudget(4ull << 20); // About 240 MB/s at 60 Hz
+    streamer.setViewport(1080.0f, 1.0f);
+    streamer.reset(model);
+
+    // The camera covers the street once, panels passing 3 units to the side.
+    const float streetLength = materialCount * kSpacing;
+    const float speed = streetLength / frameCount;
+
+    std::vector<StreamingCommand> commands;
+    double updateSeconds = 0.0;
+    uint64_t peakResident = 0;
+    uint64_t uploaded = 0;
+    uint64_t requestedTextures = 0;
+    uint64_t wantingTextures = 0;
+    uint64_t evictedLevels = 0;
+    for (uint32_t frame = 0; frame < frameCount; ++frame)
+    {
+        const float camera = frame * speed;
+        uint32_t visible = 0;
+        const uint32_t first = static_cast<uint32_t>(std::max(0.0f, camera / kSpacing));
+        for (uint32_t m = first; m < materialCount && m * kSpacing - camera < kViewDistance; ++m)
+        {
+            const float along = m * kSpacing - camera;
+            streamer.requestMaterial(static_cast<int32_t>(m), 1.0f, std::sqrt(along * along + 9.0f));
+            ++visible;
+        }
+
+        const double start = Bench::now();
+        commands.clear();
+        streamer.update(commands);
+        updateSeconds += Bench::now() - start;
+
+        const TextureStreamingStats& stats = streamer.getStats();
+        peakResident = std::max(peakResident, stats.residentBytes);
+        uploaded += stats.uploadedBytes;
+        evictedLevels += stats.levelsEvicted;
+        requestedTextures += visible * kTexturesPerMaterial;
+        wantingTextures += stats.texturesWanting;
+    }
+
+    std::printf("scene: %u materials, %u textures, %.1f MB of mips (all resident up front)\n", materialCount,
+                static_cast<uint32_t>(model.textures.size()), Bench::toMB(totalBytes));
+    std::printf("budget %.1f MB: peak resident %.1f MB (%.1f%% of scene), %.2f MB uploaded per frame, %llu levels evicted\n",
+                Bench::toMB(budget), Bench::toMB(peakResident), 100.0 * peakResident / totalBytes,
+                Bench::toMB(uploaded) / frameCount, static_cast<unsigned long long>(evictedLevels));
+    std::printf("requests met: %.2f%% of visible textures at their wanted mip (average over %u frames)\n",
+                requestedTextures ? 100.0 * (requestedTextures - wantingTextures) / requestedTextures : 100.0, frameCount);
+    std::printf("update(): %.1f us per frame\n", updateSeconds * 1e6 / frameCount);
+    return peakResident <= budget ? 0 : 1;
+}
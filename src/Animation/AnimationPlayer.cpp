@@ -0,0 +1,442 @@
+#include "AnimationPlayer.hpp"
+
+#include "../Asset/AnimationCompressor.hpp"
+#include "../Core/Parallel.hpp"
+#include "../Core/Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const float kIdentityMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+
+        // Index of the last key at or before `time`, which lies strictly
+        // inside the key range. Playback moves forward a key or two per
+        // frame, so the previous result is tried before a binary search.
+        uint32_t findKey(const float* pTimes, uint32_t count, float time, uint32_t& cursor)
+        {
+            if (cursor + 1 < count && pTimes[cursor] <= time)
+            {
+                if (time < pTimes[cursor + 1])
+                {
+                    return cursor;
+                }
+                if (cursor + 2 < count && time < pTimes[cursor + 2])
+                {
+                    return ++cursor;
+                }
+            }
+            const float* pNext = std::upper_bound(pTimes, pTimes + count, time);
+            cursor = static_cast<uint32_t>(pNext - pTimes) - 1;
+            return cursor;
+        }
+
+        // The parts of a slerp from `a` to `b` that do not depend on t.
+        void prepareSlerp(const float* a, const float* b, float& sign, float& theta, float& sinTheta)
+        {
+            float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+            sign = d < 0.0f ? -1.0f : 1.0f; // Shorter way round
+            d *= sign;
+            theta = 0.0f;
+            sinTheta = 0.0f;
+            if (d < 0.9995f)
+            {
+                theta = std::acos(d);
+                sinTheta = std::sin(theta);
+            }
+        }
+
+        void slerp(const float* a, const float* b, float sign, float theta, float sinTheta, float t, float* out)
+        {
+            float wa = 1.0f - t;
+            float wb = t * sign;
+            if (theta > 0.0f)
+            {
+                wa = std::sin((1.0f - t) * theta) / sinTheta;
+                wb = std::sin(t * theta) / sinTheta * sign;
+            }
+            float length = 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                out[i] = a[i] * wa + b[i] * wb;
+                length += out[i] * out[i];
+            }
+            const float scale = length > 0.0f ? 1.0f / std::sqrt(length) : 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                out[i] *= scale;
+            }
+        }
+
+        // Keys `key` and `key + 1` (when there is one) of a packed channel,
+        // decoded into `decoded` unless they are there already.
+        const float* decodeKeys(const ModelData& model, const AnimationChannelData& channel, uint32_t key,
+                                AnimationPose::DecodedKeys& decoded)
+        {
+            if (decoded.key == key)
+            {
+                return decoded.values;
+            }
+            if (decoded.key != AnimationPose::DecodedKeys::kNone && decoded.key + 1 == key)
+            {
+                std::memcpy(decoded.values, decoded.values + 4, 4 * sizeof(float));
+            }
+            else
+            {
+                decodeAnimationKey(model, channel, key, decoded.values);
+            }
+            if (key + 1 < channel.keyCount)
+            {
+                decodeAnimationKey(model, channel, key + 1, decoded.values + 4);
+                if (channel.path == AnimationPath::Rotation && channel.interpolation == AnimationInterpolation::Linear)
+                {
+                    prepareSlerp(decoded.values, decoded.values + 4, decoded.slerpSign, decoded.slerpTheta,
+                                 decoded.slerpSinTheta);
+                }
+            }
+            decoded.key = key;
+            return decoded.values;
+        }
+
+        void sampleChannel(const ModelData& model, const AnimationChannelData& channel, uint32_t components, float time,
+                           uint32_t& cursor, AnimationPose::DecodedKeys& decoded, float* out)
+        {
+            const float* pTimes = model.animationTimes.data() + channel.firstKey;
+            const bool cubic = channel.interpolation == AnimationInterpolation::CubicSpline;
+            // Cubic spline keys hold in-tangent, value, out-tangent
+            const uint32_t keyStride = cubic ? components * 3 : components;
+            const uint32_t valueOffset = cubic ? components : 0;
+            // Packed channels (never cubic) decode only when the keys used change
+            const bool packed = channel.encoding != AnimationEncoding::Float;
+            const float* pValues = packed ? nullptr : model.animationValues.data() + channel.firstValue;
+
+            const uint32_t count = channel.keyCount;
+            if (count == 1 || time <= pTimes[0] || time >= pTimes[count - 1])
+            {
+                const uint32_t key = count == 1 || time <= pTimes[0] ? 0 : count - 1;
+                const float* pValue =
+                    packed ? decodeKeys(model, channel, key, decoded) : pValues + key * keyStride + valueOffset;
+                std::memcpy(out, pValue, components * sizeof(float));
+                return;
+            }
+
+            const uint32_t key = findKey(pTimes, count, time, cursor);
+            const float* pFrom = packed ? decodeKeys(model, channel, key, decoded) : pValues + key * keyStride;
+            const float* pTo = packed ? pFrom + 4 : pFrom + keyStride;
+            const float span = pTimes[key + 1] - pTimes[key];
+            const float t = span > 0.0f ? (time - pTimes[key]) / span : 0.0f;
+            switch (channel.interpolation)
+            {
+                case AnimationInterpolation::Step:
+                    std::memcpy(out, pFrom, components * sizeof(float));
+                    break;
+                case AnimationInterpolation::Linear:
+                    if (channel.path == AnimationPath::Rotation)
+                    {
+                        if (packed)
+                        {
+                            slerp(pFrom, pTo, decoded.slerpSign, decoded.slerpTheta, decoded.slerpSinTheta, t, out);
+                            break;
+                        }
+                        float sign;
+                        float theta;
+                        float sinTheta;
+                        prepareSlerp(pFrom, pTo, sign, theta, sinTheta);
+                        slerp(pFrom, pTo, sign, theta, sinTheta, t, out);
+                        break;
+                    }
+                    for (uint32_t c = 0; c < components; ++c)
+                    {
+                        out[c] = pFrom[c] + (pTo[c] - pFrom[c]) * t;
+                    }
+                    break;
+                case AnimationInterpolation::CubicSpline:
+                {
+                    // Hermite basis; tangents are per second, so scale by the span
+                    const float t2 = t * t;
+                    const float t3 = t2 * t;
+                    const float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+                    const float h10 = (t3 - 2.0f * t2 + t) * span;
+                    const float h01 = -2.0f * t3 + 3.0f * t2;
+                    const float h11 = (t3 - t2) * span;
+                    const float* pFromValue = pFrom + components;
+                    const float* pFromOut = pFrom + components * 2;
+                    const float* pToIn = pTo;
+                    const float* pToValue = pTo + components;
+                    float length = 0.0f;
+                    for (uint32_t c = 0; c < components; ++c)
+                    {
+                        out[c] = h00 * pFromValue[c] + h10 * pFromOut[c] + h01 * pToValue[c] + h11 * pToIn[c];
+                        length += out[c] * out[c];
+                    }
+                    if (channel.path == AnimationPath::Rotation && length > 0.0f)
+                    {
+                        const float scale = 1.0f / std::sqrt(length);
+                        for (uint32_t c = 0; c < components; ++c)
+                        {
+                            out[c] *= scale;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+
+        // out = a * b for column-major 4x4 matrices, one result column per
+        // four multiply-adds. `out` may alias neither input.
+        void multiplyMatricesSimd(const float* a, const float* b, float* out)
+        {
+            const Simd::Float4 column0 = Simd::load(a);
+            const Simd::Float4 column1 = Simd::load(a + 4);
+            const Simd::Float4 column2 = Simd::load(a + 8);
+            const Simd::Float4 column3 = Simd::load(a + 12);
+            for (int column = 0; column < 4; ++column)
+            {
+                const float* pB = b + column * 4;
+                Simd::Float4 result = Simd::mul(column0, Simd::splat(pB[0]));
+                result = Simd::madd(column1, Simd::splat(pB[1]), result);
+                result = Simd::madd(column2, Simd::splat(pB[2]), result);
+                result = Simd::madd(column3, Simd::splat(pB[3]), result);
+                Simd::store(out + column * 4, result);
+            }
+        }
+    } // namespace
+
+    void AnimationPose::bind(const ModelData& model, uint32_t animation)
+    {
+        clear();
+        m_animation = animation;
+        const AnimationData& clip = model.animations[animation];
+        m_channelSlots.resize(clip.channelCount);
+        m_keyCursors.assign(clip.channelCount, 0);
+        m_decodedKeys.assign(clip.channelCount, DecodedKeys());
+        for (uint32_t i = 0; i < clip.channelCount; ++i)
+        {
+            const AnimationChannelData& channel = model.animationChannels[clip.firstChannel + i];
+            if (channel.path == AnimationPath::Weights)
+            {
+                m_channelSlots[i] = kNoSlot;
+                continue;
+            }
+            const int32_t node = channel.node;
+            const auto found = std::find(m_nodes.begin(), m_nodes.end(), node);
+            m_channelSlots[i] = static_cast<uint32_t>(found - m_nodes.begin());
+            if (found == m_nodes.end())
+            {
+                m_nodes.push_back(node);
+            }
+        }
+        m_stride = (m_nodes.size() + 3) & ~size_t(3);
+        m_components.resize(m_stride * kComponentCount);
+        reset(model);
+    }
+
+    void AnimationPose::clear()
+    {
+        m_animation = 0;
+        m_nodes.clear();
+        m_channelSlots.clear();
+        m_keyCursors.clear();
+        m_decodedKeys.clear();
+        m_components.clear();
+        m_stride = 0;
+    }
+
+    void AnimationPose::reset(const ModelData& model)
+    {
+        for (size_t slot = 0; slot < m_stride; ++slot)
+        {
+            NodeData rest; // Identity for the padding slots
+            const NodeData& node = slot < m_nodes.size() ? model.nodes[m_nodes[slot]] : rest;
+            for (int c = 0; c < 3; ++c)
+            {
+                getComponent(static_cast<Component>(kTranslationX + c))[slot] = node.translation[c];
+                getComponent(static_cast<Component>(kScaleX + c))[slot] = node.scale[c];
+            }
+            for (int c = 0; c < 4; ++c)
+            {
+                getComponent(static_cast<Component>(kRotationX + c))[slot] = node.rotation[c];
+            }
+        }
+    }
+
+    void sampleAnimation(const ModelData& model, float time, AnimationPose& pose, float* pMorphWeights)
+    {
+        const AnimationData& clip = model.animations[pose.getAnimation()];
+        uint32_t* pCursors = pose.getKeyCursors();
+        AnimationPose::DecodedKeys* pDecoded = pose.getDecodedKeys();
+        for (uint32_t i = 0; i < clip.channelCount; ++i)
+        {
+            const AnimationChannelData& channel = model.animationChannels[clip.firstChannel + i];
+            if (channel.path == AnimationPath::Weights)
+            {
+                const NodeData& node = model.nodes[channel.node];
+                if (pMorphWeights)
+                {
+                    sampleChannel(model, channel, node.morphWeightCount, time, pCursors[i], pDecoded[i],
+                                  pMorphWeights + node.firstMorphWeight);
+                }
+                continue;
+            }
+            float value[4];
+            sampleChannel(model, channel, getComponentCount(channel.path), time, pCursors[i], pDecoded[i], value);
+
+            const AnimationPose::Component first = channel.path == AnimationPath::Translation ? AnimationPose::kTranslationX
+                                                   : channel.path == AnimationPath::Rotation  ? AnimationPose::kRotationX
+                                                                                              : AnimationPose::kScaleX;
+            const uint32_t slot = pose.getChannelSlot(i);
+            for (uint32_t c = 0; c < getComponentCount(channel.path); ++c)
+            {
+                pose.getComponent(static_cast<AnimationPose::Component>(first + c))[slot] = value[c];
+            }
+        }
+    }
+
+    void computeLocalMatrices(const AnimationPose& pose, float* pOutMatrices)
+    {
+        using namespace Simd;
+        const Float4 one = splat(1.0f);
+        const Float4 two = splat(2.0f);
+        for (size_t slot = 0; slot < pose.getPaddedSlotCount(); slot += 4)
+        {
+            const Float4 tx = load(pose.getComponent(AnimationPose::kTranslationX) + slot);
+            const Float4 ty = load(pose.getComponent(AnimationPose::kTranslationY) + slot);
+            const Float4 tz = load(pose.getComponent(AnimationPose::kTranslationZ) + slot);
+            const Float4 x = load(pose.getComponent(AnimationPose::kRotationX) + slot);
+            const Float4 y = load(pose.getComponent(AnimationPose::kRotationY) + slot);
+            const Float4 z = load(pose.getComponent(AnimationPose::kRotationZ) + slot);
+            const Float4 w = load(pose.getComponent(AnimationPose::kRotationW) + slot);
+            const Float4 sx = load(pose.getComponent(AnimationPose::kScaleX) + slot);
+            const Float4 sy = load(pose.getComponent(AnimationPose::kScaleY) + slot);
+            const Float4 sz = load(pose.getComponent(AnimationPose::kScaleZ) + slot);
+
+            const Float4 xx = mul(x, x), yy = mul(y, y), zz = mul(z, z);
+            const Float4 xy = mul(x, y), xz = mul(x, z), yz = mul(y, z);
+            const Float4 xw = mul(x, w), yw = mul(y, w), zw = mul(z, w);
+
+            // Same element order as GltfImporter's rest-pose matrices:
+            // rotation columns scaled per axis, translation in column 3.
+            Float4 elements[16];
+            elements[0] = mul(sub(one, mul(two, add(yy, zz))), sx);
+            elements[1] = mul(mul(two, add(xy, zw)), sx);
+            elements[2] = mul(mul(two, sub(xz, yw)), sx);
+            elements[3] = splat(0.0f);
+            elements[4] = mul(mul(two, sub(xy, zw)), sy);
+            elements[5] = mul(sub(one, mul(two, add(xx, zz))), sy);
+            elements[6] = mul(mul(two, add(yz, xw)), sy);
+            elements[7] = splat(0.0f);
+            elements[8] = mul(mul(two, add(xz, yw)), sz);
+            elements[9] = mul(mul(two, sub(yz, xw)), sz);
+            elements[10] = mul(sub(one, mul(two, add(xx, yy))), sz);
+            elements[11] = splat(0.0f);
+            elements[12] = tx;
+            elements[13] = ty;
+            elements[14] = tz;
+            elements[15] = one;
+
+            // Lanes are slots; transpose into one matrix per slot
+            float lanes[16][4];
+            for (int e = 0; e < 16; ++e)
+            {
+                store(lanes[e], elements[e]);
+            }
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                float* pMatrix = pOutMatrices + (slot + lane) * 16;
+                for (int e = 0; e < 16; ++e)
+                {
+                    pMatrix[e] = lanes[e][lane];
+                }
+            }
+        }
+    }
+
+    void AnimationPlayer::setAnimation(const ModelData& model, int32_t animation)
+    {
+        m_animation = animation >= 0 && animation < static_cast<int32_t>(model.animations.size()) ? animation : -1;
+        m_time = 0.0f;
+        m_nodeSlots.assign(model.nodes.size(), -1);
+        if (m_animation < 0)
+        {
+            m_pose.clear();
+            return;
+        }
+        m_pose.bind(model, static_cast<uint32_t>(m_animation));
+        for (size_t slot = 0; slot < m_pose.getSlotCount(); ++slot)
+        {
+            m_nodeSlots[m_pose.getNodes()[slot]] = static_cast<int32_t>(slot);
+        }
+    }
+
+    void AnimationPlayer::advance(const ModelData& model, float seconds)
+    {
+        if (m_animation < 0)
+        {
+            return;
+        }
+        const float duration = model.animations[m_animation].duration;
+        m_time += seconds * m_speed;
+        if (duration <= 0.0f)
+        {
+            m_time = 0.0f;
+        }
+        else if (m_looping)
+        {
+            m_time = std::fmod(m_time, duration);
+            m_time += m_time < 0.0f ? duration : 0.0f;
+        }
+        else
+        {
+            m_time = std::min(std::max(m_time, 0.0f), duration);
+        }
+    }
+
+    void AnimationPlayer::update(const ModelData& model)
+    {
+        if (m_nodeSlots.size() != model.nodes.size())
+        {
+            setAnimation(model, m_animation);
+        }
+        m_morphWeights.assign(model.morphWeights.begin(), model.morphWeights.end());
+        if (m_animation >= 0)
+        {
+            sampleAnimation(model, m_time, m_pose, m_morphWeights.data());
+        }
+        m_localMatrices.resize(m_pose.getPaddedSlotCount() * 16);
+        computeLocalMatrices(m_pose, m_localMatrices.data());
+
+        // Parents precede their children in ModelData::nodes
+        m_worldMatrices.resize(model.nodes.size() * 16);
+        for (size_t i = 0; i < model.nodes.size(); ++i)
+        {
+            const NodeData& node = model.nodes[i];
+            const float* pLocal = m_nodeSlots[i] >= 0 ? &m_localMatrices[m_nodeSlots[i] * 16] : node.localMatrix;
+            float* pWorld = &m_worldMatrices[i * 16];
+            if (node.parent >= 0)
+            {
+                multiplyMatricesSimd(&m_worldMatrices[node.parent * 16], pLocal, pWorld);
+            }
+            else
+            {
+                std::memcpy(pWorld, pLocal, 16 * sizeof(float));
+            }
+        }
+
+        m_jointMatrices.resize(model.joints.size() * 16);
+        for (size_t i = 0; i < model.joints.size(); ++i)
+        {
+            const JointData& joint = model.joints[i];
+            const float* pWorld = joint.node >= 0 ? &m_worldMatrices[joint.node * 16] : kIdentityMatrix;
+            multiplyMatricesSimd(pWorld, joint.inverseBindMatrix, &m_jointMatrices[i * 16]);
+        }
+    }
+
+    void updateAnimationPlayers(const ModelData& model, AnimationPlayer* pPlayers, size_t count, unsigned int threadCount)
+    {
+        parallelFor(count, threadCount, [&](size_t i) { pPlayers[i].update(model); });
+    }
+} // namespace Pinnacle
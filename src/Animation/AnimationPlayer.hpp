@@ -0,0 +1,139 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Local transforms of the nodes one animation drives, one array per
+    // component (structure of arrays) so matrices are built four nodes per
+    // SIMD operation. The slot count is padded to a multiple of four with
+    // identity transforms.
+    class AnimationPose
+    {
+    public:
+        enum Component
+        {
+            kTranslationX,
+            kTranslationY,
+            kTranslationZ,
+            kRotationX,
+            kRotationY,
+            kRotationZ,
+            kRotationW,
+            kScaleX,
+            kScaleY,
+            kScaleZ,
+            kComponentCount
+        };
+
+        // One slot per node the animation's channels target, each starting
+        // at the node's rest pose.
+        void bind(const ModelData& model, uint32_t animation);
+        void clear();
+
+        // Every slot back to its node's rest pose.
+        void reset(const ModelData& model);
+
+        uint32_t getAnimation() const { return m_animation; }
+        size_t getSlotCount() const { return m_nodes.size(); }
+        size_t getPaddedSlotCount() const { return m_stride; }
+        const std::vector<int32_t>& getNodes() const { return m_nodes; } // Model node per slot
+        uint32_t getChannelSlot(uint32_t channel) const { return m_channelSlots[channel]; } // Channel within the animation
+
+        static const uint32_t kNoSlot = UINT32_MAX; // Slot of morph weight channels, which drive no transform
+
+        float* getComponent(Component component) { return m_components.data() + component * m_stride; }
+        const float* getComponent(Component component) const { return m_components.data() + component * m_stride; }
+
+        // Last key found per channel; forward playback resumes the search there.
+        uint32_t* getKeyCursors() { return m_keyCursors.data(); }
+
+        // Per packed channel, its keys `key` and `key + 1` as last decoded,
+        // with the slerp angle between them for rotations. Sampling again
+        // between the same two keys decodes nothing, and moving on by one
+        // key decodes one. Bind again if the model's animation data changes.
+        struct DecodedKeys
+        {
+            static const uint32_t kNone = UINT32_MAX;
+            uint32_t key = kNone;
+            float values[8];
+            float slerpSign; // -1 when the second key is negated to take the shorter way round
+            float slerpTheta; // 0 when the keys are close enough to lerp
+            float slerpSinTheta;
+        };
+        DecodedKeys* getDecodedKeys() { return m_decodedKeys.data(); }
+
+    private:
+        uint32_t m_animation = 0;
+        std::vector<int32_t> m_nodes;
+        std::vector<uint32_t> m_channelSlots;
+        std::vector<uint32_t> m_keyCursors;
+        std::vector<DecodedKeys> m_decodedKeys;
+        std::vector<float> m_components;
+        size_t m_stride = 0;
+    };
+
+    // Overwrites the pose slots the animation's channels target with their
+    // values at `time` (seconds, held at the first and last keys). Rotations
+    // slerp between linear keys and are renormalized after cubic splines.
+    // Morph weight channels write into `pMorphWeights` (laid out like
+    // ModelData::morphWeights) when it is given.
+    void sampleAnimation(const ModelData& model, float time, AnimationPose& pose, float* pMorphWeights = nullptr);
+
+    // Column-major matrix (16 floats) per padded pose slot.
+    void computeLocalMatrices(const AnimationPose& pose, float* pOutMatrices);
+
+    // One animated instance of a model: the clip it plays, the playback
+    // time and the matrices derived from them. Holds no reference to the
+    // model; pass the same one to every call.
+    class AnimationPlayer
+    {
+    public:
+        // -1 stops playback and returns every node to its rest pose.
+        void setAnimation(const ModelData& model, int32_t animation);
+        int32_t getAnimation() const { return m_animation; }
+
+        void setLooping(bool looping) { m_looping = looping; }
+        void setSpeed(float speed) { m_speed = speed; }
+        void setTime(float seconds) { m_time = seconds; }
+        float getTime() const { return m_time; }
+
+        // Moves the playback time, wrapping around the clip when looping and
+        // holding its end otherwise.
+        void advance(const ModelData& model, float seconds);
+
+        // Samples the clip at the current time and rebuilds every node's
+        // world matrix, then every joint matrix and the morph weights.
+        void update(const ModelData& model);
+
+        // 16 floats per ModelData::nodes entry.
+        const float* getWorldMatrices() const { return m_worldMatrices.data(); }
+        // 16 floats per ModelData::joints entry: the joint node's world
+        // matrix times its inverse bind matrix, so skinned vertices come out
+        // in world space. A skin's matrices start at SkinData::firstJoint.
+        const float* getJointMatrices() const { return m_jointMatrices.data(); }
+        // One per ModelData::morphWeights entry: the rest weights with the
+        // clip's weight channels applied. A node's start at firstMorphWeight.
+        const std::vector<float>& getMorphWeights() const { return m_morphWeights; }
+
+    private:
+        int32_t m_animation = -1;
+        bool m_looping = true;
+        float m_speed = 1.0f;
+        float m_time = 0.0f;
+        AnimationPose m_pose;
+        std::vector<int32_t> m_nodeSlots; // Pose slot per model node, -1 when not animated
+        std::vector<float> m_localMatrices;
+        std::vector<float> m_worldMatrices;
+        std::vector<float> m_jointMatrices;
+        std::vector<float> m_morphWeights;
+    };
+
+    // Updates many players of the same model in parallel on up to
+    // `threadCount` threads (0 = every worker of the shared job system).
+    void updateAnimationPlayers(const ModelData& model, AnimationPlayer* pPlayers, size_t count, unsigned int threadCount = 0);
+} // namespace Pinnacle
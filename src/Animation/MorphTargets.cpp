@@ -0,0 +1,111 @@
+#include "MorphTargets.hpp"
+
+#include "../Core/Simd.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Pinnacle
+{
+    static_assert(sizeof(ModelVertex) == 8 * sizeof(float), "A morph delta is two Float4s");
+
+    void accumulateMorphTarget(const ModelData& model, const MorphTargetData& target, float weight, uint32_t firstVertex,
+                               uint32_t endVertex, ModelVertex* pVertices)
+    {
+        using namespace Simd;
+        const uint32_t* pBegin = model.morphDeltaVertices.data() + target.firstDelta;
+        const uint32_t* pEnd = pBegin + target.deltaCount;
+        const uint32_t* pVertex = firstVertex == 0 ? pBegin : std::lower_bound(pBegin, pEnd, firstVertex);
+        const ModelVertex* pDelta = model.morphDeltas.data() + (pVertex - model.morphDeltaVertices.data());
+        const Float4 scale = splat(weight);
+        for (; pVertex < pEnd && *pVertex < endVertex; ++pVertex, ++pDelta)
+        {
+            float* pOut = pVertices[*pVertex].position;
+            const float* pIn = pDelta->position;
+            store(pOut, madd(load(pIn), scale, load(pOut)));
+            store(pOut + 4, madd(load(pIn + 4), scale, load(pOut + 4)));
+        }
+    }
+
+    Bounds computeMorphedBounds(const ModelData& model, const PrimitiveData& primitive, const float* pWeights)
+    {
+        Bounds bounds = primitive.bounds;
+        if (!bounds.isValid())
+        {
+            return bounds;
+        }
+        for (uint32_t t = 0; t < primitive.morphTargetCount; ++t)
+        {
+            const float weight = pWeights[t];
+            if (weight == 0.0f)
+            {
+                continue;
+            }
+            // A negative weight flips the delta bounds
+            const Bounds& delta = model.morphTargets[primitive.firstMorphTarget + t].deltaBounds;
+            for (int c = 0; c < 3; ++c)
+            {
+                const float low = delta.min[c] * weight;
+                const float high = delta.max[c] * weight;
+                bounds.min[c] += std::min(low, high);
+                bounds.max[c] += std::max(low, high);
+            }
+        }
+        return bounds;
+    }
+
+    void MorphedPrimitive::bind(const ModelData& model, uint32_t primitive)
+    {
+        const PrimitiveData& data = model.primitives[primitive];
+        m_primitive = primitive;
+        m_vertices.assign(model.vertices.begin() + data.vertexOffset,
+                          model.vertices.begin() + data.vertexOffset + data.vertexCount);
+        m_weights.assign(data.morphTargetCount, 0.0f);
+        m_pendingFirst = 0;
+        m_pendingEnd = data.vertexCount;
+    }
+
+    MorphedRange MorphedPrimitive::update(const ModelData& model, const float* pWeights)
+    {
+        const PrimitiveData& primitive = model.primitives[m_primitive];
+        uint32_t first = m_pendingFirst < m_pendingEnd ? m_pendingFirst : UINT32_MAX;
+        uint32_t end = m_pendingEnd;
+        m_pendingFirst = 0;
+        m_pendingEnd = 0;
+
+        // Deltas are in ascending vertex order, so a target spans its first
+        // to its last delta
+        for (uint32_t t = 0; t < primitive.morphTargetCount; ++t)
+        {
+            if (pWeights[t] == m_weights[t])
+            {
+                continue;
+            }
+            m_weights[t] = pWeights[t];
+            const MorphTargetData& target = model.morphTargets[primitive.firstMorphTarget + t];
+            if (target.deltaCount > 0)
+            {
+                first = std::min(first, model.morphDeltaVertices[target.firstDelta]);
+                end = std::max(end, model.morphDeltaVertices[target.firstDelta + target.deltaCount - 1] + 1);
+            }
+        }
+        if (first >= end)
+        {
+            return MorphedRange();
+        }
+
+        std::memcpy(&m_vertices[first], &model.vertices[primitive.vertexOffset + first], (end - first) * sizeof(ModelVertex));
+        for (uint32_t t = 0; t < primitive.morphTargetCount; ++t)
+        {
+            if (m_weights[t] != 0.0f)
+            {
+                accumulateMorphTarget(model, model.morphTargets[primitive.firstMorphTarget + t], m_weights[t], first, end,
+                                      m_vertices.data());
+            }
+        }
+        MorphedRange range;
+        range.firstVertex = first;
+        range.vertexCount = end - first;
+        return range;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Adds `weight` times each of the target's deltas whose vertex lies in
+    // [firstVertex, endVertex) onto `pVertices`, the primitive's vertices.
+    // A delta is two four-wide multiply-adds.
+    void accumulateMorphTarget(const ModelData& model, const MorphTargetData& target, float weight, uint32_t firstVertex,
+                               uint32_t endVertex, ModelVertex* pVertices);
+
+    // Bounds of the primitive's positions under `pWeights`, one per target:
+    // its rest bounds plus each target's delta bounds scaled by the weight.
+    Bounds computeMorphedBounds(const ModelData& model, const PrimitiveData& primitive, const float* pWeights);
+
+    struct MorphedRange
+    {
+        uint32_t firstVertex = 0;
+        uint32_t vertexCount = 0;
+    };
+
+    // A morphed copy of one primitive's vertices, kept up to date between
+    // frames. When weights change, only the vertex span the changed targets
+    // touch is rebuilt: reset to rest, then every target still weighted is
+    // added over it. Unchanged weights cost one comparison each.
+    class MorphedPrimitive
+    {
+    public:
+        // Starts at the rest vertices with every weight zero. The whole
+        // primitive counts as changed until the next update().
+        void bind(const ModelData& model, uint32_t primitive);
+
+        // Applies `pWeights`, one per target. Returns the vertices rebuilt
+        // since the last call (vertexCount 0 when nothing changed).
+        MorphedRange update(const ModelData& model, const float* pWeights);
+
+        uint32_t getPrimitive() const { return m_primitive; }
+        const ModelVertex* getVertices() const { return m_vertices.data(); }
+
+    private:
+        uint32_t m_primitive = 0;
+        std::vector<ModelVertex> m_vertices;
+        std::vector<float> m_weights;
+        uint32_t m_pendingFirst = 0; // Changed vertices not yet reported
+        uint32_t m_pendingEnd = 0;
+    };
+} // namespace Pinnacle
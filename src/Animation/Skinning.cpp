@@ -0,0 +1,86 @@
+#include "Skinning.hpp"
+
+#include "../Core/Simd.hpp"
+
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    void skinVertices(const ModelVertex* pVertices, const SkinVertex* pSkin, size_t count, const float* pJointMatrices,
+                      ModelVertex* pOut)
+    {
+        using namespace Simd;
+        const float kWeightScale = 1.0f / 65535.0f;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const ModelVertex& vertex = pVertices[i];
+            const SkinVertex& skin = pSkin[i];
+
+            // Weighted sum of the joint matrices, column by column
+            Float4 column0 = splat(0.0f);
+            Float4 column1 = splat(0.0f);
+            Float4 column2 = splat(0.0f);
+            Float4 column3 = splat(0.0f);
+            for (int k = 0; k < 4; ++k)
+            {
+                if (skin.weights[k] == 0)
+                {
+                    continue;
+                }
+                const Float4 weight = splat(skin.weights[k] * kWeightScale);
+                const float* pMatrix = pJointMatrices + skin.joints[k] * 16;
+                column0 = madd(load(pMatrix), weight, column0);
+                column1 = madd(load(pMatrix + 4), weight, column1);
+                column2 = madd(load(pMatrix + 8), weight, column2);
+                column3 = madd(load(pMatrix + 12), weight, column3);
+            }
+
+            float position[4];
+            store(position, madd(column0, splat(vertex.position[0]),
+                                 madd(column1, splat(vertex.position[1]), madd(column2, splat(vertex.position[2]), column3))));
+            float normal[4];
+            store(normal, madd(column0, splat(vertex.normal[0]),
+                               madd(column1, splat(vertex.normal[1]), mul(column2, splat(vertex.normal[2])))));
+            const float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+
+            ModelVertex& out = pOut[i];
+            std::memcpy(out.position, position, sizeof(out.position));
+            for (int c = 0; c < 3; ++c)
+            {
+                out.normal[c] = normal[c] * scale;
+            }
+            std::memcpy(out.texCoords, vertex.texCoords, sizeof(out.texCoords));
+        }
+    }
+
+    void computeJointBounds(const ModelVertex* pVertices, const SkinVertex* pSkin, size_t count, uint32_t jointCount,
+                            Bounds* pOutJointBounds)
+    {
+        for (uint32_t j = 0; j < jointCount; ++j)
+        {
+            pOutJointBounds[j] = Bounds();
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                if (pSkin[i].weights[k] > 0 && pSkin[i].joints[k] < jointCount)
+                {
+                    pOutJointBounds[pSkin[i].joints[k]].expand(pVertices[i].position);
+                }
+            }
+        }
+    }
+
+    Bounds computeSkinnedBounds(const Bounds* pJointBounds, uint32_t jointCount, const float* pJointMatrices)
+    {
+        Bounds bounds;
+        for (uint32_t j = 0; j < jointCount; ++j)
+        {
+            bounds.merge(transformBounds(pJointMatrices + j * 16, pJointBounds[j]));
+        }
+        return bounds;
+    }
+} // namespace Pinnacle
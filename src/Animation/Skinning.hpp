@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinnacle
+{
+    enum class SkinningMode : uint32_t
+    {
+        Gpu, // Compute pass writing a skinned copy of the vertices each frame
+        Cpu  // skinVertices() on job threads into a shared buffer
+    };
+
+    // Blends each vertex by its weighted joint matrices (16 floats each,
+    // column-major, indexed by SkinVertex::joints): positions as points,
+    // normals as directions, renormalized. Texture coordinates are copied.
+    // The blend runs four floats wide, one matrix column per operation.
+    void skinVertices(const ModelVertex* pVertices, const SkinVertex* pSkin, size_t count, const float* pJointMatrices,
+                      ModelVertex* pOut);
+
+    // Bind-space bounds of the vertices each of `jointCount` joints
+    // influences; joints that influence none stay invalid.
+    void computeJointBounds(const ModelVertex* pVertices, const SkinVertex* pSkin, size_t count, uint32_t jointCount,
+                            Bounds* pOutJointBounds);
+
+    // Bounds of the skinned vertices. Each is a weighted average of its
+    // position under each of its joints, so it stays within the union of the
+    // joint bounds moved by their joint matrices.
+    Bounds computeSkinnedBounds(const Bounds* pJointBounds, uint32_t jointCount, const float* pJointMatrices);
+} // namespace Pinnacle
@@ -0,0 +1,431 @@
+#include "AnimationCompressor.hpp"
+
+#include "../Core/Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const float kSmallestThreeMax = 0.70710678f; // No component but the largest can exceed 1/sqrt(2)
+        const float kSmallestThreeScale = 2.0f * kSmallestThreeMax / 32767.0f;
+
+        // Longest run of keys one linear segment may replace. Bounds the
+        // quadratic fit test; runs of identical keys are not limited.
+        const uint32_t kMaxSegmentKeys = 32;
+
+        struct CompressedChannel
+        {
+            AnimationChannelData channel;
+            std::vector<float> times;
+            std::vector<float> values;
+            std::vector<uint16_t> packed;
+        };
+
+        // Same arithmetic as AnimationPlayer's sampler, so the measured error
+        // is the real one.
+        void slerp(const float* a, const float* b, float t, float* out)
+        {
+            float d = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+            const float sign = d < 0.0f ? -1.0f : 1.0f;
+            d *= sign;
+            float wa = 1.0f - t;
+            float wb = t * sign;
+            if (d < 0.9995f)
+            {
+                const float theta = std::acos(d);
+                const float sinTheta = std::sin(theta);
+                wa = std::sin((1.0f - t) * theta) / sinTheta;
+                wb = std::sin(t * theta) / sinTheta * sign;
+            }
+            float length = 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                out[i] = a[i] * wa + b[i] * wb;
+                length += out[i] * out[i];
+            }
+            const float scale = length > 0.0f ? 1.0f / std::sqrt(length) : 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                out[i] *= scale;
+            }
+        }
+
+        // Angle between two rotations; better conditioned than acos of the
+        // dot product for nearly equal ones.
+        float rotationError(const float* a, const float* b)
+        {
+            const float dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+            const float sign = dot < 0.0f ? -1.0f : 1.0f;
+            float distance = 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                const float d = a[i] - sign * b[i];
+                distance += d * d;
+            }
+            return 4.0f * std::asin(std::min(std::sqrt(distance) * 0.5f, 1.0f));
+        }
+
+        float valueError(AnimationPath path, const float* a, const float* b, uint32_t components)
+        {
+            if (path == AnimationPath::Rotation)
+            {
+                return rotationError(a, b);
+            }
+            float error = 0.0f;
+            for (uint32_t c = 0; c < components; ++c)
+            {
+                error = std::max(error, std::fabs(a[c] - b[c]));
+            }
+            return error;
+        }
+
+        float getTolerance(AnimationPath path, const AnimationCompressionOptions& options)
+        {
+            switch (path)
+            {
+                case AnimationPath::Translation:
+                    return options.maxTranslationError;
+                case AnimationPath::Rotation:
+                    return options.maxRotationError;
+                case AnimationPath::Scale:
+                    return options.maxScaleError;
+                case AnimationPath::Weights:
+                    return options.maxWeightError;
+            }
+            return 0.0f;
+        }
+
+        // Whether the linear segment from key `first` to key `last` rebuilds
+        // every key between them within `tolerance`.
+        bool fitsSegment(const CompressedChannel& source, uint32_t components, uint32_t first, uint32_t last, float tolerance)
+        {
+            const float* pTimes = source.times.data();
+            const float* pFrom = source.values.data() + first * components;
+            const float* pTo = source.values.data() + last * components;
+            const float span = pTimes[last] - pTimes[first];
+            for (uint32_t key = first + 1; key < last; ++key)
+            {
+                const float t = span > 0.0f ? (pTimes[key] - pTimes[first]) / span : 0.0f;
+                const float* pKey = source.values.data() + key * components;
+                if (source.channel.path == AnimationPath::Rotation)
+                {
+                    float value[4];
+                    slerp(pFrom, pTo, t, value);
+                    if (!(rotationError(value, pKey) <= tolerance))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                for (uint32_t c = 0; c < components; ++c)
+                {
+                    if (!(std::fabs(pFrom[c] + (pTo[c] - pFrom[c]) * t - pKey[c]) <= tolerance))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        // Indices of the keys to keep, ascending. The first and last keys
+        // are always kept unless every key matches the first.
+        void reduceKeys(const CompressedChannel& source, uint32_t components, float tolerance, std::vector<uint32_t>& outKept)
+        {
+            const AnimationPath path = source.channel.path;
+            const uint32_t count = source.channel.keyCount;
+            const float* pValues = source.values.data();
+            outKept.assign(1, 0);
+
+            bool constant = true;
+            for (uint32_t key = 1; key < count && constant; ++key)
+            {
+                constant = valueError(path, pValues, pValues + key * components, components) <= tolerance;
+            }
+            if (constant)
+            {
+                return;
+            }
+
+            if (source.channel.interpolation == AnimationInterpolation::Step)
+            {
+                for (uint32_t key = 1; key < count; ++key)
+                {
+                    const float* pKept = pValues + outKept.back() * components;
+                    if (key + 1 == count || !(valueError(path, pKept, pValues + key * components, components) <= tolerance))
+                    {
+                        outKept.push_back(key);
+                    }
+                }
+                return;
+            }
+
+            // Greedy: extend each segment while it still rebuilds the keys it
+            // skips, then start the next one at its end
+            const size_t valueBytes = components * sizeof(float);
+            uint32_t anchor = 0;
+            while (anchor + 1 < count)
+            {
+                uint32_t end = anchor + 1;
+                const float* pAnchor = pValues + anchor * components;
+                bool identical = std::memcmp(pValues + end * components, pAnchor, valueBytes) == 0; // Keys anchor..end
+                for (uint32_t key = anchor + 2; key < count; ++key)
+                {
+                    identical = identical && std::memcmp(pValues + key * components, pAnchor, valueBytes) == 0;
+                    if (!identical && (key - anchor > kMaxSegmentKeys || !fitsSegment(source, components, anchor, key, tolerance)))
+                    {
+                        break;
+                    }
+                    end = key;
+                }
+                outKept.push_back(end);
+                anchor = end;
+            }
+        }
+
+        bool packRotations(CompressedChannel& channel, float tolerance)
+        {
+            const uint32_t count = channel.channel.keyCount;
+            channel.packed.resize(count * 3);
+            for (uint32_t key = 0; key < count; ++key)
+            {
+                const float* pSource = channel.values.data() + key * 4;
+                float decoded[4];
+                encodeSmallestThree(pSource, channel.packed.data() + key * 3);
+                decodeSmallestThree(channel.packed.data() + key * 3, decoded);
+                if (!(rotationError(decoded, pSource) <= tolerance))
+                {
+                    return false;
+                }
+            }
+            channel.channel.encoding = AnimationEncoding::SmallestThree;
+            return true;
+        }
+
+        bool packUnorm16(CompressedChannel& channel, float tolerance)
+        {
+            const uint32_t count = channel.channel.keyCount;
+            AnimationChannelData& data = channel.channel;
+            float extent[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                float low = channel.values[c];
+                float high = low;
+                for (uint32_t key = 1; key < count; ++key)
+                {
+                    low = std::min(low, channel.values[key * 3 + c]);
+                    high = std::max(high, channel.values[key * 3 + c]);
+                }
+                extent[c] = high - low;
+                data.rangeMin[c] = low;
+                data.rangeScale[c] = extent[c] / 65535.0f;
+            }
+
+            channel.packed.resize(count * 3);
+            for (uint32_t key = 0; key < count; ++key)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float value = channel.values[key * 3 + c];
+                    const float normalized = extent[c] > 0.0f ? std::min(std::max((value - data.rangeMin[c]) / extent[c], 0.0f), 1.0f) : 0.0f;
+                    const uint16_t packed = static_cast<uint16_t>(normalized * 65535.0f + 0.5f);
+                    channel.packed[key * 3 + c] = packed;
+                    // Same arithmetic as decodeAnimationKey()
+                    if (!(std::fabs(data.rangeMin[c] + packed * data.rangeScale[c] - value) <= tolerance))
+                    {
+                        return false;
+                    }
+                }
+            }
+            data.encoding = AnimationEncoding::Unorm16;
+            return true;
+        }
+
+        CompressedChannel compressChannel(const ModelData& model, const AnimationChannelData& channel,
+                                          const AnimationCompressionOptions& options)
+        {
+            const uint32_t components = getComponentCount(model, channel);
+            const bool cubic = channel.interpolation == AnimationInterpolation::CubicSpline;
+            const uint32_t keyStride = cubic ? components * 3 : components;
+
+            CompressedChannel source;
+            source.channel = channel;
+            source.channel.encoding = AnimationEncoding::Float;
+            source.times.assign(model.animationTimes.begin() + channel.firstKey,
+                                model.animationTimes.begin() + channel.firstKey + channel.keyCount);
+            source.values.resize(channel.keyCount * keyStride);
+            for (uint32_t key = 0; key < channel.keyCount; ++key)
+            {
+                // Packed channels are decoded first, so a compressed model can be compressed again
+                if (channel.encoding != AnimationEncoding::Float)
+                {
+                    decodeAnimationKey(model, channel, key, &source.values[key * keyStride]);
+                    continue;
+                }
+                std::memcpy(&source.values[key * keyStride], &model.animationValues[channel.firstValue + key * keyStride],
+                            keyStride * sizeof(float));
+            }
+            // Tangents make every cubic key matter
+            if (cubic || channel.keyCount == 0)
+            {
+                return source;
+            }
+
+            const float tolerance = getTolerance(channel.path, options);
+            std::vector<uint32_t> kept;
+            reduceKeys(source, components, tolerance, kept);
+
+            CompressedChannel result;
+            result.channel = source.channel;
+            result.channel.keyCount = static_cast<uint32_t>(kept.size());
+            result.times.reserve(kept.size());
+            result.values.reserve(kept.size() * components);
+            for (uint32_t key : kept)
+            {
+                result.times.push_back(source.times[key]);
+                result.values.insert(result.values.end(), source.values.begin() + key * components,
+                                     source.values.begin() + (key + 1) * components);
+            }
+
+            if (options.quantize)
+            {
+                const bool packed = channel.path == AnimationPath::Rotation ? packRotations(result, tolerance)
+                                    : channel.path != AnimationPath::Weights ? packUnorm16(result, tolerance)
+                                                                             : false;
+                if (!packed)
+                {
+                    result.packed.clear();
+                    result.channel.encoding = AnimationEncoding::Float;
+                    std::fill(result.channel.rangeMin, result.channel.rangeMin + 3, 0.0f);
+                    std::fill(result.channel.rangeScale, result.channel.rangeScale + 3, 0.0f);
+                }
+            }
+            return result;
+        }
+    } // namespace
+
+    void encodeSmallestThree(const float quaternion[4], uint16_t out[3])
+    {
+        int largest = 0;
+        float length = 0.0f;
+        for (int i = 0; i < 4; ++i)
+        {
+            largest = std::fabs(quaternion[i]) > std::fabs(quaternion[largest]) ? i : largest;
+            length += quaternion[i] * quaternion[i];
+        }
+        // Normalize and make the dropped component positive
+        float scale = length > 0.0f ? 1.0f / std::sqrt(length) : 0.0f;
+        scale = quaternion[largest] < 0.0f ? -scale : scale;
+
+        int slot = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (i == largest)
+            {
+                continue;
+            }
+            const float value = std::min(std::max(quaternion[i] * scale, -kSmallestThreeMax), kSmallestThreeMax);
+            out[slot++] = static_cast<uint16_t>((value + kSmallestThreeMax) / kSmallestThreeScale + 0.5f);
+        }
+        out[0] = static_cast<uint16_t>(out[0] | ((largest >> 1) << 15));
+        out[1] = static_cast<uint16_t>(out[1] | ((largest & 1) << 15));
+    }
+
+    void decodeSmallestThree(const uint16_t encoded[3], float out[4])
+    {
+        // Straight-line selects rather than a loop over the index: sampling
+        // decodes two keys per rotation channel per pose
+        const uint32_t largest = ((encoded[0] >> 15) << 1) | (encoded[1] >> 15);
+        const float a = (encoded[0] & 0x7fff) * kSmallestThreeScale - kSmallestThreeMax;
+        const float b = (encoded[1] & 0x7fff) * kSmallestThreeScale - kSmallestThreeMax;
+        const float c = encoded[2] * kSmallestThreeScale - kSmallestThreeMax;
+        const float w = std::sqrt(std::max(1.0f - a * a - b * b - c * c, 0.0f));
+        out[0] = largest == 0 ? w : a;
+        out[1] = largest == 0 ? a : largest == 1 ? w : b;
+        out[2] = largest < 2 ? b : largest == 2 ? w : c;
+        out[3] = largest < 3 ? c : w;
+    }
+
+    uint64_t getAnimationMemory(const ModelData& model)
+    {
+        return model.animations.size() * sizeof(AnimationData) +
+               model.animationChannels.size() * sizeof(AnimationChannelData) +
+               model.animationTimes.size() * sizeof(float) + model.animationValues.size() * sizeof(float) +
+               model.animationPackedValues.size() * sizeof(uint16_t);
+    }
+
+    AnimationCompressionStats compressAnimations(ModelData& model, const AnimationCompressionOptions& options,
+                                                 unsigned int threadCount)
+    {
+        AnimationCompressionStats stats;
+        stats.bytesBefore = getAnimationMemory(model);
+        for (const AnimationChannelData& channel : model.animationChannels)
+        {
+            stats.keysBefore += channel.keyCount;
+        }
+
+        std::vector<CompressedChannel> compressed(model.animationChannels.size());
+        parallelFor(compressed.size(), threadCount,
+                    [&](size_t i) { compressed[i] = compressChannel(model, model.animationChannels[i], options); });
+
+        // Clips own consecutive channel ranges, so emitting channels in order
+        // keeps each clip's data together
+        std::vector<float> times;
+        std::vector<float> values;
+        std::vector<uint16_t> packedValues;
+        size_t clip = 0;
+        uint32_t clipFirstChannel = 0;
+        for (size_t i = 0; i < compressed.size(); ++i)
+        {
+            while (clip < model.animations.size() && i >= model.animations[clip].firstChannel + model.animations[clip].channelCount)
+            {
+                ++clip;
+                clipFirstChannel = static_cast<uint32_t>(i);
+            }
+
+            CompressedChannel& source = compressed[i];
+            AnimationChannelData& channel = source.channel;
+            const size_t timeBytes = source.times.size() * sizeof(float);
+
+            // Channels of one clip often key the same times
+            channel.firstKey = static_cast<uint32_t>(times.size());
+            for (uint32_t other = clipFirstChannel; other < i; ++other)
+            {
+                const AnimationChannelData& previous = compressed[other].channel;
+                if (previous.keyCount == channel.keyCount && std::memcmp(times.data() + previous.firstKey, source.times.data(), timeBytes) == 0)
+                {
+                    channel.firstKey = previous.firstKey;
+                    break;
+                }
+            }
+            if (channel.firstKey == times.size())
+            {
+                times.insert(times.end(), source.times.begin(), source.times.end());
+            }
+
+            if (channel.encoding == AnimationEncoding::Float)
+            {
+                channel.firstValue = static_cast<uint32_t>(values.size());
+                values.insert(values.end(), source.values.begin(), source.values.end());
+            }
+            else
+            {
+                channel.firstValue = static_cast<uint32_t>(packedValues.size());
+                packedValues.insert(packedValues.end(), source.packed.begin(), source.packed.end());
+                ++stats.packedChannels;
+            }
+            model.animationChannels[i] = channel;
+            stats.keysAfter += channel.keyCount;
+        }
+
+        model.animationTimes.swap(times);
+        model.animationValues.swap(values);
+        model.animationPackedValues.swap(packedValues);
+        stats.bytesAfter = getAnimationMemory(model);
+        return stats;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinnacle
+{
+    // Largest error each stage may add to a sampled value. Key reduction and
+    // quantization are checked separately, so a sample stays within twice
+    // these of the source.
+    struct AnimationCompressionOptions
+    {
+        float maxTranslationError = 1e-4f; // Per axis, in node units (metres in glTF)
+        float maxRotationError = 5e-4f;    // Radians
+        float maxScaleError = 1e-4f;       // Per axis
+        float maxWeightError = 1e-3f;      // Per morph target weight
+        bool quantize = true;              // Pack rotations, translations and scales (weights stay Float)
+    };
+
+    struct AnimationCompressionStats
+    {
+        uint64_t keysBefore = 0; // Summed over channels
+        uint64_t keysAfter = 0;
+        uint64_t bytesBefore = 0; // getAnimationMemory() before and after
+        uint64_t bytesAfter = 0;
+        uint32_t packedChannels = 0; // SmallestThree or Unorm16 after compression
+    };
+
+    // Unit quaternion as its three smallest components, 15 bits each over
+    // [-1/sqrt(2), 1/sqrt(2)], with the largest one's index in the top bits
+    // of the first two values. The largest component is rebuilt as positive
+    // (q and -q are the same rotation).
+    void encodeSmallestThree(const float quaternion[4], uint16_t out[3]);
+    void decodeSmallestThree(const uint16_t encoded[3], float out[4]);
+
+    // Value of one key of a packed channel (three or four floats).
+    inline void decodeAnimationKey(const ModelData& model, const AnimationChannelData& channel, uint32_t key, float* out)
+    {
+        const uint16_t* pPacked = model.animationPackedValues.data() + channel.firstValue + key * 3;
+        if (channel.encoding == AnimationEncoding::SmallestThree)
+        {
+            decodeSmallestThree(pPacked, out);
+            return;
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+            out[c] = channel.rangeMin[c] + pPacked[c] * channel.rangeScale[c];
+        }
+    }
+
+    // Bytes held by the model's channels, key times and values.
+    uint64_t getAnimationMemory(const ModelData& model);
+
+    // Import stage for animations:
+    // - Drops keys that linear or step interpolation of their neighbours
+    //   rebuilds within `options`. Channels that never change keep one key.
+    // - Packs rotations as smallest-three and translations and scales as
+    //   Unorm16 over their range where the round trip stays within `options`.
+    // - Lays the result out clip by clip and channel by channel, each
+    //   channel's keys in time order, so sampling a pose walks the arrays
+    //   forward. Identical key times within a clip are stored once.
+    // Cubic spline channels are copied unchanged. Channels are processed in
+    // parallel on `threadCount` threads (0 = hardware concurrency).
+    AnimationCompressionStats compressAnimations(ModelData& model, const AnimationCompressionOptions& options,
+                                                 unsigned int threadCount = 0);
+} // namespace Pinnacle
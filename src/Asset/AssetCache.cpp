@@ -0,0 +1,172 @@
+#include "AssetCache.hpp"
+
+#include "BakedModel.hpp"
+#include "../Core/Hash.hpp"
+#include "../Core/MappedFile.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        bool hashFile(const std::string& path, uint64_t& outHash)
+        {
+            MappedFile file;
+            if (!file.open(path))
+            {
+                return false;
+            }
+            outHash = hashBytes(file.data(), file.size());
+            return true;
+        }
+
+        // Content hash a dependency is recorded and checked with. A file that
+        // cannot be read hashes to 0, so one missing at bake time still
+        // invalidates the cache once it appears.
+        uint64_t hashDependency(const std::string& path)
+        {
+            uint64_t hash = 0;
+            return hashFile(path, hash) ? hash : 0;
+        }
+
+        // Directory relative buffer and image URIs resolve against. Part of
+        // the cache key: byte-identical glTF files in two directories can
+        // reference different files under the same names.
+        std::string getSourceDirectory(const std::string& sourcePath)
+        {
+            std::error_code error;
+            std::filesystem::path path = std::filesystem::absolute(sourcePath, error);
+            if (error)
+            {
+                path = sourcePath;
+            }
+            return path.lexically_normal().parent_path().generic_string();
+        }
+
+        std::string toHex(uint64_t value)
+        {
+            char buffer[17];
+            std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+            return buffer;
+        }
+    } // namespace
+
+    AssetCache::AssetCache(const std::string& directory)
+        : m_directory(directory.empty() ? getDefaultDirectory() : directory)
+        , m_importCache(m_directory + "/chunks")
+    {
+    }
+
+    std::string AssetCache::getDefaultDirectory()
+    {
+        if (const char* pOverride = std::getenv("PINNACLE_CACHE_DIR"))
+        {
+            return pOverride;
+        }
+        const char* pHome = std::getenv("HOME");
+        const std::string home = pHome ? pHome : ".";
+#if defined(__APPLE__)
+        return home + "/Library/Caches/PinnacleCore";
+#else
+        if (const char* pXdg = std::getenv("XDG_CACHE_HOME"))
+        {
+            return std::string(pXdg) + "/pinnacle";
+        }
+        return home + "/.cache/pinnacle";
+#endif
+    }
+
+    bool AssetCache::loadModel(const std::string& sourcePath, GltfImporter& importer, ModelData& outModel)
+    {
+        uint64_t sourceHash = 0;
+        if (!m_enabled || !hashFile(sourcePath, sourceHash))
+        {
+            return importer.importFile(sourcePath, outModel);
+        }
+
+        const std::string sourceDirectory = getSourceDirectory(sourcePath);
+        uint64_t key = hashCombine(sourceHash, hashBytes(sourceDirectory.data(), sourceDirectory.size()));
+        key = hashCombine(hashCombine(key, importer.getSettingsHash()), kBakedModelVersion);
+        const std::string cachePath = m_directory + "/" + toHex(key) + ".pnb";
+
+        std::string error;
+        BakedModelInfo info;
+        if (readBakedModelInfo(cachePath, info, error) && info.sourceHash == key)
+        {
+            bool current = true;
+            for (const BakedDependency& dependency : info.dependencies)
+            {
+                if (hashDependency(dependency.path) != dependency.contentHash)
+                {
+                    current = false;
+                    break;
+                }
+            }
+            if (current && readBakedModel(cachePath, outModel, error))
+            {
+                // The file may have been baked from a copy in the same directory.
+                outModel.sourcePath = sourcePath;
+                if (m_pResourceCache)
+                {
+                    m_pResourceCache->shareTextures(outModel);
+                }
+                m_hits++;
+                return true;
+            }
+        }
+
+        m_misses++;
+        const bool useChunks = importer.getImportCache() == nullptr;
+        if (useChunks)
+        {
+            importer.setImportCache(&m_importCache);
+        }
+        const bool useResources = importer.getResourceCache() == nullptr;
+        if (useResources)
+        {
+            importer.setResourceCache(m_pResourceCache);
+        }
+        const bool imported = importer.importFile(sourcePath, outModel);
+        if (useChunks)
+        {
+            importer.setImportCache(nullptr);
+        }
+        if (useResources)
+        {
+            importer.setResourceCache(nullptr);
+        }
+        if (!imported)
+        {
+            return false;
+        }
+
+        info = BakedModelInfo();
+        info.sourceHash = key;
+        for (const std::string& dependency : importer.getDependencies())
+        {
+            BakedDependency entry;
+            entry.path = dependency;
+            entry.contentHash = hashDependency(dependency);
+            info.dependencies.push_back(entry);
+        }
+
+        // Write to a private temporary and rename so concurrent loaders never
+        // see a partial file. A failed write only costs the next launch a re-import.
+        std::error_code filesystemError;
+        std::filesystem::create_directories(m_directory, filesystemError);
+        const std::string temporaryPath = makeTemporaryPath(cachePath);
+        if (writeBakedModel(temporaryPath, outModel, info, error))
+        {
+            std::filesystem::rename(temporaryPath, cachePath, filesystemError);
+            if (!filesystemError)
+            {
+                return true;
+            }
+        }
+        std::filesystem::remove(temporaryPath, filesystemError);
+        return true;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "GltfImporter.hpp"
+#include "ImportCache.hpp"
+#include "ModelData.hpp"
+#include "ResourceCache.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace Pinnacle
+{
+    // On-disk cache of baked models. An entry is keyed by the content hash of
+    // the source glTF, its directory, the importer settings and the baked
+    // format version, and is only used while every external buffer and image
+    // it was built from still hashes the same. Safe to use from several
+    // loader threads.
+    class AssetCache
+    {
+    public:
+        // An empty directory selects getDefaultDirectory().
+        explicit AssetCache(const std::string& directory = std::string());
+
+        // Loads a baked copy when a valid one exists, otherwise imports the
+        // source with `importer` and bakes the result for next time. Import
+        // warnings and errors are left on the importer. An importer without
+        // its own ImportCache uses getImportCache() for the re-import, so an
+        // edited model only redoes the images and primitives that changed.
+        bool loadModel(const std::string& sourcePath, GltfImporter& importer, ModelData& outModel);
+
+        void setEnabled(bool enabled) { m_enabled = enabled; }
+        bool isEnabled() const { return m_enabled; }
+        const std::string& getDirectory() const { return m_directory; }
+
+        uint32_t getHitCount() const { return m_hits.load(); }
+        uint32_t getMissCount() const { return m_misses.load(); }
+
+        // Chunk store under <directory>/chunks.
+        ImportCache& getImportCache() { return m_importCache; }
+
+        // Optional in-memory texture cache (not owned). Baked models share
+        // their textures through it, and re-imports use it when the importer
+        // has none of its own.
+        void setResourceCache(ResourceCache* pCache) { m_pResourceCache = pCache; }
+        ResourceCache* getResourceCache() const { return m_pResourceCache; }
+
+        // $PINNACLE_CACHE_DIR if set; otherwise ~/Library/Caches/PinnacleCore
+        // on Apple platforms and $XDG_CACHE_HOME/pinnacle (or ~/.cache/pinnacle)
+        // elsewhere.
+        static std::string getDefaultDirectory();
+
+    private:
+        std::string m_directory;
+        ImportCache m_importCache;
+        ResourceCache* m_pResourceCache = nullptr;
+        bool m_enabled = true;
+        std::atomic<uint32_t> m_hits{ 0 };
+        std::atomic<uint32_t> m_misses{ 0 };
+    };
+} // namespace Pinnacle
@@ -0,0 +1,746 @@
+#include "BakedModel.hpp"
+
+#include "../Core/MappedFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        constexpr uint32_t fourCC(char a, char b, char c, char d)
+        {
+            return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) |
+                   (static_cast<uint32_t>(d) << 24);
+        }
+
+        const char kMagic[4] = { 'P', 'N', 'B', 'K' };
+        const uint64_t kBlobAlignment = 16;
+
+        enum SectionType : uint32_t
+        {
+            kSectionModel = fourCC('M', 'O', 'D', 'L'),
+            kSectionStrings = fourCC('S', 'T', 'R', 'S'),
+            kSectionDependencies = fourCC('D', 'E', 'P', 'S'),
+            kSectionVertices = fourCC('V', 'R', 'T', 'X'),
+            kSectionVertexColors = fourCC('C', 'O', 'L', 'R'),
+            kSectionIndices = fourCC('I', 'N', 'D', 'X'),
+            kSectionPrimitives = fourCC('P', 'R', 'I', 'M'),
+            kSectionLods = fourCC('L', 'O', 'D', 'S'),
+            kSectionMeshlets = fourCC('M', 'S', 'H', 'L'),
+            kSectionMeshes = fourCC('M', 'E', 'S', 'H'),
+            kSectionMaterials = fourCC('M', 'A', 'T', 'L'),
+            kSectionTextures = fourCC('T', 'E', 'X', 'R'),
+            kSectionTextureMips = fourCC('T', 'M', 'I', 'P'),
+            kSectionTexels = fourCC('T', 'E', 'X', 'L'),
+            kSectionNodes = fourCC('N', 'O', 'D', 'E'),
+            kSectionLights = fourCC('L', 'G', 'H', 'T'),
+            kSectionSkinVertices = fourCC('S', 'K', 'V', 'X'),
+            kSectionSkins = fourCC('S', 'K', 'I', 'N'),
+            kSectionJoints = fourCC('J', 'O', 'N', 'T'),
+            kSectionAnimations = fourCC('A', 'N', 'I', 'M'),
+            kSectionAnimationChannels = fourCC('A', 'C', 'H', 'N'),
+            kSectionAnimationTimes = fourCC('A', 'T', 'I', 'M'),
+            kSectionAnimationValues = fourCC('A', 'V', 'A', 'L'),
+            kSectionAnimationPackedValues = fourCC('A', 'P', 'C', 'K'),
+            kSectionMorphTargets = fourCC('M', 'T', 'G', 'T'),
+            kSectionMorphDeltas = fourCC('M', 'D', 'L', 'T'),
+            kSectionMorphDeltaVertices = fourCC('M', 'D', 'V', 'X'),
+            kSectionMorphWeights = fourCC('M', 'W', 'G', 'T')
+        };
+
+        struct FileHeader
+        {
+            char magic[4];
+            uint32_t version;
+            uint32_t sectionCount;
+            uint32_t reserved;
+            uint64_t sourceHash;
+            uint64_t fileSize;
+        };
+
+        struct SectionEntry
+        {
+            uint32_t type;
+            uint32_t elementSize;
+            uint64_t offset; // From the start of the file, kBlobAlignment-aligned
+            uint64_t size;   // In bytes
+        };
+
+        struct StringRef
+        {
+            uint32_t offset; // Into the string table
+            uint32_t length;
+        };
+
+        struct ModelRecord
+        {
+            Bounds bounds;
+            StringRef sourcePath;
+        };
+
+        struct MeshRecord
+        {
+            StringRef name;
+            uint32_t firstPrimitive;
+            uint32_t primitiveCount;
+        };
+
+        struct TextureRecord
+        {
+            StringRef name;
+            StringRef uri;
+            uint32_t format;
+            uint32_t width;
+            uint32_t height;
+            uint32_t firstMip;
+            uint32_t mipCount;
+            uint32_t reserved;
+            uint64_t contentHash;
+        };
+
+        struct AnimationRecord
+        {
+            StringRef name;
+            uint32_t firstChannel;
+            uint32_t channelCount;
+            float duration;
+        };
+
+        struct DependencyRecord
+        {
+            StringRef path;
+            uint64_t contentHash;
+        };
+
+        static_assert(std::is_trivially_copyable<ModelVertex>::value, "ModelVertex is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<PrimitiveData>::value, "PrimitiveData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<LodData>::value, "LodData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<MeshletData>::value, "MeshletData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<MaterialData>::value, "MaterialData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<TextureMipData>::value, "TextureMipData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<NodeData>::value, "NodeData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<LightData>::value, "LightData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<SkinVertex>::value, "SkinVertex is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<SkinData>::value, "SkinData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<JointData>::value, "JointData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<AnimationChannelData>::value, "AnimationChannelData is stored as raw bytes");
+        static_assert(std::is_trivially_copyable<MorphTargetData>::value, "MorphTargetData is stored as raw bytes");
+
+        class StringTable
+        {
+        public:
+            StringRef add(const std::string& value)
+            {
+                StringRef ref = { static_cast<uint32_t>(m_data.size()), static_cast<uint32_t>(value.size()) };
+                m_data += value;
+                return ref;
+            }
+
+            const std::string& getData() const { return m_data; }
+
+        private:
+            std::string m_data;
+        };
+
+        struct PendingSection
+        {
+            uint32_t type;
+            uint32_t elementSize;
+            const void* pData;
+            uint64_t size;
+        };
+
+        template <typename T>
+        PendingSection makeSection(uint32_t type, const std::vector<T>& values)
+        {
+            return { type, static_cast<uint32_t>(sizeof(T)), values.data(), values.size() * sizeof(T) };
+        }
+
+        uint64_t alignUp(uint64_t value) { return (value + kBlobAlignment - 1) & ~(kBlobAlignment - 1); }
+
+        // Bounds-checked view over a mapped baked file.
+        class SectionReader
+        {
+        public:
+            bool open(const std::string& path, std::string& error)
+            {
+                if (!m_file.open(path))
+                {
+                    error = "Cannot open baked model: " + path;
+                    return false;
+                }
+                if (m_file.size() < sizeof(FileHeader))
+                {
+                    error = "Baked model is truncated: " + path;
+                    return false;
+                }
+                std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+                if (std::memcmp(m_header.magic, kMagic, sizeof(kMagic)) != 0)
+                {
+                    error = "Not a baked model: " + path;
+                    return false;
+                }
+                if (m_header.version != kBakedModelVersion)
+                {
+                    error = "Baked model version mismatch: " + path;
+                    return false;
+                }
+                const uint64_t tableEnd = sizeof(FileHeader) + uint64_t(m_header.sectionCount) * sizeof(SectionEntry);
+                if (m_header.fileSize != m_file.size() || tableEnd > m_file.size())
+                {
+                    error = "Baked model is truncated: " + path;
+                    return false;
+                }
+                m_pSections = m_file.data() + sizeof(FileHeader);
+                return true;
+            }
+
+            const FileHeader& getHeader() const { return m_header; }
+
+            // Null with size 0 when the section is absent; false if it is malformed.
+            bool find(uint32_t type, uint32_t elementSize, const uint8_t*& pData, uint64_t& size) const
+            {
+                pData = nullptr;
+                size = 0;
+                for (uint32_t i = 0; i < m_header.sectionCount; ++i)
+                {
+                    SectionEntry entry;
+                    std::memcpy(&entry, m_pSections + i * sizeof(SectionEntry), sizeof(entry));
+                    if (entry.type != type)
+                    {
+                        continue;
+                    }
+                    if (entry.elementSize != elementSize || entry.size % elementSize != 0 ||
+                        entry.offset > m_file.size() || entry.size > m_file.size() - entry.offset)
+                    {
+                        return false;
+                    }
+                    pData = m_file.data() + entry.offset;
+                    size = entry.size;
+                    return true;
+                }
+                return true;
+            }
+
+            template <typename T>
+            bool read(uint32_t type, std::vector<T>& out) const
+            {
+                const uint8_t* pData;
+                uint64_t size;
+                if (!find(type, sizeof(T), pData, size))
+                {
+                    return false;
+                }
+                out.resize(static_cast<size_t>(size / sizeof(T)));
+                if (size > 0)
+                {
+                    std::memcpy(out.data(), pData, static_cast<size_t>(size));
+                }
+                return true;
+            }
+
+        private:
+            MappedFile m_file;
+            FileHeader m_header;
+            const uint8_t* m_pSections = nullptr;
+        };
+
+        bool resolveString(const std::vector<char>& strings, const StringRef& ref, std::string& out)
+        {
+            if (uint64_t(ref.offset) + ref.length > strings.size())
+            {
+                return false;
+            }
+            out.assign(strings.data() + ref.offset, ref.length);
+            return true;
+        }
+
+        bool readDependencies(const SectionReader& reader, const std::vector<char>& strings,
+                              std::vector<BakedDependency>& out)
+        {
+            std::vector<DependencyRecord> records;
+            if (!reader.read(kSectionDependencies, records))
+            {
+                return false;
+            }
+            out.resize(records.size());
+            for (size_t i = 0; i < records.size(); ++i)
+            {
+                out[i].contentHash = records[i].contentHash;
+                if (!resolveString(strings, records[i].path, out[i].path))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Whether a range of ModelData::indices exists and only addresses
+        // the first `vertexCount` vertices.
+        bool validateIndices(const std::vector<uint32_t>& indices, uint32_t indexOffset, uint32_t indexCount,
+                             uint32_t vertexCount)
+        {
+            if (uint64_t(indexOffset) + indexCount > indices.size())
+            {
+                return false;
+            }
+            for (uint32_t i = 0; i < indexCount; ++i)
+            {
+                if (indices[indexOffset + i] >= vertexCount)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Rejects ranges that would make the renderer read out of bounds.
+        bool validate(const ModelData& model)
+        {
+            for (const PrimitiveData& primitive : model.primitives)
+            {
+                if ((primitive.vertexFormat != VertexFormat::Float && primitive.vertexFormat != VertexFormat::Quantized) ||
+                    uint64_t(primitive.vertexOffset) + primitive.vertexCount > model.vertices.size() ||
+                    uint64_t(primitive.indexOffset) + primitive.indexCount > model.indices.size() ||
+                    uint64_t(primitive.firstLod) + primitive.lodCount > model.lods.size() ||
+                    uint64_t(primitive.firstMeshlet) + primitive.meshletCount > model.meshlets.size() ||
+                    (primitive.hasVertexColors &&
+                     uint64_t(primitive.firstColor) + primitive.vertexCount > model.vertexColors.size()) ||
+                    (primitive.hasSkinWeights &&
+                     uint64_t(primitive.firstSkinVertex) + primitive.vertexCount > model.skinVertices.size()) ||
+                    uint64_t(primitive.firstMorphTarget) + primitive.morphTargetCount > model.morphTargets.size())
+                {
+                    return false;
+                }
+                // Indices are primitive-relative, at every level of detail
+                if (!validateIndices(model.indices, primitive.indexOffset, primitive.indexCount, primitive.vertexCount))
+                {
+                    return false;
+                }
+                for (uint32_t l = 0; l < primitive.lodCount; ++l)
+                {
+                    const LodData& lod = model.lods[primitive.firstLod + l];
+                    if (!validateIndices(model.indices, lod.indexOffset, lod.indexCount, primitive.vertexCount))
+                    {
+                        return false;
+                    }
+                }
+                for (uint32_t m = 0; m < primitive.meshletCount; ++m)
+                {
+                    const MeshletData& meshlet = model.meshlets[primitive.firstMeshlet + m];
+                    if (meshlet.indexOffset < primitive.indexOffset ||
+                        uint64_t(meshlet.indexOffset) + uint64_t(meshlet.triangleCount) * 3 >
+                            uint64_t(primitive.indexOffset) + primitive.indexCount)
+                    {
+                        return false;
+                    }
+                }
+                // Morphing walks each target's deltas in ascending vertex order
+                for (uint32_t t = 0; t < primitive.morphTargetCount; ++t)
+                {
+                    const MorphTargetData& target = model.morphTargets[primitive.firstMorphTarget + t];
+                    if (uint64_t(target.firstDelta) + target.deltaCount > model.morphDeltas.size() ||
+                        model.morphDeltaVertices.size() != model.morphDeltas.size())
+                    {
+                        return false;
+                    }
+                    for (uint32_t d = 0; d < target.deltaCount; ++d)
+                    {
+                        const uint32_t vertex = model.morphDeltaVertices[target.firstDelta + d];
+                        if (vertex >= primitive.vertexCount ||
+                            (d > 0 && vertex <= model.morphDeltaVertices[target.firstDelta + d - 1]))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+            for (const LodData& lod : model.lods)
+            {
+                if (uint64_t(lod.indexOffset) + lod.indexCount > model.indices.size())
+                {
+                    return false;
+                }
+            }
+            for (const MeshletData& meshlet : model.meshlets)
+            {
+                if (uint64_t(meshlet.indexOffset) + uint64_t(meshlet.triangleCount) * 3 > model.indices.size())
+                {
+                    return false;
+                }
+            }
+            for (const MeshData& mesh : model.meshes)
+            {
+                if (uint64_t(mesh.firstPrimitive) + mesh.primitiveCount > model.primitives.size())
+                {
+                    return false;
+                }
+            }
+            const int32_t textureCount = static_cast<int32_t>(model.textures.size());
+            for (const MaterialData& material : model.materials)
+            {
+                for (int32_t texture : { material.baseColorTexture, material.metallicRoughnessTexture, material.normalTexture,
+                                         material.occlusionTexture, material.emissiveTexture })
+                {
+                    if (texture >= textureCount)
+                    {
+                        return false;
+                    }
+                }
+                if (material.alphaMode > AlphaMode::Blend)
+                {
+                    return false;
+                }
+            }
+            for (const TextureData& texture : model.textures)
+            {
+                if (uint64_t(texture.firstMip) + texture.mipCount > model.textureMips.size() ||
+                    texture.format > TextureFormat::BC7Srgb)
+                {
+                    return false;
+                }
+            }
+            for (const TextureMipData& mip : model.textureMips)
+            {
+                if (mip.offset > model.texels.size() || mip.size > model.texels.size() - mip.offset)
+                {
+                    return false;
+                }
+            }
+            for (size_t i = 0; i < model.nodes.size(); ++i)
+            {
+                const NodeData& node = model.nodes[i];
+                if (node.parent >= static_cast<int32_t>(i) || node.mesh >= static_cast<int32_t>(model.meshes.size()) ||
+                    node.skin >= static_cast<int32_t>(model.skins.size()) || (node.skin >= 0 && node.mesh < 0) ||
+                    uint64_t(node.firstMorphWeight) + node.morphWeightCount > model.morphWeights.size())
+                {
+                    return false;
+                }
+                // Skinning indexes joint matrices with the stored joint numbers
+                if (node.skin >= 0)
+                {
+                    const MeshData& mesh = model.meshes[node.mesh];
+                    for (uint32_t p = 0; p < mesh.primitiveCount; ++p)
+                    {
+                        const PrimitiveData& primitive = model.primitives[mesh.firstPrimitive + p];
+                        for (uint32_t v = 0; primitive.hasSkinWeights && v < primitive.vertexCount; ++v)
+                        {
+                            const SkinVertex& vertex = model.skinVertices[primitive.firstSkinVertex + v];
+                            for (int c = 0; c < 4; ++c)
+                            {
+                                if (vertex.weights[c] > 0 && vertex.joints[c] >= model.skins[node.skin].jointCount)
+                                {
+                                    return false;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            for (const SkinData& skin : model.skins)
+            {
+                if (uint64_t(skin.firstJoint) + skin.jointCount > model.joints.size())
+                {
+                    return false;
+                }
+            }
+            for (const JointData& joint : model.joints)
+            {
+                if (joint.node >= static_cast<int32_t>(model.nodes.size()))
+                {
+                    return false;
+                }
+            }
+            for (const AnimationData& animation : model.animations)
+            {
+                if (uint64_t(animation.firstChannel) + animation.channelCount > model.animationChannels.size())
+                {
+                    return false;
+                }
+            }
+            for (const AnimationChannelData& channel : model.animationChannels)
+            {
+                if (channel.node < 0 || channel.node >= static_cast<int32_t>(model.nodes.size()))
+                {
+                    return false;
+                }
+                if (channel.path > AnimationPath::Weights || channel.interpolation > AnimationInterpolation::CubicSpline ||
+                    channel.encoding > AnimationEncoding::Unorm16 || channel.keyCount == 0 ||
+                    uint64_t(channel.firstKey) + channel.keyCount > model.animationTimes.size())
+                {
+                    return false;
+                }
+                if (channel.encoding != AnimationEncoding::Float)
+                {
+                    // Rotations pack as SmallestThree, translations and scales as Unorm16
+                    const bool rotation = channel.path == AnimationPath::Rotation;
+                    if (channel.interpolation == AnimationInterpolation::CubicSpline || channel.path == AnimationPath::Weights ||
+                        rotation != (channel.encoding == AnimationEncoding::SmallestThree) ||
+                        channel.firstValue + uint64_t(channel.keyCount) * 3 > model.animationPackedValues.size())
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+                const uint64_t valuesPerKey =
+                    getComponentCount(model, channel) * (channel.interpolation == AnimationInterpolation::CubicSpline ? 3 : 1);
+                if (channel.firstValue + channel.keyCount * valuesPerKey > model.animationValues.size())
+                {
+                    return false;
+                }
+            }
+            for (const LightData& light : model.lights)
+            {
+                if (light.node < 0 || light.node >= static_cast<int32_t>(model.nodes.size()) || light.type > LightType::Spot)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    bool writeBakedModel(const std::string& path, const ModelData& model, const BakedModelInfo& info, std::string& error)
+    {
+        StringTable strings;
+
+        std::vector<ModelRecord> modelRecord(1);
+        modelRecord[0].bounds = model.bounds;
+        modelRecord[0].sourcePath = strings.add(model.sourcePath);
+
+        std::vector<MeshRecord> meshes(model.meshes.size());
+        for (size_t i = 0; i < model.meshes.size(); ++i)
+        {
+            meshes[i].name = strings.add(model.meshes[i].name);
+            meshes[i].firstPrimitive = model.meshes[i].firstPrimitive;
+            meshes[i].primitiveCount = model.meshes[i].primitiveCount;
+        }
+
+        std::vector<TextureRecord> textures(model.textures.size());
+        for (size_t i = 0; i < model.textures.size(); ++i)
+        {
+            const TextureData& texture = model.textures[i];
+            textures[i] = {};
+            textures[i].name = strings.add(texture.name);
+            textures[i].uri = strings.add(texture.uri);
+            textures[i].contentHash = texture.contentHash;
+            textures[i].format = static_cast<uint32_t>(texture.format);
+            textures[i].width = texture.width;
+            textures[i].height = texture.height;
+            textures[i].firstMip = texture.firstMip;
+            textures[i].mipCount = texture.mipCount;
+        }
+
+        // Shared textures keep their texels outside the model; the file always
+        // holds one flat texel section.
+        std::vector<TextureMipData> flatMips;
+        std::vector<uint8_t> flatTexels;
+        const bool flatten = std::any_of(model.textures.begin(), model.textures.end(),
+                                         [](const TextureData& texture) { return texture.resource != nullptr; });
+        if (flatten)
+        {
+            flatMips = model.textureMips;
+            flatTexels = model.texels;
+            for (const TextureData& texture : model.textures)
+            {
+                for (uint32_t mip = 0; texture.resource && mip < texture.mipCount; ++mip)
+                {
+                    TextureMipData& level = flatMips[texture.firstMip + mip];
+                    const uint8_t* pBegin = texture.resource->texels.data() + level.offset;
+                    level.offset = flatTexels.size();
+                    flatTexels.insert(flatTexels.end(), pBegin, pBegin + level.size);
+                }
+            }
+        }
+
+        std::vector<AnimationRecord> animations(model.animations.size());
+        for (size_t i = 0; i < model.animations.size(); ++i)
+        {
+            animations[i].name = strings.add(model.animations[i].name);
+            animations[i].firstChannel = model.animations[i].firstChannel;
+            animations[i].channelCount = model.animations[i].channelCount;
+            animations[i].duration = model.animations[i].duration;
+        }
+
+        std::vector<DependencyRecord> dependencies(info.dependencies.size());
+        for (size_t i = 0; i < info.dependencies.size(); ++i)
+        {
+            dependencies[i].path = strings.add(info.dependencies[i].path);
+            dependencies[i].contentHash = info.dependencies[i].contentHash;
+        }
+
+        const std::string& stringData = strings.getData();
+        const PendingSection sections[] = {
+            makeSection(kSectionModel, modelRecord),
+            { kSectionStrings, 1, stringData.data(), stringData.size() },
+            makeSection(kSectionDependencies, dependencies),
+            makeSection(kSectionVertices, model.vertices),
+            makeSection(kSectionVertexColors, model.vertexColors),
+            makeSection(kSectionIndices, model.indices),
+            makeSection(kSectionPrimitives, model.primitives),
+            makeSection(kSectionLods, model.lods),
+            makeSection(kSectionMeshlets, model.meshlets),
+            makeSection(kSectionMeshes, meshes),
+            makeSection(kSectionMaterials, model.materials),
+            makeSection(kSectionTextures, textures),
+            makeSection(kSectionTextureMips, flatten ? flatMips : model.textureMips),
+            makeSection(kSectionTexels, flatten ? flatTexels : model.texels),
+            makeSection(kSectionNodes, model.nodes),
+            makeSection(kSectionLights, model.lights),
+            makeSection(kSectionSkinVertices, model.skinVertices),
+            makeSection(kSectionSkins, model.skins),
+            makeSection(kSectionJoints, model.joints),
+            makeSection(kSectionAnimations, animations),
+            makeSection(kSectionAnimationChannels, model.animationChannels),
+            makeSection(kSectionAnimationTimes, model.animationTimes),
+            makeSection(kSectionAnimationValues, model.animationValues),
+            makeSection(kSectionAnimationPackedValues, model.animationPackedValues),
+            makeSection(kSectionMorphTargets, model.morphTargets),
+            makeSection(kSectionMorphDeltas, model.morphDeltas),
+            makeSection(kSectionMorphDeltaVertices, model.morphDeltaVertices),
+            makeSection(kSectionMorphWeights, model.morphWeights),
+        };
+        const uint32_t sectionCount = static_cast<uint32_t>(sizeof(sections) / sizeof(sections[0]));
+
+        std::vector<SectionEntry> table(sectionCount);
+        uint64_t offset = alignUp(sizeof(FileHeader) + sectionCount * sizeof(SectionEntry));
+        for (uint32_t i = 0; i < sectionCount; ++i)
+        {
+            table[i] = { sections[i].type, sections[i].elementSize, offset, sections[i].size };
+            offset = alignUp(offset + sections[i].size);
+        }
+
+        FileHeader header = {};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = kBakedModelVersion;
+        header.sectionCount = sectionCount;
+        header.sourceHash = info.sourceHash;
+        header.fileSize = offset;
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+        {
+            error = "Cannot create baked model: " + path;
+            return false;
+        }
+
+        static const char kPadding[kBlobAlignment] = {};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(table.data()), table.size() * sizeof(SectionEntry));
+        uint64_t written = sizeof(header) + table.size() * sizeof(SectionEntry);
+        for (uint32_t i = 0; i < sectionCount; ++i)
+        {
+            file.write(kPadding, static_cast<std::streamsize>(table[i].offset - written));
+            file.write(static_cast<const char*>(sections[i].pData), static_cast<std::streamsize>(sections[i].size));
+            written = table[i].offset + sections[i].size;
+        }
+        file.write(kPadding, static_cast<std::streamsize>(header.fileSize - written));
+
+        if (!file.flush())
+        {
+            error = "Failed writing baked model: " + path;
+            return false;
+        }
+        return true;
+    }
+
+    bool readBakedModelInfo(const std::string& path, BakedModelInfo& outInfo, std::string& error)
+    {
+        SectionReader reader;
+        if (!reader.open(path, error))
+        {
+            return false;
+        }
+        std::vector<char> strings;
+        if (!reader.read(kSectionStrings, strings) || !readDependencies(reader, strings, outInfo.dependencies))
+        {
+            error = "Baked model is corrupt: " + path;
+            return false;
+        }
+        outInfo.sourceHash = reader.getHeader().sourceHash;
+        return true;
+    }
+
+    bool readBakedModel(const std::string& path, ModelData& outModel, std::string& error)
+    {
+        SectionReader reader;
+        if (!reader.open(path, error))
+        {
+            return false;
+        }
+
+        std::vector<char> strings;
+        std::vector<ModelRecord> modelRecord;
+        std::vector<MeshRecord> meshes;
+        std::vector<TextureRecord> textures;
+        std::vector<AnimationRecord> animations;
+        bool valid = reader.read(kSectionStrings, strings) && reader.read(kSectionModel, modelRecord) &&
+                     modelRecord.size() == 1 && reader.read(kSectionVertices, outModel.vertices) &&
+                     reader.read(kSectionVertexColors, outModel.vertexColors) &&
+                     reader.read(kSectionIndices, outModel.indices) && reader.read(kSectionPrimitives, outModel.primitives) &&
+                     reader.read(kSectionLods, outModel.lods) && reader.read(kSectionMeshlets, outModel.meshlets) &&
+                     reader.read(kSectionMeshes, meshes) && reader.read(kSectionMaterials, outModel.materials) &&
+                     reader.read(kSectionTextures, textures) && reader.read(kSectionTextureMips, outModel.textureMips) &&
+                     reader.read(kSectionTexels, outModel.texels) && reader.read(kSectionNodes, outModel.nodes) &&
+                     reader.read(kSectionLights, outModel.lights) && reader.read(kSectionSkinVertices, outModel.skinVertices) &&
+                     reader.read(kSectionSkins, outModel.skins) && reader.read(kSectionJoints, outModel.joints) &&
+                     reader.read(kSectionAnimations, animations) &&
+                     reader.read(kSectionAnimationChannels, outModel.animationChannels) &&
+                     reader.read(kSectionAnimationTimes, outModel.animationTimes) &&
+                     reader.read(kSectionAnimationValues, outModel.animationValues) &&
+                     reader.read(kSectionAnimationPackedValues, outModel.animationPackedValues) &&
+                     reader.read(kSectionMorphTargets, outModel.morphTargets) &&
+                     reader.read(kSectionMorphDeltas, outModel.morphDeltas) &&
+                     reader.read(kSectionMorphDeltaVertices, outModel.morphDeltaVertices) &&
+                     reader.read(kSectionMorphWeights, outModel.morphWeights);
+
+        if (valid)
+        {
+            outModel.bounds = modelRecord[0].bounds;
+            valid = resolveString(strings, modelRecord[0].sourcePath, outModel.sourcePath);
+
+            outModel.meshes.resize(meshes.size());
+            for (size_t i = 0; i < meshes.size() && valid; ++i)
+            {
+                valid = resolveString(strings, meshes[i].name, outModel.meshes[i].name);
+                outModel.meshes[i].firstPrimitive = meshes[i].firstPrimitive;
+                outModel.meshes[i].primitiveCount = meshes[i].primitiveCount;
+            }
+
+            outModel.textures.resize(textures.size());
+            for (size_t i = 0; i < textures.size() && valid; ++i)
+            {
+                TextureData& texture = outModel.textures[i];
+                valid = resolveString(strings, textures[i].name, texture.name) &&
+                        resolveString(strings, textures[i].uri, texture.uri);
+                texture.contentHash = textures[i].contentHash;
+                texture.format = static_cast<TextureFormat>(textures[i].format);
+                texture.width = textures[i].width;
+                texture.height = textures[i].height;
+                texture.firstMip = textures[i].firstMip;
+                texture.mipCount = textures[i].mipCount;
+            }
+
+            outModel.animations.resize(animations.size());
+            for (size_t i = 0; i < animations.size() && valid; ++i)
+            {
+                valid = resolveString(strings, animations[i].name, outModel.animations[i].name);
+                outModel.animations[i].firstChannel = animations[i].firstChannel;
+                outModel.animations[i].channelCount = animations[i].channelCount;
+                outModel.animations[i].duration = animations[i].duration;
+            }
+        }
+
+        if (!valid || !validate(outModel))
+        {
+            error = "Baked model is corrupt: " + path;
+            outModel = ModelData();
+            return false;
+        }
+        return true;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ModelData.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Pinnacle baked model (.pnb): a header, a table of contents and one
+    // 16-byte-aligned blob per ModelData array, written in native byte order
+    // and record layout. Loading maps the file and copies each blob once;
+    // nothing is parsed or decoded.
+    //
+    // Bump kBakedModelVersion whenever the layout or any record stored in it
+    // (ModelVertex, PrimitiveData, MeshletData, ...) changes; older files are
+    // then rejected and rebuilt from source.
+    const uint32_t kBakedModelVersion = 10;
+
+    struct BakedDependency
+    {
+        std::string path;
+        uint64_t contentHash = 0; // 0 when the file was missing at bake time
+    };
+
+    struct BakedModelInfo
+    {
+        uint64_t sourceHash = 0; // Cache key the file was written under
+        std::vector<BakedDependency> dependencies;
+    };
+
+    bool writeBakedModel(const std::string& path, const ModelData& model, const BakedModelInfo& info, std::string& error);
+
+    // Reads only the header and dependency table.
+    bool readBakedModelInfo(const std::string& path, BakedModelInfo& outInfo, std::string& error);
+
+    bool readBakedModel(const std::string& path, ModelData& outModel, std::string& error);
+} // namespace Pinnacle
@@ -0,0 +1,294 @@
+#include "Bc7Encoder.hpp"
+
+#include "../Core/Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // BC7 interpolation weights for 4-bit indices, in 64ths.
+        const int kIndexWeights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+        struct EncodedBlock
+        {
+            int quantized[2][4] = {}; // 7-bit endpoint channels
+            int pBits[2] = {};
+            uint8_t indices[16] = {};
+            uint32_t error = UINT32_MAX;
+        };
+
+        uint32_t assignIndices(const int pixels[16][4], const int endpoint0[4], const int endpoint1[4], uint8_t indices[16])
+        {
+            int palette[16][4];
+            for (int i = 0; i < 16; ++i)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    palette[i][c] = ((64 - kIndexWeights[i]) * endpoint0[c] + kIndexWeights[i] * endpoint1[c] + 32) >> 6;
+                }
+            }
+
+            uint32_t total = 0;
+            for (int p = 0; p < 16; ++p)
+            {
+                uint32_t best = UINT32_MAX;
+                for (int i = 0; i < 16; ++i)
+                {
+                    uint32_t error = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        const int delta = pixels[p][c] - palette[i][c];
+                        error += static_cast<uint32_t>(delta * delta);
+                    }
+                    if (error < best)
+                    {
+                        best = error;
+                        indices[p] = static_cast<uint8_t>(i);
+                    }
+                }
+                total += best;
+            }
+            return total;
+        }
+
+        // Quantizes a float endpoint pair for every p-bit combination and
+        // keeps the one with the lowest block error.
+        void evaluate(const int pixels[16][4], const float endpoints[2][4], EncodedBlock& best)
+        {
+            for (int pBit0 = 0; pBit0 < 2; ++pBit0)
+            {
+                for (int pBit1 = 0; pBit1 < 2; ++pBit1)
+                {
+                    EncodedBlock candidate;
+                    candidate.pBits[0] = pBit0;
+                    candidate.pBits[1] = pBit1;
+                    int expanded[2][4];
+                    for (int e = 0; e < 2; ++e)
+                    {
+                        for (int c = 0; c < 4; ++c)
+                        {
+                            const int q = static_cast<int>(std::lround((endpoints[e][c] - candidate.pBits[e]) * 0.5f));
+                            candidate.quantized[e][c] = std::min(127, std::max(0, q));
+                            expanded[e][c] = (candidate.quantized[e][c] << 1) | candidate.pBits[e];
+                        }
+                    }
+                    candidate.error = assignIndices(pixels, expanded[0], expanded[1], candidate.indices);
+                    if (candidate.error < best.error)
+                    {
+                        best = candidate;
+                    }
+                }
+            }
+        }
+
+        // Least-squares endpoints for fixed indices. Returns false when the
+        // indices do not span a line (all equal).
+        bool fitEndpoints(const int pixels[16][4], const uint8_t indices[16], float endpoints[2][4])
+        {
+            float a = 0.0f, b = 0.0f, c = 0.0f;
+            float rhs0[4] = {}, rhs1[4] = {};
+            for (int p = 0; p < 16; ++p)
+            {
+                const float t = kIndexWeights[indices[p]] / 64.0f;
+                const float s = 1.0f - t;
+                a += s * s;
+                b += s * t;
+                c += t * t;
+                for (int k = 0; k < 4; ++k)
+                {
+                    rhs0[k] += s * pixels[p][k];
+                    rhs1[k] += t * pixels[p][k];
+                }
+            }
+            const float determinant = a * c - b * b;
+            if (std::fabs(determinant) < 1e-6f)
+            {
+                return false;
+            }
+            for (int k = 0; k < 4; ++k)
+            {
+                endpoints[0][k] = std::min(255.0f, std::max(0.0f, (c * rhs0[k] - b * rhs1[k]) / determinant));
+                endpoints[1][k] = std::min(255.0f, std::max(0.0f, (a * rhs1[k] - b * rhs0[k]) / determinant));
+            }
+            return true;
+        }
+
+        void putBits(uint8_t* pBlock, uint32_t& position, uint32_t value, uint32_t count)
+        {
+            for (uint32_t i = 0; i < count; ++i, ++position)
+            {
+                if ((value >> i) & 1u)
+                {
+                    pBlock[position >> 3] |= static_cast<uint8_t>(1u << (position & 7));
+                }
+            }
+        }
+    } // namespace
+
+    void encodeBc7Block(const uint8_t* pTexels, uint8_t* pOut)
+    {
+        int pixels[16][4];
+        float mean[4] = {};
+        for (int p = 0; p < 16; ++p)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                pixels[p][c] = pTexels[p * 4 + c];
+                mean[c] += pixels[p][c] / 16.0f;
+            }
+        }
+
+        // Principal axis of the block's colours by power iteration on the covariance.
+        float covariance[4][4] = {};
+        for (int p = 0; p < 16; ++p)
+        {
+            float delta[4];
+            for (int c = 0; c < 4; ++c)
+            {
+                delta[c] = pixels[p][c] - mean[c];
+            }
+            for (int i = 0; i < 4; ++i)
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    covariance[i][j] += delta[i] * delta[j];
+                }
+            }
+        }
+        // Start from the row of the channel with the largest variance, which
+        // is never orthogonal to the principal axis.
+        int dominant = 0;
+        for (int i = 1; i < 4; ++i)
+        {
+            dominant = covariance[i][i] > covariance[dominant][dominant] ? i : dominant;
+        }
+        float axis[4];
+        std::memcpy(axis, covariance[dominant], sizeof(axis));
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    next[i] += covariance[i][j] * axis[j];
+                }
+                length = std::max(length, std::fabs(next[i]));
+            }
+            if (length < 1e-6f)
+            {
+                break;
+            }
+            for (int i = 0; i < 4; ++i)
+            {
+                axis[i] = next[i] / length;
+            }
+        }
+        float axisLengthSquared = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3];
+        if (axisLengthSquared < 1e-12f)
+        {
+            // Solid block: both endpoints land on the mean.
+            axis[0] = axis[1] = axis[2] = axis[3] = 1.0f;
+            axisLengthSquared = 4.0f;
+        }
+
+        float minProjection = 0.0f;
+        float maxProjection = 0.0f;
+        for (int p = 0; p < 16; ++p)
+        {
+            float projection = 0.0f;
+            for (int c = 0; c < 4; ++c)
+            {
+                projection += (pixels[p][c] - mean[c]) * axis[c];
+            }
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        float endpoints[2][4];
+        for (int c = 0; c < 4; ++c)
+        {
+            const float scale = axis[c] / axisLengthSquared;
+            endpoints[0][c] = std::min(255.0f, std::max(0.0f, mean[c] + minProjection * scale));
+            endpoints[1][c] = std::min(255.0f, std::max(0.0f, mean[c] + maxProjection * scale));
+        }
+
+        EncodedBlock best;
+        evaluate(pixels, endpoints, best);
+        for (int iteration = 0; iteration < 2 && best.error > 0; ++iteration)
+        {
+            const uint32_t previousError = best.error;
+            if (!fitEndpoints(pixels, best.indices, endpoints))
+            {
+                break;
+            }
+            evaluate(pixels, endpoints, best);
+            if (best.error >= previousError)
+            {
+                break;
+            }
+        }
+
+        // The first index is stored with an implicit zero top bit.
+        if (best.indices[0] & 8)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                std::swap(best.quantized[0][c], best.quantized[1][c]);
+            }
+            std::swap(best.pBits[0], best.pBits[1]);
+            for (uint8_t& index : best.indices)
+            {
+                index = static_cast<uint8_t>(15 - index);
+            }
+        }
+
+        std::memset(pOut, 0, kBc7BlockSize);
+        uint32_t position = 0;
+        putBits(pOut, position, 1u << 6, 7); // Mode 6
+        for (int c = 0; c < 4; ++c)
+        {
+            putBits(pOut, position, static_cast<uint32_t>(best.quantized[0][c]), 7);
+            putBits(pOut, position, static_cast<uint32_t>(best.quantized[1][c]), 7);
+        }
+        putBits(pOut, position, static_cast<uint32_t>(best.pBits[0]), 1);
+        putBits(pOut, position, static_cast<uint32_t>(best.pBits[1]), 1);
+        for (int p = 0; p < 16; ++p)
+        {
+            putBits(pOut, position, best.indices[p], p == 0 ? 3 : 4);
+        }
+    }
+
+    size_t getBc7Size(uint32_t width, uint32_t height)
+    {
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * kBc7BlockSize;
+    }
+
+    void encodeBc7(const uint8_t* pTexels, uint32_t width, uint32_t height, uint8_t* pOut, unsigned int threadCount)
+    {
+        const uint32_t blocksWide = (width + 3) / 4;
+        const uint32_t blocksHigh = (height + 3) / 4;
+        parallelFor(blocksHigh, threadCount, [&](size_t blockY)
+        {
+            uint8_t block[64];
+            for (uint32_t blockX = 0; blockX < blocksWide; ++blockX)
+            {
+                for (uint32_t y = 0; y < 4; ++y)
+                {
+                    const uint32_t sourceY = std::min<uint32_t>(static_cast<uint32_t>(blockY) * 4 + y, height - 1);
+                    for (uint32_t x = 0; x < 4; ++x)
+                    {
+                        const uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+                        std::memcpy(block + (y * 4 + x) * 4, pTexels + (static_cast<size_t>(sourceY) * width + sourceX) * 4, 4);
+                    }
+                }
+                encodeBc7Block(block, pOut + (blockY * blocksWide + blockX) * kBc7BlockSize);
+            }
+        });
+    }
+} // namespace Pinnacle
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinnacle
+{
+    const size_t kBc7BlockSize = 16;
+
+    // Encodes one 4x4 block of RGBA8 texels (row-major, 64 bytes) as BC7
+    // mode 6: one RGBA endpoint pair with 7-bit endpoints, a p-bit each and
+    // 4-bit indices. Endpoints come from the block's principal axis and are
+    // then refined by least squares; every p-bit combination is tried.
+    void encodeBc7Block(const uint8_t* pTexels, uint8_t* pOut);
+
+    // Number of bytes encodeBc7() writes for a width x height image.
+    size_t getBc7Size(uint32_t width, uint32_t height);
+
+    // Encodes a tightly packed RGBA8 image. Partial edge blocks are padded by
+    // repeating the last row/column. Block rows are encoded in parallel on
+    // `threadCount` threads (0 = hardware concurrency).
+    void encodeBc7(const uint8_t* pTexels, uint32_t width, uint32_t height, uint8_t* pOut, unsigned int threadCount = 0);
+} // namespace Pinnacle
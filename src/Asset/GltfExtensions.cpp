@@ -0,0 +1,127 @@
+#include "GltfExtensions.hpp"
+
+#include "GltfParser.hpp"
+#include "ModelData.hpp"
+#include "../Core/Hash.hpp"
+
+#include <cstddef>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        GltfExtensionField makeField(const char* pKey, GltfExtensionFieldType type, size_t offset)
+        {
+            GltfExtensionField field;
+            field.key = pKey;
+            field.type = type;
+            field.offset = static_cast<uint32_t>(offset);
+            return field;
+        }
+    } // namespace
+
+    const GltfExtensionField* GltfExtensionHandler::findField(std::string_view key) const
+    {
+        for (const GltfExtensionField& field : fields)
+        {
+            if (field.key == key)
+            {
+                return &field;
+            }
+        }
+        return nullptr;
+    }
+
+    GltfExtensionRegistry::GltfExtensionRegistry()
+    {
+        using Type = GltfExtensionFieldType;
+
+        GltfExtensionHandler emissiveStrength;
+        emissiveStrength.name = "KHR_materials_emissive_strength";
+        emissiveStrength.fields.push_back(makeField("emissiveStrength", Type::Float, offsetof(GltfMaterial, emissiveStrength)));
+        registerHandler(emissiveStrength);
+
+        // Only the factors: clearcoat textures are not sampled
+        GltfExtensionHandler clearcoat;
+        clearcoat.name = "KHR_materials_clearcoat";
+        clearcoat.flags = kMaterialClearcoat;
+        clearcoat.fields.push_back(makeField("clearcoatFactor", Type::Float, offsetof(GltfMaterial, clearcoatFactor)));
+        clearcoat.fields.push_back(
+            makeField("clearcoatRoughnessFactor", Type::Float, offsetof(GltfMaterial, clearcoatRoughnessFactor)));
+        registerHandler(clearcoat);
+
+        GltfExtensionHandler unlit;
+        unlit.name = "KHR_materials_unlit";
+        unlit.flags = kMaterialUnlit;
+        registerHandler(unlit);
+
+        // texCoord overrides are ignored: vertices carry one UV set
+        GltfExtensionHandler textureTransform;
+        textureTransform.name = "KHR_texture_transform";
+        textureTransform.target = GltfExtensionTarget::TextureInfo;
+        textureTransform.fields.push_back(makeField("offset", Type::Float2, offsetof(GltfTextureTransform, offset)));
+        textureTransform.fields.push_back(makeField("rotation", Type::Float, offsetof(GltfTextureTransform, rotation)));
+        textureTransform.fields.push_back(makeField("scale", Type::Float2, offsetof(GltfTextureTransform, scale)));
+        registerHandler(textureTransform);
+    }
+
+    GltfExtensionRegistry& GltfExtensionRegistry::getShared()
+    {
+        static GltfExtensionRegistry shared;
+        return shared;
+    }
+
+    void GltfExtensionRegistry::registerHandler(const GltfExtensionHandler& handler)
+    {
+        GltfExtensionHandler checked = handler;
+        const size_t blockSize = handler.target == GltfExtensionTarget::Material ? sizeof(GltfMaterial) : sizeof(GltfTextureTransform);
+        checked.fields.clear();
+        for (const GltfExtensionField& field : handler.fields)
+        {
+            if (field.offset % sizeof(float) == 0 && field.offset + getComponentCount(field.type) * sizeof(float) <= blockSize)
+            {
+                checked.fields.push_back(field);
+            }
+        }
+
+        for (GltfExtensionHandler& existing : m_handlers)
+        {
+            if (existing.name == checked.name && existing.target == checked.target)
+            {
+                existing = checked;
+                return;
+            }
+        }
+        m_handlers.push_back(checked);
+    }
+
+    const GltfExtensionHandler* GltfExtensionRegistry::findHandler(std::string_view name, GltfExtensionTarget target) const
+    {
+        for (const GltfExtensionHandler& handler : m_handlers)
+        {
+            if (handler.target == target && handler.name == name)
+            {
+                return &handler;
+            }
+        }
+        return nullptr;
+    }
+
+    uint64_t GltfExtensionRegistry::getHash() const
+    {
+        uint64_t hash = hashValue(m_handlers.size());
+        for (const GltfExtensionHandler& handler : m_handlers)
+        {
+            hash = hashCombine(hash, hashBytes(handler.name.data(), handler.name.size()));
+            hash = hashCombine(hash, hashValue(handler.target));
+            hash = hashCombine(hash, hashValue(handler.flags));
+            for (const GltfExtensionField& field : handler.fields)
+            {
+                hash = hashCombine(hash, hashBytes(field.key.data(), field.key.size()));
+                hash = hashCombine(hash, hashValue(field.type));
+                hash = hashCombine(hash, hashValue(field.offset));
+            }
+        }
+        return hash;
+    }
+} // namespace Pinnacle
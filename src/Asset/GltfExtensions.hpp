@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Pinnacle
+{
+    // glTF object an extension object hangs off.
+    enum class GltfExtensionTarget : uint8_t
+    {
+        Material,   // Fields are offsets into GltfMaterial
+        TextureInfo // Fields are offsets into GltfTextureTransform
+    };
+
+    enum class GltfExtensionFieldType : uint8_t
+    {
+        Float,
+        Float2,
+        Float3
+    };
+
+    inline uint32_t getComponentCount(GltfExtensionFieldType type) { return static_cast<uint32_t>(type) + 1; }
+
+    struct GltfExtensionField
+    {
+        std::string key;
+        GltfExtensionFieldType type = GltfExtensionFieldType::Float;
+        uint32_t offset = 0; // Byte offset of the value in the target's block
+    };
+
+    // One extension, described by the members it reads rather than by code,
+    // so both the streaming parser and the tinygltf path apply it the same
+    // way. Listed members are stored at their offsets and every other member
+    // is skipped; `flags` (MaterialFlag bits) are OR-ed into
+    // GltfMaterial::flags when the extension is present on a material.
+    struct GltfExtensionHandler
+    {
+        std::string name;
+        GltfExtensionTarget target = GltfExtensionTarget::Material;
+        uint32_t flags = 0;
+        std::vector<GltfExtensionField> fields;
+
+        const GltfExtensionField* findField(std::string_view key) const;
+    };
+
+    // Where `field` lives in `pBlock`, the handler's GltfMaterial or
+    // GltfTextureTransform.
+    inline float* getFieldValues(const GltfExtensionField& field, void* pBlock)
+    {
+        return reinterpret_cast<float*>(static_cast<uint8_t*>(pBlock) + field.offset);
+    }
+
+    // Handlers for the extensions parsed into materials. Extensions are
+    // resolved once at import into GltfMaterial's flags and parameters;
+    // nothing downstream sees their names. A handler can only fill fields
+    // GltfMaterial already has, so an extension with new parameters needs a
+    // field there (and in MaterialData) as well.
+    class GltfExtensionRegistry
+    {
+    public:
+        // Starts with KHR_materials_emissive_strength, KHR_materials_clearcoat,
+        // KHR_materials_unlit and KHR_texture_transform.
+        GltfExtensionRegistry();
+
+        static GltfExtensionRegistry& getShared();
+
+        // Adds `handler`, replacing one with the same name and target. Fields
+        // that are misaligned or overrun the target are dropped. Register
+        // before importing: lookups are not synchronized with it.
+        void registerHandler(const GltfExtensionHandler& handler);
+        const GltfExtensionHandler* findHandler(std::string_view name, GltfExtensionTarget target) const;
+
+        // Fingerprint of every handler; part of GltfImporter::getSettingsHash().
+        uint64_t getHash() const;
+
+    private:
+        std::vector<GltfExtensionHandler> m_handlers;
+    };
+} // namespace Pinnacle
@@ -0,0 +1,1966 @@
+#include "GltfImporter.hpp"
+
+#include "GltfExtensions.hpp"
+#include "GltfParser.hpp"
+#include "ImportCache.hpp"
+#include "MeshoptDecoder.hpp"
+#include "ResourceCache.hpp"
+#include "../Core/Hash.hpp"
+#include "../Core/Memory.hpp"
+#include "../Core/Parallel.hpp"
+
+#include "stb_image.h"
+#include "tiny_gltf.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        bool hasExtension(const std::string& path, const char* extension)
+        {
+            const size_t length = std::strlen(extension);
+            if (path.size() < length)
+            {
+                return false;
+            }
+            for (size_t i = 0; i < length; ++i)
+            {
+                const char c = path[path.size() - length + i];
+                if (std::tolower(static_cast<unsigned char>(c)) != extension[i])
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        int getComponentSize(GltfComponentType componentType)
+        {
+            switch (componentType)
+            {
+                case GltfComponentType::Byte:
+                case GltfComponentType::UnsignedByte:
+                    return 1;
+                case GltfComponentType::Short:
+                case GltfComponentType::UnsignedShort:
+                    return 2;
+                case GltfComponentType::UnsignedInt:
+                case GltfComponentType::Float:
+                    return 4;
+                default:
+                    return 0;
+            }
+        }
+
+        // Distance between elements of an accessor; 0 if it is malformed.
+        uint32_t getByteStride(const GltfAccessor& accessor, const GltfBufferView& view)
+        {
+            const int componentSize = getComponentSize(accessor.componentType);
+            if (componentSize == 0 || accessor.componentCount == 0)
+            {
+                return 0;
+            }
+            return view.byteStride != 0 ? view.byteStride : static_cast<uint32_t>(componentSize * accessor.componentCount);
+        }
+
+        float readComponent(const unsigned char* pData, GltfComponentType componentType, bool normalized)
+        {
+            switch (componentType)
+            {
+                case GltfComponentType::Float:
+                {
+                    float value;
+                    std::memcpy(&value, pData, sizeof(value));
+                    return value;
+                }
+                case GltfComponentType::UnsignedByte:
+                    return normalized ? pData[0] / 255.0f : pData[0];
+                case GltfComponentType::Byte:
+                {
+                    const float value = static_cast<int8_t>(pData[0]);
+                    return normalized ? std::fmax(value / 127.0f, -1.0f) : value;
+                }
+                case GltfComponentType::UnsignedShort:
+                {
+                    uint16_t value;
+                    std::memcpy(&value, pData, sizeof(value));
+                    return normalized ? value / 65535.0f : value;
+                }
+                case GltfComponentType::Short:
+                {
+                    int16_t value;
+                    std::memcpy(&value, pData, sizeof(value));
+                    return normalized ? std::fmax(value / 32767.0f, -1.0f) : value;
+                }
+                case GltfComponentType::UnsignedInt:
+                {
+                    uint32_t value;
+                    std::memcpy(&value, pData, sizeof(value));
+                    return static_cast<float>(value);
+                }
+                default:
+                    return 0.0f;
+            }
+        }
+
+        // Whether [offset, offset + size) lies within [0, limit), without
+        // overflowing on sizes read from the JSON.
+        bool isRangeWithin(uint64_t offset, uint64_t size, uint64_t limit)
+        {
+            return size <= limit && offset <= limit - size;
+        }
+
+        // Resolves the bytes behind an accessor: the first element and the
+        // stride. False if any element would fall outside its buffer view.
+        bool locateAccessor(const GltfDocument& document, int32_t accessorIndex, const uint8_t*& pData, uint32_t& stride)
+        {
+            if (accessorIndex < 0 || accessorIndex >= static_cast<int32_t>(document.accessors.size()))
+            {
+                return false;
+            }
+            const GltfAccessor& accessor = document.accessors[accessorIndex];
+            if (accessor.bufferView < 0 || accessor.bufferView >= static_cast<int32_t>(document.bufferViews.size()))
+            {
+                return false;
+            }
+            const GltfBufferView& view = document.bufferViews[accessor.bufferView];
+            if (view.buffer < 0 || view.buffer >= static_cast<int32_t>(document.buffers.size()))
+            {
+                return false;
+            }
+            const GltfBuffer& buffer = document.buffers[view.buffer];
+
+            stride = getByteStride(accessor, view);
+            if (stride == 0)
+            {
+                return false;
+            }
+            if (!isRangeWithin(view.byteOffset, view.byteLength, buffer.size))
+            {
+                return false;
+            }
+            const uint64_t elementSize = static_cast<uint64_t>(getComponentSize(accessor.componentType)) * accessor.componentCount;
+            if (accessor.count > 0 &&
+                (accessor.count - 1 > (UINT64_MAX - elementSize) / stride ||
+                 !isRangeWithin(accessor.byteOffset, (accessor.count - 1) * stride + elementSize, view.byteLength)))
+            {
+                return false;
+            }
+            pData = buffer.pData + view.byteOffset + accessor.byteOffset;
+            return true;
+        }
+
+        // `size` bytes of a buffer view from `byteOffset`; null if they fall outside it.
+        const uint8_t* locateViewBytes(const GltfDocument& document, int32_t viewIndex, uint64_t byteOffset, uint64_t size)
+        {
+            if (viewIndex < 0 || viewIndex >= static_cast<int32_t>(document.bufferViews.size()))
+            {
+                return nullptr;
+            }
+            const GltfBufferView& view = document.bufferViews[viewIndex];
+            if (view.buffer < 0 || view.buffer >= static_cast<int32_t>(document.buffers.size()) ||
+                !isRangeWithin(byteOffset, size, view.byteLength) ||
+                !isRangeWithin(view.byteOffset, view.byteLength, document.buffers[view.buffer].size))
+            {
+                return nullptr;
+            }
+            return document.buffers[view.buffer].pData + view.byteOffset + byteOffset;
+        }
+
+        // Overwrites the elements a sparse accessor lists with its values.
+        bool applySparse(const GltfDocument& document, const GltfAccessor& accessor, int componentCount, ArenaVector<float>& out)
+        {
+            const GltfSparseAccessor& sparse = accessor.sparse;
+            if (sparse.count > accessor.count)
+            {
+                return false;
+            }
+            const int indexSize = getComponentSize(sparse.indicesComponentType);
+            const int componentSize = getComponentSize(accessor.componentType);
+            const uint64_t elementSize = static_cast<uint64_t>(componentSize) * accessor.componentCount;
+            const uint8_t* pIndices = locateViewBytes(document, sparse.indicesBufferView, sparse.indicesByteOffset, sparse.count * indexSize);
+            const uint8_t* pValues = locateViewBytes(document, sparse.valuesBufferView, sparse.valuesByteOffset, sparse.count * elementSize);
+            const bool unsignedIndices = sparse.indicesComponentType == GltfComponentType::UnsignedByte ||
+                                         sparse.indicesComponentType == GltfComponentType::UnsignedShort ||
+                                         sparse.indicesComponentType == GltfComponentType::UnsignedInt;
+            if (!pIndices || !pValues || !unsignedIndices)
+            {
+                return false;
+            }
+
+            const int copied = accessor.componentCount < componentCount ? accessor.componentCount : componentCount;
+            for (uint64_t i = 0; i < sparse.count; ++i)
+            {
+                uint32_t index = 0;
+                std::memcpy(&index, pIndices + i * indexSize, indexSize); // Little endian, like glTF
+                if (index >= accessor.count)
+                {
+                    return false;
+                }
+                const uint8_t* pElement = pValues + i * elementSize;
+                for (int c = 0; c < copied; ++c)
+                {
+                    out[index * componentCount + c] = readComponent(pElement + c * componentSize, accessor.componentType, accessor.normalized);
+                }
+            }
+            return true;
+        }
+
+        // Reads up to `componentCount` components of every element of an
+        // accessor into a tightly packed float array, honouring byteStride
+        // and sparse substitution. A sparse accessor without a buffer view
+        // starts from zeros.
+        bool readAccessor(const GltfDocument& document, int32_t accessorIndex, int componentCount, ArenaVector<float>& out)
+        {
+            if (accessorIndex < 0 || accessorIndex >= static_cast<int32_t>(document.accessors.size()))
+            {
+                return false;
+            }
+            const GltfAccessor& accessor = document.accessors[accessorIndex];
+            const uint8_t* pData = nullptr;
+            uint32_t stride = 0;
+            if ((accessor.bufferView >= 0 || accessor.sparse.count == 0) && !locateAccessor(document, accessorIndex, pData, stride))
+            {
+                return false;
+            }
+            const int componentSize = getComponentSize(accessor.componentType);
+
+            const int copied = accessor.componentCount < componentCount ? accessor.componentCount : componentCount;
+            out.assign(accessor.count * componentCount, 0.0f);
+            for (size_t i = 0; pData && i < accessor.count; ++i)
+            {
+                const unsigned char* pElement = pData + i * stride;
+                for (int c = 0; c < copied; ++c)
+                {
+                    out[i * componentCount + c] = readComponent(pElement + c * componentSize, accessor.componentType, accessor.normalized);
+                }
+            }
+            return accessor.sparse.count == 0 || applySparse(document, accessor, componentCount, out);
+        }
+
+        bool readIndices(const GltfDocument& document, int32_t accessorIndex, std::vector<uint32_t>& out)
+        {
+            const uint8_t* pData;
+            uint32_t stride;
+            if (!locateAccessor(document, accessorIndex, pData, stride))
+            {
+                return false;
+            }
+            const GltfAccessor& accessor = document.accessors[accessorIndex];
+
+            out.resize(accessor.count);
+            for (size_t i = 0; i < accessor.count; ++i)
+            {
+                const unsigned char* pElement = pData + i * stride;
+                switch (accessor.componentType)
+                {
+                    case GltfComponentType::UnsignedByte:
+                        out[i] = pElement[0];
+                        break;
+                    case GltfComponentType::UnsignedShort:
+                    {
+                        uint16_t value;
+                        std::memcpy(&value, pElement, sizeof(value));
+                        out[i] = value;
+                        break;
+                    }
+                    case GltfComponentType::UnsignedInt:
+                        std::memcpy(&out[i], pElement, sizeof(uint32_t));
+                        break;
+                    default:
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        // One primitive converted to ModelData layout, together with its
+        // derived LODs and meshlets. Indices and meshlet offsets are relative
+        // to the primitive, so a chunk can be cached and reused in any model.
+        struct PrimitiveChunk
+        {
+            uint64_t key = 0;
+            bool cached = false;
+            std::vector<ModelVertex> vertices;
+            std::vector<uint32_t> colors; // RGBA8 per vertex; empty without COLOR_0
+            std::vector<SkinVertex> skin; // Per vertex; empty without JOINTS_0 and WEIGHTS_0
+            std::vector<uint32_t> indices;
+            std::vector<LodLevel> lods;
+            std::vector<MeshletData> meshlets;
+            std::vector<MorphTargetData> morphTargets; // Delta ranges relative to this chunk
+            std::vector<ModelVertex> morphDeltas;
+            std::vector<uint32_t> morphDeltaVertices;
+        };
+
+        bool isZeroDelta(const ModelVertex& delta)
+        {
+            const float* pValues = delta.position;
+            for (size_t c = 0; c < sizeof(ModelVertex) / sizeof(float); ++c)
+            {
+                if (pValues[c] != 0.0f)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool convertPrimitive(const GltfDocument& document, const GltfPrimitive& gltfPrimitive, PrimitiveChunk& chunk,
+                              std::string& problem)
+        {
+            // Attribute streams only live until they are interleaved below.
+            ScratchScope scratch;
+            ArenaVector<float> positions(&scratch.getArena());
+            ArenaVector<float> normals(&scratch.getArena());
+            ArenaVector<float> texCoords(&scratch.getArena());
+
+            if (!readAccessor(document, gltfPrimitive.position, 3, positions))
+            {
+                problem = "no readable POSITION";
+                return false;
+            }
+            const size_t vertexCount = positions.size() / 3;
+
+            if (!readAccessor(document, gltfPrimitive.normal, 3, normals) || normals.size() != vertexCount * 3)
+            {
+                normals.assign(vertexCount * 3, 0.0f);
+            }
+
+            if (!readAccessor(document, gltfPrimitive.texCoord0, 2, texCoords) || texCoords.size() != vertexCount * 2)
+            {
+                texCoords.assign(vertexCount * 2, 0.0f);
+            }
+
+            // COLOR_0 is RGB or RGBA; packed to RGBA8 with alpha 1 for RGB.
+            ArenaVector<float> colors(&scratch.getArena());
+            if (readAccessor(document, gltfPrimitive.color0, 4, colors) && colors.size() == vertexCount * 4)
+            {
+                const bool hasAlpha = document.accessors[gltfPrimitive.color0].componentCount == 4;
+                chunk.colors.resize(vertexCount);
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    uint32_t packed = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        const float value = c == 3 && !hasAlpha ? 1.0f : std::min(std::max(colors[i * 4 + c], 0.0f), 1.0f);
+                        packed |= static_cast<uint32_t>(value * 255.0f + 0.5f) << (c * 8);
+                    }
+                    chunk.colors[i] = packed;
+                }
+            }
+
+            // Weights are renormalized (exporters leave rounding error) and
+            // quantized to sum to exactly 65535, the remainder going to the
+            // largest. Vertices with no weight at all follow joint 0.
+            ArenaVector<float> joints(&scratch.getArena());
+            ArenaVector<float> weights(&scratch.getArena());
+            if (readAccessor(document, gltfPrimitive.joints0, 4, joints) && joints.size() == vertexCount * 4 &&
+                readAccessor(document, gltfPrimitive.weights0, 4, weights) && weights.size() == vertexCount * 4)
+            {
+                chunk.skin.resize(vertexCount);
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    SkinVertex& skin = chunk.skin[i];
+                    float sum = 0.0f;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        sum += std::max(weights[i * 4 + c], 0.0f);
+                    }
+                    uint32_t total = 0;
+                    int largest = 0;
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        const float weight = sum > 0.0f ? std::max(weights[i * 4 + c], 0.0f) / sum : (c == 0 ? 1.0f : 0.0f);
+                        skin.joints[c] = static_cast<uint16_t>(std::min(std::max(joints[i * 4 + c], 0.0f), 65535.0f));
+                        skin.weights[c] = static_cast<uint16_t>(weight * 65535.0f + 0.5f);
+                        total += skin.weights[c];
+                        largest = skin.weights[c] > skin.weights[largest] ? c : largest;
+                    }
+                    skin.weights[largest] = static_cast<uint16_t>(skin.weights[largest] + 65535 - static_cast<int32_t>(total));
+                }
+            }
+
+            if (gltfPrimitive.indices >= 0)
+            {
+                if (!readIndices(document, gltfPrimitive.indices, chunk.indices))
+                {
+                    problem = "unreadable indices";
+                    return false;
+                }
+            }
+            else
+            {
+                chunk.indices.resize(vertexCount);
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    chunk.indices[i] = static_cast<uint32_t>(i);
+                }
+            }
+            chunk.indices.resize(chunk.indices.size() - chunk.indices.size() % 3);
+            for (uint32_t& index : chunk.indices)
+            {
+                index = index < vertexCount ? index : 0;
+            }
+
+            chunk.vertices.resize(vertexCount);
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                ModelVertex& vertex = chunk.vertices[i];
+                std::memcpy(vertex.position, &positions[i * 3], sizeof(vertex.position));
+                std::memcpy(vertex.normal, &normals[i * 3], sizeof(vertex.normal));
+                std::memcpy(vertex.texCoords, &texCoords[i * 2], sizeof(vertex.texCoords));
+            }
+
+            // Morph targets keep only the vertices they move. Unreadable
+            // attributes move nothing, and every target is kept so the node
+            // weights still line up.
+            for (uint32_t t = 0; t < gltfPrimitive.targetCount; ++t)
+            {
+                const GltfMorphTarget& target = document.morphTargets[gltfPrimitive.firstTarget + t];
+                const bool hasPositions = readAccessor(document, target.position, 3, positions) && positions.size() == vertexCount * 3;
+                const bool hasNormals = readAccessor(document, target.normal, 3, normals) && normals.size() == vertexCount * 3;
+                const bool hasTexCoords =
+                    readAccessor(document, target.texCoord0, 2, texCoords) && texCoords.size() == vertexCount * 2;
+
+                MorphTargetData morph;
+                morph.firstDelta = static_cast<uint32_t>(chunk.morphDeltas.size());
+                const float zero[3] = { 0.0f, 0.0f, 0.0f };
+                morph.deltaBounds.expand(zero);
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    ModelVertex delta = {};
+                    if (hasPositions)
+                    {
+                        std::memcpy(delta.position, &positions[i * 3], sizeof(delta.position));
+                    }
+                    if (hasNormals)
+                    {
+                        std::memcpy(delta.normal, &normals[i * 3], sizeof(delta.normal));
+                    }
+                    if (hasTexCoords)
+                    {
+                        std::memcpy(delta.texCoords, &texCoords[i * 2], sizeof(delta.texCoords));
+                    }
+                    if (isZeroDelta(delta))
+                    {
+                        continue;
+                    }
+                    morph.deltaBounds.expand(delta.position);
+                    chunk.morphDeltas.push_back(delta);
+                    chunk.morphDeltaVertices.push_back(static_cast<uint32_t>(i));
+                }
+                morph.deltaCount = static_cast<uint32_t>(chunk.morphDeltas.size()) - morph.firstDelta;
+                chunk.morphTargets.push_back(morph);
+            }
+            return true;
+        }
+
+        // Smaller primitives are culled whole rather than per meshlet.
+        const uint32_t kMinMeshletPrimitiveTriangles = 4 * kMaxMeshletTriangles;
+
+        void processChunk(PrimitiveChunk& chunk, bool generateLods, const LodOptions& lodOptions, bool generateMeshlets)
+        {
+            // LODs come from the original triangle order; buildMeshlets() reorders it.
+            if (generateLods)
+            {
+                Bounds bounds;
+                for (const ModelVertex& vertex : chunk.vertices)
+                {
+                    bounds.expand(vertex.position);
+                }
+                generateLodChain(chunk.vertices.data(), chunk.vertices.size(), chunk.indices.data(), chunk.indices.size(),
+                                 bounds, lodOptions, chunk.lods);
+            }
+            // Meshlet bounds would not hold once morph targets move the vertices.
+            if (generateMeshlets && chunk.morphTargets.empty() && chunk.indices.size() / 3 >= kMinMeshletPrimitiveTriangles)
+            {
+                buildMeshlets(chunk.vertices.data(), chunk.vertices.size(), chunk.indices.data(), chunk.indices.size(),
+                              0, chunk.meshlets);
+            }
+        }
+
+        void writeChunk(const PrimitiveChunk& chunk, ChunkWriter& writer)
+        {
+            writer.writeArray(chunk.vertices);
+            writer.writeArray(chunk.colors);
+            writer.writeArray(chunk.skin);
+            writer.writeArray(chunk.indices);
+            writer.write(static_cast<uint32_t>(chunk.lods.size()));
+            for (const LodLevel& level : chunk.lods)
+            {
+                writer.write(level.error);
+                writer.writeArray(level.indices);
+            }
+            writer.writeArray(chunk.meshlets);
+            writer.writeArray(chunk.morphTargets);
+            writer.writeArray(chunk.morphDeltas);
+            writer.writeArray(chunk.morphDeltaVertices);
+        }
+
+        bool readChunk(const std::vector<uint8_t>& payload, PrimitiveChunk& chunk)
+        {
+            ChunkReader reader(payload);
+            uint32_t lodCount = 0;
+            if (!reader.readArray(chunk.vertices) || !reader.readArray(chunk.colors) || !reader.readArray(chunk.skin) ||
+                !reader.readArray(chunk.indices) || !reader.read(lodCount) ||
+                (!chunk.colors.empty() && chunk.colors.size() != chunk.vertices.size()) ||
+                (!chunk.skin.empty() && chunk.skin.size() != chunk.vertices.size()))
+            {
+                return false;
+            }
+            const size_t vertexCount = chunk.vertices.size();
+            auto validIndices = [vertexCount](const std::vector<uint32_t>& indices)
+            {
+                return std::all_of(indices.begin(), indices.end(), [vertexCount](uint32_t index) { return index < vertexCount; });
+            };
+            if (!validIndices(chunk.indices))
+            {
+                return false;
+            }
+
+            chunk.lods.resize(lodCount);
+            for (LodLevel& level : chunk.lods)
+            {
+                if (!reader.read(level.error) || !reader.readArray(level.indices) || !validIndices(level.indices))
+                {
+                    return false;
+                }
+            }
+            if (!reader.readArray(chunk.meshlets) || !reader.readArray(chunk.morphTargets) ||
+                !reader.readArray(chunk.morphDeltas) || !reader.readArray(chunk.morphDeltaVertices) || !reader.atEnd() ||
+                chunk.morphDeltas.size() != chunk.morphDeltaVertices.size() || !validIndices(chunk.morphDeltaVertices))
+            {
+                return false;
+            }
+            for (const MorphTargetData& morph : chunk.morphTargets)
+            {
+                if (static_cast<uint64_t>(morph.firstDelta) + morph.deltaCount > chunk.morphDeltas.size())
+                {
+                    return false;
+                }
+                for (uint32_t d = 1; d < morph.deltaCount; ++d)
+                {
+                    if (chunk.morphDeltaVertices[morph.firstDelta + d] <= chunk.morphDeltaVertices[morph.firstDelta + d - 1])
+                    {
+                        return false;
+                    }
+                }
+            }
+            for (const MeshletData& meshlet : chunk.meshlets)
+            {
+                if (static_cast<uint64_t>(meshlet.indexOffset) + meshlet.triangleCount * 3ull > chunk.indices.size())
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void appendChunk(const PrimitiveChunk& chunk, PrimitiveData& primitive, ModelData& outModel)
+        {
+            primitive.vertexOffset = static_cast<uint32_t>(outModel.vertices.size());
+            primitive.vertexCount = static_cast<uint32_t>(chunk.vertices.size());
+            primitive.indexOffset = static_cast<uint32_t>(outModel.indices.size());
+            primitive.indexCount = static_cast<uint32_t>(chunk.indices.size());
+            for (const ModelVertex& vertex : chunk.vertices)
+            {
+                primitive.bounds.expand(vertex.position);
+            }
+            outModel.vertices.insert(outModel.vertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+            primitive.hasVertexColors = !chunk.colors.empty();
+            primitive.firstColor = static_cast<uint32_t>(outModel.vertexColors.size());
+            outModel.vertexColors.insert(outModel.vertexColors.end(), chunk.colors.begin(), chunk.colors.end());
+            primitive.hasSkinWeights = !chunk.skin.empty();
+            primitive.firstSkinVertex = static_cast<uint32_t>(outModel.skinVertices.size());
+            outModel.skinVertices.insert(outModel.skinVertices.end(), chunk.skin.begin(), chunk.skin.end());
+            outModel.indices.insert(outModel.indices.end(), chunk.indices.begin(), chunk.indices.end());
+
+            primitive.firstLod = static_cast<uint32_t>(outModel.lods.size());
+            primitive.lodCount = static_cast<uint32_t>(chunk.lods.size());
+            for (const LodLevel& level : chunk.lods)
+            {
+                LodData lod;
+                lod.indexOffset = static_cast<uint32_t>(outModel.indices.size());
+                lod.indexCount = static_cast<uint32_t>(level.indices.size());
+                lod.error = level.error;
+                outModel.indices.insert(outModel.indices.end(), level.indices.begin(), level.indices.end());
+                outModel.lods.push_back(lod);
+            }
+
+            primitive.firstMeshlet = static_cast<uint32_t>(outModel.meshlets.size());
+            primitive.meshletCount = static_cast<uint32_t>(chunk.meshlets.size());
+            for (MeshletData meshlet : chunk.meshlets)
+            {
+                meshlet.indexOffset += primitive.indexOffset;
+                outModel.meshlets.push_back(meshlet);
+            }
+
+            primitive.firstMorphTarget = static_cast<uint32_t>(outModel.morphTargets.size());
+            primitive.morphTargetCount = static_cast<uint32_t>(chunk.morphTargets.size());
+            const uint32_t firstDelta = static_cast<uint32_t>(outModel.morphDeltas.size());
+            for (MorphTargetData morph : chunk.morphTargets)
+            {
+                morph.firstDelta += firstDelta;
+                outModel.morphTargets.push_back(morph);
+            }
+            outModel.morphDeltas.insert(outModel.morphDeltas.end(), chunk.morphDeltas.begin(), chunk.morphDeltas.end());
+            outModel.morphDeltaVertices.insert(outModel.morphDeltaVertices.end(), chunk.morphDeltaVertices.begin(),
+                                               chunk.morphDeltaVertices.end());
+        }
+
+        // Content keys for primitives. Each buffer view is hashed at most once
+        // per import, so a key only changes when the bytes a primitive reads
+        // (or the way it reads them) change, not when unrelated data moves.
+        class ContentHasher
+        {
+        public:
+            ContentHasher(const GltfDocument& document, ImportCache* pCache)
+                : m_document(document), m_pCache(pCache), m_viewHashes(document.bufferViews.size()),
+                  m_viewHashed(document.bufferViews.size(), false)
+            {
+            }
+
+            uint64_t hashPrimitive(const GltfPrimitive& primitive, uint64_t settingsHash)
+            {
+                uint64_t hash = settingsHash;
+                for (int32_t attribute : { primitive.position, primitive.normal, primitive.texCoord0, primitive.color0,
+                                           primitive.joints0, primitive.weights0 })
+                {
+                    hash = hashCombine(hash, attribute >= 0 ? hashAccessor(attribute) : 0);
+                }
+                hash = hashCombine(hash, hashValue(primitive.targetCount));
+                for (uint32_t t = 0; t < primitive.targetCount; ++t)
+                {
+                    const GltfMorphTarget& target = m_document.morphTargets[primitive.firstTarget + t];
+                    for (int32_t attribute : { target.position, target.normal, target.texCoord0 })
+                    {
+                        hash = hashCombine(hash, attribute >= 0 ? hashAccessor(attribute) : 0);
+                    }
+                }
+                return hashCombine(hash, primitive.indices >= 0 ? hashAccessor(primitive.indices) : 0);
+            }
+
+        private:
+            uint64_t hashAccessor(int32_t accessorIndex)
+            {
+                if (accessorIndex < 0 || accessorIndex >= static_cast<int32_t>(m_document.accessors.size()))
+                {
+                    return 1;
+                }
+                const GltfAccessor& accessor = m_document.accessors[accessorIndex];
+                uint64_t hash = hashValue(accessor.byteOffset);
+                hash = hashCombine(hash, hashValue(accessor.count));
+                hash = hashCombine(hash, hashValue(static_cast<int32_t>(accessor.componentType)));
+                hash = hashCombine(hash, hashValue(accessor.componentCount));
+                hash = hashCombine(hash, hashValue(accessor.normalized));
+                if (accessor.bufferView >= 0 && accessor.bufferView < static_cast<int32_t>(m_document.bufferViews.size()))
+                {
+                    hash = hashCombine(hash, hashValue(getByteStride(accessor, m_document.bufferViews[accessor.bufferView])));
+                    hash = hashCombine(hash, hashView(accessor.bufferView));
+                }
+                const GltfSparseAccessor& sparse = accessor.sparse;
+                if (sparse.count > 0)
+                {
+                    hash = hashCombine(hash, hashValue(sparse.count));
+                    hash = hashCombine(hash, hashValue(sparse.indicesByteOffset));
+                    hash = hashCombine(hash, hashValue(static_cast<int32_t>(sparse.indicesComponentType)));
+                    hash = hashCombine(hash, hashValue(sparse.valuesByteOffset));
+                    for (int32_t view : { sparse.indicesBufferView, sparse.valuesBufferView })
+                    {
+                        const bool valid = view >= 0 && view < static_cast<int32_t>(m_document.bufferViews.size());
+                        hash = hashCombine(hash, valid ? hashView(view) : 1);
+                    }
+                }
+                return hash;
+            }
+
+            uint64_t hashView(int32_t viewIndex)
+            {
+                if (!m_viewHashed[viewIndex])
+                {
+                    const GltfBufferView& view = m_document.bufferViews[viewIndex];
+                    uint64_t hash = 0;
+                    if (view.buffer >= 0 && view.buffer < static_cast<int32_t>(m_document.buffers.size()) &&
+                        isRangeWithin(view.byteOffset, view.byteLength, m_document.buffers[view.buffer].size))
+                    {
+                        hash = hashBytes(m_document.buffers[view.buffer].pData + view.byteOffset, view.byteLength);
+                    }
+                    m_viewHashes[viewIndex] = hash;
+                    m_viewHashed[viewIndex] = true;
+                    if (m_pCache)
+                    {
+                        m_pCache->countBufferViewHashed();
+                    }
+                }
+                return m_viewHashes[viewIndex];
+            }
+
+            const GltfDocument& m_document;
+            ImportCache* m_pCache;
+            std::vector<uint64_t> m_viewHashes;
+            std::vector<bool> m_viewHashed;
+        };
+
+        // glTF URIs are percent-encoded relative references.
+        std::string decodeUri(const std::string& uri)
+        {
+            std::string result;
+            result.reserve(uri.size());
+            for (size_t i = 0; i < uri.size(); ++i)
+            {
+                if (uri[i] == '%' && i + 2 < uri.size() && std::isxdigit(static_cast<unsigned char>(uri[i + 1])) &&
+                    std::isxdigit(static_cast<unsigned char>(uri[i + 2])))
+                {
+                    result += static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16));
+                    i += 2;
+                }
+                else
+                {
+                    result += uri[i];
+                }
+            }
+            return result;
+        }
+
+        bool isExternalUri(const std::string& uri)
+        {
+            return !uri.empty() && uri.compare(0, 5, "data:") != 0;
+        }
+
+        // Expands a decoded image to tightly packed RGBA8.
+        bool convertImage(const tinygltf::Image& image, std::vector<uint8_t>& texels)
+        {
+            if (image.width <= 0 || image.height <= 0 || image.component < 1 || image.component > 4 ||
+                (image.bits != 8 && image.bits != 16))
+            {
+                return false;
+            }
+            const size_t pixelCount = static_cast<size_t>(image.width) * image.height;
+            const size_t bytesPerChannel = image.bits / 8;
+            if (image.image.size() < pixelCount * image.component * bytesPerChannel)
+            {
+                return false;
+            }
+
+            const size_t start = texels.size();
+            texels.resize(start + pixelCount * 4);
+            uint8_t* pOut = texels.data() + start;
+            for (size_t i = 0; i < pixelCount; ++i)
+            {
+                uint8_t channels[4] = { 0, 0, 0, 255 };
+                for (int c = 0; c < image.component; ++c)
+                {
+                    // 16-bit channels keep their (little-endian) high byte.
+                    const size_t source = (i * image.component + c) * bytesPerChannel + (bytesPerChannel - 1);
+                    channels[c] = image.image[source];
+                }
+                if (image.component <= 2)
+                {
+                    // Grey or grey + alpha.
+                    channels[3] = image.component == 2 ? channels[1] : 255;
+                    channels[1] = channels[2] = channels[0];
+                }
+                std::memcpy(pOut + i * 4, channels, 4);
+            }
+            return true;
+        }
+
+        // Decodes an encoded image to RGBA8. With a cache, decoded texels are
+        // keyed by the hash of the encoded bytes, so unchanged images skip decoding.
+        bool decodeImage(ImportCache* pCache, const uint8_t* pBytes, size_t size, GltfImage& image)
+        {
+            const uint64_t key = pCache ? hashBytes(pBytes, size) : 0;
+            std::vector<uint8_t> payload;
+            if (pCache && pCache->load(ChunkKind::Image, key, payload))
+            {
+                ChunkReader reader(payload);
+                int32_t width = 0;
+                int32_t height = 0;
+                if (reader.read(width) && reader.read(height) && reader.readArray(image.rgba) && reader.atEnd() &&
+                    width > 0 && height > 0 && image.rgba.size() == static_cast<size_t>(width) * height * 4)
+                {
+                    image.width = static_cast<uint32_t>(width);
+                    image.height = static_cast<uint32_t>(height);
+                    return true;
+                }
+                image.rgba.clear();
+            }
+
+            int width = 0;
+            int height = 0;
+            int components = 0;
+            stbi_uc* pTexels = size <= INT32_MAX
+                ? stbi_load_from_memory(pBytes, static_cast<int>(size), &width, &height, &components, 4)
+                : nullptr;
+            if (!pTexels)
+            {
+                return false;
+            }
+            image.width = static_cast<uint32_t>(width);
+            image.height = static_cast<uint32_t>(height);
+            image.rgba.assign(pTexels, pTexels + static_cast<size_t>(width) * height * 4);
+            stbi_image_free(pTexels);
+
+            if (pCache)
+            {
+                ChunkWriter writer;
+                writer.write(static_cast<int32_t>(width));
+                writer.write(static_cast<int32_t>(height));
+                writer.writeArray(image.rgba);
+                pCache->store(ChunkKind::Image, key, writer.getData());
+            }
+            return true;
+        }
+
+        // Encoded bytes of an image: in a buffer, decoded from a data: URI, or
+        // a mapped external file.
+        struct EncodedImage
+        {
+            const uint8_t* pData = nullptr;
+            size_t size = 0;
+            std::vector<uint8_t> storage;
+            MappedFile file;
+        };
+
+        // KHR_texture_transform's translation * rotation * scale, with the
+        // rotation counter-clockwise in UV space (v pointing down).
+        TextureTransform toTextureTransform(const GltfTextureTransform& source)
+        {
+            TextureTransform transform;
+            const float cosine = std::cos(source.rotation);
+            const float sine = std::sin(source.rotation);
+            transform.matrix[0] = cosine * source.scale[0];
+            transform.matrix[1] = sine * source.scale[1];
+            transform.matrix[2] = source.offset[0];
+            transform.matrix[3] = -sine * source.scale[0];
+            transform.matrix[4] = cosine * source.scale[1];
+            transform.matrix[5] = source.offset[1];
+            return transform;
+        }
+
+        // tinygltf counterpart of the streaming parser's extension reading:
+        // applies the registered handler of each extension in `extensions`.
+        void applyExtensions(const tinygltf::ExtensionMap& extensions, GltfExtensionTarget target, void* pBlock, uint32_t& flags)
+        {
+            const GltfExtensionRegistry& registry = GltfExtensionRegistry::getShared();
+            for (const auto& extension : extensions)
+            {
+                const GltfExtensionHandler* pHandler = registry.findHandler(extension.first, target);
+                if (!pHandler || !extension.second.IsObject())
+                {
+                    continue;
+                }
+                flags |= pHandler->flags;
+                for (const GltfExtensionField& field : pHandler->fields)
+                {
+                    if (!extension.second.Has(field.key))
+                    {
+                        continue;
+                    }
+                    const tinygltf::Value& value = extension.second.Get(field.key);
+                    const uint32_t count = getComponentCount(field.type);
+                    float* pValues = getFieldValues(field, pBlock);
+                    if (count == 1 && value.IsNumber())
+                    {
+                        pValues[0] = static_cast<float>(value.GetNumberAsDouble());
+                    }
+                    for (size_t i = 0; count > 1 && value.IsArray() && i < value.ArrayLen() && i < count; ++i)
+                    {
+                        pValues[i] = value.Get(i).IsNumber() ? static_cast<float>(value.Get(i).GetNumberAsDouble()) : pValues[i];
+                    }
+                }
+            }
+        }
+
+        // Views a tinygltf model as a GltfDocument. Buffers point into
+        // `model`, which must outlive the document.
+        void convertTinyGltf(const tinygltf::Model& model, GltfDocument& document)
+        {
+            for (const tinygltf::Buffer& gltfBuffer : model.buffers)
+            {
+                GltfBuffer buffer;
+                buffer.uri = gltfBuffer.uri;
+                buffer.byteLength = gltfBuffer.data.size();
+                buffer.pData = gltfBuffer.data.data();
+                buffer.size = gltfBuffer.data.size();
+                document.buffers.push_back(std::move(buffer));
+            }
+            for (const tinygltf::BufferView& gltfView : model.bufferViews)
+            {
+                GltfBufferView view;
+                view.buffer = gltfView.buffer;
+                view.byteOffset = gltfView.byteOffset;
+                view.byteLength = gltfView.byteLength;
+                view.byteStride = static_cast<uint32_t>(gltfView.byteStride);
+                document.bufferViews.push_back(view);
+            }
+            for (const tinygltf::Accessor& gltfAccessor : model.accessors)
+            {
+                GltfAccessor accessor;
+                accessor.bufferView = gltfAccessor.bufferView;
+                accessor.byteOffset = gltfAccessor.byteOffset;
+                accessor.count = gltfAccessor.count;
+                accessor.componentType = static_cast<GltfComponentType>(gltfAccessor.componentType);
+                accessor.componentCount = std::max(0, tinygltf::GetNumComponentsInType(static_cast<uint32_t>(gltfAccessor.type)));
+                accessor.normalized = gltfAccessor.normalized;
+                const tinygltf::Accessor::Sparse& gltfSparse = gltfAccessor.sparse;
+                if (gltfSparse.isSparse && gltfSparse.count > 0)
+                {
+                    accessor.sparse.count = static_cast<uint64_t>(gltfSparse.count);
+                    accessor.sparse.indicesBufferView = gltfSparse.indices.bufferView;
+                    accessor.sparse.indicesByteOffset = gltfSparse.indices.byteOffset;
+                    accessor.sparse.indicesComponentType = static_cast<GltfComponentType>(gltfSparse.indices.componentType);
+                    accessor.sparse.valuesBufferView = gltfSparse.values.bufferView;
+                    accessor.sparse.valuesByteOffset = gltfSparse.values.byteOffset;
+                }
+                document.accessors.push_back(accessor);
+            }
+            for (const tinygltf::Image& gltfImage : model.images)
+            {
+                GltfImage image;
+                image.name = gltfImage.name;
+                image.uri = gltfImage.uri;
+                image.mimeType = gltfImage.mimeType;
+                image.bufferView = gltfImage.bufferView;
+                if (convertImage(gltfImage, image.rgba))
+                {
+                    image.width = static_cast<uint32_t>(gltfImage.width);
+                    image.height = static_cast<uint32_t>(gltfImage.height);
+                }
+                document.images.push_back(std::move(image));
+            }
+            for (const tinygltf::Texture& texture : model.textures)
+            {
+                document.textures.push_back(texture.source);
+            }
+            for (const tinygltf::Material& gltfMaterial : model.materials)
+            {
+                GltfMaterial material;
+                const tinygltf::PbrMetallicRoughness& pbr = gltfMaterial.pbrMetallicRoughness;
+                for (size_t i = 0; i < pbr.baseColorFactor.size() && i < 4; ++i)
+                {
+                    material.baseColorFactor[i] = static_cast<float>(pbr.baseColorFactor[i]);
+                }
+                material.metallicFactor = static_cast<float>(pbr.metallicFactor);
+                material.roughnessFactor = static_cast<float>(pbr.roughnessFactor);
+                for (size_t i = 0; i < gltfMaterial.emissiveFactor.size() && i < 3; ++i)
+                {
+                    material.emissiveFactor[i] = static_cast<float>(gltfMaterial.emissiveFactor[i]);
+                }
+                material.normalScale = static_cast<float>(gltfMaterial.normalTexture.scale);
+                material.occlusionStrength = static_cast<float>(gltfMaterial.occlusionTexture.strength);
+                material.alphaCutoff = static_cast<float>(gltfMaterial.alphaCutoff);
+                material.alphaMode = gltfMaterial.alphaMode == "MASK"    ? GltfMaterial::AlphaMode::Mask
+                                     : gltfMaterial.alphaMode == "BLEND" ? GltfMaterial::AlphaMode::Blend
+                                                                         : GltfMaterial::AlphaMode::Opaque;
+                material.doubleSided = gltfMaterial.doubleSided;
+                material.baseColorTexture = pbr.baseColorTexture.index;
+                material.metallicRoughnessTexture = pbr.metallicRoughnessTexture.index;
+                material.normalTexture = gltfMaterial.normalTexture.index;
+                material.occlusionTexture = gltfMaterial.occlusionTexture.index;
+                material.emissiveTexture = gltfMaterial.emissiveTexture.index;
+                applyExtensions(gltfMaterial.extensions, GltfExtensionTarget::Material, &material, material.flags);
+                const tinygltf::ExtensionMap* textureExtensions[kMaterialTextureCount] = {
+                    &pbr.baseColorTexture.extensions, &pbr.metallicRoughnessTexture.extensions,
+                    &gltfMaterial.normalTexture.extensions, &gltfMaterial.occlusionTexture.extensions,
+                    &gltfMaterial.emissiveTexture.extensions
+                };
+                for (uint32_t slot = 0; slot < kMaterialTextureCount; ++slot)
+                {
+                    uint32_t flags = 0; // Texture extensions set no material flags
+                    applyExtensions(*textureExtensions[slot], GltfExtensionTarget::TextureInfo, &material.textureTransforms[slot],
+                                    flags);
+                }
+                document.materials.push_back(material);
+            }
+            for (const tinygltf::Mesh& gltfMesh : model.meshes)
+            {
+                GltfMesh mesh;
+                mesh.name = gltfMesh.name;
+                mesh.firstPrimitive = static_cast<uint32_t>(document.primitives.size());
+                mesh.primitiveCount = static_cast<uint32_t>(gltfMesh.primitives.size());
+                mesh.firstWeight = static_cast<uint32_t>(document.morphWeights.size());
+                mesh.weightCount = static_cast<uint32_t>(gltfMesh.weights.size());
+                document.morphWeights.insert(document.morphWeights.end(), gltfMesh.weights.begin(), gltfMesh.weights.end());
+                for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives)
+                {
+                    GltfPrimitive primitive;
+                    auto attribute = [&gltfPrimitive](const char* pName)
+                    {
+                        auto found = gltfPrimitive.attributes.find(pName);
+                        return found == gltfPrimitive.attributes.end() ? -1 : found->second;
+                    };
+                    primitive.position = attribute("POSITION");
+                    primitive.normal = attribute("NORMAL");
+                    primitive.texCoord0 = attribute("TEXCOORD_0");
+                    primitive.color0 = attribute("COLOR_0");
+                    primitive.joints0 = attribute("JOINTS_0");
+                    primitive.weights0 = attribute("WEIGHTS_0");
+                    primitive.indices = gltfPrimitive.indices;
+                    primitive.material = gltfPrimitive.material;
+                    primitive.mode = gltfPrimitive.mode == -1 ? GltfPrimitive::kTriangles : gltfPrimitive.mode;
+                    auto draco = gltfPrimitive.extensions.find("KHR_draco_mesh_compression");
+                    if (draco != gltfPrimitive.extensions.end() && draco->second.Get("bufferView").IsNumber())
+                    {
+                        primitive.dracoBufferView = draco->second.Get("bufferView").GetNumberAsInt();
+                    }
+                    primitive.firstTarget = static_cast<uint32_t>(document.morphTargets.size());
+                    primitive.targetCount = static_cast<uint32_t>(gltfPrimitive.targets.size());
+                    for (const std::map<std::string, int>& gltfTarget : gltfPrimitive.targets)
+                    {
+                        auto targetAttribute = [&gltfTarget](const char* pName)
+                        {
+                            auto found = gltfTarget.find(pName);
+                            return found == gltfTarget.end() ? -1 : found->second;
+                        };
+                        GltfMorphTarget target;
+                        target.position = targetAttribute("POSITION");
+                        target.normal = targetAttribute("NORMAL");
+                        target.texCoord0 = targetAttribute("TEXCOORD_0");
+                        document.morphTargets.push_back(target);
+                    }
+                    document.primitives.push_back(primitive);
+                }
+                document.meshes.push_back(std::move(mesh));
+            }
+            for (const tinygltf::Node& gltfNode : model.nodes)
+            {
+                GltfNode node;
+                node.mesh = gltfNode.mesh;
+                node.light = gltfNode.light;
+                node.skin = gltfNode.skin;
+                node.hasMatrix = gltfNode.matrix.size() == 16;
+                for (size_t i = 0; i < gltfNode.matrix.size() && i < 16; ++i) node.matrix[i] = static_cast<float>(gltfNode.matrix[i]);
+                for (size_t i = 0; i < gltfNode.translation.size() && i < 3; ++i) node.translation[i] = static_cast<float>(gltfNode.translation[i]);
+                for (size_t i = 0; i < gltfNode.rotation.size() && i < 4; ++i) node.rotation[i] = static_cast<float>(gltfNode.rotation[i]);
+                for (size_t i = 0; i < gltfNode.scale.size() && i < 3; ++i) node.scale[i] = static_cast<float>(gltfNode.scale[i]);
+                node.firstChild = static_cast<uint32_t>(document.nodeChildren.size());
+                node.childCount = static_cast<uint32_t>(gltfNode.children.size());
+                node.firstWeight = static_cast<uint32_t>(document.morphWeights.size());
+                node.weightCount = static_cast<uint32_t>(gltfNode.weights.size());
+                document.morphWeights.insert(document.morphWeights.end(), gltfNode.weights.begin(), gltfNode.weights.end());
+                document.nodeChildren.insert(document.nodeChildren.end(), gltfNode.children.begin(), gltfNode.children.end());
+                document.nodes.push_back(node);
+            }
+            for (const tinygltf::Scene& gltfScene : model.scenes)
+            {
+                GltfScene scene;
+                scene.firstNode = static_cast<uint32_t>(document.sceneNodes.size());
+                scene.nodeCount = static_cast<uint32_t>(gltfScene.nodes.size());
+                document.sceneNodes.insert(document.sceneNodes.end(), gltfScene.nodes.begin(), gltfScene.nodes.end());
+                document.scenes.push_back(scene);
+            }
+            for (const tinygltf::Light& gltfLight : model.lights)
+            {
+                GltfLight light;
+                light.type = gltfLight.type == "directional" ? GltfLight::Type::Directional
+                             : gltfLight.type == "spot"      ? GltfLight::Type::Spot
+                                                             : GltfLight::Type::Point;
+                for (size_t i = 0; i < gltfLight.color.size() && i < 3; ++i) light.color[i] = static_cast<float>(gltfLight.color[i]);
+                light.intensity = static_cast<float>(gltfLight.intensity);
+                light.range = static_cast<float>(gltfLight.range);
+                light.innerConeAngle = static_cast<float>(gltfLight.spot.innerConeAngle);
+                light.outerConeAngle = static_cast<float>(gltfLight.spot.outerConeAngle);
+                document.lights.push_back(light);
+            }
+            for (const tinygltf::Skin& gltfSkin : model.skins)
+            {
+                GltfSkin skin;
+                skin.inverseBindMatrices = gltfSkin.inverseBindMatrices;
+                skin.firstJoint = static_cast<uint32_t>(document.skinJoints.size());
+                skin.jointCount = static_cast<uint32_t>(gltfSkin.joints.size());
+                document.skinJoints.insert(document.skinJoints.end(), gltfSkin.joints.begin(), gltfSkin.joints.end());
+                document.skins.push_back(skin);
+            }
+            for (const tinygltf::Animation& gltfAnimation : model.animations)
+            {
+                GltfAnimation animation;
+                animation.name = gltfAnimation.name;
+                animation.firstChannel = static_cast<uint32_t>(document.animationChannels.size());
+                animation.channelCount = static_cast<uint32_t>(gltfAnimation.channels.size());
+                animation.firstSampler = static_cast<uint32_t>(document.animationSamplers.size());
+                animation.samplerCount = static_cast<uint32_t>(gltfAnimation.samplers.size());
+                for (const tinygltf::AnimationChannel& gltfChannel : gltfAnimation.channels)
+                {
+                    GltfAnimationChannel channel;
+                    channel.sampler = gltfChannel.sampler;
+                    channel.node = gltfChannel.target_node;
+                    const std::string& path = gltfChannel.target_path;
+                    channel.path = path == "translation" ? GltfAnimationChannel::Path::Translation
+                                   : path == "rotation"  ? GltfAnimationChannel::Path::Rotation
+                                   : path == "scale"     ? GltfAnimationChannel::Path::Scale
+                                   : path == "weights"   ? GltfAnimationChannel::Path::Weights
+                                                         : GltfAnimationChannel::Path::Unknown;
+                    document.animationChannels.push_back(channel);
+                }
+                for (const tinygltf::AnimationSampler& gltfSampler : gltfAnimation.samplers)
+                {
+                    GltfAnimationSampler sampler;
+                    sampler.input = gltfSampler.input;
+                    sampler.output = gltfSampler.output;
+                    sampler.interpolation = gltfSampler.interpolation == "STEP"          ? GltfAnimationSampler::Interpolation::Step
+                                            : gltfSampler.interpolation == "CUBICSPLINE" ? GltfAnimationSampler::Interpolation::CubicSpline
+                                                                                         : GltfAnimationSampler::Interpolation::Linear;
+                    document.animationSamplers.push_back(sampler);
+                }
+                document.animations.push_back(std::move(animation));
+            }
+            document.defaultScene = model.defaultScene;
+            document.extensionsRequired = model.extensionsRequired;
+        }
+
+        // Draco is out of scope: decoding it means vendoring the Draco
+        // library. Files that only work with it are refused; primitives that
+        // use it optionally fall back to their plain accessors.
+        bool checkRequiredExtensions(const GltfDocument& document, const std::string& source, std::string& outError)
+        {
+            for (const std::string& extension : document.extensionsRequired)
+            {
+                if (extension == "KHR_draco_mesh_compression")
+                {
+                    outError = "Required extension KHR_draco_mesh_compression is not supported (Draco meshes are not "
+                               "decoded; re-export without Draco, or with EXT_meshopt_compression)";
+                    outError += source.empty() ? std::string() : ": " + source;
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void computeLocalMatrix(const GltfNode& node, float out[16])
+        {
+            if (node.hasMatrix)
+            {
+                std::memcpy(out, node.matrix, sizeof(node.matrix));
+                return;
+            }
+
+            const float* t = node.translation;
+            const float* s = node.scale;
+            const float x = node.rotation[0], y = node.rotation[1], z = node.rotation[2], w = node.rotation[3];
+            out[0] = (1.0f - 2.0f * (y * y + z * z)) * s[0];
+            out[1] = (2.0f * (x * y + z * w)) * s[0];
+            out[2] = (2.0f * (x * z - y * w)) * s[0];
+            out[3] = 0.0f;
+            out[4] = (2.0f * (x * y - z * w)) * s[1];
+            out[5] = (1.0f - 2.0f * (x * x + z * z)) * s[1];
+            out[6] = (2.0f * (y * z + x * w)) * s[1];
+            out[7] = 0.0f;
+            out[8] = (2.0f * (x * z + y * w)) * s[2];
+            out[9] = (2.0f * (y * z - x * w)) * s[2];
+            out[10] = (1.0f - 2.0f * (x * x + y * y)) * s[2];
+            out[11] = 0.0f;
+            out[12] = t[0];
+            out[13] = t[1];
+            out[14] = t[2];
+            out[15] = 1.0f;
+        }
+
+        // `nodeMap` receives the model node of every glTF node reached, for
+        // skins and animations to refer to.
+        void appendNode(const GltfDocument& document, int32_t nodeIndex, int32_t parent, int depth, ModelData& outModel,
+                        std::vector<int32_t>& nodeMap)
+        {
+            // Guard against cyclic hierarchies in malformed files.
+            if (nodeIndex < 0 || nodeIndex >= static_cast<int32_t>(document.nodes.size()) || depth > 256)
+            {
+                return;
+            }
+            const GltfNode& gltfNode = document.nodes[nodeIndex];
+
+            NodeData node;
+            node.parent = parent;
+            node.mesh = gltfNode.mesh;
+            node.skin = gltfNode.skin >= 0 && gltfNode.skin < static_cast<int32_t>(document.skins.size()) ? gltfNode.skin : -1;
+            if (!gltfNode.hasMatrix)
+            {
+                std::memcpy(node.translation, gltfNode.translation, sizeof(node.translation));
+                std::memcpy(node.rotation, gltfNode.rotation, sizeof(node.rotation));
+                std::memcpy(node.scale, gltfNode.scale, sizeof(node.scale));
+            }
+            computeLocalMatrix(gltfNode, node.localMatrix);
+
+            // One weight per target of the mesh's widest primitive: the
+            // node's own weights, else the mesh defaults, else zero.
+            if (gltfNode.mesh >= 0 && gltfNode.mesh < static_cast<int32_t>(document.meshes.size()))
+            {
+                const GltfMesh& gltfMesh = document.meshes[gltfNode.mesh];
+                uint32_t targetCount = 0;
+                for (uint32_t i = 0; i < gltfMesh.primitiveCount; ++i)
+                {
+                    targetCount = std::max(targetCount, document.primitives[gltfMesh.firstPrimitive + i].targetCount);
+                }
+                if (targetCount > 0)
+                {
+                    const float* pWeights = gltfNode.weightCount == targetCount ? &document.morphWeights[gltfNode.firstWeight]
+                                            : gltfMesh.weightCount == targetCount ? &document.morphWeights[gltfMesh.firstWeight]
+                                                                                  : nullptr;
+                    node.firstMorphWeight = static_cast<uint32_t>(outModel.morphWeights.size());
+                    node.morphWeightCount = targetCount;
+                    for (uint32_t i = 0; i < targetCount; ++i)
+                    {
+                        outModel.morphWeights.push_back(pWeights ? pWeights[i] : 0.0f);
+                    }
+                }
+            }
+            if (parent >= 0)
+            {
+                multiplyMatrices(outModel.nodes[parent].worldMatrix, node.localMatrix, node.worldMatrix);
+            }
+            else
+            {
+                std::memcpy(node.worldMatrix, node.localMatrix, sizeof(node.worldMatrix));
+            }
+
+            const int32_t index = static_cast<int32_t>(outModel.nodes.size());
+            outModel.nodes.push_back(node);
+            if (nodeMap[nodeIndex] < 0)
+            {
+                nodeMap[nodeIndex] = index;
+            }
+            if (gltfNode.light >= 0 && gltfNode.light < static_cast<int32_t>(document.lights.size()))
+            {
+                const GltfLight& gltfLight = document.lights[gltfNode.light];
+                LightData light;
+                light.type = static_cast<LightType>(gltfLight.type);
+                light.node = index;
+                std::memcpy(light.color, gltfLight.color, sizeof(light.color));
+                light.intensity = gltfLight.intensity;
+                light.range = gltfLight.range;
+                light.innerConeAngle = gltfLight.innerConeAngle;
+                light.outerConeAngle = gltfLight.outerConeAngle;
+                outModel.lights.push_back(light);
+            }
+            for (uint32_t i = 0; i < gltfNode.childCount; ++i)
+            {
+                appendNode(document, document.nodeChildren[gltfNode.firstChild + i], index, depth + 1, outModel, nodeMap);
+            }
+        }
+
+        // Joints outside the imported scene keep an identity bind matrix and
+        // follow no node (-1).
+        void importSkins(const GltfDocument& document, const std::vector<int32_t>& nodeMap, ModelData& outModel)
+        {
+            ScratchScope scratch;
+            ArenaVector<float> matrices(&scratch.getArena());
+            for (const GltfSkin& gltfSkin : document.skins)
+            {
+                SkinData skin;
+                skin.firstJoint = static_cast<uint32_t>(outModel.joints.size());
+                skin.jointCount = gltfSkin.jointCount;
+                const bool hasMatrices = readAccessor(document, gltfSkin.inverseBindMatrices, 16, matrices) &&
+                                         matrices.size() >= gltfSkin.jointCount * 16ull;
+                for (uint32_t i = 0; i < gltfSkin.jointCount; ++i)
+                {
+                    JointData joint;
+                    const int32_t gltfNode = document.skinJoints[gltfSkin.firstJoint + i];
+                    joint.node = gltfNode >= 0 && gltfNode < static_cast<int32_t>(nodeMap.size()) ? nodeMap[gltfNode] : -1;
+                    if (hasMatrices)
+                    {
+                        std::memcpy(joint.inverseBindMatrix, &matrices[i * 16], sizeof(joint.inverseBindMatrix));
+                    }
+                    outModel.joints.push_back(joint);
+                }
+                outModel.skins.push_back(skin);
+            }
+        }
+
+        // Converts translation, rotation, scale and morph weight channels.
+        // Channels sharing a sampler share its key and value ranges. Returns
+        // the number of channels dropped (unreadable samplers, nodes outside
+        // the scene, weights of nodes without morph targets).
+        uint32_t importAnimations(const GltfDocument& document, const std::vector<int32_t>& nodeMap, ModelData& outModel)
+        {
+            ScratchScope scratch;
+            ArenaVector<float> times(&scratch.getArena());
+            ArenaVector<float> values(&scratch.getArena());
+            uint32_t dropped = 0;
+            for (const GltfAnimation& gltfAnimation : document.animations)
+            {
+                AnimationData animation;
+                animation.name = gltfAnimation.name;
+                animation.firstChannel = static_cast<uint32_t>(outModel.animationChannels.size());
+
+                // Key and value ranges of each sampler once read, per component count
+                struct SamplerRange
+                {
+                    uint32_t components = 0;
+                    uint32_t firstKey = 0;
+                    uint32_t keyCount = 0;
+                    uint32_t firstValue = 0;
+                };
+                ArenaVector<SamplerRange> samplerRanges(gltfAnimation.samplerCount, SamplerRange(), &scratch.getArena());
+
+                for (uint32_t c = 0; c < gltfAnimation.channelCount; ++c)
+                {
+                    const GltfAnimationChannel& gltfChannel = document.animationChannels[gltfAnimation.firstChannel + c];
+                    const bool knownPath = gltfChannel.path == GltfAnimationChannel::Path::Translation ||
+                                           gltfChannel.path == GltfAnimationChannel::Path::Rotation ||
+                                           gltfChannel.path == GltfAnimationChannel::Path::Scale ||
+                                           gltfChannel.path == GltfAnimationChannel::Path::Weights;
+                    const int32_t node = gltfChannel.node >= 0 && gltfChannel.node < static_cast<int32_t>(nodeMap.size())
+                                             ? nodeMap[gltfChannel.node] : -1;
+                    if (!knownPath || node < 0 ||
+                        (gltfChannel.path == GltfAnimationChannel::Path::Weights && outModel.nodes[node].morphWeightCount == 0) || gltfChannel.sampler < 0 ||
+                        gltfChannel.sampler >= static_cast<int32_t>(gltfAnimation.samplerCount))
+                    {
+                        dropped++;
+                        continue;
+                    }
+
+                    AnimationChannelData channel;
+                    channel.node = node;
+                    channel.path = static_cast<AnimationPath>(gltfChannel.path);
+                    const GltfAnimationSampler& sampler = document.animationSamplers[gltfAnimation.firstSampler + gltfChannel.sampler];
+                    channel.interpolation = static_cast<AnimationInterpolation>(sampler.interpolation);
+
+                    // Weights are scalar accessors holding every target's weight per key.
+                    const uint32_t components = getComponentCount(outModel, channel);
+                    const int readComponents = channel.path == AnimationPath::Weights ? 1 : static_cast<int>(components);
+                    SamplerRange& range = samplerRanges[gltfChannel.sampler];
+                    if (range.components != components)
+                    {
+                        const uint32_t valuesPerKey = components * (channel.interpolation == AnimationInterpolation::CubicSpline ? 3 : 1);
+                        bool ascending = readAccessor(document, sampler.input, 1, times) && !times.empty() &&
+                                         readAccessor(document, sampler.output, readComponents, values) &&
+                                         values.size() == times.size() * valuesPerKey;
+                        for (size_t i = 1; ascending && i < times.size(); ++i)
+                        {
+                            ascending = times[i] >= times[i - 1];
+                        }
+                        if (!ascending)
+                        {
+                            dropped++;
+                            continue;
+                        }
+                        range.components = components;
+                        range.firstKey = static_cast<uint32_t>(outModel.animationTimes.size());
+                        range.keyCount = static_cast<uint32_t>(times.size());
+                        range.firstValue = static_cast<uint32_t>(outModel.animationValues.size());
+                        outModel.animationTimes.insert(outModel.animationTimes.end(), times.begin(), times.end());
+                        outModel.animationValues.insert(outModel.animationValues.end(), values.begin(), values.end());
+                    }
+                    channel.firstKey = range.firstKey;
+                    channel.keyCount = range.keyCount;
+                    channel.firstValue = range.firstValue;
+                    animation.duration = std::max(animation.duration, outModel.animationTimes[range.firstKey + range.keyCount - 1]);
+                    outModel.animationChannels.push_back(channel);
+                }
+
+                animation.channelCount = static_cast<uint32_t>(outModel.animationChannels.size()) - animation.firstChannel;
+                outModel.animations.push_back(std::move(animation));
+            }
+            return dropped;
+        }
+
+        // A node keeps its skin only if every skinned primitive it draws
+        // addresses joints the skin has; the renderer relies on that.
+        bool skinFitsMesh(const ModelData& model, const NodeData& node)
+        {
+            const SkinData& skin = model.skins[node.skin];
+            const MeshData& mesh = model.meshes[node.mesh];
+            for (uint32_t i = 0; i < mesh.primitiveCount; ++i)
+            {
+                const PrimitiveData& primitive = model.primitives[mesh.firstPrimitive + i];
+                for (uint32_t v = 0; primitive.hasSkinWeights && v < primitive.vertexCount; ++v)
+                {
+                    const SkinVertex& vertex = model.skinVertices[primitive.firstSkinVertex + v];
+                    for (int c = 0; c < 4; ++c)
+                    {
+                        if (vertex.weights[c] > 0 && vertex.joints[c] >= skin.jointCount)
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    bool GltfImporter::importFile(const std::string& path, ModelData& outModel)
+    {
+        m_error.clear();
+        m_warning.clear();
+        m_dependencies.clear();
+
+        // GLB buffers point into the mapping, so it stays open for the whole import.
+        MappedFile file;
+        if (!file.open(path))
+        {
+            m_error = "Failed to open glTF: " + path;
+            return false;
+        }
+        const char* pJson = reinterpret_cast<const char*>(file.data());
+        size_t jsonSize = file.size();
+        const uint8_t* pBin = nullptr;
+        size_t binSize = 0;
+        if (hasExtension(path, ".glb") && !splitGlb(file.data(), file.size(), pJson, jsonSize, pBin, binSize, m_error))
+        {
+            return false;
+        }
+        GltfDocument document;
+        if (!parseGltfJson(pJson, jsonSize, document, m_error))
+        {
+            return false;
+        }
+        if (!checkRequiredExtensions(document, path, m_error))
+        {
+            return false;
+        }
+
+        const size_t separator = path.find_last_of('/');
+        const std::string baseDirectory = separator == std::string::npos ? std::string() : path.substr(0, separator + 1);
+        for (size_t i = 0; i < document.buffers.size(); ++i)
+        {
+            GltfBuffer& buffer = document.buffers[i];
+            if (buffer.uri.empty() && i == 0 && pBin)
+            {
+                buffer.pData = pBin;
+                buffer.size = binSize;
+            }
+            else if (decodeDataUri(buffer.uri, buffer.storage))
+            {
+                buffer.pData = buffer.storage.data();
+                buffer.size = buffer.storage.size();
+            }
+            else if (isExternalUri(buffer.uri))
+            {
+                // External buffers are mapped rather than copied.
+                const std::string bufferPath = baseDirectory + decodeUri(buffer.uri);
+                m_dependencies.push_back(bufferPath);
+                if (buffer.mapping.open(bufferPath))
+                {
+                    buffer.pData = buffer.mapping.data();
+                    buffer.size = buffer.mapping.size();
+                }
+            }
+            if (buffer.size < buffer.byteLength && !buffer.isFallback)
+            {
+                m_error = "glTF buffer " + std::to_string(i) + " is missing or shorter than its byteLength";
+                return false;
+            }
+        }
+
+        // EXT_meshopt_compression views decode in parallel, one task per
+        // view, each into a buffer of its own that the view is redirected to.
+        // The sizes come from the JSON, so they are checked and the buffers
+        // allocated before any task runs.
+        std::vector<size_t> compressedViews;
+        const size_t sourceBufferCount = document.buffers.size();
+        for (size_t i = 0; i < document.bufferViews.size(); ++i)
+        {
+            const GltfMeshoptCompression& compression = document.bufferViews[i].meshopt;
+            if (compression.buffer < 0)
+            {
+                continue;
+            }
+            size_t decodedSize = 0;
+            if (compression.buffer >= static_cast<int32_t>(sourceBufferCount) ||
+                !isRangeWithin(compression.byteOffset, compression.byteLength, document.buffers[compression.buffer].size) ||
+                !getMeshoptDecodedSize(compression, decodedSize))
+            {
+                m_error = "Invalid EXT_meshopt_compression buffer view " + std::to_string(i);
+                return false;
+            }
+            compressedViews.push_back(i);
+            document.buffers.emplace_back();
+            document.buffers.back().storage.resize(decodedSize);
+        }
+        std::atomic<size_t> failedView(SIZE_MAX);
+        parallelFor(compressedViews.size(), m_workerThreadCount, [&](size_t i)
+        {
+            GltfBufferView& view = document.bufferViews[compressedViews[i]];
+            const GltfMeshoptCompression& compression = view.meshopt;
+            GltfBuffer& decoded = document.buffers[sourceBufferCount + i];
+            if (!decodeMeshoptBufferView(compression, document.buffers[compression.buffer].pData + compression.byteOffset,
+                                         compression.byteLength, decoded.storage.data()))
+            {
+                failedView.store(compressedViews[i]);
+                return;
+            }
+            decoded.pData = decoded.storage.data();
+            decoded.size = decoded.storage.size();
+            decoded.byteLength = decoded.size;
+            view.buffer = static_cast<int32_t>(sourceBufferCount + i);
+            view.byteOffset = 0;
+            view.byteLength = decoded.size;
+        });
+        if (failedView.load() != SIZE_MAX)
+        {
+            m_error = "Failed to decode EXT_meshopt_compression buffer view " + std::to_string(failedView.load());
+            return false;
+        }
+
+        // Locate every image's encoded bytes, then decode them in parallel.
+        std::vector<EncodedImage> encoded(document.images.size());
+        for (size_t i = 0; i < document.images.size(); ++i)
+        {
+            const GltfImage& image = document.images[i];
+            EncodedImage& bytes = encoded[i];
+            if (image.bufferView >= 0 && image.bufferView < static_cast<int32_t>(document.bufferViews.size()))
+            {
+                const GltfBufferView& view = document.bufferViews[image.bufferView];
+                if (view.buffer >= 0 && view.buffer < static_cast<int32_t>(document.buffers.size()) &&
+                    isRangeWithin(view.byteOffset, view.byteLength, document.buffers[view.buffer].size))
+                {
+                    bytes.pData = document.buffers[view.buffer].pData + view.byteOffset;
+                    bytes.size = view.byteLength;
+                }
+            }
+            else if (decodeDataUri(image.uri, bytes.storage))
+            {
+                bytes.pData = bytes.storage.data();
+                bytes.size = bytes.storage.size();
+            }
+            else if (isExternalUri(image.uri))
+            {
+                const std::string imagePath = baseDirectory + decodeUri(image.uri);
+                m_dependencies.push_back(imagePath);
+                if (bytes.file.open(imagePath))
+                {
+                    bytes.pData = bytes.file.data();
+                    bytes.size = bytes.file.size();
+                }
+            }
+        }
+        parallelFor(encoded.size(), m_workerThreadCount, [&](size_t i)
+        {
+            if (encoded[i].pData)
+            {
+                decodeImage(m_pImportCache, encoded[i].pData, encoded[i].size, document.images[i]);
+            }
+        });
+
+        outModel.sourcePath = path;
+        return importDocument(document, outModel);
+    }
+
+    uint64_t GltfImporter::getSettingsHash() const
+    {
+        uint64_t hash = getMeshSettingsHash();
+        hash = hashCombine(hash, hashValue(m_processTextures));
+        if (m_processTextures)
+        {
+            hash = hashCombine(hash, hashValue(m_textureOptions.generateMips));
+            hash = hashCombine(hash, hashValue(m_textureOptions.mipFilter));
+            hash = hashCombine(hash, hashValue(m_textureOptions.compress));
+        }
+        hash = hashCombine(hash, hashValue(m_compressAnimations));
+        if (m_compressAnimations)
+        {
+            hash = hashCombine(hash, hashValue(m_animationOptions.maxTranslationError));
+            hash = hashCombine(hash, hashValue(m_animationOptions.maxRotationError));
+            hash = hashCombine(hash, hashValue(m_animationOptions.maxScaleError));
+            hash = hashCombine(hash, hashValue(m_animationOptions.maxWeightError));
+            hash = hashCombine(hash, hashValue(m_animationOptions.quantize));
+        }
+        return hash;
+    }
+
+    uint64_t GltfImporter::getMeshSettingsHash() const
+    {
+        uint64_t hash = hashValue(m_generateLods);
+        hash = hashCombine(hash, hashValue(m_generateMeshlets));
+        if (m_generateLods)
+        {
+            hash = hashCombine(hash, hashValue(m_lodOptions.maxLevels));
+            hash = hashCombine(hash, hashValue(m_lodOptions.reductionPerLevel));
+            hash = hashCombine(hash, hashValue(m_lodOptions.maxRelativeError));
+            hash = hashCombine(hash, hashValue(m_lodOptions.minReduction));
+        }
+        hash = hashCombine(hash, hashValue(m_quantizeVertices));
+        if (m_quantizeVertices)
+        {
+            hash = hashCombine(hash, hashValue(m_quantizationOptions.maxPositionError));
+            hash = hashCombine(hash, hashValue(m_quantizationOptions.maxNormalError));
+            hash = hashCombine(hash, hashValue(m_quantizationOptions.maxTexCoordError));
+        }
+        return hashCombine(hash, GltfExtensionRegistry::getShared().getHash());
+    }
+
+    void GltfImporter::buildTexture(const std::vector<uint8_t>& rgba, const TextureData& texture, uint64_t key,
+                                    TextureResource& outResource)
+    {
+        outResource.format = texture.format;
+        if (!m_processTextures)
+        {
+            TextureMipData mip;
+            mip.size = rgba.size();
+            mip.width = texture.width;
+            mip.height = texture.height;
+            outResource.mips.assign(1, mip);
+            outResource.texels = rgba;
+            return;
+        }
+
+        const bool srgb = texture.format == TextureFormat::RGBA8Srgb;
+        std::vector<uint8_t> payload;
+        if (m_pImportCache && m_pImportCache->load(ChunkKind::Texture, key, payload))
+        {
+            ChunkReader reader(payload);
+            bool cached = reader.read(outResource.format) && reader.readArray(outResource.mips) &&
+                          reader.readArray(outResource.texels) && reader.atEnd() &&
+                          outResource.format <= TextureFormat::BC7Srgb && !outResource.mips.empty();
+            for (const TextureMipData& mip : outResource.mips)
+            {
+                cached = cached && mip.offset <= outResource.texels.size() && mip.size <= outResource.texels.size() - mip.offset;
+            }
+            if (cached)
+            {
+                return;
+            }
+        }
+
+        processTexture(rgba.data(), texture.width, texture.height, srgb, m_textureOptions, m_workerThreadCount,
+                       outResource.format, outResource.mips, outResource.texels);
+        if (m_pImportCache)
+        {
+            ChunkWriter writer;
+            writer.write(outResource.format);
+            writer.writeArray(outResource.mips);
+            writer.writeArray(outResource.texels);
+            m_pImportCache->store(ChunkKind::Texture, key, writer.getData());
+        }
+    }
+
+    void GltfImporter::importTexture(const std::vector<uint8_t>& rgba, TextureData& texture, ModelData& outModel)
+    {
+        // Also the ImportCache key of the processed texture.
+        uint64_t key = hashCombine(hashBytes(rgba.data(), rgba.size()), hashValue(texture.format == TextureFormat::RGBA8Srgb));
+        if (m_processTextures)
+        {
+            key = hashCombine(key, hashValue(m_textureOptions.generateMips));
+            key = hashCombine(key, hashValue(m_textureOptions.mipFilter));
+            key = hashCombine(key, hashValue(m_textureOptions.compress));
+        }
+        texture.contentHash = key;
+
+        TextureResource built;
+        const TextureResource* pResource = &built;
+        if (m_pResourceCache)
+        {
+            texture.resource = m_pResourceCache->acquireTexture(texture.uri, key, [&](TextureResource& outResource)
+            {
+                buildTexture(rgba, texture, key, outResource);
+                return true;
+            });
+            pResource = texture.resource.get();
+        }
+        else
+        {
+            buildTexture(rgba, texture, key, built);
+        }
+
+        // Shared textures keep their texels in the resource; mip offsets stay relative to it.
+        const uint64_t base = texture.resource ? 0 : outModel.texels.size();
+        if (!texture.resource)
+        {
+            outModel.texels.insert(outModel.texels.end(), built.texels.begin(), built.texels.end());
+        }
+        texture.format = pResource->format;
+        texture.firstMip = static_cast<uint32_t>(outModel.textureMips.size());
+        texture.mipCount = static_cast<uint32_t>(pResource->mips.size());
+        for (TextureMipData mip : pResource->mips)
+        {
+            mip.offset += base;
+            outModel.textureMips.push_back(mip);
+        }
+    }
+
+    bool GltfImporter::importModel(const tinygltf::Model& gltfModel, ModelData& outModel)
+    {
+        m_error.clear();
+        m_warning.clear();
+        m_dependencies.clear();
+
+        GltfDocument document;
+        convertTinyGltf(gltfModel, document);
+        if (!checkRequiredExtensions(document, std::string(), m_error))
+        {
+            return false;
+        }
+        return importDocument(document, outModel);
+    }
+
+    bool GltfImporter::importDocument(const GltfDocument& document, ModelData& outModel)
+    {
+        outModel.vertices.clear();
+        outModel.vertexColors.clear();
+        outModel.indices.clear();
+        outModel.primitives.clear();
+        outModel.lods.clear();
+        outModel.meshlets.clear();
+        outModel.meshes.clear();
+        outModel.materials.clear();
+        outModel.textures.clear();
+        outModel.textureMips.clear();
+        outModel.texels.clear();
+        outModel.nodes.clear();
+        outModel.lights.clear();
+        outModel.skinVertices.clear();
+        outModel.morphTargets.clear();
+        outModel.morphDeltas.clear();
+        outModel.morphDeltaVertices.clear();
+        outModel.morphWeights.clear();
+        outModel.skins.clear();
+        outModel.joints.clear();
+        outModel.animations.clear();
+        outModel.animationChannels.clear();
+        outModel.animationTimes.clear();
+        outModel.animationValues.clear();
+        outModel.animationPackedValues.clear();
+        outModel.bounds = Bounds();
+        m_animationStats = AnimationCompressionStats();
+
+        for (const GltfMaterial& gltfMaterial : document.materials)
+        {
+            MaterialData material;
+            std::memcpy(material.baseColorFactor, gltfMaterial.baseColorFactor, sizeof(material.baseColorFactor));
+            std::memcpy(material.emissiveFactor, gltfMaterial.emissiveFactor, sizeof(material.emissiveFactor));
+            material.metallicFactor = gltfMaterial.metallicFactor;
+            material.roughnessFactor = gltfMaterial.roughnessFactor;
+            material.normalScale = gltfMaterial.normalScale;
+            material.occlusionStrength = gltfMaterial.occlusionStrength;
+            material.alphaCutoff = gltfMaterial.alphaCutoff;
+            material.alphaMode = static_cast<AlphaMode>(gltfMaterial.alphaMode);
+            material.doubleSided = gltfMaterial.doubleSided;
+            // glTF textures name an image; model textures are one per image.
+            auto imageOf = [&document](int32_t textureIndex)
+            {
+                return textureIndex >= 0 && textureIndex < static_cast<int32_t>(document.textures.size()) ? document.textures[textureIndex] : -1;
+            };
+            material.baseColorTexture = imageOf(gltfMaterial.baseColorTexture);
+            material.metallicRoughnessTexture = imageOf(gltfMaterial.metallicRoughnessTexture);
+            material.normalTexture = imageOf(gltfMaterial.normalTexture);
+            material.occlusionTexture = imageOf(gltfMaterial.occlusionTexture);
+            material.emissiveTexture = imageOf(gltfMaterial.emissiveTexture);
+
+            // Extensions become flags and parameters here, so nothing after
+            // import looks at their names. Flags whose effect is nil are
+            // dropped to keep such materials on the plain shader variants.
+            material.flags = gltfMaterial.flags;
+            material.emissiveStrength = gltfMaterial.emissiveStrength;
+            material.clearcoatFactor = gltfMaterial.clearcoatFactor;
+            material.clearcoatRoughnessFactor = gltfMaterial.clearcoatRoughnessFactor;
+            if (!(material.clearcoatFactor > 0.0f))
+            {
+                material.flags &= ~kMaterialClearcoat;
+            }
+            for (uint32_t slot = 0; slot < kMaterialTextureCount; ++slot)
+            {
+                material.textureTransforms[slot] = toTextureTransform(gltfMaterial.textureTransforms[slot]);
+                if (!material.textureTransforms[slot].isIdentity())
+                {
+                    material.flags |= kMaterialTextureTransform;
+                }
+            }
+            outModel.materials.push_back(material);
+        }
+
+        // Images were decoded up front; their colour space is only known once
+        // every material has been read.
+        const size_t separator = outModel.sourcePath.find_last_of('/');
+        const std::string baseDirectory = separator == std::string::npos ? std::string() : outModel.sourcePath.substr(0, separator + 1);
+        for (const GltfImage& image : document.images)
+        {
+            TextureData texture;
+            texture.name = image.name.empty() ? image.uri : image.name;
+            if (isExternalUri(image.uri))
+            {
+                texture.uri = baseDirectory + decodeUri(image.uri);
+            }
+            if (!image.rgba.empty())
+            {
+                texture.width = image.width;
+                texture.height = image.height;
+            }
+            else
+            {
+                m_warning += "Skipping undecodable image '" + texture.name + "'\n";
+            }
+            outModel.textures.push_back(texture);
+        }
+
+        // Colour textures are sampled as sRGB; everything else stays linear.
+        for (MaterialData& material : outModel.materials)
+        {
+            for (int32_t* pTexture : { &material.baseColorTexture, &material.metallicRoughnessTexture, &material.normalTexture,
+                                       &material.occlusionTexture, &material.emissiveTexture })
+            {
+                if (*pTexture >= static_cast<int32_t>(outModel.textures.size()))
+                {
+                    *pTexture = -1;
+                }
+            }
+            for (int32_t colorTexture : { material.baseColorTexture, material.emissiveTexture })
+            {
+                if (colorTexture >= 0)
+                {
+                    outModel.textures[colorTexture].format = TextureFormat::RGBA8Srgb;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < document.images.size(); ++i)
+        {
+            if (!document.images[i].rgba.empty())
+            {
+                importTexture(document.images[i].rgba, outModel.textures[i], outModel);
+            }
+        }
+
+        // Convert every primitive into a standalone chunk first. Chunks whose
+        // inputs hash to a cached entry skip conversion and processing.
+        ContentHasher hasher(document, m_pImportCache);
+        const uint64_t settingsHash = getMeshSettingsHash();
+        std::vector<PrimitiveChunk> chunks;
+
+        for (const GltfMesh& gltfMesh : document.meshes)
+        {
+            MeshData mesh;
+            mesh.name = gltfMesh.name;
+            mesh.firstPrimitive = static_cast<uint32_t>(outModel.primitives.size());
+
+            for (uint32_t p = 0; p < gltfMesh.primitiveCount; ++p)
+            {
+                const GltfPrimitive& gltfPrimitive = document.primitives[gltfMesh.firstPrimitive + p];
+                if (gltfPrimitive.mode != GltfPrimitive::kTriangles)
+                {
+                    m_warning += "Skipping non-triangle primitive in mesh '" + gltfMesh.name + "'\n";
+                    continue;
+                }
+                if (gltfPrimitive.dracoBufferView >= 0 && gltfPrimitive.position >= 0 &&
+                    gltfPrimitive.position < static_cast<int32_t>(document.accessors.size()) &&
+                    document.accessors[gltfPrimitive.position].bufferView < 0)
+                {
+                    // Optional Draco with no uncompressed fallback data.
+                    m_warning += "Skipping Draco-compressed primitive in mesh '" + gltfMesh.name + "'\n";
+                    continue;
+                }
+
+                PrimitiveChunk chunk;
+                if (m_pImportCache)
+                {
+                    chunk.key = hasher.hashPrimitive(gltfPrimitive, settingsHash);
+                    std::vector<uint8_t> payload;
+                    chunk.cached = m_pImportCache->load(ChunkKind::Mesh, chunk.key, payload) && readChunk(payload, chunk);
+                }
+                if (!chunk.cached)
+                {
+                    std::string problem;
+                    if (!convertPrimitive(document, gltfPrimitive, chunk, problem))
+                    {
+                        m_warning += "Skipping primitive with " + problem + " in mesh '" + gltfMesh.name + "'\n";
+                        continue;
+                    }
+                }
+
+                PrimitiveData primitive;
+                primitive.material = gltfPrimitive.material;
+                outModel.primitives.push_back(primitive);
+                chunks.push_back(std::move(chunk));
+            }
+
+            mesh.primitiveCount = static_cast<uint32_t>(outModel.primitives.size()) - mesh.firstPrimitive;
+            outModel.meshes.push_back(mesh);
+        }
+
+        // LODs and meshlets only for the chunks that missed, in parallel.
+        std::vector<size_t> pending;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            if (!chunks[i].cached)
+            {
+                pending.push_back(i);
+            }
+        }
+        parallelFor(pending.size(), m_workerThreadCount, [&](size_t i)
+        {
+            PrimitiveChunk& chunk = chunks[pending[i]];
+            processChunk(chunk, m_generateLods, m_lodOptions, m_generateMeshlets);
+            if (m_pImportCache)
+            {
+                ChunkWriter writer;
+                writeChunk(chunk, writer);
+                m_pImportCache->store(ChunkKind::Mesh, chunk.key, writer.getData());
+            }
+        });
+
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            appendChunk(chunks[i], outModel.primitives[i], outModel);
+        }
+
+        std::vector<int32_t> nodeMap(document.nodes.size(), -1);
+        if (!document.scenes.empty())
+        {
+            const int32_t sceneIndex =
+                document.defaultScene >= 0 && document.defaultScene < static_cast<int32_t>(document.scenes.size()) ? document.defaultScene : 0;
+            const GltfScene& scene = document.scenes[sceneIndex];
+            for (uint32_t i = 0; i < scene.nodeCount; ++i)
+            {
+                appendNode(document, document.sceneNodes[scene.firstNode + i], -1, 0, outModel, nodeMap);
+            }
+        }
+        else
+        {
+            // No scene graph: show every mesh once at the origin.
+            for (size_t i = 0; i < outModel.meshes.size(); ++i)
+            {
+                NodeData node;
+                node.mesh = static_cast<int32_t>(i);
+                outModel.nodes.push_back(node);
+            }
+        }
+
+        importSkins(document, nodeMap, outModel);
+        const uint32_t droppedChannels = importAnimations(document, nodeMap, outModel);
+        if (droppedChannels > 0)
+        {
+            m_warning += "Skipping " + std::to_string(droppedChannels) + " unsupported or unreadable animation channels\n";
+        }
+        if (m_compressAnimations)
+        {
+            m_animationStats = compressAnimations(outModel, m_animationOptions, m_workerThreadCount);
+        }
+
+        for (NodeData& node : outModel.nodes)
+        {
+            if (node.mesh < 0 || node.mesh >= static_cast<int32_t>(outModel.meshes.size()))
+            {
+                node.skin = -1;
+                continue;
+            }
+            if (node.skin >= 0 && !skinFitsMesh(outModel, node))
+            {
+                m_warning += "Ignoring a skin with fewer joints than its mesh addresses\n";
+                node.skin = -1;
+            }
+            const MeshData& mesh = outModel.meshes[node.mesh];
+            for (uint32_t i = 0; i < mesh.primitiveCount; ++i)
+            {
+                outModel.bounds.merge(transformBounds(node.worldMatrix, outModel.primitives[mesh.firstPrimitive + i].bounds));
+            }
+        }
+
+        if (m_quantizeVertices)
+        {
+            selectVertexFormats(outModel, m_quantizationOptions, m_workerThreadCount);
+        }
+
+        if (outModel.empty())
+        {
+            m_error = "glTF contains no drawable triangle primitives";
+            return false;
+        }
+
+        return true;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "AnimationCompressor.hpp"
+#include "MeshSimplifier.hpp"
+#include "MeshletBuilder.hpp"
+#include "ModelData.hpp"
+#include "TextureProcessor.hpp"
+#include "VertexQuantizer.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace tinygltf
+{
+    class Model;
+}
+
+namespace Pinnacle
+{
+    class ImportCache;
+    class ResourceCache;
+    struct GltfDocument;
+
+    // Converts glTF files into ModelData. Holds no GPU state, so several
+    // importers can run concurrently on loader threads.
+    class GltfImporter
+    {
+    public:
+        // Parses the file with the streaming parser (GltfParser.hpp); .glb
+        // files are read as binary containers. EXT_meshopt_compression views
+        // are decoded. Draco is not: files that require
+        // KHR_draco_mesh_compression fail (here and in importModel()), and
+        // primitives using it optionally import their uncompressed accessors.
+        bool importFile(const std::string& path, ModelData& outModel);
+        // For models already loaded through tinygltf.
+        bool importModel(const tinygltf::Model& gltfModel, ModelData& outModel);
+
+        // LOD chains, meshlets, texture processing (mips, BC7), vertex
+        // quantization and animation compression are off by default; all of
+        // them cost import time.
+        void setGenerateLods(bool enabled) { m_generateLods = enabled; }
+        void setGenerateMeshlets(bool enabled) { m_generateMeshlets = enabled; }
+        void setProcessTextures(bool enabled) { m_processTextures = enabled; }
+        void setQuantizeVertices(bool enabled) { m_quantizeVertices = enabled; }
+        void setCompressAnimations(bool enabled) { m_compressAnimations = enabled; }
+        void setLodOptions(const LodOptions& options) { m_lodOptions = options; }
+        void setTextureOptions(const TextureOptions& options) { m_textureOptions = options; }
+        void setVertexQuantizationOptions(const VertexQuantizationOptions& options) { m_quantizationOptions = options; }
+        void setAnimationCompressionOptions(const AnimationCompressionOptions& options) { m_animationOptions = options; }
+        void setWorkerThreadCount(unsigned int count) { m_workerThreadCount = count; } // 0 = hardware concurrency
+
+        // Optional chunk cache (not owned): decoded images and processed
+        // primitives whose inputs hash the same are reused instead of rebuilt.
+        void setImportCache(ImportCache* pCache) { m_pImportCache = pCache; }
+        ImportCache* getImportCache() const { return m_pImportCache; }
+
+        // Optional in-memory texture cache (not owned): textures go into
+        // shared resources instead of ModelData::texels, and one already
+        // held by another model is reused without processing.
+        void setResourceCache(ResourceCache* pCache) { m_pResourceCache = pCache; }
+        ResourceCache* getResourceCache() const { return m_pResourceCache; }
+
+        // Fingerprint of every setting that changes the imported result; part
+        // of the baked cache key.
+        uint64_t getSettingsHash() const;
+
+        // External files (buffers, images) the last importFile() read besides
+        // the glTF itself.
+        const std::vector<std::string>& getDependencies() const { return m_dependencies; }
+
+        // Savings of the last import's animation compression (all zero when
+        // it was off).
+        const AnimationCompressionStats& getAnimationCompressionStats() const { return m_animationStats; }
+
+        const std::string& getError() const { return m_error; }
+        const std::string& getWarning() const { return m_warning; }
+
+    private:
+        bool importDocument(const GltfDocument& document, ModelData& outModel);
+        // The part of getSettingsHash() that mesh chunks depend on, so a
+        // texture or animation setting change keeps them cached.
+        uint64_t getMeshSettingsHash() const;
+        void buildTexture(const std::vector<uint8_t>& rgba, const TextureData& texture, uint64_t key,
+                          TextureResource& outResource);
+        void importTexture(const std::vector<uint8_t>& rgba, TextureData& texture, ModelData& outModel);
+
+        std::string m_error;
+        std::string m_warning;
+        std::vector<std::string> m_dependencies;
+        bool m_generateLods = false;
+        bool m_generateMeshlets = false;
+        bool m_processTextures = false;
+        bool m_quantizeVertices = false;
+        bool m_compressAnimations = false;
+        LodOptions m_lodOptions;
+        TextureOptions m_textureOptions;
+        VertexQuantizationOptions m_quantizationOptions;
+        AnimationCompressionOptions m_animationOptions;
+        AnimationCompressionStats m_animationStats;
+        unsigned int m_workerThreadCount = 0;
+        ImportCache* m_pImportCache = nullptr;
+        ResourceCache* m_pResourceCache = nullptr;
+    };
+} // namespace Pinnacle
@@ -0,0 +1,1236 @@
+#include "GltfParser.hpp"
+
+#include "GltfExtensions.hpp"
+#include "ModelData.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string_view>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const uint64_t kOnes = 0x0101010101010101ull;
+        const uint64_t kHighBits = 0x8080808080808080ull;
+
+        // High bit set in every byte of `word` equal to `byte`. Bytes above a
+        // match may report false positives, so only the lowest set bit counts.
+        uint64_t matchByte(uint64_t word, uint8_t byte)
+        {
+            const uint64_t x = word ^ (kOnes * byte);
+            return (x - kOnes) & ~x & kHighBits;
+        }
+
+        void appendUtf8(uint32_t codePoint, std::string& out)
+        {
+            if (codePoint < 0x80)
+            {
+                out += static_cast<char>(codePoint);
+            }
+            else if (codePoint < 0x800)
+            {
+                out += static_cast<char>(0xC0 | (codePoint >> 6));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else if (codePoint < 0x10000)
+            {
+                out += static_cast<char>(0xE0 | (codePoint >> 12));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+            else
+            {
+                out += static_cast<char>(0xF0 | (codePoint >> 18));
+                out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (codePoint & 0x3F));
+            }
+        }
+
+        // Pull reader over JSON text. Values the caller does not ask for are
+        // skipped by matching brackets and string quotes only; nothing of
+        // them is decoded or validated.
+        class JsonReader
+        {
+        public:
+            JsonReader(const char* pText, size_t size) : m_pBegin(pText), m_p(pText), m_pEnd(pText + size) {}
+
+            bool fail(const char* pMessage)
+            {
+                if (!m_pMessage)
+                {
+                    m_pMessage = pMessage;
+                    m_failOffset = static_cast<size_t>(m_p - m_pBegin);
+                }
+                return false;
+            }
+
+            const char* getMessage() const { return m_pMessage; }
+            size_t getFailOffset() const { return m_failOffset; }
+
+            bool atEnd()
+            {
+                skipWhitespace();
+                return m_p == m_pEnd;
+            }
+
+            // Calls `member(key)` for every member; it must consume the value.
+            // Keys with escape sequences are passed as empty.
+            template <typename Member>
+            bool readObject(const Member& member)
+            {
+                if (!expect('{'))
+                {
+                    return false;
+                }
+                if (consume('}'))
+                {
+                    return true;
+                }
+                for (;;)
+                {
+                    const char* pKey;
+                    size_t length;
+                    bool hasEscapes;
+                    if (!scanString(pKey, length, hasEscapes) || !expect(':') ||
+                        !member(hasEscapes ? std::string_view() : std::string_view(pKey, length)))
+                    {
+                        return false;
+                    }
+                    if (!consume(','))
+                    {
+                        return expect('}');
+                    }
+                }
+            }
+
+            // Calls `element()` for every element; it must consume the value.
+            template <typename Element>
+            bool readArray(const Element& element)
+            {
+                if (!expect('['))
+                {
+                    return false;
+                }
+                if (consume(']'))
+                {
+                    return true;
+                }
+                for (;;)
+                {
+                    if (!element())
+                    {
+                        return false;
+                    }
+                    if (!consume(','))
+                    {
+                        return expect(']');
+                    }
+                }
+            }
+
+            bool readString(std::string& out)
+            {
+                const char* pStart;
+                size_t length;
+                bool hasEscapes;
+                if (!scanString(pStart, length, hasEscapes))
+                {
+                    return false;
+                }
+                if (!hasEscapes)
+                {
+                    out.assign(pStart, length);
+                    return true;
+                }
+                return unescape(pStart, length, out);
+            }
+
+            bool readNumber(double& out)
+            {
+                skipWhitespace();
+                const bool negative = m_p < m_pEnd && *m_p == '-';
+                m_p += negative ? 1 : 0;
+                if (m_p >= m_pEnd || !isDigit(*m_p))
+                {
+                    return fail("expected a number");
+                }
+
+                // Up to 19 significant digits are exact in the mantissa; float
+                // attributes and byte offsets never need more.
+                uint64_t mantissa = 0;
+                int digits = 0;
+                int exponent = 0;
+                for (; m_p < m_pEnd && isDigit(*m_p); ++m_p)
+                {
+                    if (digits < 19)
+                    {
+                        mantissa = mantissa * 10 + static_cast<uint64_t>(*m_p - '0');
+                        digits += mantissa != 0 ? 1 : 0;
+                    }
+                    else
+                    {
+                        exponent++;
+                    }
+                }
+                if (m_p < m_pEnd && *m_p == '.')
+                {
+                    for (++m_p; m_p < m_pEnd && isDigit(*m_p); ++m_p)
+                    {
+                        if (digits < 19)
+                        {
+                            mantissa = mantissa * 10 + static_cast<uint64_t>(*m_p - '0');
+                            digits += mantissa != 0 ? 1 : 0;
+                            exponent--;
+                        }
+                    }
+                }
+                if (m_p < m_pEnd && (*m_p == 'e' || *m_p == 'E'))
+                {
+                    ++m_p;
+                    const bool negativeExponent = m_p < m_pEnd && *m_p == '-';
+                    m_p += (m_p < m_pEnd && (*m_p == '-' || *m_p == '+')) ? 1 : 0;
+                    int value = 0;
+                    for (; m_p < m_pEnd && isDigit(*m_p); ++m_p)
+                    {
+                        value = value < 10000 ? value * 10 + (*m_p - '0') : value;
+                    }
+                    exponent += negativeExponent ? -value : value;
+                }
+
+                static const double kPowers[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+                double value = static_cast<double>(mantissa);
+                if (exponent >= 0)
+                {
+                    value *= exponent <= 22 ? kPowers[exponent] : std::pow(10.0, exponent);
+                }
+                else
+                {
+                    value /= exponent >= -22 ? kPowers[-exponent] : std::pow(10.0, -exponent);
+                }
+                out = negative ? -value : value;
+                return true;
+            }
+
+            bool readFloat(float& out)
+            {
+                double value;
+                if (!readNumber(value))
+                {
+                    return false;
+                }
+                out = static_cast<float>(value);
+                return true;
+            }
+
+            bool readInt(int32_t& out)
+            {
+                double value;
+                if (!readNumber(value))
+                {
+                    return false;
+                }
+                out = value >= -2147483648.0 && value <= 2147483647.0 ? static_cast<int32_t>(value) : -1;
+                return true;
+            }
+
+            bool readUint64(uint64_t& out)
+            {
+                double value;
+                if (!readNumber(value))
+                {
+                    return false;
+                }
+                if (value >= 18446744073709551616.0) // 2^64
+                {
+                    return fail("number is too large");
+                }
+                out = value > 0.0 ? static_cast<uint64_t>(value) : 0;
+                return true;
+            }
+
+            bool readBool(bool& out)
+            {
+                skipWhitespace();
+                if (matchLiteral("true"))
+                {
+                    out = true;
+                    return true;
+                }
+                if (matchLiteral("false"))
+                {
+                    out = false;
+                    return true;
+                }
+                return fail("expected true or false");
+            }
+
+            // Reads up to `capacity` numbers of an array; extra elements are ignored.
+            bool readFloats(float* pOut, size_t capacity)
+            {
+                size_t count = 0;
+                return readArray([&]()
+                {
+                    float value;
+                    if (!readFloat(value))
+                    {
+                        return false;
+                    }
+                    if (count < capacity)
+                    {
+                        pOut[count] = value;
+                    }
+                    count++;
+                    return true;
+                });
+            }
+
+            bool readFloats(std::vector<float>& out)
+            {
+                return readArray([&]()
+                {
+                    float value;
+                    if (!readFloat(value))
+                    {
+                        return false;
+                    }
+                    out.push_back(value);
+                    return true;
+                });
+            }
+
+            bool readInts(std::vector<int32_t>& out)
+            {
+                return readArray([&]()
+                {
+                    int32_t value;
+                    if (!readInt(value))
+                    {
+                        return false;
+                    }
+                    out.push_back(value);
+                    return true;
+                });
+            }
+
+            bool skipValue()
+            {
+                skipWhitespace();
+                if (m_p >= m_pEnd)
+                {
+                    return fail("expected a value");
+                }
+                const char* pStart;
+                size_t length;
+                bool hasEscapes;
+                if (*m_p == '"')
+                {
+                    return scanString(pStart, length, hasEscapes);
+                }
+                if (*m_p == '{' || *m_p == '[')
+                {
+                    // Iterative, so deeply nested extras cannot exhaust the stack.
+                    size_t depth = 0;
+                    while (m_p < m_pEnd)
+                    {
+                        const char c = *m_p;
+                        if (c == '"')
+                        {
+                            if (!scanString(pStart, length, hasEscapes))
+                            {
+                                return false;
+                            }
+                            continue;
+                        }
+                        ++m_p;
+                        if (c == '{' || c == '[')
+                        {
+                            depth++;
+                        }
+                        else if ((c == '}' || c == ']') && --depth == 0)
+                        {
+                            return true;
+                        }
+                    }
+                    return fail("unterminated object or array");
+                }
+
+                // Number or literal.
+                const char* pValue = m_p;
+                while (m_p < m_pEnd && *m_p != ',' && *m_p != '}' && *m_p != ']' && !isWhitespace(*m_p))
+                {
+                    ++m_p;
+                }
+                return m_p != pValue || fail("expected a value");
+            }
+
+        private:
+            static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+            static bool isWhitespace(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+            void skipWhitespace()
+            {
+                while (m_p < m_pEnd && isWhitespace(*m_p))
+                {
+                    ++m_p;
+                }
+            }
+
+            bool consume(char c)
+            {
+                skipWhitespace();
+                if (m_p < m_pEnd && *m_p == c)
+                {
+                    ++m_p;
+                    return true;
+                }
+                return false;
+            }
+
+            bool expect(char c)
+            {
+                if (consume(c))
+                {
+                    return true;
+                }
+                switch (c)
+                {
+                    case '{': return fail("expected '{'");
+                    case '}': return fail("expected ',' or '}'");
+                    case '[': return fail("expected '['");
+                    case ']': return fail("expected ',' or ']'");
+                    case ':': return fail("expected ':'");
+                    default: return fail("expected a string");
+                }
+            }
+
+            bool matchLiteral(const char* pLiteral)
+            {
+                const size_t length = std::strlen(pLiteral);
+                if (static_cast<size_t>(m_pEnd - m_p) >= length && std::memcmp(m_p, pLiteral, length) == 0)
+                {
+                    m_p += length;
+                    return true;
+                }
+                return false;
+            }
+
+            // Finds the extent of a string without decoding it. Most of the
+            // text in a large glTF is strings and skipped values, so the
+            // search for the closing quote tests eight bytes per step.
+            bool scanString(const char*& pStart, size_t& length, bool& hasEscapes)
+            {
+                if (!expect('"'))
+                {
+                    return false;
+                }
+                pStart = m_p;
+                hasEscapes = false;
+                for (;;)
+                {
+                    while (m_pEnd - m_p >= 8)
+                    {
+                        uint64_t word;
+                        std::memcpy(&word, m_p, sizeof(word));
+                        const uint64_t hits = matchByte(word, '"') | matchByte(word, '\\');
+                        if (hits != 0)
+                        {
+                            // Little-endian: the lowest hit is the first byte in memory.
+                            m_p += __builtin_ctzll(hits) / 8;
+                            break;
+                        }
+                        m_p += 8;
+                    }
+                    while (m_p < m_pEnd && *m_p != '"' && *m_p != '\\')
+                    {
+                        ++m_p;
+                    }
+                    if (m_p >= m_pEnd)
+                    {
+                        return fail("unterminated string");
+                    }
+                    if (*m_p == '"')
+                    {
+                        length = static_cast<size_t>(m_p - pStart);
+                        ++m_p;
+                        return true;
+                    }
+                    hasEscapes = true;
+                    if (m_pEnd - m_p < 2)
+                    {
+                        return fail("unterminated string");
+                    }
+                    m_p += 2;
+                }
+            }
+
+            bool readHex4(const char* p, uint32_t& out)
+            {
+                out = 0;
+                for (int i = 0; i < 4; ++i)
+                {
+                    const char c = p[i];
+                    const uint32_t digit = isDigit(c) ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : 16;
+                    if (digit > 15)
+                    {
+                        return false;
+                    }
+                    out = out * 16 + digit;
+                }
+                return true;
+            }
+
+            bool unescape(const char* p, size_t length, std::string& out)
+            {
+                out.clear();
+                out.reserve(length);
+                const char* pEnd = p + length;
+                while (p < pEnd)
+                {
+                    if (*p != '\\')
+                    {
+                        out += *p++;
+                        continue;
+                    }
+                    // scanString() guarantees a character after every backslash.
+                    const char c = p[1];
+                    p += 2;
+                    switch (c)
+                    {
+                        case '"': out += '"'; break;
+                        case '\\': out += '\\'; break;
+                        case '/': out += '/'; break;
+                        case 'b': out += '\b'; break;
+                        case 'f': out += '\f'; break;
+                        case 'n': out += '\n'; break;
+                        case 'r': out += '\r'; break;
+                        case 't': out += '\t'; break;
+                        case 'u':
+                        {
+                            uint32_t codePoint;
+                            if (pEnd - p < 4 || !readHex4(p, codePoint))
+                            {
+                                return fail("invalid \\u escape");
+                            }
+                            p += 4;
+                            uint32_t low;
+                            if (codePoint >= 0xD800 && codePoint < 0xDC00 && pEnd - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                                readHex4(p + 2, low) && low >= 0xDC00 && low < 0xE000)
+                            {
+                                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                                p += 6;
+                            }
+                            appendUtf8(codePoint, out);
+                            break;
+                        }
+                        default:
+                            return fail("invalid escape sequence");
+                    }
+                }
+                return true;
+            }
+
+            const char* m_pBegin;
+            const char* m_p;
+            const char* m_pEnd;
+            const char* m_pMessage = nullptr;
+            size_t m_failOffset = 0;
+        };
+
+        int32_t getComponentCount(const std::string& type)
+        {
+            if (type == "SCALAR") return 1;
+            if (type == "VEC2") return 2;
+            if (type == "VEC3") return 3;
+            if (type == "VEC4" || type == "MAT2") return 4;
+            if (type == "MAT3") return 9;
+            if (type == "MAT4") return 16;
+            return 0;
+        }
+
+        // Reads an "extensions" object, handing `parse` the reader positioned
+        // on the value of `name`; every other extension is skipped.
+        template <typename Parse>
+        bool parseExtension(JsonReader& reader, std::string_view name, const Parse& parse)
+        {
+            return reader.readObject([&](std::string_view extension)
+            {
+                return extension == name ? parse() : reader.skipValue();
+            });
+        }
+
+        bool parseBuffer(JsonReader& reader, GltfBuffer& buffer)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "uri") return reader.readString(buffer.uri);
+                if (key == "byteLength") return reader.readUint64(buffer.byteLength);
+                if (key != "extensions") return reader.skipValue();
+                return parseExtension(reader, "EXT_meshopt_compression", [&]()
+                {
+                    return reader.readObject([&](std::string_view meshoptKey)
+                    {
+                        return meshoptKey == "fallback" ? reader.readBool(buffer.isFallback) : reader.skipValue();
+                    });
+                });
+            });
+        }
+
+        bool parseMeshoptCompression(JsonReader& reader, GltfMeshoptCompression& compression)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "buffer") return reader.readInt(compression.buffer);
+                if (key == "byteOffset") return reader.readUint64(compression.byteOffset);
+                if (key == "byteLength") return reader.readUint64(compression.byteLength);
+                if (key == "count") return reader.readUint64(compression.count);
+                if (key == "byteStride")
+                {
+                    uint64_t stride;
+                    if (!reader.readUint64(stride))
+                    {
+                        return false;
+                    }
+                    if (stride > 256)
+                    {
+                        return reader.fail("EXT_meshopt_compression byteStride is over 256");
+                    }
+                    compression.byteStride = static_cast<uint32_t>(stride);
+                    return true;
+                }
+                if (key == "mode" || key == "filter")
+                {
+                    std::string value;
+                    if (!reader.readString(value))
+                    {
+                        return false;
+                    }
+                    using Mode = GltfMeshoptCompression::Mode;
+                    using Filter = GltfMeshoptCompression::Filter;
+                    if (value == "ATTRIBUTES") compression.mode = Mode::Attributes;
+                    else if (value == "TRIANGLES") compression.mode = Mode::Triangles;
+                    else if (value == "INDICES") compression.mode = Mode::Indices;
+                    else if (value == "NONE") compression.filter = Filter::None;
+                    else if (value == "OCTAHEDRAL") compression.filter = Filter::Octahedral;
+                    else if (value == "QUATERNION") compression.filter = Filter::Quaternion;
+                    else if (value == "EXPONENTIAL") compression.filter = Filter::Exponential;
+                    else return reader.fail("unknown EXT_meshopt_compression mode or filter");
+                    return true;
+                }
+                return reader.skipValue();
+            });
+        }
+
+        bool parseBufferView(JsonReader& reader, GltfBufferView& view)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "buffer") return reader.readInt(view.buffer);
+                if (key == "byteOffset") return reader.readUint64(view.byteOffset);
+                if (key == "byteLength") return reader.readUint64(view.byteLength);
+                if (key == "byteStride")
+                {
+                    uint64_t stride;
+                    if (!reader.readUint64(stride))
+                    {
+                        return false;
+                    }
+                    if (stride > 252)
+                    {
+                        return reader.fail("bufferView byteStride is over 252");
+                    }
+                    view.byteStride = static_cast<uint32_t>(stride);
+                    return true;
+                }
+                if (key != "extensions") return reader.skipValue();
+                return parseExtension(reader, "EXT_meshopt_compression", [&]()
+                {
+                    return parseMeshoptCompression(reader, view.meshopt);
+                });
+            });
+        }
+
+        bool parseAccessor(JsonReader& reader, GltfAccessor& accessor)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "bufferView") return reader.readInt(accessor.bufferView);
+                if (key == "byteOffset") return reader.readUint64(accessor.byteOffset);
+                if (key == "count") return reader.readUint64(accessor.count);
+                if (key == "normalized") return reader.readBool(accessor.normalized);
+                if (key == "componentType")
+                {
+                    int32_t type;
+                    if (!reader.readInt(type))
+                    {
+                        return false;
+                    }
+                    accessor.componentType = static_cast<GltfComponentType>(type);
+                    return true;
+                }
+                if (key == "type")
+                {
+                    std::string type;
+                    if (!reader.readString(type))
+                    {
+                        return false;
+                    }
+                    accessor.componentCount = getComponentCount(type);
+                    return true;
+                }
+                if (key != "sparse") return reader.skipValue();
+                GltfSparseAccessor& sparse = accessor.sparse;
+                return reader.readObject([&](std::string_view sparseKey)
+                {
+                    if (sparseKey == "count") return reader.readUint64(sparse.count);
+                    if (sparseKey == "indices")
+                    {
+                        return reader.readObject([&](std::string_view indicesKey)
+                        {
+                            if (indicesKey == "bufferView") return reader.readInt(sparse.indicesBufferView);
+                            if (indicesKey == "byteOffset") return reader.readUint64(sparse.indicesByteOffset);
+                            if (indicesKey != "componentType") return reader.skipValue();
+                            int32_t type;
+                            if (!reader.readInt(type))
+                            {
+                                return false;
+                            }
+                            sparse.indicesComponentType = static_cast<GltfComponentType>(type);
+                            return true;
+                        });
+                    }
+                    if (sparseKey != "values") return reader.skipValue();
+                    return reader.readObject([&](std::string_view valuesKey)
+                    {
+                        if (valuesKey == "bufferView") return reader.readInt(sparse.valuesBufferView);
+                        return valuesKey == "byteOffset" ? reader.readUint64(sparse.valuesByteOffset) : reader.skipValue();
+                    });
+                });
+            });
+        }
+
+        bool parseImage(JsonReader& reader, GltfImage& image)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "name") return reader.readString(image.name);
+                if (key == "uri") return reader.readString(image.uri);
+                if (key == "mimeType") return reader.readString(image.mimeType);
+                if (key == "bufferView") return reader.readInt(image.bufferView);
+                return reader.skipValue();
+            });
+        }
+
+        bool parseTexture(JsonReader& reader, int32_t& source)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                return key == "source" ? reader.readInt(source) : reader.skipValue();
+            });
+        }
+
+        static_assert(sizeof(GltfMaterial::textureTransforms) / sizeof(GltfTextureTransform) == kMaterialTextureCount,
+                      "GltfMaterial holds one texture transform per MaterialTexture slot");
+
+        // Reads one extension object through its handler: listed members
+        // into `pBlock`, every other member skipped.
+        bool parseHandledExtension(JsonReader& reader, const GltfExtensionHandler& handler, void* pBlock)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                const GltfExtensionField* pField = handler.findField(key);
+                if (!pField)
+                {
+                    return reader.skipValue();
+                }
+                const uint32_t count = getComponentCount(pField->type);
+                float* pValues = getFieldValues(*pField, pBlock);
+                return count == 1 ? reader.readFloat(*pValues) : reader.readFloats(pValues, count);
+            });
+        }
+
+        // Reads an "extensions" object of a `target` object, applying the
+        // registered handler of each extension and skipping the others.
+        bool parseRegisteredExtensions(JsonReader& reader, GltfExtensionTarget target, void* pBlock, uint32_t& flags)
+        {
+            const GltfExtensionRegistry& registry = GltfExtensionRegistry::getShared();
+            return reader.readObject([&](std::string_view extension)
+            {
+                const GltfExtensionHandler* pHandler = registry.findHandler(extension, target);
+                if (!pHandler)
+                {
+                    return reader.skipValue();
+                }
+                flags |= pHandler->flags;
+                return parseHandledExtension(reader, *pHandler, pBlock);
+            });
+        }
+
+        // Reads a textureInfo object: its "index", an optional extra factor
+        // ("scale" of a normal texture, "strength" of an occlusion texture)
+        // and its extensions (KHR_texture_transform).
+        bool parseTextureInfo(JsonReader& reader, int32_t& texture, GltfTextureTransform& transform,
+                              std::string_view factorKey = std::string_view(), float* pFactor = nullptr)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "index") return reader.readInt(texture);
+                if (pFactor && key == factorKey) return reader.readFloat(*pFactor);
+                if (key != "extensions") return reader.skipValue();
+                uint32_t flags = 0; // Texture extensions set no material flags
+                return parseRegisteredExtensions(reader, GltfExtensionTarget::TextureInfo, &transform, flags);
+            });
+        }
+
+        bool parseMaterial(JsonReader& reader, GltfMaterial& material)
+        {
+            GltfTextureTransform* pTransforms = material.textureTransforms;
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "doubleSided") return reader.readBool(material.doubleSided);
+                if (key == "emissiveFactor") return reader.readFloats(material.emissiveFactor, 3);
+                if (key == "alphaCutoff") return reader.readFloat(material.alphaCutoff);
+                if (key == "emissiveTexture")
+                {
+                    return parseTextureInfo(reader, material.emissiveTexture, pTransforms[kMaterialEmissiveTexture]);
+                }
+                if (key == "normalTexture")
+                {
+                    return parseTextureInfo(reader, material.normalTexture, pTransforms[kMaterialNormalTexture], "scale",
+                                            &material.normalScale);
+                }
+                if (key == "occlusionTexture")
+                {
+                    return parseTextureInfo(reader, material.occlusionTexture, pTransforms[kMaterialOcclusionTexture], "strength",
+                                            &material.occlusionStrength);
+                }
+                if (key == "extensions")
+                {
+                    return parseRegisteredExtensions(reader, GltfExtensionTarget::Material, &material, material.flags);
+                }
+                if (key == "alphaMode")
+                {
+                    std::string mode;
+                    if (!reader.readString(mode))
+                    {
+                        return false;
+                    }
+                    material.alphaMode = mode == "MASK"    ? GltfMaterial::AlphaMode::Mask
+                                         : mode == "BLEND" ? GltfMaterial::AlphaMode::Blend
+                                                           : GltfMaterial::AlphaMode::Opaque;
+                    return true;
+                }
+                if (key != "pbrMetallicRoughness") return reader.skipValue();
+                return reader.readObject([&](std::string_view pbrKey)
+                {
+                    if (pbrKey == "baseColorFactor") return reader.readFloats(material.baseColorFactor, 4);
+                    if (pbrKey == "metallicFactor") return reader.readFloat(material.metallicFactor);
+                    if (pbrKey == "roughnessFactor") return reader.readFloat(material.roughnessFactor);
+                    if (pbrKey == "baseColorTexture")
+                    {
+                        return parseTextureInfo(reader, material.baseColorTexture, pTransforms[kMaterialBaseColorTexture]);
+                    }
+                    if (pbrKey == "metallicRoughnessTexture")
+                    {
+                        return parseTextureInfo(reader, material.metallicRoughnessTexture,
+                                                pTransforms[kMaterialMetallicRoughnessTexture]);
+                    }
+                    return reader.skipValue();
+                });
+            });
+        }
+
+        bool parseMorphTarget(JsonReader& reader, GltfMorphTarget& target)
+        {
+            return reader.readObject([&](std::string_view attribute)
+            {
+                if (attribute == "POSITION") return reader.readInt(target.position);
+                if (attribute == "NORMAL") return reader.readInt(target.normal);
+                if (attribute == "TEXCOORD_0") return reader.readInt(target.texCoord0);
+                return reader.skipValue();
+            });
+        }
+
+        bool parsePrimitive(JsonReader& reader, GltfDocument& document, GltfPrimitive& primitive)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "indices") return reader.readInt(primitive.indices);
+                if (key == "targets")
+                {
+                    primitive.firstTarget = static_cast<uint32_t>(document.morphTargets.size());
+                    const bool parsed = reader.readArray([&]()
+                    {
+                        document.morphTargets.emplace_back();
+                        return parseMorphTarget(reader, document.morphTargets.back());
+                    });
+                    primitive.targetCount = static_cast<uint32_t>(document.morphTargets.size()) - primitive.firstTarget;
+                    return parsed;
+                }
+                if (key == "material") return reader.readInt(primitive.material);
+                if (key == "mode") return reader.readInt(primitive.mode);
+                if (key == "extensions")
+                {
+                    return parseExtension(reader, "KHR_draco_mesh_compression", [&]()
+                    {
+                        return reader.readObject([&](std::string_view dracoKey)
+                        {
+                            return dracoKey == "bufferView" ? reader.readInt(primitive.dracoBufferView) : reader.skipValue();
+                        });
+                    });
+                }
+                if (key != "attributes") return reader.skipValue();
+                return reader.readObject([&](std::string_view attribute)
+                {
+                    if (attribute == "POSITION") return reader.readInt(primitive.position);
+                    if (attribute == "NORMAL") return reader.readInt(primitive.normal);
+                    if (attribute == "TEXCOORD_0") return reader.readInt(primitive.texCoord0);
+                    if (attribute == "COLOR_0") return reader.readInt(primitive.color0);
+                    if (attribute == "JOINTS_0") return reader.readInt(primitive.joints0);
+                    if (attribute == "WEIGHTS_0") return reader.readInt(primitive.weights0);
+                    return reader.skipValue();
+                });
+            });
+        }
+
+        bool parseMesh(JsonReader& reader, GltfDocument& document, GltfMesh& mesh)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "name") return reader.readString(mesh.name);
+                if (key == "weights")
+                {
+                    mesh.firstWeight = static_cast<uint32_t>(document.morphWeights.size());
+                    const bool parsed = reader.readFloats(document.morphWeights);
+                    mesh.weightCount = static_cast<uint32_t>(document.morphWeights.size()) - mesh.firstWeight;
+                    return parsed;
+                }
+                if (key != "primitives") return reader.skipValue();
+                mesh.firstPrimitive = static_cast<uint32_t>(document.primitives.size());
+                const bool parsed = reader.readArray([&]()
+                {
+                    document.primitives.emplace_back();
+                    return parsePrimitive(reader, document, document.primitives.back());
+                });
+                mesh.primitiveCount = static_cast<uint32_t>(document.primitives.size()) - mesh.firstPrimitive;
+                return parsed;
+            });
+        }
+
+        bool parseLight(JsonReader& reader, GltfLight& light)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "color") return reader.readFloats(light.color, 3);
+                if (key == "intensity") return reader.readFloat(light.intensity);
+                if (key == "range") return reader.readFloat(light.range);
+                if (key == "type")
+                {
+                    std::string type;
+                    if (!reader.readString(type))
+                    {
+                        return false;
+                    }
+                    if (type == "directional") light.type = GltfLight::Type::Directional;
+                    else if (type == "point") light.type = GltfLight::Type::Point;
+                    else if (type == "spot") light.type = GltfLight::Type::Spot;
+                    else return reader.fail("unknown light type");
+                    return true;
+                }
+                if (key == "spot")
+                {
+                    return reader.readObject([&](std::string_view spotKey)
+                    {
+                        if (spotKey == "innerConeAngle") return reader.readFloat(light.innerConeAngle);
+                        if (spotKey == "outerConeAngle") return reader.readFloat(light.outerConeAngle);
+                        return reader.skipValue();
+                    });
+                }
+                return reader.skipValue();
+            });
+        }
+
+        bool parseNode(JsonReader& reader, GltfDocument& document, GltfNode& node)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "mesh") return reader.readInt(node.mesh);
+                if (key == "skin") return reader.readInt(node.skin);
+                if (key == "extensions")
+                {
+                    return parseExtension(reader, "KHR_lights_punctual", [&]()
+                    {
+                        return reader.readObject([&](std::string_view lightKey)
+                        {
+                            return lightKey == "light" ? reader.readInt(node.light) : reader.skipValue();
+                        });
+                    });
+                }
+                if (key == "translation") return reader.readFloats(node.translation, 3);
+                if (key == "rotation") return reader.readFloats(node.rotation, 4);
+                if (key == "scale") return reader.readFloats(node.scale, 3);
+                if (key == "matrix")
+                {
+                    node.hasMatrix = true;
+                    return reader.readFloats(node.matrix, 16);
+                }
+                if (key == "children")
+                {
+                    node.firstChild = static_cast<uint32_t>(document.nodeChildren.size());
+                    const bool parsed = reader.readInts(document.nodeChildren);
+                    node.childCount = static_cast<uint32_t>(document.nodeChildren.size()) - node.firstChild;
+                    return parsed;
+                }
+                if (key == "weights")
+                {
+                    node.firstWeight = static_cast<uint32_t>(document.morphWeights.size());
+                    const bool parsed = reader.readFloats(document.morphWeights);
+                    node.weightCount = static_cast<uint32_t>(document.morphWeights.size()) - node.firstWeight;
+                    return parsed;
+                }
+                return reader.skipValue();
+            });
+        }
+
+        bool parseScene(JsonReader& reader, GltfDocument& document, GltfScene& scene)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key != "nodes") return reader.skipValue();
+                scene.firstNode = static_cast<uint32_t>(document.sceneNodes.size());
+                const bool parsed = reader.readInts(document.sceneNodes);
+                scene.nodeCount = static_cast<uint32_t>(document.sceneNodes.size()) - scene.firstNode;
+                return parsed;
+            });
+        }
+
+        bool parseSkin(JsonReader& reader, GltfDocument& document, GltfSkin& skin)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "inverseBindMatrices") return reader.readInt(skin.inverseBindMatrices);
+                if (key != "joints") return reader.skipValue();
+                skin.firstJoint = static_cast<uint32_t>(document.skinJoints.size());
+                const bool parsed = reader.readInts(document.skinJoints);
+                skin.jointCount = static_cast<uint32_t>(document.skinJoints.size()) - skin.firstJoint;
+                return parsed;
+            });
+        }
+
+        bool parseAnimationSampler(JsonReader& reader, GltfAnimationSampler& sampler)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "input") return reader.readInt(sampler.input);
+                if (key == "output") return reader.readInt(sampler.output);
+                if (key != "interpolation") return reader.skipValue();
+                std::string interpolation;
+                if (!reader.readString(interpolation))
+                {
+                    return false;
+                }
+                sampler.interpolation = interpolation == "STEP"          ? GltfAnimationSampler::Interpolation::Step
+                                        : interpolation == "CUBICSPLINE" ? GltfAnimationSampler::Interpolation::CubicSpline
+                                                                         : GltfAnimationSampler::Interpolation::Linear;
+                return true;
+            });
+        }
+
+        bool parseAnimationChannel(JsonReader& reader, GltfAnimationChannel& channel)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "sampler") return reader.readInt(channel.sampler);
+                if (key != "target") return reader.skipValue();
+                return reader.readObject([&](std::string_view targetKey)
+                {
+                    if (targetKey == "node") return reader.readInt(channel.node);
+                    if (targetKey != "path") return reader.skipValue();
+                    std::string path;
+                    if (!reader.readString(path))
+                    {
+                        return false;
+                    }
+                    channel.path = path == "translation" ? GltfAnimationChannel::Path::Translation
+                                   : path == "rotation"  ? GltfAnimationChannel::Path::Rotation
+                                   : path == "scale"     ? GltfAnimationChannel::Path::Scale
+                                   : path == "weights"   ? GltfAnimationChannel::Path::Weights
+                                                         : GltfAnimationChannel::Path::Unknown;
+                    return true;
+                });
+            });
+        }
+
+        bool parseAnimation(JsonReader& reader, GltfDocument& document, GltfAnimation& animation)
+        {
+            return reader.readObject([&](std::string_view key)
+            {
+                if (key == "name") return reader.readString(animation.name);
+                if (key == "channels")
+                {
+                    animation.firstChannel = static_cast<uint32_t>(document.animationChannels.size());
+                    const bool parsed = reader.readArray([&]()
+                    {
+                        document.animationChannels.emplace_back();
+                        return parseAnimationChannel(reader, document.animationChannels.back());
+                    });
+                    animation.channelCount = static_cast<uint32_t>(document.animationChannels.size()) - animation.firstChannel;
+                    return parsed;
+                }
+                if (key == "samplers")
+                {
+                    animation.firstSampler = static_cast<uint32_t>(document.animationSamplers.size());
+                    const bool parsed = reader.readArray([&]()
+                    {
+                        document.animationSamplers.emplace_back();
+                        return parseAnimationSampler(reader, document.animationSamplers.back());
+                    });
+                    animation.samplerCount = static_cast<uint32_t>(document.animationSamplers.size()) - animation.firstSampler;
+                    return parsed;
+                }
+                return reader.skipValue();
+            });
+        }
+
+        // Reads a top-level array, appending one T per element.
+        template <typename T, typename Parse>
+        bool parseList(JsonReader& reader, std::vector<T>& out, const Parse& parse)
+        {
+            return reader.readArray([&]()
+            {
+                out.emplace_back();
+                return parse(out.back());
+            });
+        }
+
+        uint32_t readLittleEndian32(const uint8_t* p)
+        {
+            return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+                   static_cast<uint32_t>(p[3]) << 24;
+        }
+    } // namespace
+
+    bool parseGltfJson(const char* pText, size_t size, GltfDocument& outDocument, std::string& outError)
+    {
+        outDocument = GltfDocument();
+        JsonReader reader(pText, size);
+        GltfDocument& document = outDocument;
+        const bool parsed = reader.readObject([&](std::string_view key)
+        {
+            if (key == "scene") return reader.readInt(document.defaultScene);
+            if (key == "buffers") return parseList(reader, document.buffers, [&](GltfBuffer& buffer) { return parseBuffer(reader, buffer); });
+            if (key == "bufferViews") return parseList(reader, document.bufferViews, [&](GltfBufferView& view) { return parseBufferView(reader, view); });
+            if (key == "accessors") return parseList(reader, document.accessors, [&](GltfAccessor& accessor) { return parseAccessor(reader, accessor); });
+            if (key == "images") return parseList(reader, document.images, [&](GltfImage& image) { return parseImage(reader, image); });
+            if (key == "textures") return parseList(reader, document.textures, [&](int32_t& source) { source = -1; return parseTexture(reader, source); });
+            if (key == "materials") return parseList(reader, document.materials, [&](GltfMaterial& material) { return parseMaterial(reader, material); });
+            if (key == "meshes") return parseList(reader, document.meshes, [&](GltfMesh& mesh) { return parseMesh(reader, document, mesh); });
+            if (key == "nodes") return parseList(reader, document.nodes, [&](GltfNode& node) { return parseNode(reader, document, node); });
+            if (key == "scenes") return parseList(reader, document.scenes, [&](GltfScene& scene) { return parseScene(reader, document, scene); });
+            if (key == "skins") return parseList(reader, document.skins, [&](GltfSkin& skin) { return parseSkin(reader, document, skin); });
+            if (key == "animations") return parseList(reader, document.animations, [&](GltfAnimation& animation) { return parseAnimation(reader, document, animation); });
+            if (key == "extensionsRequired") return parseList(reader, document.extensionsRequired, [&](std::string& name) { return reader.readString(name); });
+            if (key == "extensions")
+            {
+                return parseExtension(reader, "KHR_lights_punctual", [&]()
+                {
+                    return reader.readObject([&](std::string_view lightsKey)
+                    {
+                        if (lightsKey != "lights") return reader.skipValue();
+                        return parseList(reader, document.lights, [&](GltfLight& light) { return parseLight(reader, light); });
+                    });
+                });
+            }
+            return reader.skipValue();
+        });
+
+        if (parsed && !reader.atEnd())
+        {
+            reader.fail("unexpected data after the document");
+        }
+        if (reader.getMessage())
+        {
+            outError = "glTF JSON error at byte " + std::to_string(reader.getFailOffset()) + ": " + reader.getMessage();
+            return false;
+        }
+        return true;
+    }
+
+    bool splitGlb(const uint8_t* pData, size_t size, const char*& pJson, size_t& jsonSize, const uint8_t*& pBin,
+                  size_t& binSize, std::string& outError)
+    {
+        const uint32_t kMagic = 0x46546C67;    // "glTF"
+        const uint32_t kJsonChunk = 0x4E4F534A; // "JSON"
+        const uint32_t kBinChunk = 0x004E4942;  // "BIN\0"
+
+        if (size < 20 || readLittleEndian32(pData) != kMagic || readLittleEndian32(pData + 4) != 2)
+        {
+            outError = "Not a glTF 2.0 binary file";
+            return false;
+        }
+        const size_t length = std::min<size_t>(readLittleEndian32(pData + 8), size);
+        const size_t jsonLength = readLittleEndian32(pData + 12);
+        if (length < 20 || readLittleEndian32(pData + 16) != kJsonChunk || jsonLength > length - 20)
+        {
+            outError = "GLB has no valid JSON chunk";
+            return false;
+        }
+        pJson = reinterpret_cast<const char*>(pData + 20);
+        jsonSize = jsonLength;
+
+        pBin = nullptr;
+        binSize = 0;
+        // Chunks are 4-byte aligned; the JSON chunk is padded with spaces.
+        const size_t binHeader = 20 + ((jsonLength + 3) & ~size_t(3));
+        if (binHeader <= length - 8 && readLittleEndian32(pData + binHeader + 4) == kBinChunk)
+        {
+            const size_t binLength = readLittleEndian32(pData + binHeader);
+            if (binLength > length - binHeader - 8)
+            {
+                outError = "GLB BIN chunk is truncated";
+                return false;
+            }
+            pBin = pData + binHeader + 8;
+            binSize = binLength;
+        }
+        return true;
+    }
+
+    bool decodeDataUri(const std::string& uri, std::vector<uint8_t>& outData)
+    {
+        const size_t marker = uri.find(";base64,");
+        if (uri.compare(0, 5, "data:") != 0 || marker == std::string::npos)
+        {
+            return false;
+        }
+
+        outData.clear();
+        outData.reserve((uri.size() - marker) / 4 * 3);
+        uint32_t bits = 0;
+        int bitCount = 0;
+        for (size_t i = marker + 8; i < uri.size(); ++i)
+        {
+            const char c = uri[i];
+            uint32_t value;
+            if (c >= 'A' && c <= 'Z') value = c - 'A';
+            else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+            else if (c >= '0' && c <= '9') value = c - '0' + 52;
+            else if (c == '+' || c == '-') value = 62;
+            else if (c == '/' || c == '_') value = 63;
+            else if (c == '=') break;
+            else return false;
+
+            bits = bits << 6 | value;
+            bitCount += 6;
+            if (bitCount >= 8)
+            {
+                bitCount -= 8;
+                outData.push_back(static_cast<uint8_t>(bits >> bitCount));
+            }
+        }
+        return true;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,311 @@
+#pragma once
+
+#include "../Core/MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Flat tables for the parts of a glTF document the importer reads, filled
+// straight from the JSON text by a streaming parser. Nothing else of the
+// document is materialized: unknown members (extras, cameras, most
+// extensions, ...) are skipped without being decoded. Indices are -1 when
+// absent.
+
+namespace Pinnacle
+{
+    enum class GltfComponentType : int32_t
+    {
+        Byte = 5120,
+        UnsignedByte = 5121,
+        Short = 5122,
+        UnsignedShort = 5123,
+        UnsignedInt = 5125,
+        Float = 5126
+    };
+
+    struct GltfBuffer
+    {
+        std::string uri;
+        uint64_t byteLength = 0;
+        // Bytes the loader resolved the buffer to: the GLB binary chunk, a
+        // mapped external file, or `storage` for data: URIs.
+        const uint8_t* pData = nullptr;
+        size_t size = 0;
+        std::vector<uint8_t> storage;
+        MappedFile mapping;
+        // EXT_meshopt_compression fallback buffer: may have no data at all
+        // when every view that uses it is compressed.
+        bool isFallback = false;
+    };
+
+    // EXT_meshopt_compression on a buffer view: where the compressed bytes
+    // are and how they decode into the view.
+    struct GltfMeshoptCompression
+    {
+        enum class Mode : uint8_t
+        {
+            Attributes,
+            Triangles,
+            Indices
+        };
+        enum class Filter : uint8_t
+        {
+            None,
+            Octahedral,
+            Quaternion,
+            Exponential
+        };
+
+        int32_t buffer = -1; // -1 = the view is not compressed
+        uint64_t byteOffset = 0;
+        uint64_t byteLength = 0;
+        uint32_t byteStride = 0;
+        uint64_t count = 0;
+        Mode mode = Mode::Attributes;
+        Filter filter = Filter::None;
+    };
+
+    struct GltfBufferView
+    {
+        int32_t buffer = -1;
+        uint64_t byteOffset = 0;
+        uint64_t byteLength = 0;
+        uint32_t byteStride = 0; // 0 = tightly packed
+        GltfMeshoptCompression meshopt;
+    };
+
+    // Elements of an accessor replaced by tightly packed values; the rest
+    // come from its buffer view, or are zero without one.
+    struct GltfSparseAccessor
+    {
+        uint64_t count = 0; // 0 = not sparse
+        int32_t indicesBufferView = -1;
+        uint64_t indicesByteOffset = 0;
+        GltfComponentType indicesComponentType = GltfComponentType::UnsignedInt;
+        int32_t valuesBufferView = -1;
+        uint64_t valuesByteOffset = 0;
+    };
+
+    struct GltfAccessor
+    {
+        int32_t bufferView = -1;
+        uint64_t byteOffset = 0;
+        uint64_t count = 0;
+        GltfComponentType componentType = GltfComponentType::Float;
+        int32_t componentCount = 0; // From the type: SCALAR = 1 ... MAT4 = 16; 0 if unknown
+        bool normalized = false;
+        GltfSparseAccessor sparse;
+    };
+
+    struct GltfImage
+    {
+        std::string name;
+        std::string uri;
+        std::string mimeType;
+        int32_t bufferView = -1;
+        // Decoded RGBA8, filled by the loader; empty if the image could not be decoded.
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::vector<uint8_t> rgba;
+    };
+
+    // KHR_texture_transform of one textureInfo, as written in the file.
+    struct GltfTextureTransform
+    {
+        float offset[2] = { 0.0f, 0.0f };
+        float rotation = 0.0f; // Radians, counter-clockwise in UV space
+        float scale[2] = { 1.0f, 1.0f };
+    };
+
+    struct GltfMaterial
+    {
+        enum class AlphaMode : uint8_t
+        {
+            Opaque,
+            Mask,
+            Blend
+        };
+
+        float baseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float emissiveFactor[3] = { 0.0f, 0.0f, 0.0f };
+        float metallicFactor = 1.0f;
+        float roughnessFactor = 1.0f;
+        float normalScale = 1.0f;
+        float occlusionStrength = 1.0f;
+        float alphaCutoff = 0.5f;
+        AlphaMode alphaMode = AlphaMode::Opaque;
+        bool doubleSided = false;
+        int32_t baseColorTexture = -1; // Indices into GltfDocument::textures
+        int32_t metallicRoughnessTexture = -1;
+        int32_t normalTexture = -1;
+        int32_t occlusionTexture = -1;
+        int32_t emissiveTexture = -1;
+        // Filled by the GltfExtensionRegistry handlers
+        uint32_t flags = 0; // MaterialFlag bits of the extensions present
+        float emissiveStrength = 1.0f;
+        float clearcoatFactor = 0.0f;
+        float clearcoatRoughnessFactor = 0.0f;
+        GltfTextureTransform textureTransforms[5]; // Per MaterialTexture slot
+    };
+
+    struct GltfPrimitive
+    {
+        static constexpr int32_t kTriangles = 4;
+
+        int32_t position = -1; // Accessor indices
+        int32_t normal = -1;
+        int32_t texCoord0 = -1;
+        int32_t color0 = -1;
+        int32_t joints0 = -1;
+        int32_t weights0 = -1;
+        int32_t indices = -1;
+        int32_t material = -1;
+        int32_t mode = kTriangles;
+        int32_t dracoBufferView = -1; // KHR_draco_mesh_compression; never decoded, only used to skip the primitive
+        uint32_t firstTarget = 0; // Range in GltfDocument::morphTargets
+        uint32_t targetCount = 0;
+    };
+
+    // Accessors of one morph target's attribute deltas
+    struct GltfMorphTarget
+    {
+        int32_t position = -1;
+        int32_t normal = -1;
+        int32_t texCoord0 = -1;
+    };
+
+    struct GltfMesh
+    {
+        std::string name;
+        uint32_t firstPrimitive = 0; // Range in GltfDocument::primitives
+        uint32_t primitiveCount = 0;
+        uint32_t firstWeight = 0; // Default morph target weights, range in GltfDocument::morphWeights
+        uint32_t weightCount = 0;
+    };
+
+    // KHR_lights_punctual
+    struct GltfLight
+    {
+        enum class Type : uint8_t
+        {
+            Directional,
+            Point,
+            Spot
+        };
+
+        Type type = Type::Point;
+        float color[3] = { 1.0f, 1.0f, 1.0f };
+        float intensity = 1.0f;
+        float range = 0.0f; // 0 = unlimited
+        float innerConeAngle = 0.0f;
+        float outerConeAngle = 0.7853982f;
+    };
+
+    struct GltfNode
+    {
+        int32_t mesh = -1;
+        int32_t light = -1;
+        int32_t skin = -1;
+        bool hasMatrix = false;
+        float matrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+        float translation[3] = { 0.0f, 0.0f, 0.0f };
+        float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        float scale[3] = { 1.0f, 1.0f, 1.0f };
+        uint32_t firstChild = 0; // Range in GltfDocument::nodeChildren
+        uint32_t childCount = 0;
+        uint32_t firstWeight = 0; // Morph weights overriding the mesh's, range in GltfDocument::morphWeights
+        uint32_t weightCount = 0;
+    };
+
+    struct GltfSkin
+    {
+        int32_t inverseBindMatrices = -1; // Accessor; identity matrices when absent
+        uint32_t firstJoint = 0;          // Range in GltfDocument::skinJoints
+        uint32_t jointCount = 0;
+    };
+
+    struct GltfAnimationSampler
+    {
+        enum class Interpolation : uint8_t
+        {
+            Linear,
+            Step,
+            CubicSpline
+        };
+
+        int32_t input = -1; // Accessors: key times and values
+        int32_t output = -1;
+        Interpolation interpolation = Interpolation::Linear;
+    };
+
+    struct GltfAnimationChannel
+    {
+        enum class Path : uint8_t
+        {
+            Translation,
+            Rotation,
+            Scale,
+            Weights,
+            Unknown
+        };
+
+        int32_t sampler = -1; // Index within the animation's samplers
+        int32_t node = -1;
+        Path path = Path::Unknown;
+    };
+
+    struct GltfAnimation
+    {
+        std::string name;
+        uint32_t firstChannel = 0; // Range in GltfDocument::animationChannels
+        uint32_t channelCount = 0;
+        uint32_t firstSampler = 0; // Range in GltfDocument::animationSamplers
+        uint32_t samplerCount = 0;
+    };
+
+    struct GltfScene
+    {
+        uint32_t firstNode = 0; // Range in GltfDocument::sceneNodes
+        uint32_t nodeCount = 0;
+    };
+
+    struct GltfDocument
+    {
+        std::vector<GltfBuffer> buffers;
+        std::vector<GltfBufferView> bufferViews;
+        std::vector<GltfAccessor> accessors;
+        std::vector<GltfImage> images;
+        std::vector<int32_t> textures; // Source image of each texture
+        std::vector<GltfMaterial> materials;
+        std::vector<GltfPrimitive> primitives;
+        std::vector<GltfMorphTarget> morphTargets;
+        std::vector<float> morphWeights;
+        std::vector<GltfMesh> meshes;
+        std::vector<GltfNode> nodes;
+        std::vector<GltfLight> lights;
+        std::vector<GltfSkin> skins;
+        std::vector<int32_t> skinJoints;
+        std::vector<GltfAnimation> animations;
+        std::vector<GltfAnimationChannel> animationChannels;
+        std::vector<GltfAnimationSampler> animationSamplers;
+        std::vector<int32_t> nodeChildren;
+        std::vector<GltfScene> scenes;
+        std::vector<int32_t> sceneNodes;
+        int32_t defaultScene = -1;
+        std::vector<std::string> extensionsRequired;
+    };
+
+    // Parses glTF JSON text into `outDocument`. Buffers and images are only
+    // described, not loaded. On failure `outError` names the byte offset.
+    bool parseGltfJson(const char* pText, size_t size, GltfDocument& outDocument, std::string& outError);
+
+    // Splits a GLB container into its JSON chunk and optional BIN chunk
+    // (`pBin` is null when there is none). The chunks point into `pData`.
+    bool splitGlb(const uint8_t* pData, size_t size, const char*& pJson, size_t& jsonSize, const uint8_t*& pBin,
+                  size_t& binSize, std::string& outError);
+
+    // Decodes a base64 data: URI; false if `uri` is not one or is malformed.
+    bool decodeDataUri(const std::string& uri, std::vector<uint8_t>& outData);
+} // namespace Pinnacle
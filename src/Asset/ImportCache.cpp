@@ -0,0 +1,130 @@
+#include "ImportCache.hpp"
+
+#include "AssetCache.hpp"
+#include "../Core/MappedFile.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // Bump when a chunk payload layout changes.
+        const uint32_t kChunkVersion = 4;
+        const uint32_t kChunkMagic = 0x4B4E4843; // "CHNK"
+
+        struct ChunkHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t key;
+            uint64_t size;
+        };
+    } // namespace
+
+    ImportCache::ImportCache(const std::string& directory)
+        : m_directory(directory.empty() ? AssetCache::getDefaultDirectory() + "/chunks" : directory)
+    {
+        resetStats();
+    }
+
+    const char* ImportCache::getKindName(ChunkKind kind)
+    {
+        switch (kind)
+        {
+            case ChunkKind::Image:
+                return "images";
+            case ChunkKind::Texture:
+                return "textures";
+            case ChunkKind::Mesh:
+                return "meshes";
+            default:
+                return "other";
+        }
+    }
+
+    std::string ImportCache::getChunkPath(ChunkKind kind, uint64_t key) const
+    {
+        char name[24];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return m_directory + "/" + getKindName(kind) + "/" + name;
+    }
+
+    bool ImportCache::load(ChunkKind kind, uint64_t key, std::vector<uint8_t>& outData)
+    {
+        const size_t slot = static_cast<size_t>(kind);
+        MappedFile file;
+        ChunkHeader header;
+        if (file.open(getChunkPath(kind, key)) && file.size() >= sizeof(header))
+        {
+            std::memcpy(&header, file.data(), sizeof(header));
+            if (header.magic == kChunkMagic && header.version == kChunkVersion && header.key == key &&
+                header.size == file.size() - sizeof(header))
+            {
+                outData.assign(file.data() + sizeof(header), file.data() + file.size());
+                m_hits[slot]++;
+                m_bytesRead += outData.size();
+                return true;
+            }
+        }
+        m_misses[slot]++;
+        return false;
+    }
+
+    void ImportCache::store(ChunkKind kind, uint64_t key, const std::vector<uint8_t>& data)
+    {
+        const std::string path = getChunkPath(kind, key);
+        std::error_code filesystemError;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), filesystemError);
+
+        // Temporary + rename, as in AssetCache, so readers never see a partial chunk.
+        const std::string temporaryPath = makeTemporaryPath(path);
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            const ChunkHeader header = { kChunkMagic, kChunkVersion, key, data.size() };
+            file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file.flush())
+            {
+                file.close();
+                std::filesystem::remove(temporaryPath, filesystemError);
+                return;
+            }
+        }
+        std::filesystem::rename(temporaryPath, path, filesystemError);
+        if (filesystemError)
+        {
+            std::filesystem::remove(temporaryPath, filesystemError);
+            return;
+        }
+        m_bytesWritten += data.size();
+    }
+
+    ImportCacheStats ImportCache::getStats() const
+    {
+        ImportCacheStats stats;
+        for (size_t i = 0; i < static_cast<size_t>(ChunkKind::Count); ++i)
+        {
+            stats.hits[i] = m_hits[i].load();
+            stats.misses[i] = m_misses[i].load();
+        }
+        stats.bufferViewsHashed = m_bufferViewsHashed.load();
+        stats.bytesRead = m_bytesRead.load();
+        stats.bytesWritten = m_bytesWritten.load();
+        return stats;
+    }
+
+    void ImportCache::resetStats()
+    {
+        for (size_t i = 0; i < static_cast<size_t>(ChunkKind::Count); ++i)
+        {
+            m_hits[i] = 0;
+            m_misses[i] = 0;
+        }
+        m_bufferViewsHashed = 0;
+        m_bytesRead = 0;
+        m_bytesWritten = 0;
+    }
+} // namespace Pinnacle
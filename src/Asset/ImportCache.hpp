@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Kinds of intermediate import products cached independently, each keyed
+    // by the content hash of its own inputs.
+    enum class ChunkKind : uint32_t
+    {
+        Image,   // Decoded RGBA8 texels, keyed by the encoded image bytes
+        Texture, // Mip chain in its GPU format, keyed by the decoded texels, colour space and settings
+        Mesh,    // Converted primitive with its LODs and meshlets, keyed by its buffer views and settings
+        Count
+    };
+
+    struct ImportCacheStats
+    {
+        uint32_t hits[static_cast<size_t>(ChunkKind::Count)] = {};
+        uint32_t misses[static_cast<size_t>(ChunkKind::Count)] = {};
+        uint32_t bufferViewsHashed = 0;
+        uint64_t bytesRead = 0;
+        uint64_t bytesWritten = 0;
+    };
+
+    // Content-addressed store for import chunks, one file per chunk under
+    // <directory>/<kind>/. Re-importing a model whose glTF changed only
+    // redoes the work for chunks whose inputs changed. Thread-safe.
+    class ImportCache
+    {
+    public:
+        // An empty directory selects AssetCache::getDefaultDirectory()/chunks.
+        explicit ImportCache(const std::string& directory = std::string());
+
+        bool load(ChunkKind kind, uint64_t key, std::vector<uint8_t>& outData);
+        void store(ChunkKind kind, uint64_t key, const std::vector<uint8_t>& data);
+
+        void countBufferViewHashed() { m_bufferViewsHashed++; }
+
+        ImportCacheStats getStats() const;
+        void resetStats();
+
+        const std::string& getDirectory() const { return m_directory; }
+        static const char* getKindName(ChunkKind kind);
+
+    private:
+        std::string getChunkPath(ChunkKind kind, uint64_t key) const;
+
+        std::string m_directory;
+        std::atomic<uint32_t> m_hits[static_cast<size_t>(ChunkKind::Count)];
+        std::atomic<uint32_t> m_misses[static_cast<size_t>(ChunkKind::Count)];
+        std::atomic<uint32_t> m_bufferViewsHashed{ 0 };
+        std::atomic<uint64_t> m_bytesRead{ 0 };
+        std::atomic<uint64_t> m_bytesWritten{ 0 };
+    };
+
+    // Minimal append-only serializer for chunk payloads (native layout).
+    class ChunkWriter
+    {
+    public:
+        template <typename T>
+        void write(const T& value)
+        {
+            writeBytes(&value, sizeof(T));
+        }
+
+        template <typename T>
+        void writeArray(const std::vector<T>& values)
+        {
+            write(static_cast<uint64_t>(values.size()));
+            writeBytes(values.data(), values.size() * sizeof(T));
+        }
+
+        void writeBytes(const void* pData, size_t size)
+        {
+            const uint8_t* pBytes = static_cast<const uint8_t*>(pData);
+            m_data.insert(m_data.end(), pBytes, pBytes + size);
+        }
+
+        std::vector<uint8_t>& getData() { return m_data; }
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+
+    // Bounds-checked reader matching ChunkWriter; every read fails once the
+    // payload runs out.
+    class ChunkReader
+    {
+    public:
+        explicit ChunkReader(const std::vector<uint8_t>& data) : m_data(data) {}
+
+        template <typename T>
+        bool read(T& value)
+        {
+            return readBytes(&value, sizeof(T));
+        }
+
+        template <typename T>
+        bool readArray(std::vector<T>& values)
+        {
+            uint64_t count = 0;
+            if (!read(count) || count > (m_data.size() - m_offset) / sizeof(T))
+            {
+                return false;
+            }
+            values.resize(static_cast<size_t>(count));
+            return readBytes(values.data(), values.size() * sizeof(T));
+        }
+
+        bool readBytes(void* pData, size_t size)
+        {
+            if (size > m_data.size() - m_offset)
+            {
+                return false;
+            }
+            if (size > 0)
+            {
+                std::memcpy(pData, m_data.data() + m_offset, size);
+            }
+            m_offset += size;
+            return true;
+        }
+
+        bool atEnd() const { return m_offset == m_data.size(); }
+
+    private:
+        const std::vector<uint8_t>& m_data;
+        size_t m_offset = 0;
+    };
+} // namespace Pinnacle
@@ -0,0 +1,541 @@
+#include "MeshSimplifier.hpp"
+
+#include "MeshUtilities.hpp"
+#include "../Core/Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // Symmetric 4x4 error quadric: E(p) = p^T A p + 2 b^T p + c, summed
+        // over the planes it was built from. `weight` is the total plane
+        // weight so E / weight is a mean squared distance.
+        struct Quadric
+        {
+            double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+            double b0 = 0, b1 = 0, b2 = 0;
+            double c = 0;
+            double weight = 0;
+
+            void addPlane(const double n[3], double d, double w)
+            {
+                a00 += w * n[0] * n[0];
+                a01 += w * n[0] * n[1];
+                a02 += w * n[0] * n[2];
+                a11 += w * n[1] * n[1];
+                a12 += w * n[1] * n[2];
+                a22 += w * n[2] * n[2];
+                b0 += w * n[0] * d;
+                b1 += w * n[1] * d;
+                b2 += w * n[2] * d;
+                c += w * d * d;
+                weight += w;
+            }
+
+            void add(const Quadric& other)
+            {
+                a00 += other.a00;
+                a01 += other.a01;
+                a02 += other.a02;
+                a11 += other.a11;
+                a12 += other.a12;
+                a22 += other.a22;
+                b0 += other.b0;
+                b1 += other.b1;
+                b2 += other.b2;
+                c += other.c;
+                weight += other.weight;
+            }
+
+            double evaluate(const float p[3]) const
+            {
+                const double x = p[0], y = p[1], z = p[2];
+                const double result = a00 * x * x + a11 * y * y + a22 * z * z +
+                                      2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                                      2.0 * (b0 * x + b1 * y + b2 * z) + c;
+                return result > 0.0 ? result : 0.0;
+            }
+        };
+
+        struct Collapse
+        {
+            uint32_t from;
+            uint32_t to;
+            float cost; // Squared distance
+        };
+
+        // Border edges pull their endpoints back with a plane perpendicular to
+        // the surface; heavier than surface planes so open edges stay put.
+        const double kBorderWeight = 10.0;
+
+        void subtract(const float a[3], const float b[3], double out[3])
+        {
+            out[0] = double(a[0]) - b[0];
+            out[1] = double(a[1]) - b[1];
+            out[2] = double(a[2]) - b[2];
+        }
+
+        void cross(const double a[3], const double b[3], double out[3])
+        {
+            out[0] = a[1] * b[2] - a[2] * b[1];
+            out[1] = a[2] * b[0] - a[0] * b[2];
+            out[2] = a[0] * b[1] - a[1] * b[0];
+        }
+
+        double dot(const double a[3], const double b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+        double normalize(double v[3])
+        {
+            const double length = std::sqrt(dot(v, v));
+            if (length > 0.0)
+            {
+                v[0] /= length;
+                v[1] /= length;
+                v[2] /= length;
+            }
+            return length;
+        }
+
+        void triangleNormal(const float* p0, const float* p1, const float* p2, double out[3])
+        {
+            double e0[3], e1[3];
+            subtract(p1, p0, e0);
+            subtract(p2, p0, e1);
+            cross(e0, e1, out);
+        }
+
+        uint64_t edgeKey(uint32_t a, uint32_t b)
+        {
+            return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+        }
+
+        float attributeDistance(const ModelVertex& a, const ModelVertex& b)
+        {
+            float distance = 0.0f;
+            for (int i = 0; i < 3; ++i)
+            {
+                const float d = a.normal[i] - b.normal[i];
+                distance += d * d;
+            }
+            for (int i = 0; i < 2; ++i)
+            {
+                const float d = a.texCoords[i] - b.texCoords[i];
+                distance += d * d;
+            }
+            return distance;
+        }
+
+        // Position groups plus the inverse mapping: the vertices of group g
+        // are `groupVertices[groupOffsets[g]..groupOffsets[g + 1]]`.
+        uint32_t buildPositionGroups(const ModelVertex* pVertices, size_t vertexCount,
+                                     std::vector<uint32_t>& vertexGroup, std::vector<uint32_t>& groupRepresentative,
+                                     std::vector<uint32_t>& groupOffsets, std::vector<uint32_t>& groupVertices)
+        {
+            weldPositions(pVertices, vertexCount, vertexGroup, groupRepresentative);
+
+            const uint32_t groupCount = static_cast<uint32_t>(groupRepresentative.size());
+            groupOffsets.assign(groupCount + 1, 0);
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                groupOffsets[vertexGroup[v] + 1]++;
+            }
+            for (uint32_t g = 0; g < groupCount; ++g)
+            {
+                groupOffsets[g + 1] += groupOffsets[g];
+            }
+            groupVertices.resize(vertexCount);
+            std::vector<uint32_t> cursor(groupOffsets.begin(), groupOffsets.end() - 1);
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                groupVertices[cursor[vertexGroup[v]]++] = static_cast<uint32_t>(v);
+            }
+            return groupCount;
+        }
+    } // namespace
+
+    float simplifyMesh(const ModelVertex* pVertices, size_t vertexCount,
+                       const uint32_t* pIndices, size_t indexCount,
+                       size_t targetIndexCount, float maxError,
+                       std::vector<uint32_t>& outIndices)
+    {
+        outIndices.assign(pIndices, pIndices + indexCount);
+        if (!pVertices || vertexCount == 0 || indexCount < 3 || targetIndexCount >= indexCount)
+        {
+            return 0.0f;
+        }
+
+        std::vector<uint32_t> vertexGroup, groupRepresentative, groupOffsets, groupVertices;
+        const uint32_t groupCount = buildPositionGroups(pVertices, vertexCount, vertexGroup, groupRepresentative,
+                                                        groupOffsets, groupVertices);
+        auto groupPosition = [&](uint32_t group) { return pVertices[groupRepresentative[group]].position; };
+
+        // Drop triangles that are degenerate at the position level up front.
+        {
+            size_t write = 0;
+            for (size_t i = 0; i + 2 < indexCount; i += 3)
+            {
+                const uint32_t g0 = vertexGroup[outIndices[i]];
+                const uint32_t g1 = vertexGroup[outIndices[i + 1]];
+                const uint32_t g2 = vertexGroup[outIndices[i + 2]];
+                if (g0 != g1 && g1 != g2 && g0 != g2)
+                {
+                    outIndices[write++] = outIndices[i];
+                    outIndices[write++] = outIndices[i + 1];
+                    outIndices[write++] = outIndices[i + 2];
+                }
+            }
+            outIndices.resize(write);
+        }
+
+        // Edge use counts; an edge used by exactly one triangle is a border.
+        std::vector<uint64_t> edges;
+        auto collectEdges = [&]()
+        {
+            edges.clear();
+            edges.reserve(outIndices.size());
+            for (size_t i = 0; i < outIndices.size(); i += 3)
+            {
+                const uint32_t g[3] = { vertexGroup[outIndices[i]], vertexGroup[outIndices[i + 1]],
+                                        vertexGroup[outIndices[i + 2]] };
+                for (int e = 0; e < 3; ++e)
+                {
+                    edges.push_back(edgeKey(g[e], g[(e + 1) % 3]));
+                }
+            }
+            std::sort(edges.begin(), edges.end());
+        };
+        auto isBorderEdge = [&](uint64_t key)
+        {
+            auto range = std::equal_range(edges.begin(), edges.end(), key);
+            return range.second - range.first == 1;
+        };
+
+        collectEdges();
+
+        std::vector<Quadric> quadrics(groupCount);
+        std::vector<uint8_t> border(groupCount, 0);
+        for (size_t i = 0; i < outIndices.size(); i += 3)
+        {
+            const uint32_t g[3] = { vertexGroup[outIndices[i]], vertexGroup[outIndices[i + 1]],
+                                    vertexGroup[outIndices[i + 2]] };
+            double normal[3];
+            triangleNormal(groupPosition(g[0]), groupPosition(g[1]), groupPosition(g[2]), normal);
+            const double area = normalize(normal) * 0.5;
+            const float* p0 = groupPosition(g[0]);
+            const double origin[3] = { p0[0], p0[1], p0[2] };
+            const double d = -dot(normal, origin);
+            for (int c = 0; c < 3; ++c)
+            {
+                quadrics[g[c]].addPlane(normal, d, area);
+            }
+
+            for (int e = 0; e < 3; ++e)
+            {
+                const uint32_t a = g[e];
+                const uint32_t b = g[(e + 1) % 3];
+                if (!isBorderEdge(edgeKey(a, b)))
+                {
+                    continue;
+                }
+                border[a] = border[b] = 1;
+
+                double edge[3];
+                subtract(groupPosition(b), groupPosition(a), edge);
+                double planeNormal[3];
+                cross(edge, normal, planeNormal);
+                const double edgeLength = normalize(planeNormal);
+                const float* pa = groupPosition(a);
+                const double point[3] = { pa[0], pa[1], pa[2] };
+                const double planeD = -dot(planeNormal, point);
+                const double weight = edgeLength * edgeLength * kBorderWeight;
+                quadrics[a].addPlane(planeNormal, planeD, weight);
+                quadrics[b].addPlane(planeNormal, planeD, weight);
+            }
+        }
+
+        const double maxErrorSquared = double(maxError) * maxError;
+        double reachedError = 0.0;
+
+        std::vector<Collapse> collapses;
+        std::vector<uint32_t> triangleOffsets(groupCount + 1);
+        std::vector<uint32_t> groupTriangles;
+        std::vector<uint8_t> locked(groupCount);
+        std::vector<uint32_t> collapseTarget(groupCount);
+        std::vector<uint32_t> vertexRemap(vertexCount);
+
+        while (outIndices.size() > targetIndexCount)
+        {
+            const size_t triangleCount = outIndices.size() / 3;
+
+            // Group -> triangles adjacency for flip checks and one-ring locking.
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (size_t i = 0; i < outIndices.size(); ++i)
+            {
+                triangleOffsets[vertexGroup[outIndices[i]] + 1]++;
+            }
+            for (uint32_t g = 0; g < groupCount; ++g)
+            {
+                triangleOffsets[g + 1] += triangleOffsets[g];
+            }
+            groupTriangles.resize(outIndices.size());
+            {
+                std::vector<uint32_t> cursor(triangleOffsets.begin(), triangleOffsets.end() - 1);
+                for (size_t i = 0; i < outIndices.size(); ++i)
+                {
+                    groupTriangles[cursor[vertexGroup[outIndices[i]]]++] = static_cast<uint32_t>(i / 3);
+                }
+            }
+
+            // Candidate collapses, cheapest valid direction per edge.
+            collapses.clear();
+            collectEdges();
+            for (size_t i = 0; i < edges.size();)
+            {
+                size_t run = i + 1;
+                while (run < edges.size() && edges[run] == edges[i])
+                {
+                    ++run;
+                }
+                const bool borderEdge = run - i == 1;
+                const uint32_t a = static_cast<uint32_t>(edges[i] >> 32);
+                const uint32_t b = static_cast<uint32_t>(edges[i] & 0xffffffffu);
+                i = run;
+
+                Quadric combined = quadrics[a];
+                combined.add(quadrics[b]);
+                const double scale = combined.weight > 0.0 ? 1.0 / combined.weight : 0.0;
+
+                Collapse best = { 0, 0, -1.0f };
+                for (int direction = 0; direction < 2; ++direction)
+                {
+                    const uint32_t from = direction == 0 ? a : b;
+                    const uint32_t to = direction == 0 ? b : a;
+                    // Border vertices may only slide along their own border.
+                    if (border[from] && (!border[to] || !borderEdge))
+                    {
+                        continue;
+                    }
+                    const float cost = static_cast<float>(combined.evaluate(groupPosition(to)) * scale);
+                    if (best.cost < 0.0f || cost < best.cost)
+                    {
+                        best = { from, to, cost };
+                    }
+                }
+                if (best.cost >= 0.0f && best.cost <= maxErrorSquared)
+                {
+                    collapses.push_back(best);
+                }
+            }
+            if (collapses.empty())
+            {
+                break;
+            }
+            std::sort(collapses.begin(), collapses.end(),
+                      [](const Collapse& lhs, const Collapse& rhs) { return lhs.cost < rhs.cost; });
+
+            std::fill(locked.begin(), locked.end(), 0);
+            for (uint32_t g = 0; g < groupCount; ++g)
+            {
+                collapseTarget[g] = g;
+            }
+
+            const size_t targetTriangles = targetIndexCount / 3;
+            size_t removedTriangles = 0;
+            size_t applied = 0;
+            for (const Collapse& collapse : collapses)
+            {
+                if (triangleCount - removedTriangles <= targetTriangles)
+                {
+                    break;
+                }
+                if (locked[collapse.from] || locked[collapse.to])
+                {
+                    continue;
+                }
+
+                // Reject collapses that flip or squash any surviving triangle.
+                const float* pTarget = groupPosition(collapse.to);
+                bool valid = true;
+                size_t removed = 0;
+                for (uint32_t t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1] && valid; ++t)
+                {
+                    const uint32_t triangle = groupTriangles[t];
+                    uint32_t g[3];
+                    const float* p[3];
+                    bool touchesTarget = false;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        g[c] = vertexGroup[outIndices[triangle * 3 + c]];
+                        p[c] = groupPosition(g[c]);
+                        touchesTarget = touchesTarget || g[c] == collapse.to;
+                    }
+                    if (touchesTarget)
+                    {
+                        ++removed;
+                        continue;
+                    }
+                    double before[3], after[3];
+                    triangleNormal(p[0], p[1], p[2], before);
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        p[c] = g[c] == collapse.from ? pTarget : p[c];
+                    }
+                    triangleNormal(p[0], p[1], p[2], after);
+                    const double beforeLength = std::sqrt(dot(before, before));
+                    const double afterLength = std::sqrt(dot(after, after));
+                    valid = dot(before, after) > 0.25 * beforeLength * afterLength;
+                }
+                if (!valid)
+                {
+                    continue;
+                }
+
+                // Lock the one-ring so later collapses this pass see the
+                // positions their flip checks were made against.
+                for (uint32_t t = triangleOffsets[collapse.from]; t < triangleOffsets[collapse.from + 1]; ++t)
+                {
+                    const uint32_t triangle = groupTriangles[t];
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        locked[vertexGroup[outIndices[triangle * 3 + c]]] = 1;
+                    }
+                }
+                locked[collapse.to] = 1;
+
+                collapseTarget[collapse.from] = collapse.to;
+                quadrics[collapse.to].add(quadrics[collapse.from]);
+                reachedError = std::max(reachedError, double(collapse.cost));
+                removedTriangles += removed;
+                ++applied;
+            }
+            if (applied == 0)
+            {
+                break;
+            }
+
+            // Move each vertex of a collapsed group onto the target vertex with
+            // the closest attributes, then rewrite and compact the triangles.
+            for (size_t v = 0; v < vertexCount; ++v)
+            {
+                vertexRemap[v] = static_cast<uint32_t>(v);
+                const uint32_t target = collapseTarget[vertexGroup[v]];
+                if (target == vertexGroup[v])
+                {
+                    continue;
+                }
+                float bestDistance = FLT_MAX;
+                for (uint32_t i = groupOffsets[target]; i < groupOffsets[target + 1]; ++i)
+                {
+                    const float distance = attributeDistance(pVertices[v], pVertices[groupVertices[i]]);
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        vertexRemap[v] = groupVertices[i];
+                    }
+                }
+            }
+
+            size_t write = 0;
+            for (size_t i = 0; i < outIndices.size(); i += 3)
+            {
+                const uint32_t v0 = vertexRemap[outIndices[i]];
+                const uint32_t v1 = vertexRemap[outIndices[i + 1]];
+                const uint32_t v2 = vertexRemap[outIndices[i + 2]];
+                const uint32_t g0 = vertexGroup[v0], g1 = vertexGroup[v1], g2 = vertexGroup[v2];
+                if (g0 != g1 && g1 != g2 && g0 != g2)
+                {
+                    outIndices[write++] = v0;
+                    outIndices[write++] = v1;
+                    outIndices[write++] = v2;
+                }
+            }
+            outIndices.resize(write);
+        }
+
+        return static_cast<float>(std::sqrt(reachedError));
+    }
+
+    void generateLodChain(const ModelVertex* pVertices, size_t vertexCount,
+                          const uint32_t* pIndices, size_t indexCount,
+                          const Bounds& bounds, const LodOptions& options,
+                          std::vector<LodLevel>& outLevels)
+    {
+        outLevels.clear();
+        if (!bounds.isValid() || indexCount < 3)
+        {
+            return;
+        }
+
+        float diagonal = 0.0f;
+        for (int i = 0; i < 3; ++i)
+        {
+            const float extent = bounds.max[i] - bounds.min[i];
+            diagonal += extent * extent;
+        }
+        const float maxError = std::sqrt(diagonal) * options.maxRelativeError;
+
+        const uint32_t* pSource = pIndices;
+        size_t sourceCount = indexCount;
+        float accumulatedError = 0.0f;
+        for (uint32_t level = 0; level < options.maxLevels; ++level)
+        {
+            const size_t target = static_cast<size_t>(sourceCount / 3 * options.reductionPerLevel) * 3;
+            LodLevel lod;
+            const float error = simplifyMesh(pVertices, vertexCount, pSource, sourceCount, target, maxError, lod.indices);
+            if (lod.indices.empty() || lod.indices.size() > sourceCount * (1.0f - options.minReduction))
+            {
+                break;
+            }
+            // Each level is simplified from the previous one, so errors add up.
+            accumulatedError += error;
+            lod.error = accumulatedError;
+            outLevels.push_back(std::move(lod));
+            pSource = outLevels.back().indices.data();
+            sourceCount = outLevels.back().indices.size();
+        }
+    }
+
+    void generateModelLods(ModelData& model, const LodOptions& options, unsigned int threadCount)
+    {
+        // Drop any previously generated levels.
+        size_t baseIndexCount = 0;
+        for (PrimitiveData& primitive : model.primitives)
+        {
+            baseIndexCount = std::max<size_t>(baseIndexCount, primitive.indexOffset + primitive.indexCount);
+            primitive.firstLod = primitive.lodCount = 0;
+        }
+        model.indices.resize(baseIndexCount);
+        model.lods.clear();
+
+        const size_t primitiveCount = model.primitives.size();
+        std::vector<std::vector<LodLevel>> chains(primitiveCount);
+
+        parallelFor(primitiveCount, threadCount, [&](size_t i)
+        {
+            const PrimitiveData& primitive = model.primitives[i];
+            generateLodChain(model.vertices.data() + primitive.vertexOffset, primitive.vertexCount,
+                             model.indices.data() + primitive.indexOffset, primitive.indexCount,
+                             primitive.bounds, options, chains[i]);
+        });
+
+        for (size_t i = 0; i < primitiveCount; ++i)
+        {
+            PrimitiveData& primitive = model.primitives[i];
+            primitive.firstLod = static_cast<uint32_t>(model.lods.size());
+            primitive.lodCount = static_cast<uint32_t>(chains[i].size());
+            for (const LodLevel& level : chains[i])
+            {
+                LodData lod;
+                lod.indexOffset = static_cast<uint32_t>(model.indices.size());
+                lod.indexCount = static_cast<uint32_t>(level.indices.size());
+                lod.error = level.error;
+                model.indices.insert(model.indices.end(), level.indices.begin(), level.indices.end());
+                model.lods.push_back(lod);
+            }
+        }
+    }
+} // namespace Pinnacle
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Quadric-error edge-collapse simplifier. Simplification is index-only:
+    // the output indices reference the input vertex array, so every LOD of a
+    // primitive shares one vertex range. Vertices are welded by position for
+    // collapsing; when a group collapses, each of its vertices is remapped to
+    // the target vertex with the closest normal/UV so attribute seams survive.
+    //
+    // `maxError` is an object-space distance. Returns the error reached (the
+    // largest collapse cost accepted, as a distance).
+    float simplifyMesh(const ModelVertex* pVertices, size_t vertexCount,
+                       const uint32_t* pIndices, size_t indexCount,
+                       size_t targetIndexCount, float maxError,
+                       std::vector<uint32_t>& outIndices);
+
+    struct LodOptions
+    {
+        uint32_t maxLevels = 4;       // Not counting the source level
+        float reductionPerLevel = 0.5f;
+        float maxRelativeError = 0.02f; // Fraction of the bounds diagonal, per level
+        float minReduction = 0.1f;    // Stop once a level removes less than this fraction
+    };
+
+    struct LodLevel
+    {
+        std::vector<uint32_t> indices;
+        float error = 0.0f; // Object-space distance relative to the source mesh
+    };
+
+    // Builds successively coarser levels, each simplified from the previous.
+    // The source level itself is not included in `outLevels`.
+    void generateLodChain(const ModelVertex* pVertices, size_t vertexCount,
+                          const uint32_t* pIndices, size_t indexCount,
+                          const Bounds& bounds, const LodOptions& options,
+                          std::vector<LodLevel>& outLevels);
+
+    // Generates LOD chains for every primitive of a model and appends them to
+    // ModelData::lods / indices. Primitives are simplified in parallel on
+    // `threadCount` threads (0 = hardware concurrency).
+    void generateModelLods(ModelData& model, const LodOptions& options, unsigned int threadCount = 0);
+} // namespace Pinnacle
@@ -0,0 +1,81 @@
+#include "MeshUtilities.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        struct PositionKey
+        {
+            uint32_t bits[3];
+
+            bool operator==(const PositionKey& other) const
+            {
+                return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+            }
+        };
+
+        struct PositionHash
+        {
+            size_t operator()(const PositionKey& key) const
+            {
+                uint64_t h = key.bits[0] * 73856093ull;
+                h ^= key.bits[1] * 19349663ull;
+                h ^= key.bits[2] * 83492791ull;
+                return static_cast<size_t>(h);
+            }
+        };
+    } // namespace
+
+    uint32_t weldPositions(const ModelVertex* pVertices, size_t vertexCount,
+                           std::vector<uint32_t>& vertexGroup, std::vector<uint32_t>& groupRepresentative)
+    {
+        std::unordered_map<PositionKey, uint32_t, PositionHash> groups;
+        groups.reserve(vertexCount);
+        vertexGroup.resize(vertexCount);
+        groupRepresentative.clear();
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            PositionKey key;
+            for (int i = 0; i < 3; ++i)
+            {
+                // Fold -0 into +0 so mirrored seams weld.
+                const float value = pVertices[v].position[i] == 0.0f ? 0.0f : pVertices[v].position[i];
+                std::memcpy(&key.bits[i], &value, sizeof(float));
+            }
+            auto inserted = groups.emplace(key, static_cast<uint32_t>(groupRepresentative.size()));
+            if (inserted.second)
+            {
+                groupRepresentative.push_back(static_cast<uint32_t>(v));
+            }
+            vertexGroup[v] = inserted.first->second;
+        }
+        return static_cast<uint32_t>(groupRepresentative.size());
+    }
+
+    float computeUvDensity(const ModelVertex* pVertices, const uint32_t* pIndices, size_t indexCount)
+    {
+        double uvArea = 0.0;
+        double surfaceArea = 0.0;
+        for (size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            const ModelVertex& a = pVertices[pIndices[i]];
+            const ModelVertex& b = pVertices[pIndices[i + 1]];
+            const ModelVertex& c = pVertices[pIndices[i + 2]];
+
+            const double e1[3] = { b.position[0] - a.position[0], b.position[1] - a.position[1], b.position[2] - a.position[2] };
+            const double e2[3] = { c.position[0] - a.position[0], c.position[1] - a.position[1], c.position[2] - a.position[2] };
+            const double cross[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+            surfaceArea += 0.5 * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+            const double u1 = b.texCoords[0] - a.texCoords[0], v1 = b.texCoords[1] - a.texCoords[1];
+            const double u2 = c.texCoords[0] - a.texCoords[0], v2 = c.texCoords[1] - a.texCoords[1];
+            uvArea += 0.5 * std::fabs(u1 * v2 - u2 * v1);
+        }
+        return surfaceArea > 0.0 ? static_cast<float>(std::sqrt(uvArea / surfaceArea)) : 0.0f;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Welds vertices that share an exact position (attribute seams, flat
+    // shading) so topology-driven passes see one connected surface. Returns
+    // the group count; `vertexGroup[v]` is the group of vertex v and
+    // `groupRepresentative[g]` the first vertex of group g.
+    uint32_t weldPositions(const ModelVertex* pVertices, size_t vertexCount,
+                           std::vector<uint32_t>& vertexGroup, std::vector<uint32_t>& groupRepresentative);
+
+    // Average texture-space density of an indexed triangle list in UV units
+    // per object-space unit: sqrt(total UV area / total surface area).
+    // Returns 0 for meshes without usable UVs or area.
+    float computeUvDensity(const ModelVertex* pVertices, const uint32_t* pIndices, size_t indexCount);
+} // namespace Pinnacle
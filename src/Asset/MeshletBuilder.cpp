@@ -0,0 +1,269 @@
+#include "MeshletBuilder.hpp"
+
+#include "MeshUtilities.hpp"
+#include "../Core/Parallel.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // Cones wider than this (dot of the widest normal with the axis) would
+        // almost never cull; leave them disabled.
+        const float kMinConeDot = 0.1f;
+
+        void triangleCentroid(const ModelVertex* pVertices, const uint32_t* pTriangle, float out[3])
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                out[i] = (pVertices[pTriangle[0]].position[i] + pVertices[pTriangle[1]].position[i] +
+                          pVertices[pTriangle[2]].position[i]) / 3.0f;
+            }
+        }
+
+        void computeMeshletBounds(const ModelVertex* pVertices, const uint32_t* pIndices, uint32_t triangleCount,
+                                  MeshletData& meshlet)
+        {
+            Bounds bounds;
+            for (uint32_t i = 0; i < triangleCount * 3; ++i)
+            {
+                bounds.expand(pVertices[pIndices[i]].position);
+            }
+            float radiusSquared = 0.0f;
+            for (int i = 0; i < 3; ++i)
+            {
+                meshlet.center[i] = (bounds.min[i] + bounds.max[i]) * 0.5f;
+            }
+            for (uint32_t i = 0; i < triangleCount * 3; ++i)
+            {
+                const float* p = pVertices[pIndices[i]].position;
+                const float dx = p[0] - meshlet.center[0];
+                const float dy = p[1] - meshlet.center[1];
+                const float dz = p[2] - meshlet.center[2];
+                radiusSquared = std::max(radiusSquared, dx * dx + dy * dy + dz * dz);
+            }
+            meshlet.radius = std::sqrt(radiusSquared);
+
+            // Normal cone from the unit face normals (winding order, CCW front).
+            std::vector<float> normals;
+            normals.reserve(triangleCount * 3);
+            float axis[3] = { 0.0f, 0.0f, 0.0f };
+            for (uint32_t t = 0; t < triangleCount; ++t)
+            {
+                const float* p0 = pVertices[pIndices[t * 3 + 0]].position;
+                const float* p1 = pVertices[pIndices[t * 3 + 1]].position;
+                const float* p2 = pVertices[pIndices[t * 3 + 2]].position;
+                const float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+                const float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+                float n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+                const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+                if (length <= 0.0f)
+                {
+                    continue;
+                }
+                for (int i = 0; i < 3; ++i)
+                {
+                    n[i] /= length;
+                    axis[i] += n[i];
+                    normals.push_back(n[i]);
+                }
+            }
+
+            meshlet.coneAxis[0] = meshlet.coneAxis[1] = meshlet.coneAxis[2] = 0.0f;
+            meshlet.coneCutoff = 1.0f;
+            const float axisLength = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+            if (normals.empty() || axisLength <= 0.0f)
+            {
+                return;
+            }
+            float minDot = 1.0f;
+            for (size_t i = 0; i < normals.size(); i += 3)
+            {
+                const float d = (normals[i] * axis[0] + normals[i + 1] * axis[1] + normals[i + 2] * axis[2]) / axisLength;
+                minDot = std::min(minDot, d);
+            }
+            if (minDot < kMinConeDot)
+            {
+                return;
+            }
+            for (int i = 0; i < 3; ++i)
+            {
+                meshlet.coneAxis[i] = axis[i] / axisLength;
+            }
+            // Sine of the cone's half angle.
+            meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+        }
+    } // namespace
+
+    void buildMeshlets(const ModelVertex* pVertices, size_t vertexCount, uint32_t* pIndices, size_t indexCount,
+                       uint32_t indexBase, std::vector<MeshletData>& outMeshlets)
+    {
+        const size_t triangleCount = indexCount / 3;
+        if (!pVertices || vertexCount == 0 || triangleCount == 0)
+        {
+            return;
+        }
+
+        // Welded vertex -> triangle adjacency.
+        std::vector<uint32_t> vertexGroup, groupRepresentative;
+        const uint32_t groupCount = weldPositions(pVertices, vertexCount, vertexGroup, groupRepresentative);
+        std::vector<uint32_t> adjacencyOffsets(groupCount + 1, 0);
+        for (size_t i = 0; i < triangleCount * 3; ++i)
+        {
+            adjacencyOffsets[vertexGroup[pIndices[i]] + 1]++;
+        }
+        for (uint32_t g = 0; g < groupCount; ++g)
+        {
+            adjacencyOffsets[g + 1] += adjacencyOffsets[g];
+        }
+        std::vector<uint32_t> adjacency(triangleCount * 3);
+        {
+            std::vector<uint32_t> cursor(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < triangleCount * 3; ++i)
+            {
+                adjacency[cursor[vertexGroup[pIndices[i]]]++] = static_cast<uint32_t>(i / 3);
+            }
+        }
+
+        std::vector<uint32_t> source(pIndices, pIndices + triangleCount * 3);
+        std::vector<uint8_t> emitted(triangleCount, 0);
+        std::vector<uint32_t> vertexMeshlet(vertexCount, UINT32_MAX);
+        std::vector<uint32_t> candidates;
+        size_t write = 0;
+        size_t seed = 0;
+
+        while (write < triangleCount * 3)
+        {
+            const uint32_t meshletIndex = static_cast<uint32_t>(outMeshlets.size());
+            MeshletData meshlet = {};
+            meshlet.indexOffset = indexBase + static_cast<uint32_t>(write);
+            float centroidSum[3] = { 0.0f, 0.0f, 0.0f };
+
+            // Continue from the previous meshlet's frontier when possible so
+            // consecutive meshlets stay spatially coherent.
+            uint32_t next = UINT32_MAX;
+            for (uint32_t candidate : candidates)
+            {
+                if (!emitted[candidate])
+                {
+                    next = candidate;
+                    break;
+                }
+            }
+            if (next == UINT32_MAX)
+            {
+                while (emitted[seed])
+                {
+                    ++seed;
+                }
+                next = static_cast<uint32_t>(seed);
+            }
+            candidates.clear();
+
+            while (next != UINT32_MAX)
+            {
+                const uint32_t* pTriangle = &source[next * 3];
+                emitted[next] = 1;
+                for (int c = 0; c < 3; ++c)
+                {
+                    const uint32_t vertex = pTriangle[c];
+                    pIndices[write++] = vertex;
+                    if (vertexMeshlet[vertex] != meshletIndex)
+                    {
+                        vertexMeshlet[vertex] = meshletIndex;
+                        meshlet.vertexCount++;
+                        const uint32_t group = vertexGroup[vertex];
+                        candidates.insert(candidates.end(), adjacency.begin() + adjacencyOffsets[group],
+                                          adjacency.begin() + adjacencyOffsets[group + 1]);
+                    }
+                }
+                meshlet.triangleCount++;
+                float centroid[3];
+                triangleCentroid(pVertices, pTriangle, centroid);
+                for (int i = 0; i < 3; ++i)
+                {
+                    centroidSum[i] += centroid[i];
+                }
+
+                if (meshlet.triangleCount == kMaxMeshletTriangles)
+                {
+                    break;
+                }
+
+                // Fewest new vertices first, then closest to the meshlet centre.
+                const float center[3] = { centroidSum[0] / meshlet.triangleCount, centroidSum[1] / meshlet.triangleCount,
+                                          centroidSum[2] / meshlet.triangleCount };
+                next = UINT32_MAX;
+                uint32_t bestNewVertices = 4;
+                float bestDistance = 0.0f;
+                size_t keep = 0;
+                for (size_t i = 0; i < candidates.size(); ++i)
+                {
+                    const uint32_t candidate = candidates[i];
+                    if (emitted[candidate])
+                    {
+                        continue;
+                    }
+                    candidates[keep++] = candidate;
+
+                    const uint32_t* pCandidate = &source[candidate * 3];
+                    uint32_t newVertices = 0;
+                    for (int c = 0; c < 3; ++c)
+                    {
+                        newVertices += vertexMeshlet[pCandidate[c]] != meshletIndex ? 1 : 0;
+                    }
+                    if (meshlet.vertexCount + newVertices > kMaxMeshletVertices || newVertices > bestNewVertices)
+                    {
+                        continue;
+                    }
+                    float centroid[3];
+                    triangleCentroid(pVertices, pCandidate, centroid);
+                    const float dx = centroid[0] - center[0];
+                    const float dy = centroid[1] - center[1];
+                    const float dz = centroid[2] - center[2];
+                    const float distance = dx * dx + dy * dy + dz * dz;
+                    if (newVertices < bestNewVertices || distance < bestDistance)
+                    {
+                        next = candidate;
+                        bestNewVertices = newVertices;
+                        bestDistance = distance;
+                    }
+                }
+                candidates.resize(keep);
+            }
+
+            computeMeshletBounds(pVertices, pIndices + (meshlet.indexOffset - indexBase), meshlet.triangleCount, meshlet);
+            outMeshlets.push_back(meshlet);
+        }
+    }
+
+    void generateModelMeshlets(ModelData& model, uint32_t minTriangles, unsigned int threadCount)
+    {
+        model.meshlets.clear();
+        const size_t primitiveCount = model.primitives.size();
+        std::vector<std::vector<MeshletData>> clusters(primitiveCount);
+
+        parallelFor(primitiveCount, threadCount, [&](size_t i)
+        {
+            const PrimitiveData& primitive = model.primitives[i];
+            if (primitive.indexCount / 3 < minTriangles)
+            {
+                return;
+            }
+            // Each primitive owns a disjoint index range, so workers never overlap.
+            buildMeshlets(model.vertices.data() + primitive.vertexOffset, primitive.vertexCount,
+                          model.indices.data() + primitive.indexOffset, primitive.indexCount,
+                          primitive.indexOffset, clusters[i]);
+        });
+
+        for (size_t i = 0; i < primitiveCount; ++i)
+        {
+            PrimitiveData& primitive = model.primitives[i];
+            primitive.firstMeshlet = static_cast<uint32_t>(model.meshlets.size());
+            primitive.meshletCount = static_cast<uint32_t>(clusters[i].size());
+            model.meshlets.insert(model.meshlets.end(), clusters[i].begin(), clusters[i].end());
+        }
+    }
+} // namespace Pinnacle
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    const uint32_t kMaxMeshletVertices = 64;
+    const uint32_t kMaxMeshletTriangles = 124;
+
+    // Splits an indexed triangle list into meshlets and reorders `pIndices`
+    // in place so each meshlet's triangles are contiguous. Meshlets grow
+    // greedily across shared edges (positions are welded, so flat-shaded and
+    // seamed meshes still cluster), preferring triangles that add the fewest
+    // new vertices and then the ones closest to the meshlet. `indexBase` is
+    // added to every MeshletData::indexOffset.
+    void buildMeshlets(const ModelVertex* pVertices, size_t vertexCount, uint32_t* pIndices, size_t indexCount,
+                       uint32_t indexBase, std::vector<MeshletData>& outMeshlets);
+
+    // Builds meshlets for the full-detail level of every primitive with at
+    // least `minTriangles` triangles; smaller primitives are culled whole.
+    // Runs in parallel across primitives on `threadCount` threads
+    // (0 = hardware concurrency).
+    void generateModelMeshlets(ModelData& model, uint32_t minTriangles = 4 * kMaxMeshletTriangles,
+                               unsigned int threadCount = 0);
+} // namespace Pinnacle
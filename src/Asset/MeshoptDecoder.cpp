@@ -0,0 +1,491 @@
+#include "MeshoptDecoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const uint8_t kVertexHeader = 0xA0;
+        const uint8_t kIndexHeader = 0xE0;
+        const uint8_t kSequenceHeader = 0xD0;
+
+        const size_t kByteGroupSize = 16;
+        const size_t kByteGroupDecodeLimit = 24; // Most bytes one group can read
+        const size_t kVertexBlockSizeBytes = 8192;
+        const size_t kVertexBlockMaxSize = 256;
+        const size_t kTailMaxSize = 32;
+
+        // Most bytes one encoded byte can decode to: a vertex block spends at
+        // least 4 header bytes on each 256-byte column. The index codecs spend
+        // at least a byte per triangle (12 bytes) or per index (4 bytes).
+        const uint64_t kMaxExpansion = 64;
+
+        // Vertices per block: the transposed block has to fit the scratch
+        // buffer, rounded down to whole byte groups.
+        size_t getVertexBlockSize(size_t vertexSize)
+        {
+            const size_t result = (kVertexBlockSizeBytes / vertexSize) & ~(kByteGroupSize - 1);
+            return std::min(result, kVertexBlockMaxSize);
+        }
+
+        uint8_t unzigzag8(uint8_t value)
+        {
+            return static_cast<uint8_t>(-(value & 1) ^ (value >> 1));
+        }
+
+        // One group of 16 bytes stored as 0, 2 or 4 bits each (the all-ones
+        // value escapes to a literal byte after the packed bits) or raw.
+        const uint8_t* decodeBytesGroup(const uint8_t* pData, uint8_t* pOut, int bitsLog2)
+        {
+            if (bitsLog2 == 0)
+            {
+                std::memset(pOut, 0, kByteGroupSize);
+                return pData;
+            }
+            if (bitsLog2 == 3)
+            {
+                std::memcpy(pOut, pData, kByteGroupSize);
+                return pData + kByteGroupSize;
+            }
+
+            const int bits = bitsLog2 == 1 ? 2 : 4;
+            const uint8_t escape = static_cast<uint8_t>((1 << bits) - 1);
+            const uint8_t* pLiterals = pData + kByteGroupSize * bits / 8;
+            for (size_t i = 0; i < kByteGroupSize; ++i)
+            {
+                const int shift = 8 - bits - static_cast<int>(i * bits % 8);
+                const uint8_t encoded = static_cast<uint8_t>((pData[i * bits / 8] >> shift) & escape);
+                pOut[i] = encoded == escape ? *pLiterals++ : encoded;
+            }
+            return pLiterals;
+        }
+
+        const uint8_t* decodeBytes(const uint8_t* pData, const uint8_t* pEnd, uint8_t* pOut, size_t count)
+        {
+            // Two header bits per group select its encoding.
+            const size_t headerSize = (count / kByteGroupSize + 3) / 4;
+            if (static_cast<size_t>(pEnd - pData) < headerSize)
+            {
+                return nullptr;
+            }
+            const uint8_t* pHeader = pData;
+            pData += headerSize;
+
+            for (size_t i = 0; i < count; i += kByteGroupSize)
+            {
+                if (static_cast<size_t>(pEnd - pData) < kByteGroupDecodeLimit)
+                {
+                    return nullptr;
+                }
+                const size_t group = i / kByteGroupSize;
+                const int bitsLog2 = (pHeader[group / 4] >> ((group % 4) * 2)) & 3;
+                pData = decodeBytesGroup(pData, pOut + i, bitsLog2);
+            }
+            return pData;
+        }
+
+        // Each byte lane of the block is stored separately as zigzag deltas
+        // from the same byte of the previous vertex.
+        const uint8_t* decodeVertexBlock(const uint8_t* pData, const uint8_t* pEnd, uint8_t* pOut, size_t vertexCount,
+                                         size_t vertexSize, uint8_t lastVertex[256])
+        {
+            uint8_t deltas[kVertexBlockMaxSize];
+            const size_t alignedCount = (vertexCount + kByteGroupSize - 1) & ~(kByteGroupSize - 1);
+            for (size_t k = 0; k < vertexSize; ++k)
+            {
+                pData = decodeBytes(pData, pEnd, deltas, alignedCount);
+                if (!pData)
+                {
+                    return nullptr;
+                }
+                uint8_t previous = lastVertex[k];
+                for (size_t i = 0; i < vertexCount; ++i)
+                {
+                    previous = static_cast<uint8_t>(unzigzag8(deltas[i]) + previous);
+                    pOut[i * vertexSize + k] = previous;
+                }
+            }
+            std::memcpy(lastVertex, pOut + (vertexCount - 1) * vertexSize, vertexSize);
+            return pData;
+        }
+
+        bool decodeVertexBuffer(uint8_t* pOut, size_t count, size_t vertexSize, const uint8_t* pData, size_t size)
+        {
+            if (vertexSize == 0 || vertexSize > 256 || vertexSize % 4 != 0 || size < 1 + vertexSize)
+            {
+                return false;
+            }
+            const uint8_t* pEnd = pData + size;
+            if ((*pData & 0xF0) != kVertexHeader || (*pData & 0x0F) > 0)
+            {
+                return false;
+            }
+            ++pData;
+
+            // The tail holds the first vertex the deltas start from.
+            uint8_t lastVertex[256];
+            std::memcpy(lastVertex, pEnd - vertexSize, vertexSize);
+
+            const size_t blockSize = getVertexBlockSize(vertexSize);
+            for (size_t offset = 0; offset < count; offset += blockSize)
+            {
+                pData = decodeVertexBlock(pData, pEnd, pOut + offset * vertexSize, std::min(blockSize, count - offset),
+                                          vertexSize, lastVertex);
+                if (!pData)
+                {
+                    return false;
+                }
+            }
+            return static_cast<size_t>(pEnd - pData) == std::max(vertexSize, kTailMaxSize);
+        }
+
+        uint32_t decodeVByte(const uint8_t*& pData)
+        {
+            const uint8_t lead = *pData++;
+            if (lead < 128)
+            {
+                return lead;
+            }
+            // At most four more bytes, so malformed data cannot run away.
+            uint32_t result = lead & 127;
+            uint32_t shift = 7;
+            for (int i = 0; i < 4; ++i)
+            {
+                const uint8_t group = *pData++;
+                result |= static_cast<uint32_t>(group & 127) << shift;
+                shift += 7;
+                if (group < 128)
+                {
+                    break;
+                }
+            }
+            return result;
+        }
+
+        uint32_t decodeIndex(const uint8_t*& pData, uint32_t last)
+        {
+            const uint32_t value = decodeVByte(pData);
+            return last + ((value >> 1) ^ (0u - (value & 1)));
+        }
+
+        void writeIndex(uint8_t* pOut, size_t i, size_t indexSize, uint32_t index)
+        {
+            if (indexSize == 2)
+            {
+                const uint16_t value = static_cast<uint16_t>(index);
+                std::memcpy(pOut + i * 2, &value, sizeof(value));
+            }
+            else
+            {
+                std::memcpy(pOut + i * 4, &index, sizeof(index));
+            }
+        }
+
+        // Triangles are coded against a FIFO of recent edges and one of
+        // recent vertices; both must be updated exactly as the encoder does.
+        class IndexFifos
+        {
+        public:
+            IndexFifos()
+            {
+                std::memset(m_edges, 0xFF, sizeof(m_edges));
+                std::memset(m_vertices, 0xFF, sizeof(m_vertices));
+            }
+
+            const uint32_t* getEdge(int age) const { return m_edges[(m_edgeOffset - 1 - age) & 15]; }
+            uint32_t getVertex(int distance) const { return m_vertices[(m_vertexOffset - distance) & 15]; }
+
+            void pushEdge(uint32_t a, uint32_t b)
+            {
+                m_edges[m_edgeOffset][0] = a;
+                m_edges[m_edgeOffset][1] = b;
+                m_edgeOffset = (m_edgeOffset + 1) & 15;
+            }
+
+            void pushVertex(uint32_t vertex, bool advance = true)
+            {
+                m_vertices[m_vertexOffset] = vertex;
+                m_vertexOffset = (m_vertexOffset + (advance ? 1 : 0)) & 15;
+            }
+
+        private:
+            uint32_t m_edges[16][2];
+            uint32_t m_vertices[16];
+            size_t m_edgeOffset = 0;
+            size_t m_vertexOffset = 0;
+        };
+
+        bool decodeIndexBuffer(uint8_t* pOut, size_t indexCount, size_t indexSize, const uint8_t* pBuffer, size_t size)
+        {
+            // Header, one code byte per triangle and the 16-byte aux code table.
+            if (indexCount % 3 != 0 || (indexSize != 2 && indexSize != 4) || size < 1 + indexCount / 3 + 16)
+            {
+                return false;
+            }
+            if ((pBuffer[0] & 0xF0) != kIndexHeader || (pBuffer[0] & 0x0F) > 1)
+            {
+                return false;
+            }
+            const int maxFifoCode = (pBuffer[0] & 0x0F) >= 1 ? 13 : 15;
+
+            IndexFifos fifos;
+            uint32_t next = 0;
+            uint32_t last = 0;
+            const uint8_t* pCode = pBuffer + 1;
+            const uint8_t* pData = pCode + indexCount / 3;
+            const uint8_t* pSafeEnd = pBuffer + size - 16;
+            const uint8_t* pAuxTable = pSafeEnd;
+
+            for (size_t i = 0; i < indexCount; i += 3)
+            {
+                // A triangle reads at most 16 bytes; the aux table pads the end.
+                if (pData > pSafeEnd)
+                {
+                    return false;
+                }
+                const uint8_t code = *pCode++;
+                uint32_t a, b, c;
+                if (code < 0xF0)
+                {
+                    // Reuses a recent edge; the third vertex is new, recent or free.
+                    const uint32_t* pEdge = fifos.getEdge(code >> 4);
+                    a = pEdge[0];
+                    b = pEdge[1];
+                    const int vertexCode = code & 15;
+                    if (vertexCode == 0)
+                    {
+                        c = next++;
+                        fifos.pushVertex(c);
+                    }
+                    else if (vertexCode < maxFifoCode)
+                    {
+                        c = fifos.getVertex(vertexCode + 1);
+                        fifos.pushVertex(c, false);
+                    }
+                    else
+                    {
+                        // 13 and 14 are -1 and +1 from the last free index.
+                        c = last = vertexCode != 15 ? last + (vertexCode - (vertexCode ^ 3)) : decodeIndex(pData, last);
+                        fifos.pushVertex(c);
+                    }
+                    fifos.pushEdge(c, b);
+                    fifos.pushEdge(a, c);
+                }
+                else
+                {
+                    // Three vertices coded through the aux table or an aux byte.
+                    uint8_t aux;
+                    bool aIsFree = false;
+                    if (code < 0xFE)
+                    {
+                        aux = pAuxTable[code & 15];
+                    }
+                    else
+                    {
+                        aux = *pData++;
+                        aIsFree = code != 0xFE;
+                        if (aux == 0)
+                        {
+                            next = 0;
+                        }
+                    }
+                    const int bCode = aux >> 4;
+                    const int cCode = aux & 15;
+
+                    // `next` advances for all three before free indices are read, as in the encoder.
+                    a = aIsFree ? 0 : next++;
+                    b = bCode == 0 ? next++ : fifos.getVertex(bCode);
+                    c = cCode == 0 ? next++ : fifos.getVertex(cCode);
+                    if (aIsFree)
+                    {
+                        a = last = decodeIndex(pData, last);
+                    }
+                    if (bCode == 15)
+                    {
+                        b = last = decodeIndex(pData, last);
+                    }
+                    if (cCode == 15)
+                    {
+                        c = last = decodeIndex(pData, last);
+                    }
+                    fifos.pushVertex(a);
+                    fifos.pushVertex(b, bCode == 0 || bCode == 15);
+                    fifos.pushVertex(c, cCode == 0 || cCode == 15);
+                    fifos.pushEdge(b, a);
+                    fifos.pushEdge(c, b);
+                    fifos.pushEdge(a, c);
+                }
+                writeIndex(pOut, i + 0, indexSize, a);
+                writeIndex(pOut, i + 1, indexSize, b);
+                writeIndex(pOut, i + 2, indexSize, c);
+            }
+            return pData == pSafeEnd;
+        }
+
+        bool decodeIndexSequence(uint8_t* pOut, size_t indexCount, size_t indexSize, const uint8_t* pBuffer, size_t size)
+        {
+            // Header, at least one byte per index and a 4-byte tail.
+            if ((indexSize != 2 && indexSize != 4) || size < 1 + indexCount + 4)
+            {
+                return false;
+            }
+            if ((pBuffer[0] & 0xF0) != kSequenceHeader || (pBuffer[0] & 0x0F) > 1)
+            {
+                return false;
+            }
+
+            const uint8_t* pData = pBuffer + 1;
+            const uint8_t* pSafeEnd = pBuffer + size - 4;
+            uint32_t last[2] = { 0, 0 };
+            for (size_t i = 0; i < indexCount; ++i)
+            {
+                if (pData >= pSafeEnd)
+                {
+                    return false;
+                }
+                // The low bit picks which of two baselines the delta is from.
+                uint32_t value = decodeVByte(pData);
+                const uint32_t baseline = value & 1;
+                value >>= 1;
+                last[baseline] += (value >> 1) ^ (0u - (value & 1));
+                writeIndex(pOut, i, indexSize, last[baseline]);
+            }
+            return pData == pSafeEnd;
+        }
+
+        int32_t roundToInt(float value)
+        {
+            return static_cast<int32_t>(value + (value >= 0.0f ? 0.5f : -0.5f));
+        }
+
+        // Rebuilds snorm xyz from octahedral xy with the scale stored in z.
+        template <typename T>
+        void decodeOctahedralFilter(T* pData, size_t count)
+        {
+            const float maximum = static_cast<float>((1 << (sizeof(T) * 8 - 1)) - 1);
+            for (size_t i = 0; i < count; ++i)
+            {
+                T* pVector = pData + i * 4;
+                float x = pVector[0];
+                float y = pVector[1];
+                const float z = pVector[2] - std::fabs(x) - std::fabs(y);
+                const float t = std::min(z, 0.0f);
+                x += x >= 0.0f ? t : -t;
+                y += y >= 0.0f ? t : -t;
+
+                const float scale = maximum / std::sqrt(x * x + y * y + z * z);
+                pVector[0] = static_cast<T>(roundToInt(x * scale));
+                pVector[1] = static_cast<T>(roundToInt(y * scale));
+                pVector[2] = static_cast<T>(roundToInt(z * scale));
+            }
+        }
+
+        // Rebuilds a unit quaternion from its three smallest components; the
+        // fourth short holds the scale and which component was dropped.
+        void decodeQuaternionFilter(int16_t* pData, size_t count)
+        {
+            const float kScale = 1.0f / std::sqrt(2.0f);
+            for (size_t i = 0; i < count; ++i)
+            {
+                int16_t* pQuaternion = pData + i * 4;
+                const float scale = kScale / static_cast<float>(pQuaternion[3] | 3);
+                const float x = pQuaternion[0] * scale;
+                const float y = pQuaternion[1] * scale;
+                const float z = pQuaternion[2] * scale;
+                const float w = std::sqrt(std::max(1.0f - x * x - y * y - z * z, 0.0f));
+
+                const int dropped = pQuaternion[3] & 3;
+                pQuaternion[(dropped + 1) & 3] = static_cast<int16_t>(roundToInt(x * 32767.0f));
+                pQuaternion[(dropped + 2) & 3] = static_cast<int16_t>(roundToInt(y * 32767.0f));
+                pQuaternion[(dropped + 3) & 3] = static_cast<int16_t>(roundToInt(z * 32767.0f));
+                pQuaternion[dropped] = static_cast<int16_t>(roundToInt(w * 32767.0f));
+            }
+        }
+
+        // Each 32-bit value is a 24-bit mantissa with an 8-bit exponent.
+        void decodeExponentialFilter(uint8_t* pData, size_t count)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                uint32_t value;
+                std::memcpy(&value, pData + i * 4, sizeof(value));
+                const int32_t mantissa = static_cast<int32_t>(value << 8) >> 8;
+                const int32_t exponent = static_cast<int32_t>(value) >> 24;
+                const float decoded = std::ldexp(static_cast<float>(mantissa), exponent);
+                std::memcpy(pData + i * 4, &decoded, sizeof(decoded));
+            }
+        }
+    } // namespace
+
+    bool getMeshoptDecodedSize(const GltfMeshoptCompression& compression, size_t& size)
+    {
+        const uint64_t count = compression.count;
+        const uint64_t stride = compression.byteStride;
+        if (count == 0 || stride == 0 || count > SIZE_MAX / stride ||
+            count * stride / kMaxExpansion > compression.byteLength)
+        {
+            return false;
+        }
+        size = static_cast<size_t>(count * stride);
+        return true;
+    }
+
+    bool decodeMeshoptBufferView(const GltfMeshoptCompression& compression, const uint8_t* pData, size_t size,
+                                 uint8_t* pOut)
+    {
+        using Mode = GltfMeshoptCompression::Mode;
+        using Filter = GltfMeshoptCompression::Filter;
+
+        const size_t count = compression.count;
+        const size_t stride = compression.byteStride;
+        if (count == 0)
+        {
+            return true;
+        }
+        switch (compression.mode)
+        {
+            case Mode::Attributes:
+                if (!decodeVertexBuffer(pOut, count, stride, pData, size))
+                {
+                    return false;
+                }
+                break;
+            case Mode::Triangles:
+                return compression.filter == Filter::None && decodeIndexBuffer(pOut, count, stride, pData, size);
+            case Mode::Indices:
+                return compression.filter == Filter::None && decodeIndexSequence(pOut, count, stride, pData, size);
+        }
+
+        switch (compression.filter)
+        {
+            case Filter::None:
+                return true;
+            case Filter::Octahedral:
+                if (stride == 4)
+                {
+                    decodeOctahedralFilter(reinterpret_cast<int8_t*>(pOut), count);
+                    return true;
+                }
+                if (stride == 8)
+                {
+                    decodeOctahedralFilter(reinterpret_cast<int16_t*>(pOut), count);
+                    return true;
+                }
+                return false;
+            case Filter::Quaternion:
+                if (stride != 8)
+                {
+                    return false;
+                }
+                decodeQuaternionFilter(reinterpret_cast<int16_t*>(pOut), count);
+                return true;
+            case Filter::Exponential:
+                decodeExponentialFilter(pOut, count * stride / 4);
+                return true;
+        }
+        return false;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "GltfParser.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinnacle
+{
+    // Decodes one EXT_meshopt_compression buffer view: the meshoptimizer
+    // vertex codec (v0) for ATTRIBUTES, the index codec (v0, v1) for
+    // TRIANGLES and the index sequence codec for INDICES, then the view's
+    // filter. `pOut` receives count * byteStride bytes. False if the stream
+    // is malformed or truncated; nothing outside `pData` is ever read.
+    // The count * byteStride bytes a view decodes to. False if either is
+    // zero, the product overflows, or it is more than any well-formed stream
+    // of the view's byteLength could expand to.
+    bool getMeshoptDecodedSize(const GltfMeshoptCompression& compression, size_t& size);
+
+    bool decodeMeshoptBufferView(const GltfMeshoptCompression& compression, const uint8_t* pData, size_t size,
+                                 uint8_t* pOut);
+} // namespace Pinnacle
@@ -0,0 +1,449 @@
+#pragma once
+
+#include <cfloat>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// CPU-side representation of an imported model. Everything in here is plain
+// C++ so it can be produced on loader threads (and on non-Apple platforms)
+// and handed to the renderer for upload in one piece.
+
+namespace Pinnacle
+{
+    struct Bounds
+    {
+        float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        bool isValid() const { return min[0] <= max[0] && min[1] <= max[1] && min[2] <= max[2]; }
+
+        void expand(const float point[3])
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                min[i] = point[i] < min[i] ? point[i] : min[i];
+                max[i] = point[i] > max[i] ? point[i] : max[i];
+            }
+        }
+
+        void merge(const Bounds& other)
+        {
+            if (!other.isValid())
+            {
+                return;
+            }
+            expand(other.min);
+            expand(other.max);
+        }
+    };
+
+    // Transforms an AABB by a column-major 4x4 affine matrix (Arvo's method).
+    inline Bounds transformBounds(const float matrix[16], const Bounds& bounds)
+    {
+        Bounds result;
+        if (!bounds.isValid())
+        {
+            return result;
+        }
+        for (int row = 0; row < 3; ++row)
+        {
+            result.min[row] = result.max[row] = matrix[12 + row];
+            for (int column = 0; column < 3; ++column)
+            {
+                const float a = matrix[column * 4 + row] * bounds.min[column];
+                const float b = matrix[column * 4 + row] * bounds.max[column];
+                result.min[row] += a < b ? a : b;
+                result.max[row] += a < b ? b : a;
+            }
+        }
+        return result;
+    }
+
+    inline void multiplyMatrices(const float a[16], const float b[16], float out[16])
+    {
+        float result[16];
+        for (int column = 0; column < 4; ++column)
+        {
+            for (int row = 0; row < 4; ++row)
+            {
+                result[column * 4 + row] = a[0 * 4 + row] * b[column * 4 + 0] +
+                                           a[1 * 4 + row] * b[column * 4 + 1] +
+                                           a[2 * 4 + row] * b[column * 4 + 2] +
+                                           a[3 * 4 + row] * b[column * 4 + 3];
+            }
+        }
+        for (int i = 0; i < 16; ++i)
+        {
+            out[i] = result[i];
+        }
+    }
+
+    // Interleaved layout uploaded as-is; matches the vertex descriptor built
+    // in PinnacleMetalRenderer::buildShaders.
+    struct ModelVertex
+    {
+        float position[3];
+        float normal[3];
+        float texCoords[2];
+    };
+
+    enum class VertexFormat : uint32_t
+    {
+        Float,     // ModelVertex, 32 bytes
+        Quantized  // QuantizedVertex, 16 bytes
+    };
+
+    // Compact GPU layout of a ModelVertex, built at upload time for
+    // primitives whose PrimitiveData::vertexFormat is Quantized (see
+    // VertexQuantizer.hpp). Positions are unorm16 over the primitive's
+    // bounds, normals octahedral snorm16 and texture coordinates half floats.
+    struct QuantizedVertex
+    {
+        uint16_t position[4]; // w unused
+        int16_t normal[2];
+        uint16_t texCoords[2];
+    };
+
+    struct PrimitiveData
+    {
+        uint32_t vertexOffset = 0; // First vertex in ModelData::vertices
+        uint32_t vertexCount = 0;
+        uint32_t indexOffset = 0;  // First index in ModelData::indices, indices are primitive-relative
+        uint32_t indexCount = 0;
+        int32_t material = -1;
+        Bounds bounds;             // Object space
+        uint32_t firstLod = 0;     // Coarser levels in ModelData::lods; level 0 is the range above
+        uint32_t lodCount = 0;
+        uint32_t firstMeshlet = 0; // Clusters of the full-detail level in ModelData::meshlets
+        uint32_t meshletCount = 0;
+        VertexFormat vertexFormat = VertexFormat::Float; // GPU layout; ModelData::vertices is always ModelVertex
+        bool hasVertexColors = false; // COLOR_0: vertexCount entries of ModelData::vertexColors from firstColor
+        uint8_t reserved0[3] = {};    // Explicit padding: baked models store this struct as raw bytes
+        uint32_t firstColor = 0;
+        bool hasSkinWeights = false; // JOINTS_0/WEIGHTS_0: vertexCount entries of ModelData::skinVertices from firstSkinVertex
+        uint8_t reserved1[3] = {};
+        uint32_t firstSkinVertex = 0;
+        uint32_t firstMorphTarget = 0; // Blend shapes in ModelData::morphTargets, weighted by the drawing node
+        uint32_t morphTargetCount = 0;
+    };
+
+    // Four joint influences of a skinned vertex. Joints index the list of
+    // the skin the drawing node uses; weights are unorm16 summing to 65535.
+    struct SkinVertex
+    {
+        uint16_t joints[4];
+        uint16_t weights[4];
+    };
+
+    // One blend shape of a primitive, stored sparsely: only the vertices it
+    // moves have a delta, in ascending vertex order. Deltas are ModelVertex
+    // shaped (position, normal and texture coordinate offsets) so they add
+    // straight onto the vertex.
+    struct MorphTargetData
+    {
+        uint32_t firstDelta = 0; // Range in ModelData::morphDeltas and ModelData::morphDeltaVertices
+        uint32_t deltaCount = 0;
+        Bounds deltaBounds;      // Of the position deltas and zero, the offset of every other vertex
+    };
+
+    // One simplified index range of a primitive. It shares the primitive's
+    // vertex range, so indices stay primitive-relative.
+    struct LodData
+    {
+        uint32_t indexOffset = 0;
+        uint32_t indexCount = 0;
+        float error = 0.0f; // Object-space distance from the full-detail surface
+    };
+
+    // A cluster of at most 64 vertices and 124 triangles. The primitive's
+    // full-detail index range is reordered so each meshlet's triangles are
+    // contiguous. Fixed 48-byte layout, shared with the GPU culling kernel.
+    struct MeshletData
+    {
+        float center[3];        // Bounding sphere, object space
+        float radius;
+        float coneAxis[3];      // Backface cone: culled when
+        float coneCutoff;       // dot(c - eye, axis) >= cutoff * |c - eye| + radius; 1 disables
+        uint32_t indexOffset;   // First index in ModelData::indices
+        uint32_t triangleCount;
+        uint32_t vertexCount;
+        uint32_t reserved;
+    };
+
+    struct MeshData
+    {
+        std::string name;
+        uint32_t firstPrimitive = 0;
+        uint32_t primitiveCount = 0;
+    };
+
+    enum class AlphaMode : uint32_t
+    {
+        Opaque,
+        Mask, // Alpha tested against MaterialData::alphaCutoff
+        Blend
+    };
+
+    // Behaviour a material's glTF extensions switch on (see GltfExtensions.hpp).
+    // Each flag selects a shader feature, so materials without them pay nothing.
+    enum MaterialFlag : uint32_t
+    {
+        kMaterialUnlit = 1u << 0,           // KHR_materials_unlit: base color only
+        kMaterialClearcoat = 1u << 1,       // KHR_materials_clearcoat with a non-zero factor
+        kMaterialTextureTransform = 1u << 2 // KHR_texture_transform other than identity on some texture
+    };
+
+    // Texture slots of a material, in MaterialData field order.
+    enum MaterialTexture : uint32_t
+    {
+        kMaterialBaseColorTexture,
+        kMaterialMetallicRoughnessTexture,
+        kMaterialNormalTexture,
+        kMaterialOcclusionTexture,
+        kMaterialEmissiveTexture,
+        kMaterialTextureCount
+    };
+
+    // KHR_texture_transform folded into uv' = (m0 m1 m2; m3 m4 m5) * (u, v, 1).
+    struct TextureTransform
+    {
+        float matrix[6] = { 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f };
+
+        bool isIdentity() const
+        {
+            return matrix[0] == 1.0f && matrix[1] == 0.0f && matrix[2] == 0.0f && matrix[3] == 0.0f && matrix[4] == 1.0f &&
+                   matrix[5] == 0.0f;
+        }
+    };
+
+    // glTF metallic-roughness material. Texture indices are into
+    // ModelData::textures, -1 when absent.
+    struct MaterialData
+    {
+        float baseColorFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float emissiveFactor[3] = { 0.0f, 0.0f, 0.0f };
+        float metallicFactor = 1.0f;
+        float roughnessFactor = 1.0f;
+        float normalScale = 1.0f;
+        float occlusionStrength = 1.0f;
+        float alphaCutoff = 0.5f;
+        AlphaMode alphaMode = AlphaMode::Opaque;
+        bool doubleSided = false;
+        uint8_t reserved[3] = {};              // Explicit padding: baked models store this struct as raw bytes
+        int32_t baseColorTexture = -1;         // sRGB
+        int32_t metallicRoughnessTexture = -1; // Roughness in G, metallic in B
+        int32_t normalTexture = -1;            // Tangent space
+        int32_t occlusionTexture = -1;         // R
+        int32_t emissiveTexture = -1;          // sRGB
+        uint32_t flags = 0;                    // MaterialFlag bits
+        float emissiveStrength = 1.0f;         // KHR_materials_emissive_strength; scales emissiveFactor
+        float clearcoatFactor = 0.0f;
+        float clearcoatRoughnessFactor = 0.0f;
+        TextureTransform textureTransforms[kMaterialTextureCount]; // Per MaterialTexture slot
+    };
+
+    // Pixel formats stored in ModelData::texels, laid out exactly as the GPU
+    // expects them so upload is a straight copy.
+    enum class TextureFormat : uint32_t
+    {
+        RGBA8Unorm,
+        RGBA8Srgb,
+        BC7Unorm, // 4x4 blocks of 16 bytes, rows of blocks top to bottom
+        BC7Srgb
+    };
+
+    inline bool isBlockCompressed(TextureFormat format)
+    {
+        return format == TextureFormat::BC7Unorm || format == TextureFormat::BC7Srgb;
+    }
+
+    // Bytes per row of a mip as stored in ModelData::texels (per row of
+    // blocks for compressed formats); the bytesPerRow of a replaceRegion upload.
+    inline uint32_t getRowPitch(TextureFormat format, uint32_t width)
+    {
+        return isBlockCompressed(format) ? (width + 3) / 4 * 16 : width * 4;
+    }
+
+    struct TextureMipData
+    {
+        uint64_t offset = 0; // Into ModelData::texels, or TextureResource::texels for a shared texture
+        uint64_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    // Texels of one texture held outside any model so that several models
+    // can share them (see ResourceCache). Mip offsets are relative to `texels`.
+    struct TextureResource
+    {
+        TextureFormat format = TextureFormat::RGBA8Unorm;
+        std::vector<TextureMipData> mips;
+        std::vector<uint8_t> texels;
+    };
+
+    struct TextureData
+    {
+        std::string name;
+        std::string uri;          // Resolved path of an external image; empty when embedded
+        uint64_t contentHash = 0; // Of the decoded image, colour space and processing settings
+        TextureFormat format = TextureFormat::RGBA8Unorm;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t firstMip = 0; // Into ModelData::textureMips, largest first
+        uint32_t mipCount = 0; // 0 when the image could not be decoded
+        // When set, this texture's mips index resource->texels instead of
+        // ModelData::texels.
+        std::shared_ptr<const TextureResource> resource;
+    };
+
+    // Flattened node table. Nodes are stored depth-first so a parent always
+    // precedes its children.
+    struct NodeData
+    {
+        int32_t parent = -1;
+        int32_t mesh = -1;
+        int32_t skin = -1; // Index into ModelData::skins; skinned vertices ignore this node's transform
+        uint32_t firstMorphWeight = 0; // Rest weights of the mesh's morph targets in ModelData::morphWeights
+        uint32_t morphWeightCount = 0;
+        // Rest pose that animation channels override. Identity for nodes
+        // given as a matrix, which glTF does not allow to be animated.
+        float translation[3] = { 0.0f, 0.0f, 0.0f };
+        float rotation[4] = { 0.0f, 0.0f, 0.0f, 1.0f }; // Quaternion, xyzw
+        float scale[3] = { 1.0f, 1.0f, 1.0f };
+        float localMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+        float worldMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    };
+
+    struct JointData
+    {
+        int32_t node = -1; // Index into ModelData::nodes
+        float inverseBindMatrix[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    };
+
+    struct SkinData
+    {
+        uint32_t firstJoint = 0; // Range in ModelData::joints
+        uint32_t jointCount = 0;
+    };
+
+    enum class AnimationPath : uint32_t
+    {
+        Translation,
+        Rotation,
+        Scale,
+        Weights // Morph target weights of the node
+    };
+
+    enum class AnimationInterpolation : uint32_t
+    {
+        Linear, // Rotations are slerped
+        Step,
+        CubicSpline
+    };
+
+    // How a channel's key values are stored (see AnimationCompressor.hpp).
+    // Packed encodings hold three uint16 per key in
+    // ModelData::animationPackedValues and never use cubic splines.
+    enum class AnimationEncoding : uint32_t
+    {
+        Float,
+        SmallestThree, // Rotations: the three smallest quaternion components
+        Unorm16        // Translations and scales: rangeMin + value * rangeScale per axis
+    };
+
+    // One animated property of one node. Key times are ascending seconds in
+    // ModelData::animationTimes; Float values are components (3, 4 for
+    // rotations, the node's morphWeightCount for weights) per key in
+    // ModelData::animationValues, and for cubic
+    // splines each key stores in-tangent, value and out-tangent in turn.
+    // Channels may share these ranges, as those of one glTF sampler do.
+    struct AnimationChannelData
+    {
+        int32_t node = -1;
+        AnimationPath path = AnimationPath::Translation;
+        AnimationInterpolation interpolation = AnimationInterpolation::Linear;
+        uint32_t firstKey = 0;
+        uint32_t keyCount = 0;
+        uint32_t firstValue = 0; // Into animationPackedValues for packed encodings
+        AnimationEncoding encoding = AnimationEncoding::Float;
+        float rangeMin[3] = { 0.0f, 0.0f, 0.0f }; // Unorm16 only
+        float rangeScale[3] = { 0.0f, 0.0f, 0.0f };
+    };
+
+    struct AnimationData
+    {
+        std::string name;
+        uint32_t firstChannel = 0; // Range in ModelData::animationChannels
+        uint32_t channelCount = 0;
+        float duration = 0.0f; // Last key time over every channel
+    };
+
+    // Components per key of a transform path; weights depend on the node.
+    inline uint32_t getComponentCount(AnimationPath path) { return path == AnimationPath::Rotation ? 4 : 3; }
+
+    enum class LightType : uint32_t
+    {
+        Directional,
+        Point,
+        Spot
+    };
+
+    // KHR_lights_punctual light. It sits at its node's origin and shines down
+    // the node's -Z axis.
+    struct LightData
+    {
+        LightType type = LightType::Point;
+        int32_t node = -1; // Index into ModelData::nodes
+        float color[3] = { 1.0f, 1.0f, 1.0f }; // Linear
+        float intensity = 1.0f; // Candela for point and spot lights, lux for directional
+        float range = 0.0f; // 0 = unlimited
+        float innerConeAngle = 0.0f;
+        float outerConeAngle = 0.7853982f;
+    };
+
+    struct ModelData
+    {
+        std::string sourcePath;
+        std::vector<ModelVertex> vertices;
+        std::vector<uint32_t> vertexColors; // RGBA8, linear; only for primitives with COLOR_0
+        std::vector<uint32_t> indices;
+        std::vector<PrimitiveData> primitives;
+        std::vector<LodData> lods;
+        std::vector<MeshletData> meshlets;
+        std::vector<MeshData> meshes;
+        std::vector<MaterialData> materials;
+        std::vector<TextureData> textures; // One per glTF image
+        std::vector<TextureMipData> textureMips;
+        std::vector<uint8_t> texels;
+        std::vector<NodeData> nodes;
+        std::vector<LightData> lights;
+        std::vector<SkinVertex> skinVertices; // Only for primitives with JOINTS_0 and WEIGHTS_0
+        std::vector<SkinData> skins;
+        std::vector<JointData> joints;
+        std::vector<AnimationData> animations;
+        std::vector<AnimationChannelData> animationChannels;
+        std::vector<float> animationTimes;
+        std::vector<float> animationValues;
+        std::vector<uint16_t> animationPackedValues;
+        std::vector<MorphTargetData> morphTargets;
+        std::vector<ModelVertex> morphDeltas;
+        std::vector<uint32_t> morphDeltaVertices; // Primitive-relative vertex of each delta
+        std::vector<float> morphWeights;
+        Bounds bounds; // World space, over every node that references a mesh
+
+        bool empty() const { return primitives.empty(); }
+
+        // Base that a texture's mip offsets are relative to.
+        const uint8_t* getTexels(const TextureData& texture) const
+        {
+            return texture.resource ? texture.resource->texels.data() : texels.data();
+        }
+    };
+
+    inline uint32_t getComponentCount(const ModelData& model, const AnimationChannelData& channel)
+    {
+        return channel.path == AnimationPath::Weights ? model.nodes[channel.node].morphWeightCount : getComponentCount(channel.path);
+    }
+} // namespace Pinnacle
@@ -0,0 +1,153 @@
+#include "ResourceCache.hpp"
+
+#include "../Core/Hash.hpp"
+
+namespace Pinnacle
+{
+    size_t ResourceCache::KeyHasher::operator()(const Key& key) const
+    {
+        return static_cast<size_t>(hashCombine(hashBytes(key.uri.data(), key.uri.size()), key.contentHash));
+    }
+
+    ResourceCache& ResourceCache::getShared()
+    {
+        // Leaked on purpose: handles in static or late-destroyed models
+        // release into it during exit.
+        static ResourceCache* pShared = new ResourceCache();
+        return *pShared;
+    }
+
+    std::shared_ptr<const TextureResource> ResourceCache::acquireTexture(const std::string& uri, uint64_t contentHash,
+                                                                         const std::function<bool(TextureResource&)>& build)
+    {
+        const Key key = { uri, contentHash };
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto found = m_textures.find(key);
+            if (found != m_textures.end())
+            {
+                // An expired entry is one whose last handle is being released right now.
+                if (std::shared_ptr<const TextureResource> resource = found->second.resource.lock())
+                {
+                    m_hits++;
+                    m_bytesSaved += resource->texels.size();
+                    return resource;
+                }
+            }
+        }
+
+        m_misses++;
+        TextureResource resource;
+        if (!build(resource))
+        {
+            return nullptr;
+        }
+        m_liveTextures++;
+        m_liveBytes += resource.texels.size();
+        TextureResource* pResource;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            pResource = m_pool.create(std::move(resource));
+        }
+        // Declared before the lock so that a copy losing the race below is
+        // released after the lock is dropped.
+        std::shared_ptr<const TextureResource> built(pResource, [this, key](TextureResource* pReleased)
+        {
+            release(key, pReleased);
+        });
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Entry& entry = m_textures[key];
+        if (std::shared_ptr<const TextureResource> existing = entry.resource.lock())
+        {
+            m_bytesSaved += existing->texels.size();
+            return existing;
+        }
+        entry.resource = built;
+        entry.pResource = pResource;
+        return built;
+    }
+
+    void ResourceCache::release(const Key& key, TextureResource* pResource)
+    {
+        m_liveTextures--;
+        m_liveBytes -= pResource->texels.size();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_textures.find(key);
+        // The entry may already belong to a newer copy published after this one expired.
+        if (found != m_textures.end() && found->second.pResource == pResource)
+        {
+            m_textures.erase(found);
+        }
+        m_pool.destroy(pResource);
+    }
+
+    void ResourceCache::shareTextures(ModelData& model)
+    {
+        std::vector<uint8_t> remaining;
+        for (TextureData& texture : model.textures)
+        {
+            if (texture.resource || texture.mipCount == 0)
+            {
+                continue;
+            }
+
+            if (texture.contentHash != 0)
+            {
+                texture.resource = acquireTexture(texture.uri, texture.contentHash, [&](TextureResource& outResource)
+                {
+                    outResource.format = texture.format;
+                    for (uint32_t mip = 0; mip < texture.mipCount; ++mip)
+                    {
+                        TextureMipData level = model.textureMips[texture.firstMip + mip];
+                        const uint8_t* pBegin = model.texels.data() + level.offset;
+                        level.offset = outResource.texels.size();
+                        outResource.texels.insert(outResource.texels.end(), pBegin, pBegin + level.size);
+                        outResource.mips.push_back(level);
+                    }
+                    return true;
+                });
+                // A resource built from the same hash always has the same layout,
+                // unless the caller mixed up hashes; keep the model's own copy then.
+                if (texture.resource && texture.resource->mips.size() == texture.mipCount &&
+                    texture.resource->format == texture.format)
+                {
+                    for (uint32_t mip = 0; mip < texture.mipCount; ++mip)
+                    {
+                        model.textureMips[texture.firstMip + mip] = texture.resource->mips[mip];
+                    }
+                    continue;
+                }
+                texture.resource.reset();
+            }
+
+            for (uint32_t mip = 0; mip < texture.mipCount; ++mip)
+            {
+                TextureMipData& level = model.textureMips[texture.firstMip + mip];
+                const uint8_t* pBegin = model.texels.data() + level.offset;
+                level.offset = remaining.size();
+                remaining.insert(remaining.end(), pBegin, pBegin + level.size);
+            }
+        }
+        model.texels.swap(remaining);
+    }
+
+    ResourceCacheStats ResourceCache::getStats() const
+    {
+        ResourceCacheStats stats;
+        stats.hits = m_hits.load();
+        stats.misses = m_misses.load();
+        stats.bytesSaved = m_bytesSaved.load();
+        stats.liveTextures = m_liveTextures.load();
+        stats.liveBytes = m_liveBytes.load();
+        return stats;
+    }
+
+    void ResourceCache::resetStats()
+    {
+        m_hits = 0;
+        m_misses = 0;
+        m_bytesSaved = 0;
+    }
+} // namespace Pinnacle
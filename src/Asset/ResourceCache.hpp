@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ModelData.hpp"
+#include "../Core/Memory.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace Pinnacle
+{
+    struct ResourceCacheStats
+    {
+        uint32_t hits = 0;
+        uint32_t misses = 0;
+        uint64_t bytesSaved = 0; // Texels that hits neither rebuilt nor held a second copy of
+        uint32_t liveTextures = 0;
+        uint64_t liveBytes = 0;
+    };
+
+    // In-memory table of textures shared between every model loaded in the
+    // process. An entry is keyed by the texture's source URI plus its content
+    // hash (see TextureData) and lives exactly as long as some handle to it
+    // does: releasing the last handle evicts it. Handles must not outlive
+    // the cache; getShared() is never destroyed. Thread-safe.
+    class ResourceCache
+    {
+    public:
+        ResourceCache() = default;
+        ResourceCache(const ResourceCache&) = delete;
+        ResourceCache& operator=(const ResourceCache&) = delete;
+
+        static ResourceCache& getShared();
+
+        // Returns the live texture for the key, or runs `build` (outside the
+        // lock) and publishes its result. Returns null when `build` fails.
+        // Concurrent misses on one key may both build; the first to publish wins.
+        std::shared_ptr<const TextureResource> acquireTexture(const std::string& uri, uint64_t contentHash,
+                                                              const std::function<bool(TextureResource&)>& build);
+
+        // Moves the texels of every hashed texture in `model` into shared
+        // resources, leaving model.texels with only the unhashed rest. For
+        // models that did not come from an importer using this cache.
+        void shareTextures(ModelData& model);
+
+        ResourceCacheStats getStats() const;
+        void resetStats(); // Hits, misses and bytes saved
+
+    private:
+        struct Key
+        {
+            std::string uri;
+            uint64_t contentHash;
+
+            bool operator==(const Key& other) const { return contentHash == other.contentHash && uri == other.uri; }
+        };
+
+        struct KeyHasher
+        {
+            size_t operator()(const Key& key) const;
+        };
+
+        struct Entry
+        {
+            std::weak_ptr<const TextureResource> resource;
+            const TextureResource* pResource = nullptr; // Tells a stale release from the current copy's
+        };
+
+        void release(const Key& key, TextureResource* pResource);
+
+        mutable std::mutex m_mutex;
+        std::unordered_map<Key, Entry, KeyHasher> m_textures;
+        ObjectPool<TextureResource> m_pool{ 64 }; // Guarded by m_mutex
+        std::atomic<uint32_t> m_hits{ 0 };
+        std::atomic<uint32_t> m_misses{ 0 };
+        std::atomic<uint64_t> m_bytesSaved{ 0 };
+        std::atomic<uint32_t> m_liveTextures{ 0 };
+        std::atomic<uint64_t> m_liveBytes{ 0 };
+    };
+} // namespace Pinnacle
@@ -0,0 +1,301 @@
+#include "TextureProcessor.hpp"
+
+#include "Bc7Encoder.hpp"
+#include "../Core/Memory.hpp"
+#include "../Core/Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const float kPi = 3.14159265358979f;
+        const float kKaiserWidth = 3.0f; // In target texels
+        const float kKaiserAlpha = 4.0f;
+        const size_t kLinearToSrgbTableSize = 16384;
+
+        float srgbToLinear(float value)
+        {
+            return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgb(float value)
+        {
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        const float* getSrgbToLinearTable()
+        {
+            static const std::vector<float> table = []()
+            {
+                std::vector<float> values(256);
+                for (int i = 0; i < 256; ++i)
+                {
+                    values[i] = srgbToLinear(i / 255.0f);
+                }
+                return values;
+            }();
+            return table.data();
+        }
+
+        const uint8_t* getLinearToSrgbTable()
+        {
+            static const std::vector<uint8_t> table = []()
+            {
+                std::vector<uint8_t> values(kLinearToSrgbTableSize);
+                for (size_t i = 0; i < kLinearToSrgbTableSize; ++i)
+                {
+                    const float linear = (i + 0.5f) / kLinearToSrgbTableSize;
+                    values[i] = static_cast<uint8_t>(std::lround(linearToSrgb(linear) * 255.0f));
+                }
+                return values;
+            }();
+            return table.data();
+        }
+
+        // Zeroth-order modified Bessel function of the first kind.
+        float besselI0(float x)
+        {
+            float sum = 1.0f;
+            float term = 1.0f;
+            const float quarterSquare = x * x * 0.25f;
+            for (int k = 1; k < 32 && term > sum * 1e-8f; ++k)
+            {
+                term *= quarterSquare / static_cast<float>(k * k);
+                sum += term;
+            }
+            return sum;
+        }
+
+        float kaiser(float t)
+        {
+            if (std::fabs(t) >= kKaiserWidth)
+            {
+                return 0.0f;
+            }
+            const float sinc = t == 0.0f ? 1.0f : std::sin(kPi * t) / (kPi * t);
+            const float ratio = t / kKaiserWidth;
+            return sinc * besselI0(kKaiserAlpha * std::sqrt(1.0f - ratio * ratio)) / besselI0(kKaiserAlpha);
+        }
+
+        // Source texels (edge-clamped) and normalized weights for every
+        // target texel along one axis; `tapCount` entries per target texel.
+        struct FilterTaps
+        {
+            uint32_t tapCount = 0;
+            std::vector<uint32_t> sources;
+            std::vector<float> weights;
+        };
+
+        FilterTaps buildTaps(uint32_t sourceSize, uint32_t targetSize, MipFilter filter)
+        {
+            FilterTaps taps;
+            if (sourceSize == targetSize)
+            {
+                taps.tapCount = 1;
+                for (uint32_t i = 0; i < targetSize; ++i)
+                {
+                    taps.sources.push_back(i);
+                    taps.weights.push_back(1.0f);
+                }
+                return taps;
+            }
+
+            const float scale = static_cast<float>(sourceSize) / targetSize;
+            const float radius = filter == MipFilter::Box ? scale * 0.5f : kKaiserWidth * scale;
+            taps.tapCount = static_cast<uint32_t>(std::ceil(2.0f * radius)) + 1;
+            taps.sources.resize(static_cast<size_t>(targetSize) * taps.tapCount);
+            taps.weights.resize(taps.sources.size());
+
+            for (uint32_t x = 0; x < targetSize; ++x)
+            {
+                const float center = (x + 0.5f) * scale;
+                const int first = static_cast<int>(std::floor(center - radius));
+                float sum = 0.0f;
+                for (uint32_t t = 0; t < taps.tapCount; ++t)
+                {
+                    const int source = first + static_cast<int>(t);
+                    float weight;
+                    if (filter == MipFilter::Box)
+                    {
+                        weight = std::max(0.0f, std::min(source + 1.0f, center + radius) - std::max(static_cast<float>(source), center - radius));
+                    }
+                    else
+                    {
+                        weight = kaiser((source + 0.5f - center) / scale);
+                    }
+                    const size_t slot = static_cast<size_t>(x) * taps.tapCount + t;
+                    taps.sources[slot] = static_cast<uint32_t>(std::min(std::max(source, 0), static_cast<int>(sourceSize) - 1));
+                    taps.weights[slot] = weight;
+                    sum += weight;
+                }
+                for (uint32_t t = 0; t < taps.tapCount && sum != 0.0f; ++t)
+                {
+                    taps.weights[static_cast<size_t>(x) * taps.tapCount + t] /= sum;
+                }
+            }
+            return taps;
+        }
+
+        // Separable resample of an RGBA float image, one texel per Float4.
+        void resample(const std::vector<float>& source, uint32_t sourceWidth, uint32_t sourceHeight,
+                      std::vector<float>& target, uint32_t targetWidth, uint32_t targetHeight, MipFilter filter)
+        {
+            const FilterTaps horizontal = buildTaps(sourceWidth, targetWidth, filter);
+            const FilterTaps vertical = buildTaps(sourceHeight, targetHeight, filter);
+
+            ScratchScope scratch;
+            ArenaVector<float> rows(static_cast<size_t>(targetWidth) * sourceHeight * 4, &scratch.getArena());
+            for (uint32_t y = 0; y < sourceHeight; ++y)
+            {
+                const float* pIn = source.data() + static_cast<size_t>(y) * sourceWidth * 4;
+                float* pOut = rows.data() + static_cast<size_t>(y) * targetWidth * 4;
+                for (uint32_t x = 0; x < targetWidth; ++x)
+                {
+                    const uint32_t* pSources = horizontal.sources.data() + static_cast<size_t>(x) * horizontal.tapCount;
+                    const float* pWeights = horizontal.weights.data() + static_cast<size_t>(x) * horizontal.tapCount;
+                    Simd::Float4 sum = Simd::splat(0.0f);
+                    for (uint32_t t = 0; t < horizontal.tapCount; ++t)
+                    {
+                        sum = Simd::madd(Simd::load(pIn + pSources[t] * 4), Simd::splat(pWeights[t]), sum);
+                    }
+                    Simd::store(pOut + x * 4, sum);
+                }
+            }
+
+            target.assign(static_cast<size_t>(targetWidth) * targetHeight * 4, 0.0f);
+            for (uint32_t y = 0; y < targetHeight; ++y)
+            {
+                float* pOut = target.data() + static_cast<size_t>(y) * targetWidth * 4;
+                for (uint32_t t = 0; t < vertical.tapCount; ++t)
+                {
+                    const float weight = vertical.weights[static_cast<size_t>(y) * vertical.tapCount + t];
+                    if (weight == 0.0f)
+                    {
+                        continue;
+                    }
+                    const float* pIn = rows.data() + static_cast<size_t>(vertical.sources[static_cast<size_t>(y) * vertical.tapCount + t]) * targetWidth * 4;
+                    const Simd::Float4 weights = Simd::splat(weight);
+                    for (uint32_t x = 0; x < targetWidth; ++x)
+                    {
+                        Simd::store(pOut + x * 4, Simd::madd(Simd::load(pIn + x * 4), weights, Simd::load(pOut + x * 4)));
+                    }
+                }
+            }
+        }
+
+        void toLinear(const uint8_t* pTexels, size_t texelCount, bool srgb, std::vector<float>& out)
+        {
+            const float* pTable = getSrgbToLinearTable();
+            out.resize(texelCount * 4);
+            for (size_t i = 0; i < texelCount * 4; ++i)
+            {
+                const bool colour = srgb && (i & 3) != 3;
+                out[i] = colour ? pTable[pTexels[i]] : pTexels[i] / 255.0f;
+            }
+        }
+
+        void toTexels(const std::vector<float>& linear, bool srgb, std::vector<uint8_t>& out)
+        {
+            const uint8_t* pTable = getLinearToSrgbTable();
+            out.resize(linear.size());
+            for (size_t i = 0; i < linear.size(); ++i)
+            {
+                // The Kaiser kernel has negative lobes, so values can overshoot.
+                const float value = std::min(1.0f, std::max(0.0f, linear[i]));
+                if (srgb && (i & 3) != 3)
+                {
+                    out[i] = pTable[std::min(static_cast<size_t>(value * kLinearToSrgbTableSize), kLinearToSrgbTableSize - 1)];
+                }
+                else
+                {
+                    out[i] = static_cast<uint8_t>(value * 255.0f + 0.5f);
+                }
+            }
+        }
+    } // namespace
+
+    uint32_t getMipCount(uint32_t width, uint32_t height)
+    {
+        uint32_t count = 1;
+        for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    void generateMips(const uint8_t* pTexels, uint32_t width, uint32_t height, bool srgb, MipFilter filter,
+                      std::vector<std::vector<uint8_t>>& outLevels)
+    {
+        const size_t texelCount = static_cast<size_t>(width) * height;
+        const uint32_t levelCount = getMipCount(width, height);
+        outLevels.resize(levelCount);
+        outLevels[0].assign(pTexels, pTexels + texelCount * 4);
+
+        std::vector<float> current;
+        std::vector<float> next;
+        toLinear(pTexels, texelCount, srgb, current);
+        for (uint32_t level = 1; level < levelCount; ++level)
+        {
+            const uint32_t levelWidth = std::max(1u, width >> level);
+            const uint32_t levelHeight = std::max(1u, height >> level);
+            // Each level is filtered from the previous one, still in float.
+            resample(current, std::max(1u, width >> (level - 1)), std::max(1u, height >> (level - 1)),
+                     next, levelWidth, levelHeight, filter);
+            toTexels(next, srgb, outLevels[level]);
+            current.swap(next);
+        }
+    }
+
+    void processTexture(const uint8_t* pTexels, uint32_t width, uint32_t height, bool srgb,
+                        const TextureOptions& options, unsigned int threadCount, TextureFormat& outFormat,
+                        std::vector<TextureMipData>& outMips, std::vector<uint8_t>& outTexels)
+    {
+        std::vector<std::vector<uint8_t>> levels;
+        if (options.generateMips)
+        {
+            generateMips(pTexels, width, height, srgb, options.mipFilter, levels);
+        }
+        else
+        {
+            levels.emplace_back(pTexels, pTexels + static_cast<size_t>(width) * height * 4);
+        }
+
+        // Metal wants whole blocks at the top level; anything else stays RGBA8.
+        const bool compress = options.compress && width % 4 == 0 && height % 4 == 0;
+        if (compress)
+        {
+            outFormat = srgb ? TextureFormat::BC7Srgb : TextureFormat::BC7Unorm;
+        }
+        else
+        {
+            outFormat = srgb ? TextureFormat::RGBA8Srgb : TextureFormat::RGBA8Unorm;
+        }
+
+        outMips.clear();
+        outTexels.clear();
+        for (size_t level = 0; level < levels.size(); ++level)
+        {
+            TextureMipData mip;
+            mip.width = std::max(1u, width >> level);
+            mip.height = std::max(1u, height >> level);
+            mip.offset = outTexels.size();
+            if (compress)
+            {
+                mip.size = getBc7Size(mip.width, mip.height);
+                outTexels.resize(mip.offset + mip.size);
+                encodeBc7(levels[level].data(), mip.width, mip.height, outTexels.data() + mip.offset, threadCount);
+            }
+            else
+            {
+                mip.size = levels[level].size();
+                outTexels.insert(outTexels.end(), levels[level].begin(), levels[level].end());
+            }
+            outMips.push_back(mip);
+        }
+    }
+} // namespace Pinnacle
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ModelData.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    enum class MipFilter : uint32_t
+    {
+        Box,   // Area average; cheapest, slightly soft
+        Kaiser // Kaiser-windowed sinc (width 3, alpha 4); keeps detail without ringing
+    };
+
+    struct TextureOptions
+    {
+        bool generateMips = true;
+        MipFilter mipFilter = MipFilter::Kaiser;
+        bool compress = true; // BC7 when the base level is a whole number of 4x4 blocks
+    };
+
+    // Levels in a full chain down to 1x1.
+    uint32_t getMipCount(uint32_t width, uint32_t height);
+
+    // Builds the mip chain of a tightly packed RGBA8 image; outLevels[0] is
+    // a copy of the source and level n is max(1, size >> n). sRGB images are
+    // filtered in linear light (alpha always stays linear). Filtering is
+    // separable and runs four channels at a time on Simd::Float4.
+    void generateMips(const uint8_t* pTexels, uint32_t width, uint32_t height, bool srgb, MipFilter filter,
+                      std::vector<std::vector<uint8_t>>& outLevels);
+
+    // Turns a decoded RGBA8 image into GPU-ready mips laid out for a straight
+    // replaceRegion copy (see getRowPitch()). Mip offsets are relative to
+    // `outTexels`. BC7 encoding runs on `threadCount` threads
+    // (0 = hardware concurrency).
+    void processTexture(const uint8_t* pTexels, uint32_t width, uint32_t height, bool srgb,
+                        const TextureOptions& options, unsigned int threadCount, TextureFormat& outFormat,
+                        std::vector<TextureMipData>& outMips, std::vector<uint8_t>& outTexels);
+} // namespace Pinnacle
@@ -0,0 +1,208 @@
+#include "VertexQuantizer.hpp"
+
+#include "../Core/Parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        uint16_t quantizeUnorm16(float value, float minimum, float extent)
+        {
+            if (extent <= 0.0f)
+            {
+                return 0;
+            }
+            const float normalized = std::min(std::max((value - minimum) / extent, 0.0f), 1.0f);
+            return static_cast<uint16_t>(normalized * 65535.0f + 0.5f);
+        }
+
+        // Same arithmetic as the vertex shader, so the measured error is the real one.
+        float dequantizeUnorm16(uint16_t value, float minimum, float extent)
+        {
+            return minimum + (value / 65535.0f) * extent;
+        }
+
+        int16_t quantizeSnorm16(float value)
+        {
+            return static_cast<int16_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f));
+        }
+
+        float signNotZero(float value)
+        {
+            return value >= 0.0f ? 1.0f : -1.0f;
+        }
+
+        bool fitsQuantized(const ModelVertex* pVertices, size_t count, const Bounds& bounds,
+                           const VertexQuantizationOptions& options)
+        {
+            const float minNormalCosine = std::cos(options.maxNormalError);
+            for (size_t i = 0; i < count; ++i)
+            {
+                const ModelVertex& vertex = pVertices[i];
+                QuantizedVertex quantized;
+                quantizeVertices(&vertex, 1, bounds, &quantized);
+
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    const float extent = bounds.max[axis] - bounds.min[axis];
+                    const float position = dequantizeUnorm16(quantized.position[axis], bounds.min[axis], extent);
+                    if (!(std::fabs(position - vertex.position[axis]) <= options.maxPositionError))
+                    {
+                        return false;
+                    }
+                }
+
+                const float length = std::sqrt(vertex.normal[0] * vertex.normal[0] + vertex.normal[1] * vertex.normal[1] +
+                                               vertex.normal[2] * vertex.normal[2]);
+                if (length > 0.0f)
+                {
+                    float normal[3];
+                    decodeOctahedral(quantized.normal, normal);
+                    const float cosine = (normal[0] * vertex.normal[0] + normal[1] * vertex.normal[1] +
+                                          normal[2] * vertex.normal[2]) / length;
+                    if (!(cosine >= minNormalCosine))
+                    {
+                        return false;
+                    }
+                }
+
+                for (int c = 0; c < 2; ++c)
+                {
+                    if (!(std::fabs(halfToFloat(quantized.texCoords[c]) - vertex.texCoords[c]) <= options.maxTexCoordError))
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        const uint32_t magnitude = bits & 0x7FFFFFFF;
+
+        if (magnitude >= 0x7F800000)
+        {
+            return sign | (magnitude > 0x7F800000 ? 0x7E00 : 0x7C00); // NaN or infinity
+        }
+        if (magnitude >= 0x477FF000)
+        {
+            return sign | 0x7C00; // Rounds past 65504
+        }
+        if (magnitude < 0x38800000)
+        {
+            // Subnormal half: count units of 2^-24, rounding to nearest even.
+            float absolute;
+            std::memcpy(&absolute, &magnitude, sizeof(absolute));
+            return sign | static_cast<uint16_t>(std::nearbyint(absolute * 16777216.0f));
+        }
+
+        // Rebias the exponent from 127 to 15 and round the dropped 13 mantissa bits.
+        uint32_t half = (magnitude - 0x38000000) >> 13;
+        const uint32_t remainder = magnitude & 0x1FFF;
+        if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1) != 0))
+        {
+            half++;
+        }
+        return sign | static_cast<uint16_t>(half);
+    }
+
+    float halfToFloat(uint16_t value)
+    {
+        const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+        const uint32_t exponent = (value >> 10) & 0x1F;
+        const uint32_t mantissa = value & 0x3FF;
+
+        if (exponent == 0)
+        {
+            const float magnitude = mantissa / 16777216.0f;
+            return sign ? -magnitude : magnitude;
+        }
+        const uint32_t bits = exponent == 31 ? sign | 0x7F800000 | (mantissa << 13)
+                                             : sign | ((exponent + 112) << 23) | (mantissa << 13);
+        float result;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    void encodeOctahedral(const float direction[3], int16_t out[2])
+    {
+        const float l1 = std::fabs(direction[0]) + std::fabs(direction[1]) + std::fabs(direction[2]);
+        if (l1 == 0.0f)
+        {
+            out[0] = out[1] = 0;
+            return;
+        }
+        float u = direction[0] / l1;
+        float v = direction[1] / l1;
+        if (direction[2] < 0.0f)
+        {
+            // Fold the lower hemisphere over the diagonals.
+            const float foldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+            v = (1.0f - std::fabs(u)) * signNotZero(v);
+            u = foldedU;
+        }
+        out[0] = quantizeSnorm16(u);
+        out[1] = quantizeSnorm16(v);
+    }
+
+    void decodeOctahedral(const int16_t encoded[2], float out[3])
+    {
+        float u = std::max(encoded[0] / 32767.0f, -1.0f);
+        float v = std::max(encoded[1] / 32767.0f, -1.0f);
+        const float z = 1.0f - std::fabs(u) - std::fabs(v);
+        if (z < 0.0f)
+        {
+            const float unfoldedU = (1.0f - std::fabs(v)) * signNotZero(u);
+            v = (1.0f - std::fabs(u)) * signNotZero(v);
+            u = unfoldedU;
+        }
+        const float length = std::sqrt(u * u + v * v + z * z);
+        out[0] = u / length;
+        out[1] = v / length;
+        out[2] = z / length;
+    }
+
+    void quantizeVertices(const ModelVertex* pVertices, size_t count, const Bounds& bounds, QuantizedVertex* pOut)
+    {
+        const float extent[3] = { bounds.max[0] - bounds.min[0], bounds.max[1] - bounds.min[1], bounds.max[2] - bounds.min[2] };
+        for (size_t i = 0; i < count; ++i)
+        {
+            const ModelVertex& vertex = pVertices[i];
+            QuantizedVertex& quantized = pOut[i];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                quantized.position[axis] = quantizeUnorm16(vertex.position[axis], bounds.min[axis], extent[axis]);
+            }
+            quantized.position[3] = 0;
+            encodeOctahedral(vertex.normal, quantized.normal);
+            quantized.texCoords[0] = floatToHalf(vertex.texCoords[0]);
+            quantized.texCoords[1] = floatToHalf(vertex.texCoords[1]);
+        }
+    }
+
+    uint32_t selectVertexFormats(ModelData& model, const VertexQuantizationOptions& options, unsigned int threadCount)
+    {
+        std::atomic<uint32_t> quantizedCount(0);
+        parallelFor(model.primitives.size(), threadCount, [&](size_t i)
+        {
+            PrimitiveData& primitive = model.primitives[i];
+            // Skinned and morphed vertices leave the rest bounds the encoding is relative to
+            const bool fits = primitive.vertexCount > 0 && !primitive.hasSkinWeights && primitive.morphTargetCount == 0 &&
+                              fitsQuantized(model.vertices.data() + primitive.vertexOffset, primitive.vertexCount,
+                                            primitive.bounds, options);
+            primitive.vertexFormat = fits ? VertexFormat::Quantized : VertexFormat::Float;
+            quantizedCount += fits ? 1 : 0;
+        });
+        return quantizedCount.load();
+    }
+} // namespace Pinnacle
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinnacle
+{
+    // Largest round-trip errors a primitive may show and still be uploaded
+    // as QuantizedVertex.
+    struct VertexQuantizationOptions
+    {
+        float maxPositionError = 1e-4f;          // Per axis, in mesh units (metres in glTF)
+        float maxNormalError = 1e-3f;            // Radians
+        float maxTexCoordError = 1.0f / 4096.0f; // Half floats lose precision away from [0, 1]
+    };
+
+    uint16_t floatToHalf(float value);
+    float halfToFloat(uint16_t value);
+
+    // Maps a direction onto the octahedron and unfolds it into two snorm16
+    // values; decoding normalizes. A zero vector encodes as +Z.
+    void encodeOctahedral(const float direction[3], int16_t out[2]);
+    void decodeOctahedral(const int16_t encoded[2], float out[3]);
+
+    // Converts vertices to QuantizedVertex; `bounds` must contain every
+    // position. The shader rebuilds positions as min + unorm * (max - min).
+    void quantizeVertices(const ModelVertex* pVertices, size_t count, const Bounds& bounds, QuantizedVertex* pOut);
+
+    // Sets PrimitiveData::vertexFormat to Quantized for every primitive whose
+    // vertices survive the round trip within `options`, Float otherwise.
+    // Skinned and morphed primitives always stay Float.
+    // Returns the number of quantized primitives. Runs in parallel across
+    // primitives on `threadCount` threads (0 = hardware concurrency).
+    uint32_t selectVertexFormats(ModelData& model, const VertexQuantizationOptions& options, unsigned int threadCount = 0);
+
+    // Bytes per vertex on the GPU.
+    inline size_t getVertexStride(VertexFormat format)
+    {
+        return format == VertexFormat::Quantized ? sizeof(QuantizedVertex) : sizeof(ModelVertex);
+    }
+} // namespace Pinnacle
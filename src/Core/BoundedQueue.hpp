@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+
+namespace Pinnacle
+{
+    // Fixed-capacity multi-producer/multi-consumer queue. push() blocks while
+    // the queue is full, which is what bounds the number of loaded-but-not-yet-
+    // consumed items (and therefore memory) in a producer/consumer pipeline.
+    template <typename T>
+    class BoundedQueue
+    {
+    public:
+        explicit BoundedQueue(size_t capacity)
+            : m_capacity(capacity > 0 ? capacity : 1)
+        {
+        }
+
+        // Returns false if the queue was closed before the item could be added.
+        bool push(T item)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notFull.wait(lock, [this] { return m_closed || m_items.size() < m_capacity; });
+            if (m_closed)
+            {
+                return false;
+            }
+            m_items.push_back(std::move(item));
+            m_notEmpty.notify_one();
+            return true;
+        }
+
+        // Blocks until an item is available. Returns false once the queue is
+        // closed and drained.
+        bool pop(T& outItem)
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this] { return m_closed || !m_items.empty(); });
+            if (m_items.empty())
+            {
+                return false;
+            }
+            outItem = std::move(m_items.front());
+            m_items.pop_front();
+            m_notFull.notify_one();
+            return true;
+        }
+
+        void close()
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+            m_notEmpty.notify_all();
+            m_notFull.notify_all();
+        }
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_notFull;
+        std::condition_variable m_notEmpty;
+        std::deque<T> m_items;
+        size_t m_capacity;
+        bool m_closed = false;
+    };
+} // namespace Pinnacle
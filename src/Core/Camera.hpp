@@ -24,9 +24,17 @@ namespace Pinnacle
 
         void orbit(float deltaX, float deltaY);
 
+        // Re-targets the camera on an AABB, keeping the current view direction,
+        // and fits the near/far planes to it.
+        void frameBounds(simd_float3 boundsMin, simd_float3 boundsMax);
+
         simd_float3 getPosition() const { return m_position; }
         simd_float3 getLookAt() const { return m_lookAt; }
         simd_float3 getUpVector() const { return m_upVector; }
+        float getFieldOfView() const { return m_fieldOfView; }
+        float getAspectRatio() const { return m_aspectRatio; }
+        float getNearPlane() const { return m_nearPlane; }
+        float getFarPlane() const { return m_farPlane; }
 
     private:
         simd_float3 m_position;
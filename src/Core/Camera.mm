@@ -0,0 +1,107 @@
+#include "Camera.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Pinnacle
+{
+    Camera::Camera()
+        : m_position{ 0.0f, 0.0f, 3.0f }
+        , m_lookAt{ 0.0f, 0.0f, 0.0f }
+        , m_upVector{ 0.0f, 1.0f, 0.0f }
+        , m_fieldOfView(static_cast<float>(M_PI) / 4.0f)
+        , m_aspectRatio(1.0f)
+        , m_nearPlane(0.1f)
+        , m_farPlane(100.0f)
+    {
+    }
+
+    Camera::~Camera()
+    {
+    }
+
+    void Camera::setPosition(simd_float3 position) { m_position = position; }
+    void Camera::setLookAt(simd_float3 lookAt) { m_lookAt = lookAt; }
+    void Camera::setUpVector(simd_float3 upVector) { m_upVector = upVector; }
+    void Camera::setFieldOfView(float fieldOfView) { m_fieldOfView = fieldOfView; }
+    void Camera::setAspectRatio(float aspectRatio) { m_aspectRatio = aspectRatio; }
+    void Camera::setNearPlane(float nearPlane) { m_nearPlane = nearPlane; }
+    void Camera::setFarPlane(float farPlane) { m_farPlane = farPlane; }
+
+    void Camera::updateProjectionMatrix(float width, float height)
+    {
+        if (width > 0.0f && height > 0.0f)
+        {
+            m_aspectRatio = width / height;
+        }
+    }
+
+    simd_float4x4 Camera::getViewMatrix() const
+    {
+        const simd_float3 z = simd_normalize(m_position - m_lookAt);
+        const simd_float3 x = simd_normalize(simd_cross(m_upVector, z));
+        const simd_float3 y = simd_cross(z, x);
+
+        return (simd_float4x4){
+            (simd_float4){ x.x, y.x, z.x, 0.0f },
+            (simd_float4){ x.y, y.y, z.y, 0.0f },
+            (simd_float4){ x.z, y.z, z.z, 0.0f },
+            (simd_float4){ -simd_dot(x, m_position), -simd_dot(y, m_position), -simd_dot(z, m_position), 1.0f }
+        };
+    }
+
+    // Right-handed perspective projection mapping depth to Metal's [0, 1] range.
+    simd_float4x4 Camera::getProjectionMatrix() const
+    {
+        const float yScale = 1.0f / std::tan(m_fieldOfView * 0.5f);
+        const float xScale = yScale / m_aspectRatio;
+        const float zScale = m_farPlane / (m_nearPlane - m_farPlane);
+
+        return (simd_float4x4){
+            (simd_float4){ xScale, 0.0f, 0.0f, 0.0f },
+            (simd_float4){ 0.0f, yScale, 0.0f, 0.0f },
+            (simd_float4){ 0.0f, 0.0f, zScale, -1.0f },
+            (simd_float4){ 0.0f, 0.0f, zScale * m_nearPlane, 0.0f }
+        };
+    }
+
+    void Camera::orbit(float deltaX, float deltaY)
+    {
+        const simd_float3 offset = m_position - m_lookAt;
+        const float radius = simd_length(offset);
+        if (radius <= 0.0f)
+        {
+            return;
+        }
+
+        float azimuth = std::atan2(offset.x, offset.z) - deltaX;
+        float elevation = std::asin(std::clamp(offset.y / radius, -1.0f, 1.0f)) + deltaY;
+        const float limit = static_cast<float>(M_PI) * 0.5f - 0.01f;
+        elevation = std::clamp(elevation, -limit, limit);
+
+        m_position = m_lookAt + radius * (simd_float3){
+            std::cos(elevation) * std::sin(azimuth),
+            std::sin(elevation),
+            std::cos(elevation) * std::cos(azimuth)
+        };
+    }
+
+    void Camera::frameBounds(simd_float3 boundsMin, simd_float3 boundsMax)
+    {
+        const simd_float3 center = (boundsMin + boundsMax) * 0.5f;
+        const float radius = std::max(simd_length(boundsMax - boundsMin) * 0.5f, 1e-4f);
+
+        // Fit the bounding sphere inside the narrower of the two view angles.
+        const float halfFovY = m_fieldOfView * 0.5f;
+        const float halfFovX = std::atan(std::tan(halfFovY) * m_aspectRatio);
+        const float distance = radius / std::sin(std::min(halfFovX, halfFovY));
+
+        simd_float3 direction = m_position - m_lookAt;
+        direction = simd_length(direction) > 0.0f ? simd_normalize(direction) : (simd_float3){ 0.0f, 0.0f, 1.0f };
+
+        m_lookAt = center;
+        m_position = center + direction * distance;
+        m_nearPlane = std::max(distance - radius, distance * 0.001f);
+        m_farPlane = distance + radius;
+    }
+} // namespace Pinnacle
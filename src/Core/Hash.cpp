@@ -0,0 +1,106 @@
+#include "Hash.hpp"
+
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const uint64_t kPrime1 = 0x9E3779B185EBCA87ull;
+        const uint64_t kPrime2 = 0xC2B2AE3D27D4EB4Full;
+        const uint64_t kPrime3 = 0x165667B19E3779F9ull;
+        const uint64_t kPrime4 = 0x85EBCA77C2B2AE63ull;
+        const uint64_t kPrime5 = 0x27D4EB2F165667C5ull;
+
+        uint64_t rotateLeft(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+        uint64_t read64(const uint8_t* p)
+        {
+            uint64_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint32_t read32(const uint8_t* p)
+        {
+            uint32_t value;
+            std::memcpy(&value, p, sizeof(value));
+            return value;
+        }
+
+        uint64_t round(uint64_t accumulator, uint64_t input)
+        {
+            accumulator += input * kPrime2;
+            accumulator = rotateLeft(accumulator, 31);
+            return accumulator * kPrime1;
+        }
+
+        uint64_t mergeRound(uint64_t accumulator, uint64_t value)
+        {
+            accumulator ^= round(0, value);
+            return accumulator * kPrime1 + kPrime4;
+        }
+    } // namespace
+
+    uint64_t hashBytes(const void* pData, size_t size, uint64_t seed)
+    {
+        const uint8_t* p = static_cast<const uint8_t*>(pData);
+        const uint8_t* const pEnd = p + size;
+        uint64_t hash;
+
+        if (size >= 32)
+        {
+            uint64_t v1 = seed + kPrime1 + kPrime2;
+            uint64_t v2 = seed + kPrime2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - kPrime1;
+            const uint8_t* const pLimit = pEnd - 32;
+            do
+            {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+                p += 32;
+            } while (p <= pLimit);
+
+            hash = rotateLeft(v1, 1) + rotateLeft(v2, 7) + rotateLeft(v3, 12) + rotateLeft(v4, 18);
+            hash = mergeRound(hash, v1);
+            hash = mergeRound(hash, v2);
+            hash = mergeRound(hash, v3);
+            hash = mergeRound(hash, v4);
+        }
+        else
+        {
+            hash = seed + kPrime5;
+        }
+
+        hash += static_cast<uint64_t>(size);
+
+        while (p + 8 <= pEnd)
+        {
+            hash ^= round(0, read64(p));
+            hash = rotateLeft(hash, 27) * kPrime1 + kPrime4;
+            p += 8;
+        }
+        if (p + 4 <= pEnd)
+        {
+            hash ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+            hash = rotateLeft(hash, 23) * kPrime2 + kPrime3;
+            p += 4;
+        }
+        while (p < pEnd)
+        {
+            hash ^= (*p) * kPrime5;
+            hash = rotateLeft(hash, 11) * kPrime1;
+            ++p;
+        }
+
+        hash ^= hash >> 33;
+        hash *= kPrime2;
+        hash ^= hash >> 29;
+        hash *= kPrime3;
+        hash ^= hash >> 32;
+        return hash;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinnacle
+{
+    // 64-bit content hash (XXH64). Fast enough to fingerprint multi-gigabyte
+    // source assets on every launch; not cryptographic.
+    uint64_t hashBytes(const void* pData, size_t size, uint64_t seed = 0);
+
+    inline uint64_t hashCombine(uint64_t a, uint64_t b)
+    {
+        return a ^ (b + 0x9e3779b97f4a7c15ull + (a << 6) + (a >> 2));
+    }
+
+    template <typename T>
+    uint64_t hashValue(const T& value, uint64_t seed = 0)
+    {
+        return hashBytes(&value, sizeof(T), seed);
+    }
+} // namespace Pinnacle
@@ -0,0 +1,250 @@
+#include "JobSystem.hpp"
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // Pool and queue index of the calling thread when it is a worker.
+        thread_local const JobSystem* t_pWorkerSystem = nullptr;
+        thread_local size_t t_workerIndex = 0;
+        // wait() calls on the calling thread's stack.
+        thread_local uint32_t t_waitDepth = 0;
+
+        // Helping in wait() runs unrelated jobs on the waiter's stack, and each
+        // may wait in turn; past this many levels a waiter only takes its own
+        // newest jobs, usually the children it is waiting on.
+        const uint32_t kMaxHelpingDepth = 16;
+    } // namespace
+
+    JobSystem::JobSystem(unsigned int workerCount)
+        : m_mainThread(std::this_thread::get_id())
+    {
+        if (workerCount == 0)
+        {
+            const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+            workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+        }
+
+        for (unsigned int i = 0; i < workerCount; ++i)
+        {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
+        for (unsigned int i = 0; i < workerCount; ++i)
+        {
+            m_workers.emplace_back(&JobSystem::workerLoop, this, static_cast<size_t>(i));
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    JobSystem& JobSystem::getShared()
+    {
+        static JobSystem system;
+        return system;
+    }
+
+    void JobSystem::run(std::function<void()> job, JobCounter* pCounter)
+    {
+        if (pCounter)
+        {
+            pCounter->m_value.fetch_add(1, std::memory_order_relaxed);
+        }
+        push({ std::move(job), pCounter });
+    }
+
+    void JobSystem::runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* pCounter)
+    {
+        if (pCounter)
+        {
+            pCounter->m_value.fetch_add(1, std::memory_order_relaxed);
+        }
+        {
+            // finish() takes the continuations under the same lock, so the
+            // job is either parked before the last decrement or sees zero.
+            std::lock_guard<std::mutex> lock(dependency.m_mutex);
+            if (!dependency.isDone())
+            {
+                dependency.m_continuations.push_back({ std::move(job), pCounter });
+                return;
+            }
+        }
+        push({ std::move(job), pCounter });
+    }
+
+    void JobSystem::runOnMainThread(std::function<void()> job, JobCounter* pCounter)
+    {
+        if (pCounter)
+        {
+            pCounter->m_value.fetch_add(1, std::memory_order_relaxed);
+        }
+        std::lock_guard<std::mutex> lock(m_mainThreadJobs.mutex);
+        m_mainThreadJobs.jobs.push_back({ std::move(job), pCounter });
+    }
+
+    void JobSystem::wait(JobCounter& counter)
+    {
+        const bool onMainThread = std::this_thread::get_id() == m_mainThread.load();
+        const bool localOnly = t_waitDepth >= kMaxHelpingDepth;
+        ++t_waitDepth;
+        while (!counter.isDone())
+        {
+            if (onMainThread && !localOnly)
+            {
+                pumpMainThread();
+            }
+            if (!tryRunOne(localOnly))
+            {
+                std::this_thread::yield();
+            }
+        }
+        --t_waitDepth;
+        // The last finish() may still hold the lock after the value reached
+        // zero; the caller is free to destroy the counter once it is released.
+        std::lock_guard<std::mutex> lock(counter.m_mutex);
+    }
+
+    void JobSystem::pumpMainThread()
+    {
+        std::deque<Job> jobs;
+        {
+            std::lock_guard<std::mutex> lock(m_mainThreadJobs.mutex);
+            jobs.swap(m_mainThreadJobs.jobs);
+        }
+        for (Job& job : jobs)
+        {
+            execute(job);
+        }
+    }
+
+    void JobSystem::push(Job&& job)
+    {
+        // Workers keep what they spawn local; everyone else goes through the
+        // injection queue.
+        WorkerQueue& queue = t_pWorkerSystem == this ? *m_queues[t_workerIndex] : m_injected;
+        {
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.jobs.push_back(std::move(job));
+        }
+        m_pending.fetch_add(1);
+        {
+            // Pairs with the predicate check in workerLoop() so a worker
+            // about to sleep cannot miss this job.
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_one();
+    }
+
+    bool JobSystem::tryRunOne(bool localOnly)
+    {
+        Job job;
+        bool found = false;
+        const bool isWorker = t_pWorkerSystem == this;
+
+        // Own queue newest first: its data is most likely still in cache.
+        if (isWorker)
+        {
+            WorkerQueue& queue = *m_queues[t_workerIndex];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.back());
+                queue.jobs.pop_back();
+                found = true;
+            }
+        }
+        if (!found && localOnly)
+        {
+            return false;
+        }
+        if (!found)
+        {
+            std::lock_guard<std::mutex> lock(m_injected.mutex);
+            if (!m_injected.jobs.empty())
+            {
+                job = std::move(m_injected.jobs.front());
+                m_injected.jobs.pop_front();
+                found = true;
+            }
+        }
+        // Steal oldest first: those tend to be the largest pieces of work.
+        const size_t start = isWorker ? t_workerIndex + 1 : 0;
+        for (size_t i = 0; !found && i < m_queues.size(); ++i)
+        {
+            WorkerQueue& queue = *m_queues[(start + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (!queue.jobs.empty())
+            {
+                job = std::move(queue.jobs.front());
+                queue.jobs.pop_front();
+                found = true;
+            }
+        }
+
+        if (!found)
+        {
+            return false;
+        }
+        m_pending.fetch_sub(1);
+        execute(job);
+        return true;
+    }
+
+    void JobSystem::execute(Job& job)
+    {
+        job.function();
+        finish(job.pCounter);
+    }
+
+    void JobSystem::finish(JobCounter* pCounter)
+    {
+        if (!pCounter)
+        {
+            return;
+        }
+
+        std::vector<JobCounter::Continuation> ready;
+        {
+            std::lock_guard<std::mutex> lock(pCounter->m_mutex);
+            if (pCounter->m_value.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            {
+                return;
+            }
+            ready.swap(pCounter->m_continuations);
+        }
+        // The counter may be gone by now; only the continuations are touched.
+        for (JobCounter::Continuation& continuation : ready)
+        {
+            push({ std::move(continuation.function), continuation.pCounter });
+        }
+    }
+
+    void JobSystem::workerLoop(size_t index)
+    {
+        t_pWorkerSystem = this;
+        t_workerIndex = index;
+        for (;;)
+        {
+            if (tryRunOne())
+            {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            if (m_stopping)
+            {
+                return;
+            }
+            m_wake.wait(lock, [this]() { return m_stopping || m_pending.load() > 0; });
+        }
+    }
+} // namespace Pinnacle
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Counts unfinished jobs. A job run with a counter increments it when
+    // scheduled and decrements it when done; jobs run after a counter start
+    // once it reaches zero. Must outlive every job that refers to it.
+    class JobCounter
+    {
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool isDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class JobSystem;
+
+        struct Continuation
+        {
+            std::function<void()> function;
+            JobCounter* pCounter;
+        };
+
+        std::atomic<uint32_t> m_value{ 0 };
+        std::mutex m_mutex; // Guards m_continuations against the final decrement
+        std::vector<Continuation> m_continuations;
+    };
+
+    // Fixed pool of worker threads with one deque per worker. A worker pops
+    // its own newest job first and, when empty, takes the oldest job from
+    // the shared injection queue or steals from another worker. Threads that
+    // wait on a counter run jobs instead of blocking, so jobs may wait on
+    // jobs they spawn. Jobs queued with runOnMainThread() only run on the
+    // main thread (the one that created the system, see setMainThread()),
+    // inside pumpMainThread() or wait(); backend submits go there.
+    class JobSystem
+    {
+    public:
+        // 0 workers = one fewer than the hardware threads (the caller helps), at least 1.
+        explicit JobSystem(unsigned int workerCount = 0);
+        ~JobSystem();
+        JobSystem(const JobSystem&) = delete;
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // Process-wide instance, created on first use.
+        static JobSystem& getShared();
+
+        void run(std::function<void()> job, JobCounter* pCounter = nullptr);
+        // Runs `job` once `dependency` reaches zero.
+        void runAfter(JobCounter& dependency, std::function<void()> job, JobCounter* pCounter = nullptr);
+        void runOnMainThread(std::function<void()> job, JobCounter* pCounter = nullptr);
+
+        // Runs other jobs until `counter` reaches zero.
+        void wait(JobCounter& counter);
+        // Runs every queued main-thread job; call once per frame from the main thread.
+        void pumpMainThread();
+        void setMainThread(std::thread::id id) { m_mainThread.store(id); }
+
+        // Runs `task(i)` for every i in [0, count) on the workers and the
+        // calling thread, `grain` consecutive items per claim. `maxThreads`
+        // caps the threads used, caller included (0 = no cap).
+        template <typename Task>
+        void parallelFor(size_t count, size_t grain, const Task& task, unsigned int maxThreads = 0);
+
+        unsigned int getWorkerCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+    private:
+        struct Job
+        {
+            std::function<void()> function;
+            JobCounter* pCounter = nullptr;
+        };
+
+        struct WorkerQueue
+        {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+        };
+
+        void push(Job&& job);
+        // `localOnly` restricts the search to the calling worker's own queue.
+        bool tryRunOne(bool localOnly = false);
+        void execute(Job& job);
+        void finish(JobCounter* pCounter);
+        void workerLoop(size_t index);
+
+        std::vector<std::thread> m_workers;
+        std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+        WorkerQueue m_injected;   // Jobs from threads outside the pool
+        WorkerQueue m_mainThreadJobs;
+        std::atomic<std::thread::id> m_mainThread;
+        std::atomic<size_t> m_pending{ 0 }; // Queued on workers or the injection queue
+        std::mutex m_sleepMutex;
+        std::condition_variable m_wake;
+        bool m_stopping = false;
+    };
+
+    template <typename Task>
+    void JobSystem::parallelFor(size_t count, size_t grain, const Task& task, unsigned int maxThreads)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+        size_t helpers = std::min<size_t>((count + grain - 1) / grain - 1, m_workers.size());
+        if (maxThreads > 0)
+        {
+            helpers = std::min<size_t>(helpers, maxThreads - 1);
+        }
+
+        // Ranges are claimed dynamically, so uneven items balance themselves.
+        std::atomic<size_t> next(0);
+        auto claim = [&]()
+        {
+            for (size_t start = next.fetch_add(grain); start < count; start = next.fetch_add(grain))
+            {
+                const size_t end = std::min(count, start + grain);
+                for (size_t i = start; i < end; ++i)
+                {
+                    task(i);
+                }
+            }
+        };
+
+        JobCounter counter;
+        for (size_t i = 0; i < helpers; ++i)
+        {
+            run(claim, &counter);
+        }
+        claim();
+        wait(counter);
+    }
+} // namespace Pinnacle
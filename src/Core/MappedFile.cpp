@@ -0,0 +1,89 @@
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <utility>
+
+namespace Pinnacle
+{
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : m_pData(std::exchange(other.m_pData, nullptr))
+        , m_size(std::exchange(other.m_size, 0))
+        , m_isEmpty(std::exchange(other.m_isEmpty, false))
+    {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            m_pData = std::exchange(other.m_pData, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_isEmpty = std::exchange(other.m_isEmpty, false);
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::string& path)
+    {
+        close();
+
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            return false;
+        }
+
+        struct stat status;
+        if (fstat(fd, &status) != 0)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        if (status.st_size == 0)
+        {
+            ::close(fd);
+            m_isEmpty = true;
+            return true;
+        }
+
+        void* pMapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps its own reference to the file
+        if (pMapping == MAP_FAILED)
+        {
+            return false;
+        }
+
+        m_pData = static_cast<const uint8_t*>(pMapping);
+        m_size = static_cast<size_t>(status.st_size);
+        return true;
+    }
+
+    void MappedFile::close()
+    {
+        if (m_pData)
+        {
+            munmap(const_cast<uint8_t*>(m_pData), m_size);
+        }
+        m_pData = nullptr;
+        m_size = 0;
+        m_isEmpty = false;
+    }
+
+    std::string makeTemporaryPath(const std::string& path)
+    {
+        static std::atomic<uint64_t> s_counter{ 0 };
+        return path + ".tmp" + std::to_string(static_cast<long long>(::getpid())) + "-" + std::to_string(s_counter++);
+    }
+} // namespace Pinnacle
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Pinnacle
+{
+    // Read-only memory mapping of a whole file (POSIX mmap). Move-only; the
+    // mapping is released on close() or destruction.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        ~MappedFile();
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+
+        bool isOpen() const { return m_pData != nullptr || m_isEmpty; }
+        const uint8_t* data() const { return m_pData; }
+        size_t size() const { return m_size; }
+
+    private:
+        const uint8_t* m_pData = nullptr;
+        size_t m_size = 0;
+        bool m_isEmpty = false; // Zero-length files cannot be mapped but are still open
+    };
+
+    // Sibling of `path` to write before renaming it into place. Unique across
+    // threads and processes (process id plus a per-process counter), so
+    // concurrent writers of one path never share a temporary.
+    std::string makeTemporaryPath(const std::string& path);
+} // namespace Pinnacle
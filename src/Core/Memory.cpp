@@ -0,0 +1,197 @@
+#include "Memory.hpp"
+
+#include <algorithm>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const size_t kScratchBlockSize = 256 * 1024;
+
+        class NewDeleteResource : public MemoryResource
+        {
+        protected:
+            void* doAllocate(size_t bytes, size_t alignment) override
+            {
+                return ::operator new(bytes, std::align_val_t(alignment));
+            }
+
+            void doDeallocate(void* p, size_t, size_t alignment) override
+            {
+                ::operator delete(p, std::align_val_t(alignment));
+            }
+        };
+
+        size_t alignUp(size_t value, size_t alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+    } // namespace
+
+    MemoryResource* getDefaultResource()
+    {
+        static NewDeleteResource resource;
+        return &resource;
+    }
+
+    LinearArena::LinearArena(size_t blockSize, MemoryResource* pUpstream)
+        : m_pUpstream(pUpstream)
+        , m_blockSize(blockSize)
+    {
+    }
+
+    LinearArena::~LinearArena()
+    {
+        releaseBlocks(0);
+    }
+
+    void* LinearArena::doAllocate(size_t bytes, size_t alignment)
+    {
+        m_stats.allocations++;
+        m_stats.bytes += bytes;
+
+        // Try the current block, then any later one kept from before a rewind.
+        for (; m_current < m_blocks.size(); ++m_current, m_offset = 0)
+        {
+            const Block& block = m_blocks[m_current];
+            const size_t start = alignUp(reinterpret_cast<uintptr_t>(block.pData) + m_offset, alignment) -
+                                 reinterpret_cast<uintptr_t>(block.pData);
+            if (start + bytes <= block.size)
+            {
+                m_used += start + bytes - m_offset;
+                m_highWater = std::max(m_highWater, m_used);
+                m_offset = start + bytes;
+                return block.pData + start;
+            }
+        }
+
+        Block block;
+        block.size = std::max(m_blockSize, bytes + alignment);
+        block.pData = static_cast<uint8_t*>(m_pUpstream->allocate(block.size, alignof(std::max_align_t)));
+        m_stats.upstreamAllocations++;
+        m_stats.capacity += block.size;
+        m_current = m_blocks.size();
+        m_blocks.push_back(block);
+
+        const size_t start = alignUp(reinterpret_cast<uintptr_t>(block.pData), alignment) - reinterpret_cast<uintptr_t>(block.pData);
+        m_used += start + bytes;
+        m_highWater = std::max(m_highWater, m_used);
+        m_offset = start + bytes;
+        return block.pData + start;
+    }
+
+    void LinearArena::releaseBlocks(size_t first)
+    {
+        for (size_t i = first; i < m_blocks.size(); ++i)
+        {
+            m_pUpstream->deallocate(m_blocks[i].pData, m_blocks[i].size, alignof(std::max_align_t));
+            m_stats.capacity -= m_blocks[i].size;
+        }
+        m_blocks.resize(std::min(first, m_blocks.size()));
+    }
+
+    void LinearArena::reset()
+    {
+        if (m_blocks.size() > 1)
+        {
+            // Padding makes the high-water mark an estimate; keep some slack.
+            const size_t size = std::max(m_blockSize, m_highWater + m_highWater / 8);
+            releaseBlocks(0);
+            Block block;
+            block.size = size;
+            block.pData = static_cast<uint8_t*>(m_pUpstream->allocate(size, alignof(std::max_align_t)));
+            m_stats.capacity += size;
+            m_blocks.push_back(block);
+        }
+        m_current = 0;
+        m_offset = 0;
+        m_used = 0;
+        m_highWater = 0;
+        resetStats();
+    }
+
+    void LinearArena::rewind(const Marker& marker)
+    {
+        m_current = marker.block;
+        m_offset = marker.offset;
+        m_used = marker.used;
+        if (m_current == 0 && m_offset == 0)
+        {
+            releaseBlocks(!m_blocks.empty() && m_blocks[0].size <= m_blockSize ? 1 : 0);
+        }
+    }
+
+    void LinearArena::resetStats()
+    {
+        const uint64_t capacity = m_stats.capacity;
+        m_stats = AllocationStats();
+        m_stats.capacity = capacity;
+    }
+
+    LinearArena& getScratchArena()
+    {
+        thread_local LinearArena arena(kScratchBlockSize);
+        return arena;
+    }
+
+    PoolResource::PoolResource(size_t blockSize, size_t blockAlignment, size_t blocksPerChunk, MemoryResource* pUpstream)
+        : m_pUpstream(pUpstream)
+        , m_blockSize(alignUp(std::max(blockSize, sizeof(FreeBlock)), std::max(blockAlignment, alignof(FreeBlock))))
+        , m_blockAlignment(std::max(blockAlignment, alignof(FreeBlock)))
+        , m_blocksPerChunk(std::max<size_t>(blocksPerChunk, 1))
+    {
+    }
+
+    PoolResource::~PoolResource()
+    {
+        for (void* pChunk : m_chunks)
+        {
+            m_pUpstream->deallocate(pChunk, m_blockSize * m_blocksPerChunk, m_blockAlignment);
+        }
+    }
+
+    void* PoolResource::doAllocate(size_t bytes, size_t alignment)
+    {
+        m_stats.allocations++;
+        m_stats.bytes += bytes;
+        if (!fits(bytes, alignment))
+        {
+            m_stats.upstreamAllocations++;
+            return m_pUpstream->allocate(bytes, alignment);
+        }
+
+        if (!m_pFree)
+        {
+            uint8_t* pChunk = static_cast<uint8_t*>(m_pUpstream->allocate(m_blockSize * m_blocksPerChunk, m_blockAlignment));
+            m_chunks.push_back(pChunk);
+            m_stats.upstreamAllocations++;
+            m_stats.capacity += m_blockSize * m_blocksPerChunk;
+            // Thread the new blocks onto the free list, first block on top.
+            for (size_t i = m_blocksPerChunk; i-- > 0;)
+            {
+                FreeBlock* pBlock = reinterpret_cast<FreeBlock*>(pChunk + i * m_blockSize);
+                pBlock->pNext = m_pFree;
+                m_pFree = pBlock;
+            }
+        }
+        FreeBlock* pBlock = m_pFree;
+        m_pFree = pBlock->pNext;
+        return pBlock;
+    }
+
+    void PoolResource::doDeallocate(void* p, size_t bytes, size_t alignment)
+    {
+        if (!fits(bytes, alignment))
+        {
+            m_pUpstream->deallocate(p, bytes, alignment);
+            return;
+        }
+        FreeBlock* pBlock = static_cast<FreeBlock*>(p);
+        pBlock->pNext = m_pFree;
+        m_pFree = pBlock;
+    }
+
+    void PoolResource::resetStats()
+    {
+        const uint64_t capacity = m_stats.capacity;
+        m_stats = AllocationStats();
+        m_stats.capacity = capacity;
+    }
+} // namespace Pinnacle
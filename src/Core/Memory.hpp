@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Allocator layer for transient and pooled memory. The interfaces follow
+// std::pmr (memory_resource, polymorphic_allocator) so containers opt in per
+// instance; std::pmr itself needs macOS 14 in Apple's libc++, past the
+// deployment target.
+
+namespace Pinnacle
+{
+    struct AllocationStats
+    {
+        uint64_t allocations = 0; // Since the last reset
+        uint64_t bytes = 0;       // Requested since the last reset
+        uint64_t upstreamAllocations = 0;
+        uint64_t capacity = 0;    // Bytes currently held from the upstream resource
+    };
+
+    // Equivalent of std::pmr::memory_resource.
+    class MemoryResource
+    {
+    public:
+        virtual ~MemoryResource() = default;
+
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) { return doAllocate(bytes, alignment); }
+        void deallocate(void* p, size_t bytes, size_t alignment = alignof(std::max_align_t)) { doDeallocate(p, bytes, alignment); }
+        bool isEqual(const MemoryResource& other) const { return this == &other || doIsEqual(other); }
+
+    protected:
+        virtual void* doAllocate(size_t bytes, size_t alignment) = 0;
+        virtual void doDeallocate(void* p, size_t bytes, size_t alignment) = 0;
+        virtual bool doIsEqual(const MemoryResource& other) const { return this == &other; }
+    };
+
+    // Global operator new/delete.
+    MemoryResource* getDefaultResource();
+
+    // Bump allocator over a list of blocks. deallocate() is a no-op; memory
+    // comes back all at once through reset(), or down to a marker through
+    // rewind(). Not thread-safe.
+    class LinearArena : public MemoryResource
+    {
+    public:
+        struct Marker
+        {
+            size_t block = 0;
+            size_t offset = 0;
+            size_t used = 0;
+        };
+
+        explicit LinearArena(size_t blockSize = 64 * 1024, MemoryResource* pUpstream = getDefaultResource());
+        ~LinearArena() override;
+        LinearArena(const LinearArena&) = delete;
+        LinearArena& operator=(const LinearArena&) = delete;
+
+        // Frees every allocation and starts new stats. Blocks are merged
+        // into one sized to the high-water mark, so a steady workload stops
+        // touching the upstream resource after its first few resets.
+        void reset();
+
+        Marker getMarker() const { return { m_current, m_offset, m_used }; }
+        // Frees everything allocated since `marker`; markers from before a
+        // reset() are invalid. Rewinding to the start also releases every
+        // block beyond one of the configured size, so one large request is
+        // not kept forever.
+        void rewind(const Marker& marker);
+
+        AllocationStats getStats() const { return m_stats; }
+        void resetStats();
+
+    protected:
+        void* doAllocate(size_t bytes, size_t alignment) override;
+        void doDeallocate(void*, size_t, size_t) override {}
+
+    private:
+        struct Block
+        {
+            uint8_t* pData;
+            size_t size;
+        };
+
+        void releaseBlocks(size_t first);
+
+        MemoryResource* m_pUpstream;
+        size_t m_blockSize;
+        std::vector<Block> m_blocks;
+        size_t m_current = 0; // Block being bumped
+        size_t m_offset = 0;
+        size_t m_used = 0;    // Bytes handed out since the last reset, padding included
+        size_t m_highWater = 0;
+        AllocationStats m_stats;
+    };
+
+    // The calling thread's scratch arena (256 KiB blocks). Use through
+    // ScratchScope so nested users never free each other's memory.
+    LinearArena& getScratchArena();
+
+    // Everything allocated from the thread's scratch arena while the scope is
+    // alive is freed when it ends; containers using it must not outlive it.
+    class ScratchScope
+    {
+    public:
+        ScratchScope() : m_arena(getScratchArena()), m_marker(m_arena.getMarker()) {}
+        ~ScratchScope() { m_arena.rewind(m_marker); }
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+
+        LinearArena& getArena() { return m_arena; }
+
+    private:
+        LinearArena& m_arena;
+        LinearArena::Marker m_marker;
+    };
+
+    // Fixed-size blocks carved from chunks of `blocksPerChunk`, recycled
+    // through a free list. Requests that do not fit a block go upstream.
+    // Chunks are only returned on destruction. Not thread-safe.
+    class PoolResource : public MemoryResource
+    {
+    public:
+        PoolResource(size_t blockSize, size_t blockAlignment, size_t blocksPerChunk = 256,
+                     MemoryResource* pUpstream = getDefaultResource());
+        ~PoolResource() override;
+        PoolResource(const PoolResource&) = delete;
+        PoolResource& operator=(const PoolResource&) = delete;
+
+        AllocationStats getStats() const { return m_stats; }
+        void resetStats();
+
+    protected:
+        void* doAllocate(size_t bytes, size_t alignment) override;
+        void doDeallocate(void* p, size_t bytes, size_t alignment) override;
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock* pNext;
+        };
+
+        bool fits(size_t bytes, size_t alignment) const { return bytes <= m_blockSize && alignment <= m_blockAlignment; }
+
+        MemoryResource* m_pUpstream;
+        size_t m_blockSize;
+        size_t m_blockAlignment;
+        size_t m_blocksPerChunk;
+        std::vector<void*> m_chunks;
+        FreeBlock* m_pFree = nullptr;
+        AllocationStats m_stats;
+    };
+
+    // Typed front end of a PoolResource.
+    template <typename T>
+    class ObjectPool
+    {
+    public:
+        explicit ObjectPool(size_t objectsPerChunk = 256, MemoryResource* pUpstream = getDefaultResource())
+            : m_resource(sizeof(T) < sizeof(void*) ? sizeof(void*) : sizeof(T),
+                         alignof(T) < alignof(void*) ? alignof(void*) : alignof(T), objectsPerChunk, pUpstream)
+        {
+        }
+
+        template <typename... Args>
+        T* create(Args&&... args)
+        {
+            void* p = m_resource.allocate(sizeof(T), alignof(T));
+            try
+            {
+                return new (p) T(std::forward<Args>(args)...);
+            }
+            catch (...)
+            {
+                m_resource.deallocate(p, sizeof(T), alignof(T));
+                throw;
+            }
+        }
+
+        void destroy(T* p)
+        {
+            if (p)
+            {
+                p->~T();
+                m_resource.deallocate(p, sizeof(T), alignof(T));
+            }
+        }
+
+        AllocationStats getStats() const { return m_resource.getStats(); }
+
+    private:
+        PoolResource m_resource;
+    };
+
+    // Equivalent of std::pmr::polymorphic_allocator<T>.
+    template <typename T>
+    class Allocator
+    {
+    public:
+        using value_type = T;
+
+        Allocator(MemoryResource* pResource = getDefaultResource()) : m_pResource(pResource) {}
+        template <typename U>
+        Allocator(const Allocator<U>& other) : m_pResource(other.getResource())
+        {
+        }
+
+        T* allocate(size_t count) { return static_cast<T*>(m_pResource->allocate(count * sizeof(T), alignof(T))); }
+        void deallocate(T* p, size_t count) { m_pResource->deallocate(p, count * sizeof(T), alignof(T)); }
+
+        MemoryResource* getResource() const { return m_pResource; }
+
+    private:
+        MemoryResource* m_pResource;
+    };
+
+    template <typename T, typename U>
+    bool operator==(const Allocator<T>& a, const Allocator<U>& b)
+    {
+        return a.getResource()->isEqual(*b.getResource());
+    }
+
+    template <typename T, typename U>
+    bool operator!=(const Allocator<T>& a, const Allocator<U>& b)
+    {
+        return !(a == b);
+    }
+
+    template <typename T>
+    using ArenaVector = std::vector<T, Allocator<T>>;
+} // namespace Pinnacle
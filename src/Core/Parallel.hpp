@@ -0,0 +1,19 @@
+#pragma once
+
+#include "JobSystem.hpp"
+
+#include <cstddef>
+
+namespace Pinnacle
+{
+    // Runs `task(i)` for every i in [0, count) on up to `threadCount` threads
+    // (0 = every worker of the shared job system, about hardware concurrency),
+    // the calling thread included. Items are handed out one at a time, so
+    // uneven items balance themselves; use JobSystem::parallelFor() directly
+    // to hand them out in larger grains.
+    template <typename Task>
+    void parallelFor(size_t count, unsigned int threadCount, const Task& task)
+    {
+        JobSystem::getShared().parallelFor(count, 1, task, threadCount);
+    }
+} // namespace Pinnacle
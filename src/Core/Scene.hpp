@@ -1,21 +1,33 @@
 #pragma once
 
 #include "Camera.hpp"
+#include "SlotMap.hpp"
 #include "../Scene/Model.hpp"
 
 #include <vector>
-#include <memory>
 
 namespace Pinnacle
 {
+    using ModelHandle = Handle<Model>;
+
+    // Owns every scene object in one dense slot map per type; objects refer
+    // to each other through handles, so traversal is linear and copying a
+    // reference touches no refcount.
     class Scene
     {
     public:
         Scene();
         ~Scene();
 
-        void addModel(std::shared_ptr<Pinnacle::Model> model);
-        const std::vector<std::shared_ptr<Pinnacle::Model>>& getModels() const;
+        ModelHandle addModel(Pinnacle::Model&& model);
+        // Removes the model's own nodes, meshes, materials and textures too.
+        void removeModel(ModelHandle model);
+        const SlotMap<Pinnacle::Model>& getModels() const { return m_models; }
+
+        SlotMap<Pinnacle::Node>& getNodes() { return m_nodes; }
+        SlotMap<Pinnacle::Mesh>& getMeshes() { return m_meshes; }
+        SlotMap<Pinnacle::Material>& getMaterials() { return m_materials; }
+        SlotMap<Pinnacle::Texture>& getTextures() { return m_textures; }
 
         Pinnacle::Camera& getCamera();
         void setCamera(Pinnacle::Camera* pCamera);
@@ -32,7 +44,11 @@ namespace Pinnacle
 
     private:
         Pinnacle::Camera* m_pCamera;
-        std::vector<std::shared_ptr<Pinnacle::Model>> m_models;
+        SlotMap<Pinnacle::Model> m_models;
+        SlotMap<Pinnacle::Node> m_nodes;
+        SlotMap<Pinnacle::Mesh> m_meshes;
+        SlotMap<Pinnacle::Material> m_materials;
+        SlotMap<Pinnacle::Texture> m_textures;
         std::vector<Light> m_lights;
         // TODO: Add lights, etc.
     };
@@ -0,0 +1,62 @@
+#include "Scene.hpp"
+
+#include <utility>
+
+namespace Pinnacle
+{
+    Scene::Scene()
+        : m_pCamera(nullptr)
+    {
+    }
+
+    Scene::~Scene()
+    {
+    }
+
+    ModelHandle Scene::addModel(Pinnacle::Model&& model)
+    {
+        return m_models.insert(std::move(model));
+    }
+
+    void Scene::removeModel(ModelHandle model)
+    {
+        const Pinnacle::Model* pModel = m_models.get(model);
+        if (!pModel)
+        {
+            return;
+        }
+        // Handles of objects already removed no longer resolve, so each is freed once.
+        for (NodeHandle node : pModel->getNodes())
+        {
+            m_nodes.remove(node);
+        }
+        for (MeshHandle mesh : pModel->getMeshes())
+        {
+            m_meshes.remove(mesh);
+        }
+        for (MaterialHandle material : pModel->getMaterials())
+        {
+            m_materials.remove(material);
+        }
+        for (TextureHandle texture : pModel->getTextures())
+        {
+            m_textures.remove(texture);
+        }
+        m_models.remove(model);
+    }
+
+    Pinnacle::Camera& Scene::getCamera()
+    {
+        return *m_pCamera;
+    }
+
+    void Scene::setCamera(Pinnacle::Camera* pCamera)
+    {
+        m_pCamera = pCamera;
+    }
+
+    void Scene::addLight(const Light& light)
+    {
+        m_lights.push_back(light);
+    }
+} // namespace Pinnacle
@@ -0,0 +1,135 @@
+#pragma once
+
+// Minimal 4-wide float vector wrapper over SSE2 (x86-64) and NEON (arm64),
+// with a scalar fallback. Used by the CPU-side hot loops that need to run
+// on every platform we build for; Apple's <simd/simd.h> is only available
+// on Apple targets.
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define PINNACLE_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define PINNACLE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include <cstdint>
+
+namespace Pinnacle
+{
+    namespace Simd
+    {
+#if PINNACLE_SIMD_SSE2
+        using Float4 = __m128;
+        using Mask4 = __m128;
+
+        inline Float4 load(const float* p) { return _mm_loadu_ps(p); }
+        inline void store(float* p, Float4 v) { _mm_storeu_ps(p, v); }
+        inline Float4 splat(float v) { return _mm_set1_ps(v); }
+        inline Float4 make(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+        inline Float4 add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+        inline Float4 sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+        inline Float4 mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+        inline Float4 madd(Float4 a, Float4 b, Float4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+        inline Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a, b); }
+        inline Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a, b); }
+        inline Mask4 lessThan(Float4 a, Float4 b) { return _mm_cmplt_ps(a, b); }
+        inline Mask4 lessEqual(Float4 a, Float4 b) { return _mm_cmple_ps(a, b); }
+        inline Mask4 greaterEqual(Float4 a, Float4 b) { return _mm_cmpge_ps(a, b); }
+        inline Mask4 maskAnd(Mask4 a, Mask4 b) { return _mm_and_ps(a, b); }
+        inline Mask4 maskOr(Mask4 a, Mask4 b) { return _mm_or_ps(a, b); }
+        inline Float4 select(Mask4 mask, Float4 a, Float4 b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+        inline int maskBits(Mask4 mask) { return _mm_movemask_ps(mask); }
+#elif PINNACLE_SIMD_NEON
+        using Float4 = float32x4_t;
+        using Mask4 = uint32x4_t;
+
+        inline Float4 load(const float* p) { return vld1q_f32(p); }
+        inline void store(float* p, Float4 v) { vst1q_f32(p, v); }
+        inline Float4 splat(float v) { return vdupq_n_f32(v); }
+        inline Float4 make(float x, float y, float z, float w)
+        {
+            const float values[4] = { x, y, z, w };
+            return vld1q_f32(values);
+        }
+        inline Float4 add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+        inline Float4 sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+        inline Float4 mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+        inline Float4 madd(Float4 a, Float4 b, Float4 c) { return vmlaq_f32(c, a, b); }
+        inline Float4 min(Float4 a, Float4 b) { return vminq_f32(a, b); }
+        inline Float4 max(Float4 a, Float4 b) { return vmaxq_f32(a, b); }
+        inline Mask4 lessThan(Float4 a, Float4 b) { return vcltq_f32(a, b); }
+        inline Mask4 lessEqual(Float4 a, Float4 b) { return vcleq_f32(a, b); }
+        inline Mask4 greaterEqual(Float4 a, Float4 b) { return vcgeq_f32(a, b); }
+        inline Mask4 maskAnd(Mask4 a, Mask4 b) { return vandq_u32(a, b); }
+        inline Mask4 maskOr(Mask4 a, Mask4 b) { return vorrq_u32(a, b); }
+        inline Float4 select(Mask4 mask, Float4 a, Float4 b) { return vbslq_f32(mask, a, b); }
+        inline int maskBits(Mask4 mask)
+        {
+            const uint32x4_t bits = vshrq_n_u32(mask, 31);
+            return static_cast<int>(vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) |
+                                    (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3));
+        }
+#else
+        struct Float4
+        {
+            float v[4];
+        };
+        struct Mask4
+        {
+            uint32_t v[4];
+        };
+
+        inline Float4 load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+        inline void store(float* p, Float4 a) { for (int i = 0; i < 4; ++i) p[i] = a.v[i]; }
+        inline Float4 splat(float v) { return { { v, v, v, v } }; }
+        inline Float4 make(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+        inline Float4 add(Float4 a, Float4 b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+        inline Float4 sub(Float4 a, Float4 b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+        inline Float4 mul(Float4 a, Float4 b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+        inline Float4 madd(Float4 a, Float4 b, Float4 c) { return add(mul(a, b), c); }
+        inline Float4 min(Float4 a, Float4 b)
+        {
+            Float4 r;
+            for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+            return r;
+        }
+        inline Float4 max(Float4 a, Float4 b)
+        {
+            Float4 r;
+            for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+            return r;
+        }
+        inline Mask4 lessThan(Float4 a, Float4 b)
+        {
+            Mask4 r;
+            for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] < b.v[i] ? ~0u : 0u;
+            return r;
+        }
+        inline Mask4 lessEqual(Float4 a, Float4 b)
+        {
+            Mask4 r;
+            for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] <= b.v[i] ? ~0u : 0u;
+            return r;
+        }
+        inline Mask4 greaterEqual(Float4 a, Float4 b)
+        {
+            Mask4 r;
+            for (int i = 0; i < 4; ++i) r.v[i] = a.v[i] >= b.v[i] ? ~0u : 0u;
+            return r;
+        }
+        inline Mask4 maskAnd(Mask4 a, Mask4 b) { return { { a.v[0] & b.v[0], a.v[1] & b.v[1], a.v[2] & b.v[2], a.v[3] & b.v[3] } }; }
+        inline Mask4 maskOr(Mask4 a, Mask4 b) { return { { a.v[0] | b.v[0], a.v[1] | b.v[1], a.v[2] | b.v[2], a.v[3] | b.v[3] } }; }
+        inline Float4 select(Mask4 mask, Float4 a, Float4 b)
+        {
+            Float4 r;
+            for (int i = 0; i < 4; ++i) r.v[i] = mask.v[i] ? a.v[i] : b.v[i];
+            return r;
+        }
+        inline int maskBits(Mask4 mask)
+        {
+            return (mask.v[0] ? 1 : 0) | (mask.v[1] ? 2 : 0) | (mask.v[2] ? 4 : 0) | (mask.v[3] ? 8 : 0);
+        }
+#endif
+    } // namespace Simd
+} // namespace Pinnacle
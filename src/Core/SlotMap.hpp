@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Generational reference to an object in a SlotMap<T>: a slot index
+    // plus the generation the slot had when the object was inserted. Copying
+    // one is free, and a handle whose object was removed stops resolving
+    // instead of dangling. T may be incomplete where handles are declared.
+    template <typename T>
+    struct Handle
+    {
+        static const uint32_t kInvalidIndex = UINT32_MAX;
+
+        uint32_t index = kInvalidIndex;
+        uint32_t generation = 0;
+
+        bool isValid() const { return index != kInvalidIndex; }
+
+        bool operator==(const Handle& other) const { return index == other.index && generation == other.generation; }
+        bool operator!=(const Handle& other) const { return !(*this == other); }
+    };
+
+    // Objects stored densely in one array, so iteration is a linear walk,
+    // behind a slot table that keeps handles stable. remove() moves the last
+    // object into the hole, which changes iteration order but never a
+    // handle. Freed slots are reused with a bumped generation. Lookups are
+    // two array reads; not thread-safe.
+    template <typename T>
+    class SlotMap
+    {
+    public:
+        using Iterator = typename std::vector<T>::iterator;
+        using ConstIterator = typename std::vector<T>::const_iterator;
+
+        template <typename... Args>
+        Handle<T> emplace(Args&&... args)
+        {
+            uint32_t slotIndex;
+            if (m_freeHead != kNoSlot)
+            {
+                slotIndex = m_freeHead;
+                m_freeHead = m_slots[slotIndex].denseIndex;
+            }
+            else
+            {
+                slotIndex = static_cast<uint32_t>(m_slots.size());
+                m_slots.push_back(Slot());
+            }
+
+            m_values.emplace_back(std::forward<Args>(args)...);
+            m_valueSlots.push_back(slotIndex);
+            Slot& slot = m_slots[slotIndex];
+            slot.denseIndex = static_cast<uint32_t>(m_values.size() - 1);
+
+            Handle<T> handle;
+            handle.index = slotIndex;
+            handle.generation = slot.generation;
+            return handle;
+        }
+
+        Handle<T> insert(T value) { return emplace(std::move(value)); }
+
+        // Returns false when the handle no longer resolves.
+        bool remove(Handle<T> handle)
+        {
+            if (!contains(handle))
+            {
+                return false;
+            }
+            Slot& slot = m_slots[handle.index];
+            const uint32_t hole = slot.denseIndex;
+            const uint32_t last = static_cast<uint32_t>(m_values.size() - 1);
+            if (hole != last)
+            {
+                m_values[hole] = std::move(m_values[last]);
+                m_valueSlots[hole] = m_valueSlots[last];
+                m_slots[m_valueSlots[hole]].denseIndex = hole;
+            }
+            m_values.pop_back();
+            m_valueSlots.pop_back();
+
+            slot.generation++;
+            slot.denseIndex = m_freeHead;
+            m_freeHead = handle.index;
+            return true;
+        }
+
+        bool contains(Handle<T> handle) const
+        {
+            // Removal bumps the generation, so a match means the slot is live.
+            return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation;
+        }
+
+        // Null when the handle no longer resolves.
+        T* get(Handle<T> handle) { return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr; }
+        const T* get(Handle<T> handle) const
+        {
+            return contains(handle) ? &m_values[m_slots[handle.index].denseIndex] : nullptr;
+        }
+
+        // Handle of the object at position `denseIndex` of the iteration order.
+        Handle<T> getHandle(size_t denseIndex) const
+        {
+            Handle<T> handle;
+            handle.index = m_valueSlots[denseIndex];
+            handle.generation = m_slots[handle.index].generation;
+            return handle;
+        }
+
+        void clear()
+        {
+            for (uint32_t slotIndex : m_valueSlots)
+            {
+                Slot& slot = m_slots[slotIndex];
+                slot.generation++;
+                slot.denseIndex = m_freeHead;
+                m_freeHead = slotIndex;
+            }
+            m_values.clear();
+            m_valueSlots.clear();
+        }
+
+        void reserve(size_t count)
+        {
+            m_values.reserve(count);
+            m_valueSlots.reserve(count);
+            m_slots.reserve(count);
+        }
+
+        size_t size() const { return m_values.size(); }
+        bool empty() const { return m_values.empty(); }
+
+        Iterator begin() { return m_values.begin(); }
+        Iterator end() { return m_values.end(); }
+        ConstIterator begin() const { return m_values.begin(); }
+        ConstIterator end() const { return m_values.end(); }
+
+    private:
+        static const uint32_t kNoSlot = UINT32_MAX;
+
+        struct Slot
+        {
+            uint32_t denseIndex = 0; // Next free slot while the slot is free
+            uint32_t generation = 1; // Never 0, so a default Handle never resolves
+        };
+
+        std::vector<T> m_values;
+        std::vector<uint32_t> m_valueSlots; // Slot of each dense value
+        std::vector<Slot> m_slots;
+        uint32_t m_freeHead = kNoSlot;
+    };
+} // namespace Pinnacle
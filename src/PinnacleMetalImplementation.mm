@@ -3,34 +3,218 @@
 #import <Foundation/Foundation.h> // For NSBundle
 
 #include "PinnacleMetalRenderer.h" // Include the concrete renderer declaration
+#include "Asset/GltfImporter.hpp"
+#include "Asset/VertexQuantizer.hpp"
+#include "Core/Hash.hpp"
+#include "Core/JobSystem.hpp"
+#include "stb_image_write.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <utility>
 
 // Uniforms structure for our shader
 struct Uniforms {
-    vector_float4 modelColor;
+    simd_float4x4 modelViewProjection;
+    simd_float4x4 modelView;
+    vector_float4 positionOffset; // Dequantizes QuantizedVertex positions: offset + unorm * scale
+    vector_float4 positionScale;
+};
+
+// Matches ShadowParams in triangle.metal
+struct ShadowParams {
+    simd_float4x4 viewToShadow[Pinnacle::ShadowCascades::kMaxCascades];
+    vector_float4 splitDepths; // Far view depth of each cascade
+    vector_float4 normalOffsets; // Receiver offset along the normal, view units
+    uint32_t cascadeCount; // 0 = no shadows this frame
+    uint32_t padding[3];
 };
 
+// Rebuilds QuantizedVertex positions against the primitive's bounds.
+static void setPositionDequantization(Uniforms& uniforms, const Pinnacle::PrimitiveData& primitive) {
+    uniforms.positionOffset = { primitive.bounds.min[0], primitive.bounds.min[1], primitive.bounds.min[2], 0.0f };
+    uniforms.positionScale = { primitive.bounds.max[0] - primitive.bounds.min[0], primitive.bounds.max[1] - primitive.bounds.min[1],
+                               primitive.bounds.max[2] - primitive.bounds.min[2], 0.0f };
+}
+
+static simd_float4x4 toSimdMatrix(const float matrix[16]) {
+    simd_float4x4 result;
+    std::memcpy(&result, matrix, sizeof(result));
+    return result;
+}
+
+static MTLVertexFormat toMetalVertexFormat(Pinnacle::VertexAttributeFormat format) {
+    switch (format) {
+        case Pinnacle::VertexAttributeFormat::Float2: return MTLVertexFormatFloat2;
+        case Pinnacle::VertexAttributeFormat::Float3: return MTLVertexFormatFloat3;
+        case Pinnacle::VertexAttributeFormat::Half2: return MTLVertexFormatHalf2;
+        case Pinnacle::VertexAttributeFormat::UShort4Normalized: return MTLVertexFormatUShort4Normalized;
+        case Pinnacle::VertexAttributeFormat::Short2Normalized: return MTLVertexFormatShort2Normalized;
+        case Pinnacle::VertexAttributeFormat::UChar4Normalized: return MTLVertexFormatUChar4Normalized;
+    }
+    return MTLVertexFormatInvalid;
+}
+
+static MTLVertexDescriptor* newVertexDescriptor(const Pinnacle::VertexLayout& layout) {
+    MTLVertexDescriptor* vertexDescriptor = [[MTLVertexDescriptor alloc] init];
+    for (uint32_t i = 0; i < layout.attributeCount; ++i) {
+        const Pinnacle::VertexAttributeLayout& attribute = layout.attributes[i];
+        vertexDescriptor.attributes[attribute.location].format = toMetalVertexFormat(attribute.format);
+        vertexDescriptor.attributes[attribute.location].offset = attribute.offset;
+        vertexDescriptor.attributes[attribute.location].bufferIndex = attribute.buffer;
+    }
+    for (uint32_t i = 0; i < Pinnacle::VertexLayout::kMaxBuffers; ++i) {
+        if (layout.strides[i] == 0) continue;
+        vertexDescriptor.layouts[i].stride = layout.strides[i];
+        vertexDescriptor.layouts[i].stepFunction = MTLVertexStepFunctionPerVertex;
+    }
+    return vertexDescriptor;
+}
+
+// Pipelines of the main view and the shadow passes differ only in these.
+static Pinnacle::PipelineDescription describePipeline(uint32_t variantKey, MTLPixelFormat colorFormat, uint32_t flags) {
+    Pinnacle::PipelineDescription description;
+    description.variantKey = variantKey;
+    description.colorFormat = (uint32_t)colorFormat;
+    description.depthFormat = (uint32_t)MTLPixelFormatDepth32Float;
+    description.flags = flags;
+    return description;
+}
+
+// Shared buffer holding `bytes` of `pData`; never empty, so it can always be bound.
+static id<MTLBuffer> newSharedBuffer(id<MTLDevice> device, const void* pData, size_t bytes) {
+    id<MTLBuffer> pBuffer = [device newBufferWithLength:std::max<size_t>(bytes, 16) options:MTLResourceStorageModeShared];
+    if (bytes > 0) std::memcpy(pBuffer.contents, pData, bytes);
+    return pBuffer;
+}
+
+// 1x1 RGBA8 texture of one color.
+static id<MTLTexture> newSolidTexture(id<MTLDevice> device, uint8_t r, uint8_t g, uint8_t b, uint8_t a) {
+    MTLTextureDescriptor* pDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatRGBA8Unorm
+                                                                                           width:1
+                                                                                          height:1
+                                                                                       mipmapped:NO];
+    id<MTLTexture> pTexture = [device newTextureWithDescriptor:pDescriptor];
+    const uint8_t texel[4] = { r, g, b, a };
+    [pTexture replaceRegion:MTLRegionMake2D(0, 0, 1, 1) mipmapLevel:0 withBytes:texel bytesPerRow:sizeof(texel)];
+    return pTexture;
+}
+
 // Implementation of PinnacleMetalRenderer methods
 PinnacleMetalRenderer::PinnacleMetalRenderer() {
     _pDevice = MTLCreateSystemDefaultDevice();
     _pCommandQueue = [_pDevice newCommandQueue];
     _pShaderLibrary = nil; // Initialize to nil
     _pPipelineState = nil; // Initialize to nil
-    _pUniformBuffer = nil; // Initialize to nil
+    _pDepthOnlyPipelineState = nil; // Initialize to nil
+    _pQuantizedPipelineState = nil; // Initialize to nil
+    _pQuantizedDepthOnlyPipelineState = nil; // Initialize to nil
+    _pShadowPipelineState = nil; // Initialize to nil
+    _pQuantizedShadowPipelineState = nil; // Initialize to nil
+    _pDepthWriteState = nil; // Initialize to nil
+    _pDepthEqualState = nil; // Initialize to nil
+    _pDepthTexture = nil; // Initialize to nil
+    _pPipelineArchive = nil; // Initialize to nil
+    _pMaterialBuffer = nil; // Initialize to nil
+    _pTextureTableEncoder = nil; // Initialize to nil
+    _pTextureTable = nil; // Initialize to nil
+    _textureTableDirty = false;
+    _depthPrepassEnabled = false;
+    _pVertexBuffer = nil; // Initialize to nil
+    _pVertexColorBuffer = nil; // Initialize to nil
+    _pIndexBuffer = nil; // Initialize to nil
+
+    _occlusionMode = Pinnacle::OcclusionMode::Disabled;
+    _occluderTriangleBudget = 65536;
+    _lodEnabled = true;
+    _clusterCullingMode = Pinnacle::ClusterCullingMode::Cpu;
+    _pMeshletCullPipeline = nil; // Initialize to nil
+    _pMeshletBuffer = nil; // Initialize to nil
+    _pCulledIndexBuffer = nil;
+    _pCullArgumentsBuffer = nil;
+    _gpuCulledIndexCount = 0;
+    _pLightBuffer = nil;
+    _pLightClusterBuffer = nil;
+    _pLightIndexBuffer = nil;
+    _pShadowTexture = nil; // Initialize to nil
+    _shadowsEnabled = true;
+    _shadowsActive = false;
+    _skinningMode = Pinnacle::SkinningMode::Gpu;
+    _animationClockStarted = false;
+    _skinnedVertexBytes = 0;
+    _pSkinningPipeline = nil; // Initialize to nil
+    _pSkinVertexBuffer = nil; // Initialize to nil
+    _pSkinnedVertexBuffer = nil;
+    _morphedVertexBytes = 0;
+    _pMorphedVertexBuffer = nil; // Initialize to nil
+    _pDepthDownsamplePipeline = nil; // Initialize to nil
+    for (int i = 0; i < kHiZSlotCount; ++i) {
+        _pHiZReadback[i] = nil;
+        _hiZSlotFrame[i] = 0;
+        _hiZSlotCompleted[i] = 0;
+    }
+    _hiZFirstValidFrame = 0;
+    _hiZWidth = 0;
+    _hiZHeight = 0;
+    _frameIndex = 1; // 0 marks an unused Hi-Z slot
+    _assetCache.setResourceCache(&Pinnacle::ResourceCache::getShared());
+    Pinnacle::JobSystem::getShared().setMainThread(std::this_thread::get_id()); // Jobs that touch Metal objects run here
 
     buildShaders();
+    _pWhiteTexture = newSolidTexture(_pDevice, 255, 255, 255, 255);
+    _pBlackTexture = newSolidTexture(_pDevice, 0, 0, 0, 255);
+    _pFlatNormalTexture = newSolidTexture(_pDevice, 128, 128, 255, 255);
+
+    // The texture array of TextureTable in triangle.metal
+    MTLArgumentDescriptor* pTableArgument = [MTLArgumentDescriptor argumentDescriptor];
+    pTableArgument.index = 0;
+    pTableArgument.dataType = MTLDataTypeTexture;
+    pTableArgument.textureType = MTLTextureType2D;
+    pTableArgument.access = MTLArgumentAccessReadOnly;
+    pTableArgument.arrayLength = Pinnacle::kTextureTableCapacity;
+    _pTextureTableEncoder = [_pDevice newArgumentEncoderWithArguments:@[ pTableArgument ]];
+    if (_pDevice.argumentBuffersSupport < MTLArgumentBuffersTier2) {
+        NSLog(@"Material texture tables need argument buffers tier 2; this GPU may not draw textured materials");
+    }
 }
 
 PinnacleMetalRenderer::~PinnacleMetalRenderer() {
+    // Let in-flight frames finish; their completion handlers point into this object
+    id<MTLCommandBuffer> pFlush = [_pCommandQueue commandBuffer];
+    [pFlush commit];
+    [pFlush waitUntilCompleted];
+    // Background compiles also point into it; what they add is kept for the next launch
+    Pinnacle::JobSystem::getShared().wait(_pipelineJobs);
+    savePipelineCache();
+
     // Manual release calls for non-ARC environment
-    for (id<MTLBuffer> buffer : _vertexBuffers) {
-        [buffer release];
+    releaseModelBuffers();
+    for (int i = 0; i < kHiZSlotCount; ++i) {
+        [_pHiZReadback[i] release];
     }
-    _vertexBuffers.clear();
-    for (id<MTLBuffer> buffer : _indexBuffers) {
-        [buffer release];
+    [_pDepthDownsamplePipeline release];
+    [_pMeshletCullPipeline release];
+    [_pSkinningPipeline release];
+    [_pDepthTexture release];
+    [_pShadowTexture release];
+    [_pWhiteTexture release];
+    [_pBlackTexture release];
+    [_pFlatNormalTexture release];
+    [_pTextureTableEncoder release];
+    for (const auto& entry : _pipelines) {
+        [entry.second release];
     }
-    _indexBuffers.clear();
-    [_pUniformBuffer release];
+    [_pPipelineArchive release];
+    [_pDepthEqualState release];
+    [_pDepthWriteState release];
+    [_pQuantizedDepthOnlyPipelineState release];
+    [_pQuantizedShadowPipelineState release];
+    [_pShadowPipelineState release];
+    [_pQuantizedPipelineState release];
+    [_pDepthOnlyPipelineState release];
     [_pPipelineState release];
     [_pShaderLibrary release];
     [_pCommandQueue release];
@@ -38,46 +222,71 @@ PinnacleMetalRenderer::~PinnacleMetalRenderer() {
 }
 
 void PinnacleMetalRenderer::loadModel(const char* filename) {
-    tinygltf::TinyGLTF loader;
-    std::string err;
-    std::string warn;
+    Pinnacle::GltfImporter importer;
+    Pinnacle::ModelData modelData;
 
-    bool res = loader.LoadASCIIFromFile(&_gltfModel, &err, &warn, filename);
-    if (!warn.empty()) {
-        std::cout << "WARN: " << warn << std::endl;
+    importer.setGenerateLods(true);
+    importer.setGenerateMeshlets(true);
+    importer.setProcessTextures(true);
+    importer.setQuantizeVertices(true);
+    importer.setCompressAnimations(true);
+    const uint32_t cacheHits = _assetCache.getHitCount();
+    const Pinnacle::ImportCacheStats chunksBefore = _assetCache.getImportCache().getStats();
+    const Pinnacle::ResourceCacheStats resourcesBefore = Pinnacle::ResourceCache::getShared().getStats();
+    bool res = _assetCache.loadModel(filename, importer, modelData);
+    if (!importer.getWarning().empty()) {
+        std::cout << "WARN: " << importer.getWarning() << std::endl;
     }
 
-    if (!err.empty()) {
-        std::cout << "ERR: " << err << std::endl;
+    if (!importer.getError().empty()) {
+        std::cout << "ERR: " << importer.getError() << std::endl;
     }
 
     if (!res) {
         std::cout << "Failed to load glTF: " << filename << std::endl;
     } else {
-        std::cout << "Successfully loaded glTF: " << filename << std::endl;
-        setupModelBuffers(); // Setup Metal buffers after loading the model
-
-        // Setup uniform buffer with model color
-        Uniforms uniforms;
-        if (!_gltfModel.materials.empty()) {
-            const tinygltf::Material& material = _gltfModel.materials[0];
-            if (material.pbrMetallicRoughness.baseColorFactor.size() == 4) {
-                uniforms.modelColor = {
-                    (float)material.pbrMetallicRoughness.baseColorFactor[0],
-                    (float)material.pbrMetallicRoughness.baseColorFactor[1],
-                    (float)material.pbrMetallicRoughness.baseColorFactor[2],
-                    (float)material.pbrMetallicRoughness.baseColorFactor[3]
-                };
-            } else {
-                uniforms.modelColor = {1.0f, 1.0f, 1.0f, 1.0f}; // Default to white
+        std::cout << "Successfully loaded glTF: " << filename
+                  << (_assetCache.getHitCount() != cacheHits ? " (baked cache)" : "") << std::endl;
+        const Pinnacle::ImportCacheStats chunks = _assetCache.getImportCache().getStats();
+        for (size_t kind = 0; kind < static_cast<size_t>(Pinnacle::ChunkKind::Count); ++kind) {
+            const uint32_t hits = chunks.hits[kind] - chunksBefore.hits[kind];
+            const uint32_t misses = chunks.misses[kind] - chunksBefore.misses[kind];
+            if (hits + misses > 0) {
+                std::cout << "  import cache " << Pinnacle::ImportCache::getKindName(static_cast<Pinnacle::ChunkKind>(kind))
+                          << ": " << hits << " reused, " << misses << " rebuilt" << std::endl;
             }
-        } else {
-            uniforms.modelColor = {1.0f, 1.0f, 1.0f, 1.0f}; // Default to white
         }
-        _pUniformBuffer = [_pDevice newBufferWithBytes:&uniforms length:sizeof(uniforms) options:MTLResourceStorageModeShared];
+        const Pinnacle::ResourceCacheStats resources = Pinnacle::ResourceCache::getShared().getStats();
+        if (resources.hits + resources.misses > resourcesBefore.hits + resourcesBefore.misses) {
+            std::cout << "  shared textures: " << resources.hits - resourcesBefore.hits << " reused ("
+                      << (resources.bytesSaved - resourcesBefore.bytesSaved) / 1024 << " KB saved), "
+                      << resources.misses - resourcesBefore.misses << " new" << std::endl;
+        }
+        const Pinnacle::AnimationCompressionStats& animationStats = importer.getAnimationCompressionStats();
+        if (animationStats.keysBefore > 0) {
+            std::cout << "  animation keys: " << animationStats.keysBefore << " -> " << animationStats.keysAfter << " ("
+                      << animationStats.bytesBefore / 1024 << " KB -> " << animationStats.bytesAfter / 1024 << " KB)"
+                      << std::endl;
+        }
+        setModelData(std::move(modelData));
+        frameModel();
     }
 }
 
+void PinnacleMetalRenderer::setModelData(Pinnacle::ModelData&& modelData) {
+    _modelData = std::move(modelData);
+    _lodSelector.reset();
+    setupModelBuffers(); // Setup Metal buffers for the new model
+}
+
+void PinnacleMetalRenderer::frameModel() {
+    const Pinnacle::Bounds& bounds = _modelData.bounds;
+    if (!bounds.isValid()) return;
+
+    _camera.frameBounds((simd_float3){ bounds.min[0], bounds.min[1], bounds.min[2] },
+                        (simd_float3){ bounds.max[0], bounds.max[1], bounds.max[2] });
+}
+
 void PinnacleMetalRenderer::buildShaders() {
     NSError* error = nil;
     // Get the path to the default.metallib in the app bundle
@@ -90,7 +299,11 @@ void PinnacleMetalRenderer::buildShaders() {
         if (shaderPath) {
             NSString* shaderSource = [NSString stringWithContentsOfFile:shaderPath encoding:NSUTF8StringEncoding error:&error];
             if (shaderSource) {
-                _pShaderLibrary = [_pDevice newLibraryWithSource:shaderSource options:nil error:&error];
+                // The depth pre-pass relies on both pipelines producing bit-identical positions
+                MTLCompileOptions* compileOptions = [[MTLCompileOptions alloc] init];
+                compileOptions.preserveInvariance = YES;
+                _pShaderLibrary = [_pDevice newLibraryWithSource:shaderSource options:compileOptions error:&error];
+                [compileOptions release];
             }
         }
     }
@@ -100,137 +313,1317 @@ void PinnacleMetalRenderer::buildShaders() {
         return;
     }
 
-    id<MTLFunction> vertexFunction = [_pShaderLibrary newFunctionWithName:@"vertexShader"];
-    id<MTLFunction> fragmentFunction = [_pShaderLibrary newFunctionWithName:@"fragmentShader"];
+    // The library's bytes and the device identify the binaries saved by earlier runs
+    NSString* libraryPath = bundlePath ? bundlePath : [[NSBundle mainBundle] pathForResource:@"triangle" ofType:@"metal"];
+    NSData* pLibraryData = [NSData dataWithContentsOfFile:libraryPath];
+    const char* pDeviceName = [[_pDevice name] UTF8String];
+    const std::vector<Pinnacle::PipelineDescription> savedPipelines =
+        openPipelineCache(Pinnacle::hashCombine(Pinnacle::hashBytes(pLibraryData.bytes, pLibraryData.length),
+                                                Pinnacle::hashBytes(pDeviceName, std::strlen(pDeviceName))));
 
-    MTLRenderPipelineDescriptor* pipelineDescriptor = [[MTLRenderPipelineDescriptor alloc] init];
-    pipelineDescriptor.vertexFunction = vertexFunction;
-    pipelineDescriptor.fragmentFunction = fragmentFunction;
-    pipelineDescriptor.colorAttachments[0].pixelFormat = MTLPixelFormatBGRA8Unorm;
+    // The first frame needs the base variants of both vertex formats, their
+    // pre-pass variants and the shadow pipelines. Everything else earlier
+    // runs used compiles on job threads meanwhile.
+    const uint32_t floatKey = Pinnacle::ShaderVariant().getKey();
+    Pinnacle::ShaderVariant quantizedVariant;
+    quantizedVariant.vertexFormat = Pinnacle::VertexFormat::Quantized;
+    const uint32_t quantizedKey = quantizedVariant.getKey();
+    _pPipelineState = [getPipeline(describePipeline(floatKey, MTLPixelFormatBGRA8Unorm, 0)) retain];
+    _pQuantizedPipelineState = [getPipeline(describePipeline(quantizedKey, MTLPixelFormatBGRA8Unorm, 0)) retain];
+    _pDepthOnlyPipelineState = [getPipeline(describePipeline(floatKey, MTLPixelFormatBGRA8Unorm, Pinnacle::kPipelineDepthOnly)) retain];
+    _pQuantizedDepthOnlyPipelineState =
+        [getPipeline(describePipeline(quantizedKey, MTLPixelFormatBGRA8Unorm, Pinnacle::kPipelineDepthOnly)) retain];
+    // The shadow passes have no color attachment at all
+    _pShadowPipelineState = [getPipeline(describePipeline(floatKey, MTLPixelFormatInvalid, Pinnacle::kPipelineDepthOnly)) retain];
+    _pQuantizedShadowPipelineState =
+        [getPipeline(describePipeline(quantizedKey, MTLPixelFormatInvalid, Pinnacle::kPipelineDepthOnly)) retain];
 
-    // Create a vertex descriptor
-    MTLVertexDescriptor* vertexDescriptor = [[MTLVertexDescriptor alloc] init];
-    // Position attribute
-    vertexDescriptor.attributes[0].format = MTLVertexFormatFloat3;
-    vertexDescriptor.attributes[0].offset = 0;
-    vertexDescriptor.attributes[0].bufferIndex = 0;
-    // Layout for buffer 0
-    vertexDescriptor.layouts[0].stride = sizeof(float) * 3; // 3 floats for position
-    vertexDescriptor.layouts[0].stepFunction = MTLVertexStepFunctionPerVertex;
+    for (const Pinnacle::PipelineDescription& description : savedPipelines) {
+        precompilePipeline(description);
+    }
 
-    pipelineDescriptor.vertexDescriptor = vertexDescriptor;
+    MTLDepthStencilDescriptor* depthDescriptor = [[MTLDepthStencilDescriptor alloc] init];
+    depthDescriptor.depthCompareFunction = MTLCompareFunctionLess;
+    depthDescriptor.depthWriteEnabled = YES;
+    _pDepthWriteState = [_pDevice newDepthStencilStateWithDescriptor:depthDescriptor];
+
+    // After the pre-pass the depth buffer already holds the nearest surface,
+    // so the shading pass only needs to test against it.
+    depthDescriptor.depthCompareFunction = MTLCompareFunctionLessEqual;
+    depthDescriptor.depthWriteEnabled = NO;
+    _pDepthEqualState = [_pDevice newDepthStencilStateWithDescriptor:depthDescriptor];
+    [depthDescriptor release];
+
+    // Max-reduces the depth buffer into a small CPU-readable grid for Hi-Z culling
+    id<MTLFunction> downsampleFunction = [_pShaderLibrary newFunctionWithName:@"downsampleDepth"];
+    if (downsampleFunction) {
+        _pDepthDownsamplePipeline = [_pDevice newComputePipelineStateWithFunction:downsampleFunction error:&error];
+        if (!_pDepthDownsamplePipeline) {
+            NSLog(@"Failed to create depth downsample pipeline: %@", error);
+        }
+        [downsampleFunction release];
+    }
+
+    // Compacts the index ranges of meshlets that survive culling for indirect draws
+    id<MTLFunction> meshletCullFunction = [_pShaderLibrary newFunctionWithName:@"cullMeshlets"];
+    if (meshletCullFunction) {
+        _pMeshletCullPipeline = [_pDevice newComputePipelineStateWithFunction:meshletCullFunction error:&error];
+        if (!_pMeshletCullPipeline) {
+            NSLog(@"Failed to create meshlet culling pipeline: %@", error);
+        }
+        [meshletCullFunction release];
+    }
 
-    _pPipelineState = [_pDevice newRenderPipelineStateWithDescriptor:pipelineDescriptor error:&error];
+    // Deforms skinned primitives into world space before any pass draws them
+    id<MTLFunction> skinningFunction = [_pShaderLibrary newFunctionWithName:@"skinVertices"];
+    if (skinningFunction) {
+        _pSkinningPipeline = [_pDevice newComputePipelineStateWithFunction:skinningFunction error:&error];
+        if (!_pSkinningPipeline) {
+            NSLog(@"Failed to create skinning pipeline: %@", error);
+        }
+        [skinningFunction release];
+    }
+}
 
-    if (!_pPipelineState) {
-        NSLog(@"Failed to create pipeline state: %@", error);
+// Specializes a triangle.metal function on a ShaderVariant feature set.
+// Functions that read the feature constants must be created through here.
+id<MTLFunction> PinnacleMetalRenderer::newSpecializedFunction(NSString* name, uint32_t features) {
+    MTLFunctionConstantValues* pConstants = [[MTLFunctionConstantValues alloc] init];
+    for (uint32_t i = 0; i < Pinnacle::kShaderFeatureCount; ++i) {
+        const bool enabled = (features >> i) & 1u;
+        [pConstants setConstantValue:&enabled type:MTLDataTypeBool atIndex:i];
+    }
+    NSError* error = nil;
+    id<MTLFunction> pFunction = [_pShaderLibrary newFunctionWithName:name constantValues:pConstants error:&error];
+    [pConstants release];
+    if (!pFunction) {
+        NSLog(@"Failed to specialize %@ for features 0x%x: %@", name, features, error);
     }
+    return pFunction;
+}
+
+// Thread-safe; the functions and vertex layout all derive from the description.
+MTLRenderPipelineDescriptor* PinnacleMetalRenderer::newPipelineDescriptor(const Pinnacle::PipelineDescription& description) {
+    const Pinnacle::ShaderVariant variant = Pinnacle::ShaderVariant::fromKey(description.variantKey);
+    const bool quantized = variant.vertexFormat == Pinnacle::VertexFormat::Quantized;
+    const bool depthOnly = (description.flags & Pinnacle::kPipelineDepthOnly) != 0;
+    id<MTLFunction> vertexFunction = newSpecializedFunction(quantized ? @"vertexShaderQuantized" : @"vertexShader", variant.features);
+    id<MTLFunction> fragmentFunction = depthOnly ? nil : newSpecializedFunction(@"fragmentShader", variant.features);
+    MTLVertexDescriptor* vertexDescriptor = newVertexDescriptor(Pinnacle::getVertexLayout(variant));
 
+    MTLRenderPipelineDescriptor* pipelineDescriptor = [[MTLRenderPipelineDescriptor alloc] init];
+    pipelineDescriptor.vertexFunction = vertexFunction;
+    pipelineDescriptor.fragmentFunction = fragmentFunction;
+    pipelineDescriptor.vertexDescriptor = vertexDescriptor;
+    pipelineDescriptor.colorAttachments[0].pixelFormat = (MTLPixelFormat)description.colorFormat;
+    pipelineDescriptor.depthAttachmentPixelFormat = (MTLPixelFormat)description.depthFormat;
+    if (depthOnly) {
+        pipelineDescriptor.colorAttachments[0].writeMask = MTLColorWriteMaskNone;
+    } else if (variant.features & Pinnacle::kFeatureAlphaBlend) {
+        // Straight alpha over what is already drawn
+        pipelineDescriptor.colorAttachments[0].blendingEnabled = YES;
+        pipelineDescriptor.colorAttachments[0].sourceRGBBlendFactor = MTLBlendFactorSourceAlpha;
+        pipelineDescriptor.colorAttachments[0].destinationRGBBlendFactor = MTLBlendFactorOneMinusSourceAlpha;
+        pipelineDescriptor.colorAttachments[0].sourceAlphaBlendFactor = MTLBlendFactorOne;
+        pipelineDescriptor.colorAttachments[0].destinationAlphaBlendFactor = MTLBlendFactorOneMinusSourceAlpha;
+    }
+    if (_pPipelineArchive) {
+        pipelineDescriptor.binaryArchives = @[ _pPipelineArchive ];
+    }
     [vertexFunction release];
     [fragmentFunction release];
+    [vertexDescriptor release];
+    return pipelineDescriptor;
+}
+
+// Compiles on this thread unless the pipeline exists; one already compiling
+// on a job thread is waited for instead.
+id<MTLRenderPipelineState> PinnacleMetalRenderer::getPipeline(const Pinnacle::PipelineDescription& description) {
+    const uint64_t key = Pinnacle::hashPipeline(description);
+    auto found = _pipelines.find(key);
+    if (found == _pipelines.end() && _pendingPipelines.count(key) > 0) {
+        Pinnacle::JobSystem::getShared().wait(_pipelineJobs);
+        found = _pipelines.find(key);
+    }
+    if (found != _pipelines.end()) return found->second;
+    if (!_pShaderLibrary) return nil;
+
+    MTLRenderPipelineDescriptor* pipelineDescriptor = newPipelineDescriptor(description);
+    NSError* error = nil;
+    id<MTLRenderPipelineState> pPipeline = [_pDevice newRenderPipelineStateWithDescriptor:pipelineDescriptor error:&error];
+    if (!pPipeline) {
+        NSLog(@"Failed to create pipeline state for shader variant 0x%x: %@", description.variantKey, error);
+    }
+    addPipeline(description, pPipeline, pipelineDescriptor);
     [pipelineDescriptor release];
-    [vertexDescriptor release]; // Release the vertex descriptor
+    _frameStats.pipelineCompiles++;
+    return pPipeline;
+}
+
+void PinnacleMetalRenderer::precompilePipeline(const Pinnacle::PipelineDescription& description) {
+    const uint64_t key = Pinnacle::hashPipeline(description);
+    if (!_pShaderLibrary || _pipelines.count(key) > 0 || !_pendingPipelines.insert(key).second) return;
+
+    Pinnacle::JobSystem& jobs = Pinnacle::JobSystem::getShared();
+    jobs.run([this, &jobs, description]() {
+        @autoreleasepool {
+            MTLRenderPipelineDescriptor* pipelineDescriptor = newPipelineDescriptor(description);
+            NSError* error = nil;
+            id<MTLRenderPipelineState> pPipeline = [_pDevice newRenderPipelineStateWithDescriptor:pipelineDescriptor error:&error];
+            if (!pPipeline) {
+                NSLog(@"Failed to precompile pipeline state for shader variant 0x%x: %@", description.variantKey, error);
+            }
+            // The pipeline map and the archive belong to the render thread
+            jobs.runOnMainThread([this, description, pPipeline, pipelineDescriptor]() {
+                _pendingPipelines.erase(Pinnacle::hashPipeline(description));
+                addPipeline(description, pPipeline, pipelineDescriptor);
+                [pipelineDescriptor release];
+            }, &_pipelineJobs);
+        }
+    }, &_pipelineJobs);
+}
+
+// Takes ownership of pPipeline. New pipelines are recorded for the next
+// launch, their binaries added to the archive.
+void PinnacleMetalRenderer::addPipeline(const Pinnacle::PipelineDescription& description, id<MTLRenderPipelineState> pPipeline,
+                                        MTLRenderPipelineDescriptor* pDescriptor) {
+    if (!_pipelines.emplace(Pinnacle::hashPipeline(description), pPipeline).second) {
+        [pPipeline release];
+        return;
+    }
+    if (!pPipeline || !_pipelineCache.add(description) || !_pPipelineArchive) return;
+
+    NSError* error = nil;
+    if (![_pPipelineArchive addRenderPipelineFunctionsWithDescriptor:pDescriptor error:&error]) {
+        NSLog(@"Failed to archive pipeline for shader variant 0x%x: %@", description.variantKey, error);
+    }
+}
+
+// Loads what earlier runs saved for these shaders and returns the pipelines
+// they built.
+std::vector<Pinnacle::PipelineDescription> PinnacleMetalRenderer::openPipelineCache(uint64_t shaderHash) {
+    const bool manifestLoaded = _pipelineCache.load(shaderHash);
+    NSString* archivePath = [NSString stringWithUTF8String:_pipelineCache.getArchivePath().c_str()];
+    MTLBinaryArchiveDescriptor* pArchiveDescriptor = [[MTLBinaryArchiveDescriptor alloc] init];
+    if (manifestLoaded && [[NSFileManager defaultManager] fileExistsAtPath:archivePath]) {
+        pArchiveDescriptor.url = [NSURL fileURLWithPath:archivePath];
+    }
+    NSError* error = nil;
+    _pPipelineArchive = [_pDevice newBinaryArchiveWithDescriptor:pArchiveDescriptor error:&error];
+    if (!_pPipelineArchive && pArchiveDescriptor.url) {
+        NSLog(@"Discarding unreadable pipeline archive: %@", error);
+        pArchiveDescriptor.url = nil;
+        _pPipelineArchive = [_pDevice newBinaryArchiveWithDescriptor:pArchiveDescriptor error:&error];
+    }
+    const std::vector<Pinnacle::PipelineDescription> savedPipelines = _pipelineCache.getPipelines();
+    if (!pArchiveDescriptor.url) {
+        _pipelineCache.clear(); // Re-recorded as their binaries land in the new archive
+    }
+    [pArchiveDescriptor release];
+    return savedPipelines;
+}
+
+void PinnacleMetalRenderer::savePipelineCache() {
+    if (!_pipelineCache.isDirty()) return;
+
+    // Binaries first, so the manifest never lists pipelines the archive lacks
+    if (_pPipelineArchive) {
+        std::error_code filesystemError;
+        std::filesystem::create_directories(_pipelineCache.getDirectory(), filesystemError);
+        NSURL* archiveUrl = [NSURL fileURLWithPath:[NSString stringWithUTF8String:_pipelineCache.getArchivePath().c_str()]];
+        NSError* error = nil;
+        if (![_pPipelineArchive serializeToURL:archiveUrl error:&error]) {
+            NSLog(@"Failed to save pipeline archive: %@", error);
+            return;
+        }
+    }
+    _pipelineCache.save();
+}
+
+void PinnacleMetalRenderer::releaseModelBuffers() {
+    [_pVertexBuffer release];
+    [_pVertexColorBuffer release];
+    [_pIndexBuffer release];
+    [_pMeshletBuffer release];
+    [_pMaterialBuffer release];
+    [_pTextureTable release];
+    [_pSkinVertexBuffer release];
+    [_pMorphedVertexBuffer release];
+    _pVertexBuffer = nil;
+    _pSkinVertexBuffer = nil;
+    _pMorphedVertexBuffer = nil;
+    _pVertexColorBuffer = nil;
+    _pMaterialBuffer = nil;
+    _pTextureTable = nil;
+    _pIndexBuffer = nil;
+    _pMeshletBuffer = nil;
+    for (id<MTLTexture> pTexture : _streamedTextures) {
+        [pTexture release];
+    }
+    _streamedTextures.clear();
 }
 
 void PinnacleMetalRenderer::setupModelBuffers() {
-    if (_gltfModel.meshes.empty()) return;
-
-    for (const auto& mesh : _gltfModel.meshes) {
-        for (const auto& primitive : mesh.primitives) {
-            // Vertices (POSITION attribute)
-            auto positionAttribute = primitive.attributes.find("POSITION");
-            if (positionAttribute != primitive.attributes.end()) {
-                const tinygltf::Accessor& accessor = _gltfModel.accessors[positionAttribute->second];
-                const tinygltf::BufferView& bufferView = _gltfModel.bufferViews[accessor.bufferView];
-                const tinygltf::Buffer& buffer = _gltfModel.buffers[bufferView.buffer];
-
-                id<MTLBuffer> vertexBuffer = [_pDevice newBufferWithBytes:buffer.data.data() + bufferView.byteOffset + accessor.byteOffset
-                                                                    length:bufferView.byteLength
-                                                                   options:MTLResourceStorageModeShared];
-                _vertexBuffers.push_back([vertexBuffer retain]); // Retain and add to vector
-                [vertexBuffer release]; // Release the temporary ownership
+    releaseModelBuffers();
+    if (_modelData.empty()) return;
+
+    // All primitives share one vertex and one index buffer; draws address
+    // their range through buffer offsets. Quantized primitives are packed
+    // here, so the CPU copy stays full precision for culling and LODs.
+    const bool canQuantize = _pQuantizedPipelineState && _pQuantizedDepthOnlyPipelineState;
+    _vertexByteOffsets.resize(_modelData.primitives.size());
+    uint64_t vertexBytes = 0;
+    uint32_t quantizedPrimitives = 0;
+    for (size_t i = 0; i < _modelData.primitives.size(); ++i) {
+        Pinnacle::PrimitiveData& primitive = _modelData.primitives[i];
+        if (!canQuantize) primitive.vertexFormat = Pinnacle::VertexFormat::Float;
+        quantizedPrimitives += primitive.vertexFormat == Pinnacle::VertexFormat::Quantized ? 1 : 0;
+        _vertexByteOffsets[i] = vertexBytes;
+        vertexBytes += primitive.vertexCount * Pinnacle::getVertexStride(primitive.vertexFormat);
+    }
+    _pVertexBuffer = [_pDevice newBufferWithLength:std::max<uint64_t>(vertexBytes, sizeof(Pinnacle::ModelVertex))
+                                           options:MTLResourceStorageModeShared];
+    uint8_t* pVertexBytes = (uint8_t*)[_pVertexBuffer contents];
+    for (size_t i = 0; i < _modelData.primitives.size(); ++i) {
+        const Pinnacle::PrimitiveData& primitive = _modelData.primitives[i];
+        const Pinnacle::ModelVertex* pVertices = _modelData.vertices.data() + primitive.vertexOffset;
+        if (primitive.vertexFormat == Pinnacle::VertexFormat::Quantized) {
+            Pinnacle::quantizeVertices(pVertices, primitive.vertexCount, primitive.bounds,
+                                       (Pinnacle::QuantizedVertex*)(pVertexBytes + _vertexByteOffsets[i]));
+        } else {
+            std::memcpy(pVertexBytes + _vertexByteOffsets[i], pVertices, primitive.vertexCount * sizeof(Pinnacle::ModelVertex));
+        }
+    }
+    if (quantizedPrimitives > 0) {
+        std::cout << "  vertex buffer: " << vertexBytes / 1024 << " KB, "
+                  << _modelData.vertices.size() * sizeof(Pinnacle::ModelVertex) / 1024 << " KB unquantized ("
+                  << quantizedPrimitives << " of " << _modelData.primitives.size() << " primitives quantized)" << std::endl;
+    }
+    _pIndexBuffer = [_pDevice newBufferWithBytes:_modelData.indices.data()
+                                          length:_modelData.indices.size() * sizeof(uint32_t)
+                                         options:MTLResourceStorageModeShared];
+    if (!_modelData.meshlets.empty()) {
+        _pMeshletBuffer = [_pDevice newBufferWithBytes:_modelData.meshlets.data()
+                                                length:_modelData.meshlets.size() * sizeof(Pinnacle::MeshletData)
+                                               options:MTLResourceStorageModeShared];
+    }
+    if (!_modelData.vertexColors.empty()) {
+        _pVertexColorBuffer = [_pDevice newBufferWithBytes:_modelData.vertexColors.data()
+                                                    length:_modelData.vertexColors.size() * sizeof(uint32_t)
+                                                   options:MTLResourceStorageModeShared];
+    }
+
+    // Compile every shader variant the model uses now, in parallel, rather
+    // than on the frame that first draws it.
+    _primitiveVariants.resize(_modelData.primitives.size());
+    for (size_t i = 0; i < _modelData.primitives.size(); ++i) {
+        _primitiveVariants[i] = Pinnacle::getShaderVariant(_modelData, _modelData.primitives[i]).getKey();
+        precompilePipeline(describePipeline(_primitiveVariants[i], MTLPixelFormatBGRA8Unorm, 0));
+    }
+    Pinnacle::JobSystem::getShared().wait(_pipelineJobs);
+    _primitivePipelines.resize(_modelData.primitives.size());
+    for (size_t i = 0; i < _modelData.primitives.size(); ++i) {
+        _primitivePipelines[i] = getPipeline(describePipeline(_primitiveVariants[i], MTLPixelFormatBGRA8Unorm, 0));
+    }
+    savePipelineCache();
+
+    // Textures start with nothing resident and stream in once drawn.
+    _textureStreamer.reset(_modelData);
+    _streamedTextures.assign(_modelData.textures.size(), nil);
+    _materialTable.reset(_modelData);
+    _pMaterialBuffer = [_pDevice newBufferWithLength:_materialTable.getRecords().size() * sizeof(Pinnacle::GpuMaterial)
+                                             options:MTLResourceStorageModePrivate];
+    _textureTableDirty = true;
+
+    setupMorphTargets();
+    setupSkinning();
+}
+
+void PinnacleMetalRenderer::setupMorphTargets() {
+    _morphedDraws.clear();
+    _morphedVertexBytes = 0;
+    _nodeMorphedDraws.assign(_modelData.nodes.size(), -1);
+
+    for (uint32_t nodeIndex = 0; nodeIndex < _modelData.nodes.size(); ++nodeIndex) {
+        const Pinnacle::NodeData& node = _modelData.nodes[nodeIndex];
+        if (node.mesh < 0 || node.morphWeightCount == 0) continue;
+
+        const Pinnacle::MeshData& mesh = _modelData.meshes[node.mesh];
+        _nodeMorphedDraws[nodeIndex] = (int32_t)_morphedDraws.size();
+        for (uint32_t i = 0; i < mesh.primitiveCount; ++i) {
+            const uint32_t primitiveIndex = mesh.firstPrimitive + i;
+            const Pinnacle::PrimitiveData& primitive = _modelData.primitives[primitiveIndex];
+            if (primitive.morphTargetCount == 0 || primitive.morphTargetCount > node.morphWeightCount) continue;
+
+            MorphedDraw draw;
+            draw.node = nodeIndex;
+            draw.outputOffset = _morphedVertexBytes;
+            draw.vertices.bind(_modelData, primitiveIndex);
+            draw.bounds = primitive.bounds;
+            _morphedDraws.push_back(std::move(draw));
+            _morphedVertexBytes += primitive.vertexCount * sizeof(Pinnacle::ModelVertex);
+        }
+    }
+    // Filled by the first frame's upload, which covers every vertex
+    if (!_morphedDraws.empty()) {
+        _pMorphedVertexBuffer = [_pDevice newBufferWithLength:_morphedVertexBytes options:MTLResourceStorageModePrivate];
+    }
+}
+
+void PinnacleMetalRenderer::setupSkinning() {
+    _skinnedDraws.clear();
+    _skinnedJointBounds.clear();
+    _skinnedBounds.clear();
+    _skinnedVertexBytes = 0;
+    _nodeSkinnedDraws.assign(_modelData.nodes.size(), -1);
+    _animationPlayer.setAnimation(_modelData, _modelData.animations.empty() ? -1 : 0);
+    _animationClockStarted = false;
+
+    for (uint32_t nodeIndex = 0; nodeIndex < _modelData.nodes.size(); ++nodeIndex) {
+        const Pinnacle::NodeData& node = _modelData.nodes[nodeIndex];
+        if (node.skin < 0 || node.mesh < 0) continue;
+
+        const Pinnacle::SkinData& skin = _modelData.skins[node.skin];
+        const Pinnacle::MeshData& mesh = _modelData.meshes[node.mesh];
+        _nodeSkinnedDraws[nodeIndex] = (int32_t)_skinnedDraws.size();
+        for (uint32_t i = 0; i < mesh.primitiveCount; ++i) {
+            const uint32_t primitiveIndex = mesh.firstPrimitive + i;
+            const Pinnacle::PrimitiveData& primitive = _modelData.primitives[primitiveIndex];
+            if (!primitive.hasSkinWeights) continue;
+
+            SkinnedDraw draw;
+            draw.node = nodeIndex;
+            draw.primitive = primitiveIndex;
+            draw.firstJoint = skin.firstJoint;
+            draw.jointCount = skin.jointCount;
+            draw.firstJointBounds = (uint32_t)_skinnedJointBounds.size();
+            draw.outputOffset = _skinnedVertexBytes;
+            _skinnedDraws.push_back(draw);
+            _skinnedVertexBytes += primitive.vertexCount * sizeof(Pinnacle::ModelVertex);
+
+            _skinnedJointBounds.resize(_skinnedJointBounds.size() + skin.jointCount);
+            Pinnacle::computeJointBounds(_modelData.vertices.data() + primitive.vertexOffset,
+                                         _modelData.skinVertices.data() + primitive.firstSkinVertex, primitive.vertexCount,
+                                         skin.jointCount, &_skinnedJointBounds[draw.firstJointBounds]);
+        }
+    }
+    _skinnedBounds.resize(_skinnedDraws.size());
+    if (!_skinnedDraws.empty()) {
+        _pSkinVertexBuffer = newSharedBuffer(_pDevice, _modelData.skinVertices.data(),
+                                             _modelData.skinVertices.size() * sizeof(Pinnacle::SkinVertex));
+    }
+}
+
+void PinnacleMetalRenderer::updateAnimation() {
+    if (_modelData.animations.empty() && _skinnedDraws.empty() && _morphedDraws.empty()) return;
+
+    // Long stalls (loading, a breakpoint) resume the clip instead of jumping ahead
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const float seconds = _animationClockStarted ? std::chrono::duration<float>(now - _lastAnimationTime).count() : 0.0f;
+    _lastAnimationTime = now;
+    _animationClockStarted = true;
+    _animationPlayer.advance(_modelData, std::min(seconds, 0.1f));
+    _animationPlayer.update(_modelData);
+
+    // Lights, cameras and rigid children follow their animated parents
+    const float* pWorldMatrices = _animationPlayer.getWorldMatrices();
+    for (size_t i = 0; i < _modelData.nodes.size(); ++i) {
+        std::memcpy(_modelData.nodes[i].worldMatrix, pWorldMatrices + i * 16, sizeof(_modelData.nodes[i].worldMatrix));
+    }
+    updateMorphTargets();
+
+    const float* pJointMatrices = _animationPlayer.getJointMatrices();
+    for (size_t i = 0; i < _skinnedDraws.size(); ++i) {
+        const SkinnedDraw& draw = _skinnedDraws[i];
+        _skinnedBounds[i] = Pinnacle::computeSkinnedBounds(&_skinnedJointBounds[draw.firstJointBounds], draw.jointCount,
+                                                           pJointMatrices + draw.firstJoint * 16);
+    }
+}
+
+void PinnacleMetalRenderer::updateMorphTargets() {
+    if (_morphedDraws.empty()) return;
+
+    const float* pWeights = _animationPlayer.getMorphWeights().data();
+    Pinnacle::JobSystem::getShared().parallelFor(_morphedDraws.size(), 1, [&](size_t i) {
+        MorphedDraw& draw = _morphedDraws[i];
+        const uint32_t primitiveIndex = draw.vertices.getPrimitive();
+        const Pinnacle::PrimitiveData& primitive = _modelData.primitives[primitiveIndex];
+        const float* pNodeWeights = pWeights + _modelData.nodes[draw.node].firstMorphWeight;
+        draw.dirty = draw.vertices.update(_modelData, pNodeWeights);
+        draw.bounds = Pinnacle::computeMorphedBounds(_modelData, primitive, pNodeWeights);
+
+        // Skinned bounds start from the morphed vertices
+        const SkinnedDraw* pSkinned = findSkinnedDraw(draw.node, primitiveIndex);
+        if (pSkinned && draw.dirty.vertexCount > 0) {
+            Pinnacle::computeJointBounds(draw.vertices.getVertices(), _modelData.skinVertices.data() + primitive.firstSkinVertex,
+                                         primitive.vertexCount, pSkinned->jointCount,
+                                         &_skinnedJointBounds[pSkinned->firstJointBounds]);
+        }
+    });
+}
+
+const PinnacleMetalRenderer::MorphedDraw* PinnacleMetalRenderer::findMorphedDraw(uint32_t nodeIndex, uint32_t primitiveIndex) const {
+    if (nodeIndex >= _nodeMorphedDraws.size() || _nodeMorphedDraws[nodeIndex] < 0) return nullptr;
+    for (size_t i = (size_t)_nodeMorphedDraws[nodeIndex]; i < _morphedDraws.size() && _morphedDraws[i].node == nodeIndex; ++i) {
+        if (_morphedDraws[i].vertices.getPrimitive() == primitiveIndex) return &_morphedDraws[i];
+    }
+    return nullptr;
+}
+
+void PinnacleMetalRenderer::encodeMorphing(id<MTLCommandBuffer> commandBuffer) {
+    uint64_t dirtyBytes = 0;
+    for (const MorphedDraw& draw : _morphedDraws) {
+        dirtyBytes += draw.dirty.vertexCount * sizeof(Pinnacle::ModelVertex);
+    }
+    if (dirtyBytes == 0) return;
+
+    // Rebuilt ranges go through a staging buffer released once the frame completes
+    id<MTLBuffer> pStaging = [_pDevice newBufferWithLength:dirtyBytes options:MTLResourceStorageModeShared];
+    id<MTLBlitCommandEncoder> pBlitEncoder = [commandBuffer blitCommandEncoder];
+    uint64_t stagingOffset = 0;
+    for (MorphedDraw& draw : _morphedDraws) {
+        if (draw.dirty.vertexCount == 0) continue;
+        const uint64_t bytes = draw.dirty.vertexCount * sizeof(Pinnacle::ModelVertex);
+        std::memcpy((uint8_t*)pStaging.contents + stagingOffset, draw.vertices.getVertices() + draw.dirty.firstVertex, bytes);
+        [pBlitEncoder copyFromBuffer:pStaging
+                        sourceOffset:stagingOffset
+                            toBuffer:_pMorphedVertexBuffer
+                   destinationOffset:draw.outputOffset + draw.dirty.firstVertex * sizeof(Pinnacle::ModelVertex)
+                                size:bytes];
+        stagingOffset += bytes;
+        draw.dirty = Pinnacle::MorphedRange();
+    }
+    [pBlitEncoder endEncoding];
+    [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+        [pStaging release];
+    }];
+}
+
+const PinnacleMetalRenderer::SkinnedDraw* PinnacleMetalRenderer::findSkinnedDraw(uint32_t nodeIndex, uint32_t primitiveIndex) const {
+    if (nodeIndex >= _nodeSkinnedDraws.size() || _nodeSkinnedDraws[nodeIndex] < 0) return nullptr;
+    for (size_t i = (size_t)_nodeSkinnedDraws[nodeIndex]; i < _skinnedDraws.size() && _skinnedDraws[i].node == nodeIndex; ++i) {
+        if (_skinnedDraws[i].primitive == primitiveIndex) return &_skinnedDraws[i];
+    }
+    return nullptr;
+}
+
+void PinnacleMetalRenderer::encodeSkinning(id<MTLCommandBuffer> commandBuffer) {
+    _pSkinnedVertexBuffer = nil;
+    if (_skinnedDraws.empty()) return;
+
+    const float* pJointMatrices = _animationPlayer.getJointMatrices();
+    const bool gpu = _skinningMode == Pinnacle::SkinningMode::Gpu && _pSkinningPipeline;
+    id<MTLBuffer> pSkinned = [_pDevice newBufferWithLength:_skinnedVertexBytes
+                                                   options:gpu ? MTLResourceStorageModePrivate : MTLResourceStorageModeShared];
+    if (gpu) {
+        id<MTLBuffer> pJoints = newSharedBuffer(_pDevice, pJointMatrices, _modelData.joints.size() * 16 * sizeof(float));
+        id<MTLComputeCommandEncoder> pComputeEncoder = [commandBuffer computeCommandEncoder];
+        [pComputeEncoder setComputePipelineState:_pSkinningPipeline];
+        [pComputeEncoder setBuffer:_pSkinVertexBuffer offset:0 atIndex:1];
+        [pComputeEncoder setBuffer:pJoints offset:0 atIndex:2];
+        [pComputeEncoder setBuffer:pSkinned offset:0 atIndex:3];
+        for (const SkinnedDraw& draw : _skinnedDraws) {
+            const Pinnacle::PrimitiveData& primitive = _modelData.primitives[draw.primitive];
+            const MorphedDraw* pMorphed = findMorphedDraw(draw.node, draw.primitive);
+            if (pMorphed) {
+                [pComputeEncoder setBuffer:_pMorphedVertexBuffer offset:pMorphed->outputOffset atIndex:0];
+            } else {
+                [pComputeEncoder setBuffer:_pVertexBuffer offset:_vertexByteOffsets[draw.primitive] atIndex:0];
             }
+            [pComputeEncoder setBufferOffset:primitive.firstSkinVertex * sizeof(Pinnacle::SkinVertex) atIndex:1];
+            [pComputeEncoder setBufferOffset:draw.firstJoint * 16 * sizeof(float) atIndex:2];
+            [pComputeEncoder setBufferOffset:draw.outputOffset atIndex:3];
+            [pComputeEncoder setBytes:&primitive.vertexCount length:sizeof(uint32_t) atIndex:4];
+            [pComputeEncoder dispatchThreadgroups:MTLSizeMake((primitive.vertexCount + 63) / 64, 1, 1)
+                            threadsPerThreadgroup:MTLSizeMake(64, 1, 1)];
+        }
+        [pComputeEncoder endEncoding];
+        [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            [pJoints release];
+        }];
+    } else {
+        uint8_t* pOutput = (uint8_t*)pSkinned.contents;
+        Pinnacle::JobSystem::getShared().parallelFor(_skinnedDraws.size(), 1, [&](size_t i) {
+            const SkinnedDraw& draw = _skinnedDraws[i];
+            const Pinnacle::PrimitiveData& primitive = _modelData.primitives[draw.primitive];
+            const MorphedDraw* pMorphed = findMorphedDraw(draw.node, draw.primitive);
+            const Pinnacle::ModelVertex* pVertices =
+                pMorphed ? pMorphed->vertices.getVertices() : _modelData.vertices.data() + primitive.vertexOffset;
+            Pinnacle::skinVertices(pVertices, _modelData.skinVertices.data() + primitive.firstSkinVertex, primitive.vertexCount,
+                                   pJointMatrices + draw.firstJoint * 16, (Pinnacle::ModelVertex*)(pOutput + draw.outputOffset));
+        });
+    }
+
+    // The frame's draws reference it; it is released once the frame completes
+    _pSkinnedVertexBuffer = pSkinned;
+    [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+        [pSkinned release];
+    }];
+}
+
+void PinnacleMetalRenderer::ensureDepthTexture(NSUInteger width, NSUInteger height) {
+    if (_pDepthTexture && _pDepthTexture.width == width && _pDepthTexture.height == height) return;
 
-            // Indices
-            if (primitive.indices > -1) {
-                const tinygltf::Accessor& indexAccessor = _gltfModel.accessors[primitive.indices];
-                const tinygltf::BufferView& indexBufferView = _gltfModel.bufferViews[indexAccessor.bufferView];
-                const tinygltf::Buffer& indexBuffer = _gltfModel.buffers[indexBufferView.buffer];
-
-                id<MTLBuffer> metalIndexBuffer = [_pDevice newBufferWithBytes:indexBuffer.data.data() + indexBufferView.byteOffset + indexAccessor.byteOffset
-                                                                        length:indexBufferView.byteLength
-                                                                       options:MTLResourceStorageModeShared];
-                _indexBuffers.push_back([metalIndexBuffer retain]); // Retain and add to vector
-                [metalIndexBuffer release]; // Release the temporary ownership
-
-                MTLIndexType indexType;
-                if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT) {
-                    indexType = MTLIndexTypeUInt16;
-                } else if (indexAccessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT) {
-                    indexType = MTLIndexTypeUInt32;
-                } else {
-                    // Default to UInt16 or handle error
-                    indexType = MTLIndexTypeUInt16;
-                }
-                _indexBufferTypes.push_back(indexType);
+    [_pDepthTexture release];
+    MTLTextureDescriptor* pDepthDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatDepth32Float
+                                                                                                 width:width
+                                                                                                height:height
+                                                                                             mipmapped:NO];
+    pDepthDescriptor.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead; // Read by downsampleDepth
+    pDepthDescriptor.storageMode = MTLStorageModePrivate;
+    _pDepthTexture = [_pDevice newTextureWithDescriptor:pDepthDescriptor];
+
+    // Hi-Z grid: at most 256 texels wide, same aspect as the depth buffer
+    _hiZWidth = (uint32_t)std::min<NSUInteger>(width, 256);
+    _hiZHeight = (uint32_t)std::max<NSUInteger>(1, (height * _hiZWidth + width / 2) / width);
+    for (int i = 0; i < kHiZSlotCount; ++i) {
+        [_pHiZReadback[i] release];
+        _pHiZReadback[i] = [_pDevice newBufferWithLength:_hiZWidth * _hiZHeight * sizeof(float) options:MTLResourceStorageModeShared];
+        _hiZSlotFrame[i] = 0;
+    }
+    _hiZFirstValidFrame = _frameIndex;
+}
+
+void PinnacleMetalRenderer::buildOcclusionPyramid(const simd_float4x4& viewProjection) {
+    if (_occlusionMode == Pinnacle::OcclusionMode::CpuOccluders) {
+        _occlusionCuller.buildFromOccluders(_modelData, (const float*)&viewProjection, _occluderTriangleBudget);
+        return;
+    }
+    if (_occlusionMode != Pinnacle::OcclusionMode::GpuPreviousFrame) return;
+
+    // Newest slot whose GPU write has completed and which no later frame has claimed
+    int newest = -1;
+    for (int i = 0; i < kHiZSlotCount; ++i) {
+        const uint64_t writer = _hiZSlotFrame[i];
+        if (writer < _hiZFirstValidFrame || _hiZSlotCompleted[i].load() != writer) continue;
+        if (newest < 0 || writer > _hiZSlotFrame[newest]) newest = i;
+    }
+    if (newest < 0) return;
+
+    _occlusionCuller.buildFromDepth((const float*)[_pHiZReadback[newest] contents], _hiZWidth, _hiZHeight,
+                                    (const float*)&_hiZViewProjection[newest]);
+}
+
+void PinnacleMetalRenderer::encodeHiZCapture(id<MTLCommandBuffer> commandBuffer, const simd_float4x4& viewProjection) {
+    if (!_pDepthDownsamplePipeline || _hiZWidth == 0) return;
+
+    const int slot = (int)(_frameIndex % kHiZSlotCount);
+    _hiZSlotFrame[slot] = _frameIndex;
+    _hiZViewProjection[slot] = viewProjection;
+
+    const uint32_t outputSize[2] = { _hiZWidth, _hiZHeight };
+    id<MTLComputeCommandEncoder> pComputeEncoder = [commandBuffer computeCommandEncoder];
+    [pComputeEncoder setComputePipelineState:_pDepthDownsamplePipeline];
+    [pComputeEncoder setTexture:_pDepthTexture atIndex:0];
+    [pComputeEncoder setBuffer:_pHiZReadback[slot] offset:0 atIndex:0];
+    [pComputeEncoder setBytes:outputSize length:sizeof(outputSize) atIndex:1];
+    [pComputeEncoder dispatchThreadgroups:MTLSizeMake((_hiZWidth + 7) / 8, (_hiZHeight + 7) / 8, 1)
+                    threadsPerThreadgroup:MTLSizeMake(8, 8, 1)];
+    [pComputeEncoder endEncoding];
+
+    std::atomic<uint64_t>* pCompleted = &_hiZSlotCompleted[slot];
+    const uint64_t frame = _frameIndex;
+    [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+        pCompleted->store(frame);
+    }];
+}
+
+void PinnacleMetalRenderer::buildDrawList() {
+    _opaqueDrawList.clear();
+    _transparentDrawList.clear();
+    _nodeMatrices.resize(_modelData.nodes.size());
+    _nodeViewMatrices.resize(_modelData.nodes.size());
+
+    const simd_float4x4 viewMatrix = _camera.getViewMatrix();
+    const simd_float4x4 viewProjection = simd_mul(_camera.getProjectionMatrix(), viewMatrix);
+
+    _occlusionCuller.beginFrame();
+    buildOcclusionPyramid(viewProjection);
+
+    const simd_float3 cameraPosition = _camera.getPosition();
+    const float eye[3] = { cameraPosition.x, cameraPosition.y, cameraPosition.z };
+    uint32_t simplifiedDraws = 0;
+    _frameStats = Pinnacle::FrameStats();
+    _gpuCullJobs.clear();
+    _gpuCulledIndexCount = 0;
+
+    // Candidate lists live for this call only; the frame arena is reset every frame
+    Pinnacle::ArenaVector<Pinnacle::DrawItem> candidates(&_frameArena);
+    Pinnacle::ArenaVector<Pinnacle::Bounds> candidateBounds(&_frameArena);
+    for (uint32_t nodeIndex = 0; nodeIndex < _modelData.nodes.size(); ++nodeIndex) {
+        const Pinnacle::NodeData& node = _modelData.nodes[nodeIndex];
+        if (node.mesh < 0 || node.mesh >= (int32_t)_modelData.meshes.size()) continue;
+
+        _nodeViewMatrices[nodeIndex] = simd_mul(viewMatrix, toSimdMatrix(node.worldMatrix));
+        _nodeMatrices[nodeIndex] = simd_mul(_camera.getProjectionMatrix(), _nodeViewMatrices[nodeIndex]);
+
+        const Pinnacle::MeshData& mesh = _modelData.meshes[node.mesh];
+        for (uint32_t i = 0; i < mesh.primitiveCount; ++i) {
+            const uint32_t primitiveIndex = mesh.firstPrimitive + i;
+            const Pinnacle::PrimitiveData& primitive = _modelData.primitives[primitiveIndex];
+            if (primitive.indexCount == 0) continue;
+
+            Pinnacle::DrawItem candidate;
+            candidate.node = nodeIndex;
+            candidate.primitive = primitiveIndex;
+            candidates.push_back(candidate);
+            const SkinnedDraw* pSkinned = findSkinnedDraw(nodeIndex, primitiveIndex);
+            const MorphedDraw* pMorphed = findMorphedDraw(nodeIndex, primitiveIndex);
+            candidateBounds.push_back(pSkinned ? _skinnedBounds[pSkinned - _skinnedDraws.data()]
+                                               : Pinnacle::transformBounds(node.worldMatrix, pMorphed ? pMorphed->bounds : primitive.bounds));
+        }
+    }
+
+    Pinnacle::ArenaVector<Pinnacle::CullResult> cullResults(candidates.size(), Pinnacle::CullResult::Visible, &_frameArena);
+    _occlusionCuller.cull(candidateBounds.data(), candidateBounds.size(), (const float*)&viewProjection, cullResults.data());
+
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if (cullResults[i] != Pinnacle::CullResult::Visible) continue;
+
+        // Sort on the view-space depth of the bounds centre (view looks down -Z).
+        const Pinnacle::Bounds& bounds = candidateBounds[i];
+        const simd_float4 center = { (bounds.min[0] + bounds.max[0]) * 0.5f,
+                                     (bounds.min[1] + bounds.max[1]) * 0.5f,
+                                     (bounds.min[2] + bounds.max[2]) * 0.5f, 1.0f };
+        const float viewDepth = -simd_mul(viewMatrix, center).z;
+
+        const Pinnacle::PrimitiveData& primitive = _modelData.primitives[candidates[i].primitive];
+        const bool skinned = findSkinnedDraw(candidates[i].node, candidates[i].primitive) != nullptr;
+        const float worldScale = skinned ? 1.0f : Pinnacle::LodSelector::maxAxisScale(_modelData.nodes[candidates[i].node].worldMatrix);
+        const float distance = Pinnacle::LodSelector::distanceToBounds(eye, bounds);
+        _textureStreamer.requestMaterial(primitive.material, worldScale, distance);
+
+        // Candidates are enumerated in a stable order, so i identifies the
+        // instance across frames for LOD hysteresis.
+        uint32_t lod = 0;
+        if (_lodEnabled && primitive.lodCount > 0) {
+            lod = _lodSelector.select(i, primitive, _modelData.lods, worldScale, distance);
+            simplifiedDraws += lod > 0 ? 1 : 0;
+        }
+
+        // Blended surfaces are drawn whole, after everything opaque
+        const uint32_t variantKey = _primitiveVariants[candidates[i].primitive];
+        if (variantKey & Pinnacle::kFeatureAlphaBlend) {
+            _transparentDrawList.add(candidates[i].node, candidates[i].primitive, variantKey, viewDepth, lod);
+            continue;
+        }
+
+        // Meshlet bounds and cones describe the bind pose, not the skinned vertices
+        if (lod == 0 && primitive.meshletCount > 0 && !skinned && _clusterCullingMode != Pinnacle::ClusterCullingMode::Disabled) {
+            addClusterDraw(candidates[i].node, candidates[i].primitive, viewDepth, cameraPosition);
+            continue;
+        }
+
+        _opaqueDrawList.add(candidates[i].node, candidates[i].primitive, variantKey, viewDepth, lod);
+    }
+
+    _opaqueDrawList.sortFrontToBack();
+    _transparentDrawList.sortBackToFront();
+
+    _frameStats.simplifiedDraws = simplifiedDraws;
+    _frameStats.culling = _occlusionCuller.getStats();
+
+    // Casters come from every candidate: off-screen geometry still shadows the view
+    buildShadowDrawLists(candidates.data(), candidateBounds.data(), candidates.size());
+}
+
+void PinnacleMetalRenderer::buildShadowDrawLists(const Pinnacle::DrawItem* pCandidates, const Pinnacle::Bounds* pBounds, size_t count) {
+    for (Pinnacle::DrawList& list : _shadowDrawLists) {
+        list.clear();
+    }
+    float lightDirection[3];
+    _shadowsActive = _shadowsEnabled && _pShadowPipelineState && _pQuantizedShadowPipelineState &&
+                     Pinnacle::findShadowLight(_modelData, lightDirection);
+    if (!_shadowsActive) return;
+
+    const simd_float4x4 viewMatrix = _camera.getViewMatrix();
+    _shadowCascades.update((const float*)&viewMatrix, _camera.getFieldOfView(), _camera.getAspectRatio(),
+                           _camera.getNearPlane(), _camera.getFarPlane(), lightDirection, _modelData.bounds);
+
+    Pinnacle::ArenaVector<uint8_t> cascadeMasks(count, 0, &_frameArena);
+    _shadowCascades.cullCasters(pBounds, count, cascadeMasks.data());
+    for (size_t i = 0; i < count; ++i) {
+        if (cascadeMasks[i] == 0) continue;
+
+        const Pinnacle::PrimitiveData& primitive = _modelData.primitives[pCandidates[i].primitive];
+        const bool skinned = findSkinnedDraw(pCandidates[i].node, pCandidates[i].primitive) != nullptr;
+        const float worldScale = skinned ? 1.0f : Pinnacle::LodSelector::maxAxisScale(_modelData.nodes[pCandidates[i].node].worldMatrix);
+        const uint32_t stateKey = primitive.vertexFormat == Pinnacle::VertexFormat::Quantized ? 1 : 0;
+        for (uint32_t cascade = 0; cascade < _shadowCascades.getCascadeCount(); ++cascade) {
+            if (!(cascadeMasks[i] & (1u << cascade))) continue;
+            // Detail finer than a shadow texel cannot show up in the map
+            const uint32_t lod = _lodEnabled ? _shadowCascades.selectCasterLod(primitive, _modelData.lods, worldScale, cascade) : 0;
+            _shadowDrawLists[cascade].add(pCandidates[i].node, pCandidates[i].primitive, stateKey, 0.0f, lod);
+        }
+    }
+    for (Pinnacle::DrawList& list : _shadowDrawLists) {
+        list.sortFrontToBack(); // Groups the two vertex layouts
+    }
+    _frameStats.shadows = _shadowCascades.getStats();
+}
+
+void PinnacleMetalRenderer::ensureShadowTexture() {
+    const NSUInteger size = _shadowsActive ? _shadowCascades.getResolution() : 1;
+    const NSUInteger slices = _shadowsActive ? _shadowCascades.getCascadeCount() : 1;
+    if (_pShadowTexture && _pShadowTexture.width == size && _pShadowTexture.arrayLength == slices) return;
+
+    [_pShadowTexture release];
+    MTLTextureDescriptor* pShadowDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatDepth32Float
+                                                                                                  width:size
+                                                                                                 height:size
+                                                                                              mipmapped:NO];
+    pShadowDescriptor.textureType = MTLTextureType2DArray;
+    pShadowDescriptor.arrayLength = slices;
+    pShadowDescriptor.usage = MTLTextureUsageRenderTarget | MTLTextureUsageShaderRead;
+    pShadowDescriptor.storageMode = MTLStorageModePrivate;
+    _pShadowTexture = [_pDevice newTextureWithDescriptor:pShadowDescriptor];
+}
+
+void PinnacleMetalRenderer::encodeShadowPasses(id<MTLCommandBuffer> commandBuffer) {
+    ensureShadowTexture();
+    if (!_shadowsActive) return;
+
+    for (uint32_t cascade = 0; cascade < _shadowCascades.getCascadeCount(); ++cascade) {
+        MTLRenderPassDescriptor* pShadowPass = [MTLRenderPassDescriptor renderPassDescriptor];
+        pShadowPass.depthAttachment.texture = _pShadowTexture;
+        pShadowPass.depthAttachment.slice = cascade;
+        pShadowPass.depthAttachment.loadAction = MTLLoadActionClear;
+        pShadowPass.depthAttachment.clearDepth = 1.0;
+        pShadowPass.depthAttachment.storeAction = MTLStoreActionStore;
+
+        id<MTLRenderCommandEncoder> pShadowEncoder = [commandBuffer renderCommandEncoderWithDescriptor:pShadowPass];
+        [pShadowEncoder setDepthStencilState:_pDepthWriteState];
+        // Slope-scaled bias against acne on surfaces grazing the light
+        [pShadowEncoder setDepthBias:1.0f slopeScale:2.0f clamp:0.01f];
+
+        const simd_float4x4 lightViewProjection = toSimdMatrix(_shadowCascades.getCascade(cascade).viewProjection);
+        id<MTLRenderPipelineState> pBoundPipeline = nil;
+        for (const Pinnacle::DrawItem& item : _shadowDrawLists[cascade].getItems()) {
+            const Pinnacle::PrimitiveData& primitive = _modelData.primitives[item.primitive];
+            const bool quantized = primitive.vertexFormat == Pinnacle::VertexFormat::Quantized;
+            id<MTLRenderPipelineState> pPipeline = quantized ? _pQuantizedShadowPipelineState : _pShadowPipelineState;
+            if (pPipeline != pBoundPipeline) {
+                [pShadowEncoder setRenderPipelineState:pPipeline];
+                pBoundPipeline = pPipeline;
+            }
+            uint32_t indexOffset = primitive.indexOffset;
+            uint32_t indexCount = primitive.indexCount;
+            if (item.lod > 0) {
+                const Pinnacle::LodData& lod = _modelData.lods[primitive.firstLod + item.lod - 1];
+                indexOffset = lod.indexOffset;
+                indexCount = lod.indexCount;
             }
+
+            // Skinned vertices are already in world space
+            const SkinnedDraw* pSkinned = findSkinnedDraw(item.node, item.primitive);
+            Uniforms uniforms;
+            uniforms.modelViewProjection = pSkinned ? lightViewProjection
+                                                    : simd_mul(lightViewProjection, toSimdMatrix(_modelData.nodes[item.node].worldMatrix));
+            uniforms.modelView = matrix_identity_float4x4; // Unused without a fragment stage
+            setPositionDequantization(uniforms, primitive);
+            [pShadowEncoder setVertexBytes:&uniforms length:sizeof(uniforms) atIndex:1];
+            const MorphedDraw* pMorphed = pSkinned ? nullptr : findMorphedDraw(item.node, item.primitive);
+            if (pSkinned) {
+                [pShadowEncoder setVertexBuffer:_pSkinnedVertexBuffer offset:pSkinned->outputOffset atIndex:0];
+            } else if (pMorphed) {
+                [pShadowEncoder setVertexBuffer:_pMorphedVertexBuffer offset:pMorphed->outputOffset atIndex:0];
+            } else {
+                [pShadowEncoder setVertexBuffer:_pVertexBuffer offset:_vertexByteOffsets[item.primitive] atIndex:0];
+            }
+
+            _frameStats.shadows.drawCalls++;
+            _frameStats.shadows.triangles += indexCount / 3;
+            [pShadowEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                       indexCount:indexCount
+                                        indexType:MTLIndexTypeUInt32
+                                      indexBuffer:_pIndexBuffer
+                                indexBufferOffset:indexOffset * sizeof(uint32_t)];
         }
+        [pShadowEncoder endEncoding];
     }
 }
 
-void PinnacleMetalRenderer::drawModel(id<MTLRenderCommandEncoder> renderEncoder) {
-    if (_vertexBuffers.empty() || _indexBuffers.empty() || !_pUniformBuffer) return;
+void PinnacleMetalRenderer::addClusterDraw(uint32_t nodeIndex, uint32_t primitiveIndex, float viewDepth, const simd_float3& eye) {
+    const Pinnacle::NodeData& node = _modelData.nodes[nodeIndex];
+    const Pinnacle::PrimitiveData& primitive = _modelData.primitives[primitiveIndex];
+
+    // Meshlet bounds are tested in object space: planes straight from the
+    // MVP, eye through the inverse world matrix.
+    GpuCullJob job;
+    Pinnacle::extractFrustumPlanes((const float*)&_nodeMatrices[nodeIndex], job.planes);
+    const simd_float4 objectEye = simd_mul(simd_inverse(toSimdMatrix(node.worldMatrix)), simd_make_float4(eye, 1.0f));
+    std::memcpy(job.cameraPosition, &objectEye, sizeof(job.cameraPosition));
+
+    // Double-sided materials show their back faces, so only the frustum test applies
+    const bool doubleSided = primitive.material >= 0 && primitive.material < (int32_t)_modelData.materials.size() &&
+                             _modelData.materials[primitive.material].doubleSided;
+
+    if (_clusterCullingMode == Pinnacle::ClusterCullingMode::Gpu && _pMeshletCullPipeline && _pMeshletBuffer) {
+        job.firstMeshlet = primitive.firstMeshlet;
+        job.meshletCount = primitive.meshletCount;
+        job.outputOffset = _gpuCulledIndexCount;
+        job.argumentsIndex = (uint32_t)_gpuCullJobs.size();
+        job.coneCulling = doubleSided ? 0 : 1;
+        _gpuCulledIndexCount += primitive.indexCount;
 
-    [renderEncoder setVertexBuffer:_pUniformBuffer offset:0 atIndex:1]; // Set uniform buffer at index 1
+        _opaqueDrawList.add(nodeIndex, primitiveIndex, _primitiveVariants[primitiveIndex], viewDepth);
+        _opaqueDrawList.setGpuCullSlot((int32_t)job.argumentsIndex);
+        _gpuCullJobs.push_back(job);
+        return;
+    }
+
+    const Pinnacle::MeshletData* pMeshlets = &_modelData.meshlets[primitive.firstMeshlet];
+    Pinnacle::ArenaVector<uint32_t> visibleMeshlets(primitive.meshletCount, &_frameArena);
+    const size_t visibleCount = Pinnacle::cullMeshlets(pMeshlets, primitive.meshletCount, job.planes, job.cameraPosition,
+                                                       !doubleSided, visibleMeshlets.data());
+    _frameStats.meshletsTested += primitive.meshletCount;
+    _frameStats.meshletsCulled += primitive.meshletCount - (uint32_t)visibleCount;
+    if (visibleCount == 0) return;
 
-    for (size_t i = 0; i < _vertexBuffers.size(); ++i) {
-        id<MTLBuffer> vertexBuffer = _vertexBuffers[i];
-        id<MTLBuffer> indexBuffer = _indexBuffers[i];
-        MTLIndexType indexType = _indexBufferTypes[i];
+    _opaqueDrawList.add(nodeIndex, primitiveIndex, _primitiveVariants[primitiveIndex], viewDepth);
+    for (size_t i = 0; i < visibleCount; ++i) {
+        const Pinnacle::MeshletData& meshlet = pMeshlets[visibleMeshlets[i]];
+        _opaqueDrawList.addRange(meshlet.indexOffset, meshlet.triangleCount * 3); // Neighbours merge into one draw
+    }
+}
 
-        [renderEncoder setVertexBuffer:vertexBuffer offset:0 atIndex:0];
-        [renderEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
-                                 indexCount:[indexBuffer length] / (indexType == MTLIndexTypeUInt16 ? 2 : 4)
-                                  indexType:indexType
-                                  indexBuffer:indexBuffer
-                                  indexBufferOffset:0];
+static MTLPixelFormat toMetalPixelFormat(Pinnacle::TextureFormat format) {
+    switch (format) {
+        case Pinnacle::TextureFormat::RGBA8Srgb: return MTLPixelFormatRGBA8Unorm_sRGB;
+        case Pinnacle::TextureFormat::BC7Unorm: return MTLPixelFormatBC7_RGBAUnorm;
+        case Pinnacle::TextureFormat::BC7Srgb: return MTLPixelFormatBC7_RGBAUnorm_sRGB;
+        default: return MTLPixelFormatRGBA8Unorm;
     }
 }
 
+void PinnacleMetalRenderer::updateTextureResidency(id<MTLCommandBuffer> commandBuffer) {
+    _textureStreamer.update(_streamingCommands);
+    std::vector<id<MTLTexture>> replaced;
+    for (const Pinnacle::StreamingCommand& command : _streamingCommands) {
+        replaced.push_back(_streamedTextures[command.texture]);
+        _streamedTextures[command.texture] = newStreamedTexture(command.texture, command.firstMip);
+        _materialTable.setTextureResident(command.texture, _streamedTextures[command.texture] != nil);
+        _textureTableDirty = true;
+    }
+    if (!replaced.empty()) {
+        // The texture table does not retain what it references, so old
+        // textures live until this frame, the last that may sample them, completes.
+        [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+            for (id<MTLTexture> pTexture : replaced) {
+                [pTexture release];
+            }
+        }];
+    }
+    _frameStats.textureStreaming = _textureStreamer.getStats();
+}
+
+void PinnacleMetalRenderer::uploadMaterials(id<MTLCommandBuffer> commandBuffer) {
+    if (!_pMaterialBuffer) return;
+
+    if (_textureTableDirty && _pTextureTableEncoder) {
+        id<MTLBuffer> pTable = [_pDevice newBufferWithLength:_pTextureTableEncoder.encodedLength options:MTLResourceStorageModeShared];
+        [_pTextureTableEncoder setArgumentBuffer:pTable offset:0];
+        [_pTextureTableEncoder setTexture:_pWhiteTexture atIndex:Pinnacle::kTextureSlotWhite];
+        [_pTextureTableEncoder setTexture:_pBlackTexture atIndex:Pinnacle::kTextureSlotBlack];
+        [_pTextureTableEncoder setTexture:_pFlatNormalTexture atIndex:Pinnacle::kTextureSlotFlatNormal];
+        // Slots of textures that are not resident stay empty; no record points at them
+        const uint32_t slotCount = _materialTable.getTextureSlotCount();
+        for (uint32_t slot = Pinnacle::kFirstModelTextureSlot; slot < slotCount; ++slot) {
+            [_pTextureTableEncoder setTexture:_streamedTextures[slot - Pinnacle::kFirstModelTextureSlot] atIndex:slot];
+        }
+
+        // Frames in flight keep reading the table they were encoded with
+        id<MTLBuffer> pPrevious = _pTextureTable;
+        _pTextureTable = pTable;
+        if (pPrevious) {
+            [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+                [pPrevious release];
+            }];
+        }
+        _textureTableDirty = false;
+    }
+
+    // Changed records only, packed into a staging buffer and blitted into
+    // place; the blit is ordered after earlier frames' reads of the buffer.
+    _materialTable.takeDirtyRanges(_materialRanges);
+    if (_materialRanges.empty()) return;
+
+    uint32_t recordCount = 0;
+    for (const Pinnacle::MaterialRange& range : _materialRanges) {
+        recordCount += range.count;
+    }
+    const Pinnacle::GpuMaterial* pRecords = _materialTable.getRecords().data();
+    id<MTLBuffer> pStaging = [_pDevice newBufferWithLength:recordCount * sizeof(Pinnacle::GpuMaterial) options:MTLResourceStorageModeShared];
+    id<MTLBlitCommandEncoder> pBlitEncoder = [commandBuffer blitCommandEncoder];
+    size_t stagingOffset = 0;
+    for (const Pinnacle::MaterialRange& range : _materialRanges) {
+        const size_t bytes = range.count * sizeof(Pinnacle::GpuMaterial);
+        std::memcpy((uint8_t*)pStaging.contents + stagingOffset, pRecords + range.first, bytes);
+        [pBlitEncoder copyFromBuffer:pStaging
+                        sourceOffset:stagingOffset
+                            toBuffer:_pMaterialBuffer
+                   destinationOffset:range.first * sizeof(Pinnacle::GpuMaterial)
+                                size:bytes];
+        stagingOffset += bytes;
+    }
+    [pBlitEncoder endEncoding];
+    [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+        [pStaging release];
+    }];
+    _frameStats.materialUploads = recordCount;
+}
+
+id<MTLTexture> PinnacleMetalRenderer::newStreamedTexture(uint32_t textureIndex, uint32_t firstMip) {
+    const Pinnacle::TextureData& texture = _modelData.textures[textureIndex];
+    if (firstMip >= texture.mipCount) return nil;
+    if (Pinnacle::isBlockCompressed(texture.format) && ![_pDevice supportsBCTextureCompression]) return nil;
+
+    // Rebuilt from the resident levels only; mip n of the new texture is
+    // level firstMip + n of the source, which Metal sizes identically.
+    const Pinnacle::TextureMipData& top = _modelData.textureMips[texture.firstMip + firstMip];
+    MTLTextureDescriptor* pDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:toMetalPixelFormat(texture.format)
+                                                                                           width:top.width
+                                                                                          height:top.height
+                                                                                       mipmapped:NO];
+    pDescriptor.mipmapLevelCount = texture.mipCount - firstMip;
+    pDescriptor.usage = MTLTextureUsageShaderRead;
+    id<MTLTexture> pTexture = [_pDevice newTextureWithDescriptor:pDescriptor];
+
+    for (uint32_t level = firstMip; level < texture.mipCount; ++level) {
+        const Pinnacle::TextureMipData& mip = _modelData.textureMips[texture.firstMip + level];
+        [pTexture replaceRegion:MTLRegionMake2D(0, 0, mip.width, mip.height)
+                    mipmapLevel:level - firstMip
+                      withBytes:_modelData.getTexels(texture) + mip.offset
+                    bytesPerRow:Pinnacle::getRowPitch(texture.format, mip.width)];
+    }
+    return pTexture;
+}
+
+void PinnacleMetalRenderer::encodeMeshletCulling(id<MTLCommandBuffer> commandBuffer) {
+    _pCulledIndexBuffer = nil;
+    _pCullArgumentsBuffer = nil;
+    if (_gpuCullJobs.empty()) return;
+
+    id<MTLBuffer> pIndices = [_pDevice newBufferWithLength:_gpuCulledIndexCount * sizeof(uint32_t)
+                                                   options:MTLResourceStorageModePrivate];
+    id<MTLBuffer> pArguments = [_pDevice newBufferWithLength:_gpuCullJobs.size() * sizeof(MTLDrawIndexedPrimitivesIndirectArguments)
+                                                     options:MTLResourceStorageModeShared];
+    MTLDrawIndexedPrimitivesIndirectArguments* pArgs = (MTLDrawIndexedPrimitivesIndirectArguments*)pArguments.contents;
+    for (size_t i = 0; i < _gpuCullJobs.size(); ++i) {
+        pArgs[i].indexCount = 0; // Accumulated by the kernel
+        pArgs[i].instanceCount = 1;
+        pArgs[i].indexStart = _gpuCullJobs[i].outputOffset;
+        pArgs[i].baseVertex = 0;
+        pArgs[i].baseInstance = 0;
+    }
+
+    id<MTLComputeCommandEncoder> pComputeEncoder = [commandBuffer computeCommandEncoder];
+    [pComputeEncoder setComputePipelineState:_pMeshletCullPipeline];
+    [pComputeEncoder setBuffer:_pMeshletBuffer offset:0 atIndex:0];
+    [pComputeEncoder setBuffer:_pIndexBuffer offset:0 atIndex:1];
+    [pComputeEncoder setBuffer:pIndices offset:0 atIndex:2];
+    [pComputeEncoder setBuffer:pArguments offset:0 atIndex:3];
+    for (const GpuCullJob& job : _gpuCullJobs) {
+        [pComputeEncoder setBytes:&job length:sizeof(job) atIndex:4];
+        [pComputeEncoder dispatchThreadgroups:MTLSizeMake((job.meshletCount + 63) / 64, 1, 1)
+                        threadsPerThreadgroup:MTLSizeMake(64, 1, 1)];
+    }
+    [pComputeEncoder endEncoding];
+
+    // The frame's draws reference these; they are released once it completes
+    _pCulledIndexBuffer = pIndices;
+    _pCullArgumentsBuffer = pArguments;
+    [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+        [pIndices release];
+        [pArguments release];
+    }];
+}
+
+void PinnacleMetalRenderer::buildLightClusters(id<MTLCommandBuffer> commandBuffer, NSUInteger width, NSUInteger height) {
+    const simd_float4x4 viewMatrix = _camera.getViewMatrix();
+    _lightClusterer.setLights(_modelData, (const float*)&viewMatrix);
+
+    Pinnacle::ClusterView view;
+    view.fieldOfView = _camera.getFieldOfView();
+    view.aspectRatio = _camera.getAspectRatio();
+    view.nearPlane = _camera.getNearPlane();
+    view.farPlane = _camera.getFarPlane();
+    view.width = (float)width;
+    view.height = (float)height;
+    _lightClusterer.build(view);
+    _frameStats.lighting = _lightClusterer.getStats();
+
+    const std::vector<Pinnacle::ClusterLight>& lights = _lightClusterer.getLights();
+    const std::vector<Pinnacle::ClusterRange>& clusters = _lightClusterer.getClusters();
+    const std::vector<uint32_t>& indices = _lightClusterer.getLightIndices();
+    id<MTLBuffer> pLights = newSharedBuffer(_pDevice, lights.data(), lights.size() * sizeof(Pinnacle::ClusterLight));
+    id<MTLBuffer> pClusters = newSharedBuffer(_pDevice, clusters.data(), clusters.size() * sizeof(Pinnacle::ClusterRange));
+    id<MTLBuffer> pIndices = newSharedBuffer(_pDevice, indices.data(), indices.size() * sizeof(uint32_t));
+
+    // The frame's fragments read these; they are released once it completes
+    _pLightBuffer = pLights;
+    _pLightClusterBuffer = pClusters;
+    _pLightIndexBuffer = pIndices;
+    [commandBuffer addCompletedHandler:^(id<MTLCommandBuffer> buffer) {
+        [pLights release];
+        [pClusters release];
+        [pIndices release];
+    }];
+}
+
+void PinnacleMetalRenderer::drawModel(id<MTLRenderCommandEncoder> renderEncoder, const Pinnacle::DrawList& drawList, bool depthOnly,
+                                      id<MTLDepthStencilState> pDepthState) {
+    if (!_pVertexBuffer || !_pIndexBuffer) return;
+
+    const simd_float4x4 viewMatrix = _camera.getViewMatrix();
+    const simd_float4x4 viewProjection = simd_mul(_camera.getProjectionMatrix(), viewMatrix);
+    id<MTLRenderPipelineState> pBoundPipeline = nil;
+    id<MTLDepthStencilState> pBoundDepthState = nil;
+    uint32_t boundMaterial = UINT32_MAX;
+    for (const Pinnacle::DrawItem& item : drawList.getItems()) {
+        const Pinnacle::PrimitiveData& primitive = _modelData.primitives[item.primitive];
+        const uint32_t variantKey = _primitiveVariants[item.primitive];
+        const bool quantized = primitive.vertexFormat == Pinnacle::VertexFormat::Quantized;
+        const bool alphaTested = (variantKey & Pinnacle::kFeatureAlphaMask) != 0;
+        id<MTLRenderPipelineState> pPipeline = nil;
+        if (depthOnly) {
+            // Alpha-tested surfaces need their fragment stage for coverage;
+            // the shading pass writes their depth instead.
+            if (alphaTested) continue;
+            pPipeline = quantized ? _pQuantizedDepthOnlyPipelineState : _pDepthOnlyPipelineState;
+        } else {
+            pPipeline = _primitivePipelines[item.primitive];
+            if (!pPipeline) continue;
+            id<MTLDepthStencilState> pItemDepthState = alphaTested ? _pDepthWriteState : pDepthState;
+            if (pItemDepthState != pBoundDepthState) {
+                [renderEncoder setDepthStencilState:pItemDepthState];
+                pBoundDepthState = pItemDepthState;
+            }
+            // Records and textures are bound once per pass; a material is just its index
+            const uint32_t materialIndex = _materialTable.getRecordIndex(primitive.material);
+            if (materialIndex != boundMaterial) {
+                [renderEncoder setFragmentBytes:&materialIndex length:sizeof(materialIndex) atIndex:6];
+                boundMaterial = materialIndex;
+            }
+        }
+        if (pPipeline != pBoundPipeline) {
+            [renderEncoder setRenderPipelineState:pPipeline];
+            pBoundPipeline = pPipeline;
+        }
+        uint32_t indexOffset = primitive.indexOffset;
+        uint32_t indexCount = primitive.indexCount;
+        if (item.lod > 0) {
+            const Pinnacle::LodData& lod = _modelData.lods[primitive.firstLod + item.lod - 1];
+            indexOffset = lod.indexOffset;
+            indexCount = lod.indexCount;
+        }
+
+        // Skinned vertices are already in world space
+        const SkinnedDraw* pSkinned = findSkinnedDraw(item.node, item.primitive);
+        Uniforms uniforms;
+        uniforms.modelViewProjection = pSkinned ? viewProjection : _nodeMatrices[item.node];
+        uniforms.modelView = pSkinned ? viewMatrix : _nodeViewMatrices[item.node];
+        setPositionDequantization(uniforms, primitive);
+
+        [renderEncoder setVertexBytes:&uniforms length:sizeof(uniforms) atIndex:1]; // Set uniforms at index 1
+        const MorphedDraw* pMorphed = pSkinned ? nullptr : findMorphedDraw(item.node, item.primitive);
+        if (pSkinned) {
+            [renderEncoder setVertexBuffer:_pSkinnedVertexBuffer offset:pSkinned->outputOffset atIndex:0];
+        } else if (pMorphed) {
+            [renderEncoder setVertexBuffer:_pMorphedVertexBuffer offset:pMorphed->outputOffset atIndex:0];
+        } else {
+            [renderEncoder setVertexBuffer:_pVertexBuffer offset:_vertexByteOffsets[item.primitive] atIndex:0];
+        }
+        if (!depthOnly && primitive.hasVertexColors) {
+            [renderEncoder setVertexBuffer:_pVertexColorBuffer offset:primitive.firstColor * sizeof(uint32_t) atIndex:2];
+        }
+
+        if (item.gpuCullSlot >= 0) {
+            // Triangle count is an upper bound; the GPU decides how many survive
+            _frameStats.drawCalls++;
+            _frameStats.triangles += indexCount / 3;
+            [renderEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                       indexType:MTLIndexTypeUInt32
+                                     indexBuffer:_pCulledIndexBuffer
+                               indexBufferOffset:0
+                                  indirectBuffer:_pCullArgumentsBuffer
+                            indirectBufferOffset:item.gpuCullSlot * sizeof(MTLDrawIndexedPrimitivesIndirectArguments)];
+            continue;
+        }
+
+        const Pinnacle::DrawRange wholeLevel = { indexOffset, indexCount };
+        const Pinnacle::DrawRange* pRanges = item.rangeCount > 0 ? &drawList.getRanges()[item.firstRange] : &wholeLevel;
+        const uint32_t rangeCount = item.rangeCount > 0 ? item.rangeCount : 1;
+        for (uint32_t r = 0; r < rangeCount; ++r) {
+            _frameStats.drawCalls++;
+            _frameStats.triangles += pRanges[r].indexCount / 3;
+            [renderEncoder drawIndexedPrimitives:MTLPrimitiveTypeTriangle
+                                     indexCount:pRanges[r].indexCount
+                                      indexType:MTLIndexTypeUInt32
+                                    indexBuffer:_pIndexBuffer
+                              indexBufferOffset:pRanges[r].indexOffset * sizeof(uint32_t)];
+        }
+    }
+}
+
+void PinnacleMetalRenderer::encodeFrame(id<MTLCommandBuffer> commandBuffer, id<MTLTexture> colorTexture) {
+    _camera.updateProjectionMatrix((float)colorTexture.width, (float)colorTexture.height);
+    ensureDepthTexture(colorTexture.width, colorTexture.height);
+    _frameArena.reset();
+    Pinnacle::JobSystem::getShared().pumpMainThread();
+    _lodSelector.setViewport((float)colorTexture.height, _camera.getFieldOfView());
+    _textureStreamer.setViewport((float)colorTexture.height, _camera.getFieldOfView());
+    updateAnimation();
+    buildDrawList();
+    updateTextureResidency(commandBuffer);
+    uploadMaterials(commandBuffer);
+    encodeMorphing(commandBuffer);
+    encodeSkinning(commandBuffer);
+    encodeMeshletCulling(commandBuffer);
+    buildLightClusters(commandBuffer, colorTexture.width, colorTexture.height);
+    encodeShadowPasses(commandBuffer);
+
+    MTLRenderPassDescriptor* pRenderPassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
+    pRenderPassDescriptor.colorAttachments[0].texture = colorTexture;
+    pRenderPassDescriptor.colorAttachments[0].loadAction = MTLLoadActionClear;
+    pRenderPassDescriptor.colorAttachments[0].clearColor = MTLClearColorMake(0.2, 0.2, 0.2, 1.0);
+    pRenderPassDescriptor.colorAttachments[0].storeAction = MTLStoreActionStore;
+    pRenderPassDescriptor.depthAttachment.texture = _pDepthTexture;
+    pRenderPassDescriptor.depthAttachment.loadAction = MTLLoadActionClear;
+    pRenderPassDescriptor.depthAttachment.clearDepth = 1.0;
+    const bool captureHiZ = _occlusionMode == Pinnacle::OcclusionMode::GpuPreviousFrame;
+    pRenderPassDescriptor.depthAttachment.storeAction = captureHiZ ? MTLStoreActionStore : MTLStoreActionDontCare;
+
+    id<MTLRenderCommandEncoder> pRenderEncoder = [commandBuffer renderCommandEncoderWithDescriptor:pRenderPassDescriptor];
+    [pRenderEncoder setFrontFacingWinding:MTLWindingCounterClockwise]; // glTF winding, for [[front_facing]]
+
+    const bool prepass = _depthPrepassEnabled && _pDepthOnlyPipelineState;
+    if (prepass) {
+        [pRenderEncoder setDepthStencilState:_pDepthWriteState];
+        drawModel(pRenderEncoder, _opaqueDrawList, true, nil);
+    }
+
+    const Pinnacle::ClusterParams& clusterParams = _lightClusterer.getParams();
+    const uint32_t lightCount = (uint32_t)_lightClusterer.getLights().size();
+    [pRenderEncoder setFragmentBuffer:_pLightBuffer offset:0 atIndex:0];
+    [pRenderEncoder setFragmentBuffer:_pLightClusterBuffer offset:0 atIndex:1];
+    [pRenderEncoder setFragmentBuffer:_pLightIndexBuffer offset:0 atIndex:2];
+    [pRenderEncoder setFragmentBytes:&clusterParams length:sizeof(clusterParams) atIndex:3];
+    [pRenderEncoder setFragmentBytes:&lightCount length:sizeof(lightCount) atIndex:4];
+
+    // Cascades are looked up from view space, where the fragment shader works
+    ShadowParams shadowParams = {};
+    if (_shadowsActive) {
+        const simd_float4x4 viewToWorld = simd_inverse(_camera.getViewMatrix());
+        shadowParams.cascadeCount = _shadowCascades.getCascadeCount();
+        for (uint32_t i = 0; i < shadowParams.cascadeCount; ++i) {
+            const Pinnacle::ShadowCascade& cascade = _shadowCascades.getCascade(i);
+            shadowParams.viewToShadow[i] = simd_mul(toSimdMatrix(cascade.viewProjection), viewToWorld);
+            shadowParams.splitDepths[i] = cascade.splitFar;
+            shadowParams.normalOffsets[i] = cascade.texelSize * 1.5f;
+        }
+    }
+    [pRenderEncoder setFragmentBytes:&shadowParams length:sizeof(shadowParams) atIndex:5];
+    [pRenderEncoder setFragmentTexture:_pShadowTexture atIndex:0];
+    [pRenderEncoder setFragmentBuffer:_pMaterialBuffer offset:0 atIndex:7];
+    [pRenderEncoder setFragmentBuffer:_pTextureTable offset:0 atIndex:8];
+    if (_pTextureTable) {
+        // Textures reached only through the table must be made resident by hand
+        Pinnacle::ArenaVector<id<MTLResource>> tableTextures(&_frameArena);
+        tableTextures.push_back(_pWhiteTexture);
+        tableTextures.push_back(_pBlackTexture);
+        tableTextures.push_back(_pFlatNormalTexture);
+        for (id<MTLTexture> pTexture : _streamedTextures) {
+            if (pTexture) tableTextures.push_back(pTexture);
+        }
+        [pRenderEncoder useResources:tableTextures.data() count:tableTextures.size() usage:MTLResourceUsageRead];
+    }
+    drawModel(pRenderEncoder, _opaqueDrawList, false, prepass ? _pDepthEqualState : _pDepthWriteState); // Draw the loaded glTF model
+    // Blended surfaces last, farthest first, tested against depth but not writing it
+    drawModel(pRenderEncoder, _transparentDrawList, false, _pDepthEqualState);
+
+    [pRenderEncoder endEncoding];
+
+    if (captureHiZ) {
+        encodeHiZCapture(commandBuffer, simd_mul(_camera.getProjectionMatrix(), _camera.getViewMatrix()));
+    }
+    _frameStats.frameMemory = _frameArena.getStats();
+    _frameIndex++;
+}
+
 void PinnacleMetalRenderer::draw(void* metalLayer) {
     // Cast the void* to CAMetalLayer* (Objective-C type)
     CAMetalLayer* pMetalLayer = (__bridge CAMetalLayer*)metalLayer;
-    
+
     if (!_pDevice || !_pCommandQueue || !pMetalLayer || !_pPipelineState) return;
 
     // Create an autorelease pool for the frame (manual management)
     NSAutoreleasePool* pPool = [[NSAutoreleasePool alloc] init];
 
     id<MTLCommandBuffer> pCommandBuffer = [_pCommandQueue commandBuffer];
-    id<MTLDrawable> pDrawable = [pMetalLayer nextDrawable];
+    id<CAMetalDrawable> pDrawable = [pMetalLayer nextDrawable];
 
     if (pDrawable) {
-        MTLRenderPassDescriptor* pRenderPassDescriptor = [MTLRenderPassDescriptor renderPassDescriptor];
-        pRenderPassDescriptor.colorAttachments[0].texture = [pDrawable texture];
-        pRenderPassDescriptor.colorAttachments[0].loadAction = MTLLoadActionClear;
-        pRenderPassDescriptor.colorAttachments[0].clearColor = MTLClearColorMake(0.2, 0.2, 0.2, 1.0);
-        pRenderPassDescriptor.colorAttachments[0].storeAction = MTLStoreActionStore;
+        encodeFrame(pCommandBuffer, [pDrawable texture]);
+        [pCommandBuffer presentDrawable:pDrawable];
+    }
+
+    [pCommandBuffer commit];
+    [pPool release];
+}
 
-        id<MTLRenderCommandEncoder> pRenderEncoder = [pCommandBuffer renderCommandEncoderWithDescriptor:pRenderPassDescriptor];
-        [pRenderEncoder setRenderPipelineState:_pPipelineState];
-        
-        drawModel(pRenderEncoder); // Draw the loaded glTF model
+bool PinnacleMetalRenderer::renderToImage(const char* outputPath, unsigned int width, unsigned int height) {
+    if (!_pDevice || !_pCommandQueue || !_pPipelineState || width == 0 || height == 0) return false;
 
-        [pRenderEncoder endEncoding];
+    NSAutoreleasePool* pPool = [[NSAutoreleasePool alloc] init];
 
-        [pCommandBuffer presentDrawable:pDrawable];
-    }
+    MTLTextureDescriptor* pTextureDescriptor = [MTLTextureDescriptor texture2DDescriptorWithPixelFormat:MTLPixelFormatBGRA8Unorm
+                                                                                                   width:width
+                                                                                                  height:height
+                                                                                               mipmapped:NO];
+    pTextureDescriptor.usage = MTLTextureUsageRenderTarget;
+    pTextureDescriptor.storageMode = MTLStorageModePrivate;
+    id<MTLTexture> pColorTexture = [_pDevice newTextureWithDescriptor:pTextureDescriptor];
+
+    const NSUInteger bytesPerRow = width * 4;
+    id<MTLBuffer> pReadbackBuffer = [_pDevice newBufferWithLength:bytesPerRow * height options:MTLResourceStorageModeShared];
+
+    id<MTLCommandBuffer> pCommandBuffer = [_pCommandQueue commandBuffer];
+    encodeFrame(pCommandBuffer, pColorTexture);
+
+    // Private render targets are not CPU visible; copy into a shared buffer.
+    id<MTLBlitCommandEncoder> pBlitEncoder = [pCommandBuffer blitCommandEncoder];
+    [pBlitEncoder copyFromTexture:pColorTexture
+                      sourceSlice:0
+                      sourceLevel:0
+                     sourceOrigin:MTLOriginMake(0, 0, 0)
+                       sourceSize:MTLSizeMake(width, height, 1)
+                         toBuffer:pReadbackBuffer
+                destinationOffset:0
+           destinationBytesPerRow:bytesPerRow
+         destinationBytesPerImage:bytesPerRow * height];
+    [pBlitEncoder endEncoding];
 
     [pCommandBuffer commit];
+    [pCommandBuffer waitUntilCompleted];
+
+    bool written = false;
+    if (pCommandBuffer.status == MTLCommandBufferStatusCompleted) {
+        // BGRA -> RGBA for stb_image_write
+        unsigned char* pPixels = (unsigned char*)[pReadbackBuffer contents];
+        for (NSUInteger i = 0; i < (NSUInteger)width * height; ++i) {
+            std::swap(pPixels[i * 4 + 0], pPixels[i * 4 + 2]);
+        }
+        written = stbi_write_png(outputPath, (int)width, (int)height, 4, pPixels, (int)bytesPerRow) != 0;
+    }
+
+    [pReadbackBuffer release];
+    [pColorTexture release];
     [pPool release];
+    return written;
 }
 
 // Factory function implementation
 IPinnacleMetalRenderer* createPinnacleMetalRenderer() {
     return new PinnacleMetalRenderer();
-}
\ No newline at end of file
+}
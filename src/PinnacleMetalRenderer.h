@@ -2,18 +2,51 @@
 #define PinnacleMetalRenderer_h
 
 #include "PinnacleMetalRendererInterface.h" // Include the interface
-#include "tiny_gltf.h" // For tinygltf::Model
+#include "Animation/AnimationPlayer.hpp"
+#include "Animation/MorphTargets.hpp"
+#include "Animation/Skinning.hpp"
+#include "Asset/AssetCache.hpp"
+#include "Asset/ModelData.hpp" // CPU-side model produced by the importer
+#include "Core/Camera.hpp"
+#include "Core/JobSystem.hpp"
+#include "Core/Memory.hpp"
+#include "Renderer/DrawList.hpp"
+#include "Renderer/FrameStats.hpp"
+#include "Renderer/LightClusterer.hpp"
+#include "Renderer/LodSelector.hpp"
+#include "Renderer/MaterialTable.hpp"
+#include "Renderer/MeshletCuller.hpp"
+#include "Renderer/OcclusionCuller.hpp"
+#include "Renderer/PipelineCache.hpp"
+#include "Renderer/ShaderVariant.hpp"
+#include "Renderer/ShadowCascades.hpp"
+#include "Renderer/TextureStreamer.hpp"
 
 #include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 // Forward declarations for Objective-C Metal types
+@class NSString;
+@class MTLRenderPipelineDescriptor;
 @protocol MTLDevice;
 @protocol MTLCommandQueue;
 @protocol MTLLibrary;
+@protocol MTLArgumentEncoder;
+@protocol MTLBinaryArchive;
+@protocol MTLFunction;
 @protocol MTLRenderPipelineState;
+@protocol MTLDepthStencilState;
+@protocol MTLComputePipelineState;
 @protocol MTLBuffer;
+@protocol MTLTexture;
+@protocol MTLCommandBuffer;
+@protocol MTLRenderCommandEncoder;
 
 class PinnacleMetalRenderer : public IPinnacleMetalRenderer {
 public:
@@ -22,23 +55,254 @@ public:
 
     void loadModel(const char* filename) override;
     void draw(void* metalLayer) override; // void* representing CAMetalLayer*
+    bool renderToImage(const char* outputPath, unsigned int width, unsigned int height) override;
+
+    // Takes ownership of an already imported model (e.g. from a loader thread)
+    // and uploads it. Must be called on the thread that draws.
+    void setModelData(Pinnacle::ModelData&& modelData);
+
+    // Points the camera at the current model's world-space bounds.
+    void frameModel();
+
+    Pinnacle::Camera& getCamera() { return _camera; }
+    Pinnacle::AssetCache& getAssetCache() { return _assetCache; }
+
+    // Lays down depth for opaque geometry before shading so each pixel runs
+    // the fragment shader roughly once. Off by default.
+    void setDepthPrepassEnabled(bool enabled) { _depthPrepassEnabled = enabled; }
+    bool isDepthPrepassEnabled() const { return _depthPrepassEnabled; }
+
+    // Hierarchical-Z occlusion culling. GpuPreviousFrame reads back a
+    // downsampled copy of an earlier frame's depth buffer (one to two frames
+    // of latency); CpuOccluders rasterizes a budget of occluder triangles on
+    // the CPU every frame.
+    void setOcclusionMode(Pinnacle::OcclusionMode mode) { _occlusionMode = mode; }
+    Pinnacle::OcclusionMode getOcclusionMode() const { return _occlusionMode; }
+    void setOccluderTriangleBudget(uint32_t triangles) { _occluderTriangleBudget = triangles; }
+
+    // Discrete LOD selection for models imported with LOD chains. A level is
+    // used while its simplification error projects to at most this many pixels.
+    void setLodEnabled(bool enabled) { _lodEnabled = enabled; }
+    bool isLodEnabled() const { return _lodEnabled; }
+    void setLodPixelError(float pixels) { _lodSelector.setPixelErrorThreshold(pixels); }
+
+    // Per-meshlet frustum and backface-cone culling for primitives imported
+    // with meshlets, drawn at full detail. Gpu falls back to Cpu when the
+    // culling kernel is unavailable.
+    void setClusterCullingMode(Pinnacle::ClusterCullingMode mode) { _clusterCullingMode = mode; }
+    Pinnacle::ClusterCullingMode getClusterCullingMode() const { return _clusterCullingMode; }
+
+    // Model textures stream in coarse to fine as their on-screen texel
+    // density asks for it, within a GPU memory budget (bytes).
+    void setTextureBudget(uint64_t bytes) { _textureStreamer.setBudget(bytes); }
+    Pinnacle::TextureStreamer& getTextureStreamer() { return _textureStreamer; }
+
+    // Cascaded shadow maps from the model's first directional light. On by
+    // default; models without a directional light render no shadow passes.
+    void setShadowsEnabled(bool enabled) { _shadowsEnabled = enabled; }
+    bool isShadowsEnabled() const { return _shadowsEnabled; }
+    void setShadowCascadeCount(uint32_t count) { _shadowCascades.setCascadeCount(count); }
+    void setShadowMapResolution(uint32_t texels) { _shadowCascades.setResolution(texels); }
+    void setShadowDistance(float distance) { _shadowCascades.setMaxDistance(distance); } // 0 = camera far plane
+
+    // Plays the model's first animation from load, looping. Skinned meshes
+    // deform every frame; Gpu falls back to Cpu when the skinning kernel is
+    // unavailable. Morph targets blend on the CPU by the player's weights.
+    Pinnacle::AnimationPlayer& getAnimationPlayer() { return _animationPlayer; }
+    void setSkinningMode(Pinnacle::SkinningMode mode) { _skinningMode = mode; }
+    Pinnacle::SkinningMode getSkinningMode() const { return _skinningMode; }
+
+    const Pinnacle::FrameStats& getFrameStats() const { return _frameStats; }
 
 private:
     id<MTLDevice> _pDevice;
     id<MTLCommandQueue> _pCommandQueue;
     id<MTLLibrary> _pShaderLibrary;
-    id<MTLRenderPipelineState> _pPipelineState;
-    id<MTLBuffer> _pUniformBuffer; // Add uniform buffer
+    id<MTLRenderPipelineState> _pPipelineState; // Base shading variants, also held by _pipelines
+    id<MTLRenderPipelineState> _pDepthOnlyPipelineState; // No fragment stage, used by the pre-pass
+    id<MTLRenderPipelineState> _pQuantizedPipelineState; // Same stages for Pinnacle::QuantizedVertex input
+    id<MTLRenderPipelineState> _pQuantizedDepthOnlyPipelineState;
+    id<MTLRenderPipelineState> _pShadowPipelineState; // Depth only, no color attachment
+    id<MTLRenderPipelineState> _pQuantizedShadowPipelineState;
+    id<MTLDepthStencilState> _pDepthWriteState; // Less, writes depth
+    id<MTLDepthStencilState> _pDepthEqualState; // LessEqual, read-only after the pre-pass
+    id<MTLTexture> _pDepthTexture;
+
+    // Every pipeline built so far by Pinnacle::hashPipeline; failed compiles
+    // are kept as nil. Pipelines the previous runs used compile on job
+    // threads from launch, their binaries coming from _pPipelineArchive.
+    std::unordered_map<uint64_t, id<MTLRenderPipelineState>> _pipelines;
+    std::unordered_set<uint64_t> _pendingPipelines; // Compiling on a job thread
+    Pinnacle::JobCounter _pipelineJobs;
+    Pinnacle::PipelineCache _pipelineCache;
+    id<MTLBinaryArchive> _pPipelineArchive;
+    std::vector<uint32_t> _primitiveVariants; // Variant key per primitive
+    std::vector<id<MTLRenderPipelineState>> _primitivePipelines; // Shading pipeline per primitive, owned by _pipelines
+
+    // Materials are one GpuMaterial array (private storage, changed records
+    // blitted in) plus an argument buffer holding every material texture,
+    // so a draw only switches the record index.
+    Pinnacle::MaterialTable _materialTable;
+    std::vector<Pinnacle::MaterialRange> _materialRanges;
+    id<MTLBuffer> _pMaterialBuffer;
+    id<MTLArgumentEncoder> _pTextureTableEncoder;
+    id<MTLBuffer> _pTextureTable; // Re-encoded when residency changes; frames in flight keep the old one
+    bool _textureTableDirty;
+    id<MTLTexture> _pWhiteTexture; // Fixed table slots for textures that are absent or not resident
+    id<MTLTexture> _pBlackTexture;
+    id<MTLTexture> _pFlatNormalTexture;
+
+    // Hi-Z readback ring for OcclusionMode::GpuPreviousFrame
+    static const int kHiZSlotCount = 3;
+    id<MTLComputePipelineState> _pDepthDownsamplePipeline;
+    id<MTLBuffer> _pHiZReadback[kHiZSlotCount];
+    simd_float4x4 _hiZViewProjection[kHiZSlotCount];
+    uint64_t _hiZSlotFrame[kHiZSlotCount];                  // Frame that last wrote each slot
+    std::atomic<uint64_t> _hiZSlotCompleted[kHiZSlotCount]; // Set from the command buffer completion handler
+    uint64_t _hiZFirstValidFrame;                           // Older slots predate the last resize
+    uint32_t _hiZWidth;
+    uint32_t _hiZHeight;
+    uint64_t _frameIndex;
+    id<MTLBuffer> _pVertexBuffer;
+    std::vector<uint64_t> _vertexByteOffsets; // Per primitive; formats differ in stride
+    id<MTLBuffer> _pVertexColorBuffer; // ModelData::vertexColors; nil when no primitive has any
+    id<MTLBuffer> _pIndexBuffer;
+    id<MTLBuffer> _pMeshletBuffer;
 
     // For glTF model data
-    tinygltf::Model _gltfModel;
-    std::vector<id<MTLBuffer>> _vertexBuffers;
-    std::vector<id<MTLBuffer>> _indexBuffers;
-    std::vector<MTLIndexType> _indexBufferTypes;
+    Pinnacle::AssetCache _assetCache; // Baked copies of previously imported models
+    Pinnacle::ModelData _modelData;
+    Pinnacle::Camera _camera;
+
+    // Per-frame draw state
+    Pinnacle::DrawList _opaqueDrawList; // Opaque and alpha-tested, grouped by shader variant
+    Pinnacle::DrawList _transparentDrawList; // Alpha-blended, back to front
+    std::vector<simd_float4x4> _nodeMatrices; // Model-view-projection per node
+    std::vector<simd_float4x4> _nodeViewMatrices; // Model-view per node, for view-space lighting
+    bool _depthPrepassEnabled;
+
+    Pinnacle::OcclusionCuller _occlusionCuller;
+    Pinnacle::OcclusionMode _occlusionMode;
+    uint32_t _occluderTriangleBudget;
+    Pinnacle::FrameStats _frameStats;
+    Pinnacle::LinearArena _frameArena; // Transient per-frame lists; reset at the start of each frame
+
+    Pinnacle::LodSelector _lodSelector;
+    bool _lodEnabled;
+
+    // Matches MeshletCullParams in triangle.metal
+    struct GpuCullJob {
+        float planes[6][4]; // Object space
+        float cameraPosition[4]; // Object space
+        uint32_t firstMeshlet;
+        uint32_t meshletCount;
+        uint32_t outputOffset; // In indices
+        uint32_t argumentsIndex;
+        uint32_t coneCulling;
+        uint32_t padding[3];
+    };
+
+    Pinnacle::TextureStreamer _textureStreamer;
+    std::vector<id<MTLTexture>> _streamedTextures; // Per model texture, nil while not resident
+    std::vector<Pinnacle::StreamingCommand> _streamingCommands;
+
+    Pinnacle::ClusterCullingMode _clusterCullingMode;
+    id<MTLComputePipelineState> _pMeshletCullPipeline;
+    std::vector<GpuCullJob> _gpuCullJobs;
+    uint32_t _gpuCulledIndexCount;
+    id<MTLBuffer> _pCulledIndexBuffer; // This frame's compacted indices, released when the frame completes
+    id<MTLBuffer> _pCullArgumentsBuffer;
+
+    // Clustered forward lighting; this frame's buffers are released when it completes
+    Pinnacle::LightClusterer _lightClusterer;
+    id<MTLBuffer> _pLightBuffer;
+    id<MTLBuffer> _pLightClusterBuffer;
+    id<MTLBuffer> _pLightIndexBuffer;
+
+    Pinnacle::ShadowCascades _shadowCascades;
+    Pinnacle::DrawList _shadowDrawLists[Pinnacle::ShadowCascades::kMaxCascades];
+    id<MTLTexture> _pShadowTexture; // One slice per cascade; 1x1 while no shadows are drawn
+    bool _shadowsEnabled;
+    bool _shadowsActive; // This frame has a shadow light and casters were culled
+
+    // Skinned primitives are deformed into world space once per frame, into
+    // a buffer released when the frame completes, and drawn without a world
+    // matrix. One entry per (skinned node, weighted primitive).
+    struct SkinnedDraw {
+        uint32_t node;
+        uint32_t primitive;
+        uint32_t firstJoint; // Into the player's joint matrices
+        uint32_t jointCount;
+        uint32_t firstJointBounds; // Into _skinnedJointBounds
+        uint64_t outputOffset; // Bytes into _pSkinnedVertexBuffer
+    };
+    Pinnacle::AnimationPlayer _animationPlayer;
+    Pinnacle::SkinningMode _skinningMode;
+    std::chrono::steady_clock::time_point _lastAnimationTime;
+    bool _animationClockStarted;
+    std::vector<SkinnedDraw> _skinnedDraws;
+    std::vector<int32_t> _nodeSkinnedDraws; // First entry per node, -1 when not skinned
+    std::vector<Pinnacle::Bounds> _skinnedJointBounds; // Bind-space bounds per joint per entry
+    std::vector<Pinnacle::Bounds> _skinnedBounds; // World bounds per entry, this frame
+    uint64_t _skinnedVertexBytes;
+    id<MTLComputePipelineState> _pSkinningPipeline;
+    id<MTLBuffer> _pSkinVertexBuffer; // ModelData::skinVertices
+    id<MTLBuffer> _pSkinnedVertexBuffer;
+
+    // Primitives with morph targets keep a blended copy of their vertices,
+    // on the CPU and in a persistent GPU buffer; a frame uploads only the
+    // vertex ranges whose weights changed. One entry per (node with morph
+    // weights, primitive with targets). Skinning starts from these vertices.
+    struct MorphedDraw {
+        uint32_t node;
+        uint64_t outputOffset; // Bytes into _pMorphedVertexBuffer
+        Pinnacle::MorphedPrimitive vertices;
+        Pinnacle::MorphedRange dirty; // Rebuilt this frame, not yet uploaded
+        Pinnacle::Bounds bounds; // Local space, this frame
+    };
+    std::vector<MorphedDraw> _morphedDraws;
+    std::vector<int32_t> _nodeMorphedDraws; // First entry per node, -1 when not morphed
+    uint64_t _morphedVertexBytes;
+    id<MTLBuffer> _pMorphedVertexBuffer;
 
     void buildShaders();
-    void setupModelBuffers(); // New method to process glTF data into Metal buffers
-    void drawModel(id<MTLRenderCommandEncoder> renderEncoder);
+    std::vector<Pinnacle::PipelineDescription> openPipelineCache(uint64_t shaderHash);
+    void savePipelineCache();
+    id<MTLFunction> newSpecializedFunction(NSString* name, uint32_t features);
+    MTLRenderPipelineDescriptor* newPipelineDescriptor(const Pinnacle::PipelineDescription& description);
+    id<MTLRenderPipelineState> getPipeline(const Pinnacle::PipelineDescription& description);
+    void precompilePipeline(const Pinnacle::PipelineDescription& description);
+    void addPipeline(const Pinnacle::PipelineDescription& description, id<MTLRenderPipelineState> pPipeline,
+                     MTLRenderPipelineDescriptor* pDescriptor);
+    void setupModelBuffers(); // Uploads _modelData into Metal buffers
+    void releaseModelBuffers();
+    void ensureDepthTexture(NSUInteger width, NSUInteger height);
+    void setupSkinning();
+    void setupMorphTargets();
+    void updateAnimation();
+    void updateMorphTargets();
+    const SkinnedDraw* findSkinnedDraw(uint32_t nodeIndex, uint32_t primitiveIndex) const;
+    const MorphedDraw* findMorphedDraw(uint32_t nodeIndex, uint32_t primitiveIndex) const;
+    void encodeMorphing(id<MTLCommandBuffer> commandBuffer);
+    void encodeSkinning(id<MTLCommandBuffer> commandBuffer);
+    void buildDrawList();
+    void buildOcclusionPyramid(const simd_float4x4& viewProjection);
+    void encodeHiZCapture(id<MTLCommandBuffer> commandBuffer, const simd_float4x4& viewProjection);
+    void addClusterDraw(uint32_t nodeIndex, uint32_t primitiveIndex, float viewDepth, const simd_float3& eye);
+    void encodeMeshletCulling(id<MTLCommandBuffer> commandBuffer);
+    void buildShadowDrawLists(const Pinnacle::DrawItem* pCandidates, const Pinnacle::Bounds* pBounds, size_t count);
+    void ensureShadowTexture();
+    void encodeShadowPasses(id<MTLCommandBuffer> commandBuffer);
+    void buildLightClusters(id<MTLCommandBuffer> commandBuffer, NSUInteger width, NSUInteger height);
+    void updateTextureResidency(id<MTLCommandBuffer> commandBuffer);
+    void uploadMaterials(id<MTLCommandBuffer> commandBuffer);
+    id<MTLTexture> newStreamedTexture(uint32_t textureIndex, uint32_t firstMip);
+    // depthOnly draws with the pre-pass pipelines and leaves depth state to
+    // the caller; otherwise items use pDepthState, except alpha-tested ones,
+    // which always write depth.
+    void drawModel(id<MTLRenderCommandEncoder> renderEncoder, const Pinnacle::DrawList& drawList, bool depthOnly,
+                   id<MTLDepthStencilState> pDepthState);
+    void encodeFrame(id<MTLCommandBuffer> commandBuffer, id<MTLTexture> colorTexture);
 };
 
-#endif /* PinnacleMetalRenderer_h */
\ No newline at end of file
+#endif /* PinnacleMetalRenderer_h */
@@ -9,6 +9,8 @@ public:
     virtual ~IPinnacleMetalRenderer() {}
     virtual void loadModel(const char* filename) = 0;
     virtual void draw(void* metalLayer) = 0; // Change to void* representing CAMetalLayer*
+    // Renders the current model offscreen and writes it as a PNG. Returns false on failure.
+    virtual bool renderToImage(const char* outputPath, unsigned int width, unsigned int height) = 0;
     // Add other pure virtual methods for rendering, etc.
 };
 
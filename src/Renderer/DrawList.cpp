@@ -0,0 +1,60 @@
+#include "DrawList.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Pinnacle
+{
+    uint32_t DrawList::orderedDepthBits(float viewDepth)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &viewDepth, sizeof(bits));
+        // Positive floats: set the sign bit so they sort above negatives.
+        // Negative floats: flip every bit so larger magnitudes sort lower.
+        return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    }
+
+    void DrawList::add(uint32_t node, uint32_t primitive, uint32_t stateKey, float viewDepth, uint32_t lod)
+    {
+        DrawItem item;
+        item.sortKey = (static_cast<uint64_t>(stateKey) << 32) | orderedDepthBits(viewDepth);
+        item.node = node;
+        item.primitive = primitive;
+        item.lod = lod;
+        m_items.push_back(item);
+    }
+
+    void DrawList::addRange(uint32_t indexOffset, uint32_t indexCount)
+    {
+        DrawItem& item = m_items.back();
+        if (item.rangeCount > 0)
+        {
+            DrawRange& last = m_ranges.back();
+            if (last.indexOffset + last.indexCount == indexOffset)
+            {
+                last.indexCount += indexCount;
+                return;
+            }
+        }
+        else
+        {
+            item.firstRange = static_cast<uint32_t>(m_ranges.size());
+        }
+        m_ranges.push_back({ indexOffset, indexCount });
+        item.rangeCount++;
+    }
+
+    void DrawList::sortFrontToBack()
+    {
+        std::sort(m_items.begin(), m_items.end(), [](const DrawItem& a, const DrawItem& b) {
+            return a.sortKey < b.sortKey;
+        });
+    }
+
+    void DrawList::sortBackToFront()
+    {
+        std::sort(m_items.begin(), m_items.end(), [](const DrawItem& a, const DrawItem& b) {
+            return static_cast<uint32_t>(a.sortKey) > static_cast<uint32_t>(b.sortKey);
+        });
+    }
+} // namespace Pinnacle
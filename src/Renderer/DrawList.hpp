@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    struct DrawRange
+    {
+        uint32_t indexOffset = 0; // Into ModelData::indices
+        uint32_t indexCount = 0;
+    };
+
+    struct DrawItem
+    {
+        uint64_t sortKey = 0;
+        uint32_t node = 0;      // Index into ModelData::nodes
+        uint32_t primitive = 0; // Index into ModelData::primitives
+        uint32_t lod = 0;       // 0 = full detail, else ModelData::lods[firstLod + lod - 1]
+        uint32_t firstRange = 0; // Explicit index ranges (surviving meshlets); none = the whole level
+        uint32_t rangeCount = 0;
+        int32_t gpuCullSlot = -1; // Meshlets culled on the GPU and drawn indirect
+    };
+
+    // Per-frame list of draws for one pass. Items are keyed by pipeline state
+    // first and view depth second, so sorting groups state changes and orders
+    // each group front-to-back for early-Z rejection.
+    class DrawList
+    {
+    public:
+        void clear()
+        {
+            m_items.clear();
+            m_ranges.clear();
+        }
+        void reserve(size_t count) { m_items.reserve(count); }
+
+        void add(uint32_t node, uint32_t primitive, uint32_t stateKey, float viewDepth, uint32_t lod = 0);
+        // Appends an index range to the most recently added item; adjacent
+        // ranges are merged.
+        void addRange(uint32_t indexOffset, uint32_t indexCount);
+        void setGpuCullSlot(int32_t slot) { m_items.back().gpuCullSlot = slot; }
+        void sortFrontToBack();
+        // Farthest first regardless of state, the order blending needs.
+        void sortBackToFront();
+
+        const std::vector<DrawItem>& getItems() const { return m_items; }
+        const std::vector<DrawRange>& getRanges() const { return m_ranges; }
+        size_t size() const { return m_items.size(); }
+        bool empty() const { return m_items.empty(); }
+
+        // Maps a float to an unsigned integer with the same ordering.
+        static uint32_t orderedDepthBits(float viewDepth);
+
+    private:
+        std::vector<DrawItem> m_items;
+        std::vector<DrawRange> m_ranges;
+    };
+} // namespace Pinnacle
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "LightClusterer.hpp"
+#include "OcclusionCuller.hpp"
+#include "ShadowCascades.hpp"
+#include "TextureStreamer.hpp"
+#include "../Core/Memory.hpp"
+
+#include <cstdint>
+
+namespace Pinnacle
+{
+    // Counters for the most recently encoded frame.
+    struct FrameStats
+    {
+        uint32_t drawCalls = 0;
+        uint64_t triangles = 0;
+        uint32_t simplifiedDraws = 0; // Draws that used a coarser LOD
+        uint32_t meshletsTested = 0;  // CPU cluster culling only; GPU results stay on the GPU
+        uint32_t meshletsCulled = 0;
+        uint32_t materialUploads = 0; // GpuMaterial records re-uploaded
+        uint32_t pipelineCompiles = 0; // Pipelines compiled on the render thread; model upload warms them
+        OcclusionStats culling;
+        LightClusterStats lighting;
+        ShadowStats shadows; // Shadow-map passes, separate from the counts above
+        TextureStreamingStats textureStreaming;
+        AllocationStats frameMemory; // The renderer's frame arena
+    };
+} // namespace Pinnacle
@@ -0,0 +1,280 @@
+#include "LightClusterer.hpp"
+
+#include "../Core/Parallel.hpp"
+#include "../Core/Simd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double millisecondsSince(Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        // Four lights stored as x[4], y[4], z[4], radius^2[4].
+        const size_t kBlockFloats = 16;
+
+        void appendCandidate(std::vector<float>& blocks, size_t count, const float position[3], float radiusSquared)
+        {
+            const size_t block = count / 4;
+            const size_t lane = count % 4;
+            if (lane == 0)
+            {
+                // Padding lanes have a negative radius^2 and never pass.
+                blocks.resize((block + 1) * kBlockFloats, 0.0f);
+                std::fill(blocks.begin() + block * kBlockFloats + 12, blocks.begin() + (block + 1) * kBlockFloats, -1.0f);
+            }
+            float* pBlock = blocks.data() + block * kBlockFloats;
+            pBlock[lane] = position[0];
+            pBlock[4 + lane] = position[1];
+            pBlock[8 + lane] = position[2];
+            pBlock[12 + lane] = radiusSquared;
+        }
+
+        // Sphere-vs-AABB for the four lights of a block; bit i set if light i touches the box.
+        int testBlock(const float* pBlock, const Simd::Float4 boxMin[3], const Simd::Float4 boxMax[3])
+        {
+            const Simd::Float4 zero = Simd::splat(0.0f);
+            Simd::Float4 distanceSquared = zero;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const Simd::Float4 center = Simd::load(pBlock + axis * 4);
+                const Simd::Float4 outside = Simd::add(Simd::max(Simd::sub(boxMin[axis], center), zero),
+                                                       Simd::max(Simd::sub(center, boxMax[axis]), zero));
+                distanceSquared = Simd::madd(outside, outside, distanceSquared);
+            }
+            return Simd::maskBits(Simd::lessEqual(distanceSquared, Simd::load(pBlock + 12)));
+        }
+
+        void splatBox(const float boxMin[3], const float boxMax[3], Simd::Float4 outMin[3], Simd::Float4 outMax[3])
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                outMin[axis] = Simd::splat(boxMin[axis]);
+                outMax[axis] = Simd::splat(boxMax[axis]);
+            }
+        }
+
+        // View-space y (or x) extent of a band of the screen between two depths.
+        void getFroxelExtent(float ndc0, float ndc1, float depth0, float depth1, float tanHalfAngle, float& outMin,
+                             float& outMax)
+        {
+            const float a = ndc0 * tanHalfAngle;
+            const float b = ndc1 * tanHalfAngle;
+            outMin = std::min(std::min(a * depth0, a * depth1), std::min(b * depth0, b * depth1));
+            outMax = std::max(std::max(a * depth0, a * depth1), std::max(b * depth0, b * depth1));
+        }
+    } // namespace
+
+    LightClusterer::LightClusterer()
+    {
+        setGridSize(m_tilesX, m_tilesY, m_sliceCount);
+    }
+
+    void LightClusterer::setGridSize(uint32_t tilesX, uint32_t tilesY, uint32_t slices)
+    {
+        m_tilesX = std::max(tilesX, 1u);
+        m_tilesY = std::max(tilesY, 1u);
+        m_sliceCount = std::max(slices, 1u);
+        m_slices.resize(m_sliceCount);
+    }
+
+    void LightClusterer::setLights(const ModelData& model, const float viewMatrix[16])
+    {
+        m_lights.clear();
+        m_params.directionalLightCount = 0;
+
+        // Two passes so directional lights come first.
+        for (int pass = 0; pass < 2; ++pass)
+        {
+            for (const LightData& light : model.lights)
+            {
+                if ((light.type == LightType::Directional) != (pass == 0) || light.node < 0 ||
+                    light.node >= static_cast<int32_t>(model.nodes.size()))
+                {
+                    continue;
+                }
+
+                float viewWorld[16];
+                multiplyMatrices(viewMatrix, model.nodes[light.node].worldMatrix, viewWorld);
+
+                ClusterLight out = {};
+                out.type = static_cast<uint32_t>(light.type);
+                std::memcpy(out.position, viewWorld + 12, sizeof(out.position));
+                const float length = std::sqrt(viewWorld[8] * viewWorld[8] + viewWorld[9] * viewWorld[9] + viewWorld[10] * viewWorld[10]);
+                for (int i = 0; i < 3; ++i)
+                {
+                    out.direction[i] = length > 0.0f ? -viewWorld[8 + i] / length : 0.0f;
+                    out.color[i] = light.color[i] * light.intensity;
+                }
+
+                const float brightest = std::max(out.color[0], std::max(out.color[1], out.color[2]));
+                out.range = light.range > 0.0f ? light.range : std::sqrt(std::max(brightest, 0.0f) / kLightCutoff);
+
+                // Point and directional lights: a constant factor of one.
+                out.spotScale = 0.0f;
+                out.spotOffset = 1.0f;
+                if (light.type == LightType::Spot)
+                {
+                    const float cosOuter = std::cos(light.outerConeAngle);
+                    const float cosInner = std::cos(light.innerConeAngle);
+                    out.spotScale = 1.0f / std::max(cosInner - cosOuter, 0.001f);
+                    out.spotOffset = -cosOuter * out.spotScale;
+                }
+
+                m_lights.push_back(out);
+                m_params.directionalLightCount += pass == 0 ? 1 : 0;
+            }
+        }
+    }
+
+    void LightClusterer::build(const ClusterView& view, unsigned int threadCount)
+    {
+        const Clock::time_point start = Clock::now();
+
+        const float nearPlane = std::max(view.nearPlane, 1e-4f);
+        const float logDepthRatio = std::log(std::max(view.farPlane, nearPlane * 1.001f) / nearPlane);
+        m_params.tilesX = m_tilesX;
+        m_params.tilesY = m_tilesY;
+        m_params.slices = m_sliceCount;
+        m_params.tileScaleX = m_tilesX / std::max(view.width, 1.0f);
+        m_params.tileScaleY = m_tilesY / std::max(view.height, 1.0f);
+        m_params.sliceScale = m_sliceCount / logDepthRatio;
+        m_params.sliceBias = -std::log(nearPlane) * m_sliceCount / logDepthRatio;
+
+        const uint32_t tilesPerSlice = m_tilesX * m_tilesY;
+        m_clusters.assign(size_t(tilesPerSlice) * m_sliceCount, ClusterRange{ 0, 0 });
+        parallelFor(m_sliceCount, threadCount, [&](size_t slice) { buildSlice(static_cast<uint32_t>(slice), view); });
+
+        // Slices filled their own index lists; stitch them into one.
+        m_lightIndices.clear();
+        m_stats = LightClusterStats();
+        for (uint32_t slice = 0; slice < m_sliceCount; ++slice)
+        {
+            const Slice& data = m_slices[slice];
+            const uint32_t base = static_cast<uint32_t>(m_lightIndices.size());
+            for (uint32_t i = 0; i < tilesPerSlice; ++i)
+            {
+                m_clusters[size_t(slice) * tilesPerSlice + i].offset += base;
+            }
+            m_lightIndices.insert(m_lightIndices.end(), data.indices.begin(), data.indices.end());
+            m_stats.maxLightsPerCluster = std::max(m_stats.maxLightsPerCluster, data.maxLightsPerCluster);
+        }
+
+        m_stats.lights = static_cast<uint32_t>(m_lights.size());
+        m_stats.localLights = static_cast<uint32_t>(m_lights.size()) - m_params.directionalLightCount;
+        m_stats.lightReferences = static_cast<uint32_t>(m_lightIndices.size());
+        m_stats.buildMilliseconds = millisecondsSince(start);
+    }
+
+    void LightClusterer::buildSlice(uint32_t slice, const ClusterView& view)
+    {
+        Slice& out = m_slices[slice];
+        out.candidates.clear();
+        out.candidateLights.clear();
+        out.indices.clear();
+        out.maxLightsPerCluster = 0;
+
+        const float nearPlane = std::max(view.nearPlane, 1e-4f);
+        const float depthRatio = std::max(view.farPlane, nearPlane * 1.001f) / nearPlane;
+        const float depth0 = nearPlane * std::pow(depthRatio, float(slice) / m_sliceCount);
+        const float depth1 = nearPlane * std::pow(depthRatio, float(slice + 1) / m_sliceCount);
+        const float tanHalfY = std::tan(view.fieldOfView * 0.5f);
+        const float tanHalfX = tanHalfY * view.aspectRatio;
+
+        // Lights touching the slice's box at all.
+        const float sliceMin[3] = { -depth1 * tanHalfX, -depth1 * tanHalfY, -depth1 };
+        const float sliceMax[3] = { depth1 * tanHalfX, depth1 * tanHalfY, -depth0 };
+        for (uint32_t i = m_params.directionalLightCount; i < m_lights.size(); ++i)
+        {
+            const ClusterLight& light = m_lights[i];
+            float distanceSquared = 0.0f;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float outside = std::max(sliceMin[axis] - light.position[axis], 0.0f) +
+                                      std::max(light.position[axis] - sliceMax[axis], 0.0f);
+                distanceSquared += outside * outside;
+            }
+            if (distanceSquared <= light.range * light.range)
+            {
+                appendCandidate(out.candidates, out.candidateLights.size(), light.position, light.range * light.range);
+                out.candidateLights.push_back(i);
+            }
+        }
+
+        const uint32_t tilesPerSlice = m_tilesX * m_tilesY;
+        ClusterRange* pClusters = m_clusters.data() + size_t(slice) * tilesPerSlice;
+        if (out.candidateLights.empty())
+        {
+            return;
+        }
+
+        Simd::Float4 boxMin[3];
+        Simd::Float4 boxMax[3];
+        for (uint32_t tileY = 0; tileY < m_tilesY; ++tileY)
+        {
+            // Rows first, so each tile only tests the lights of its row.
+            const float ndcTop = 1.0f - 2.0f * tileY / m_tilesY;
+            const float ndcBottom = 1.0f - 2.0f * (tileY + 1) / m_tilesY;
+            float rowMin[3] = { sliceMin[0], 0.0f, sliceMin[2] };
+            float rowMax[3] = { sliceMax[0], 0.0f, sliceMax[2] };
+            getFroxelExtent(ndcBottom, ndcTop, depth0, depth1, tanHalfY, rowMin[1], rowMax[1]);
+            splatBox(rowMin, rowMax, boxMin, boxMax);
+
+            out.rowCandidates.clear();
+            out.rowCandidateLights.clear();
+            for (size_t block = 0; block * 4 < out.candidateLights.size(); ++block)
+            {
+                const float* pBlock = out.candidates.data() + block * kBlockFloats;
+                const int hits = testBlock(pBlock, boxMin, boxMax);
+                for (int lane = 0; lane < 4; ++lane)
+                {
+                    if (hits & (1 << lane))
+                    {
+                        const float position[3] = { pBlock[lane], pBlock[4 + lane], pBlock[8 + lane] };
+                        appendCandidate(out.rowCandidates, out.rowCandidateLights.size(), position, pBlock[12 + lane]);
+                        out.rowCandidateLights.push_back(out.candidateLights[block * 4 + lane]);
+                    }
+                }
+            }
+
+            for (uint32_t tileX = 0; tileX < m_tilesX; ++tileX)
+            {
+                ClusterRange& cluster = pClusters[tileY * m_tilesX + tileX];
+                cluster.offset = static_cast<uint32_t>(out.indices.size());
+                if (out.rowCandidateLights.empty())
+                {
+                    continue;
+                }
+
+                float tileMin[3] = { 0.0f, rowMin[1], rowMin[2] };
+                float tileMax[3] = { 0.0f, rowMax[1], rowMax[2] };
+                getFroxelExtent(-1.0f + 2.0f * tileX / m_tilesX, -1.0f + 2.0f * (tileX + 1) / m_tilesX, depth0, depth1,
+                                tanHalfX, tileMin[0], tileMax[0]);
+                splatBox(tileMin, tileMax, boxMin, boxMax);
+
+                for (size_t block = 0; block * 4 < out.rowCandidateLights.size(); ++block)
+                {
+                    const int hits = testBlock(out.rowCandidates.data() + block * kBlockFloats, boxMin, boxMax);
+                    for (int lane = 0; lane < 4; ++lane)
+                    {
+                        if (hits & (1 << lane))
+                        {
+                            out.indices.push_back(out.rowCandidateLights[block * 4 + lane]);
+                        }
+                    }
+                }
+                cluster.count = static_cast<uint32_t>(out.indices.size()) - cluster.offset;
+                out.maxLightsPerCluster = std::max(out.maxLightsPerCluster, cluster.count);
+            }
+        }
+    }
+} // namespace Pinnacle
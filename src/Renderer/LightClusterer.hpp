@@ -0,0 +1,121 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Matches ClusterLight in triangle.metal. Positions and directions are in
+    // view space (right-handed, looking down -Z).
+    struct ClusterLight
+    {
+        float position[3];
+        float range; // Attenuation reaches zero here; point and spot lights are binned as this sphere
+        float color[3]; // Linear, premultiplied by intensity
+        uint32_t type; // LightType
+        float direction[3]; // The way the light shines
+        float spotScale; // Spot falloff is saturate(cos(angle) * spotScale + spotOffset)^2
+        float spotOffset;
+        float padding[3];
+    };
+
+    // Matches ClusterParams in triangle.metal.
+    struct ClusterParams
+    {
+        uint32_t tilesX = 0;
+        uint32_t tilesY = 0;
+        uint32_t slices = 0;
+        uint32_t directionalLightCount = 0; // Lights [0, count) apply everywhere and are not binned
+        float tileScaleX = 0.0f; // Pixel to tile: floor(pixel * scale)
+        float tileScaleY = 0.0f;
+        float sliceScale = 0.0f; // Slice: floor(log(viewDepth) * scale + bias)
+        float sliceBias = 0.0f;
+    };
+
+    // Range of ClusterLightIndices used by one froxel.
+    struct ClusterRange
+    {
+        uint32_t offset;
+        uint32_t count;
+    };
+
+    // The view the grid is built for; matches Camera's projection.
+    struct ClusterView
+    {
+        float fieldOfView = 0.785398f; // Vertical, radians
+        float aspectRatio = 1.0f;
+        float nearPlane = 0.1f;
+        float farPlane = 100.0f;
+        float width = 1.0f; // Viewport, pixels
+        float height = 1.0f;
+    };
+
+    struct LightClusterStats
+    {
+        uint32_t lights = 0;
+        uint32_t localLights = 0; // Point and spot lights; the ones that are binned
+        uint32_t lightReferences = 0; // Total over every froxel
+        uint32_t maxLightsPerCluster = 0;
+        double buildMilliseconds = 0.0;
+    };
+
+    // Clustered light assignment. The view frustum is split into screen tiles
+    // and logarithmic depth slices (froxels); every point and spot light is
+    // tested as a sphere against the view-space bounds of each froxel it may
+    // touch, four lights per step with Simd::Float4. Slices are built in
+    // parallel on the shared job system. The fragment shader then only loops
+    // over the lights listed for its froxel.
+    class LightClusterer
+    {
+    public:
+        LightClusterer();
+
+        // 16 x 9 tiles by 24 slices unless changed.
+        void setGridSize(uint32_t tilesX, uint32_t tilesY, uint32_t slices);
+
+        // Converts the model's lights to ClusterLights in view space,
+        // directional lights first. Lights without a range get one where
+        // their contribution falls below kLightCutoff.
+        void setLights(const ModelData& model, const float viewMatrix[16]);
+
+        // Bins the current lights for `view` on up to `threadCount` threads (0 = hardware concurrency).
+        void build(const ClusterView& view, unsigned int threadCount = 0);
+
+        const std::vector<ClusterLight>& getLights() const { return m_lights; }
+        // One entry per froxel, index (slice * tilesY + tileY) * tilesX + tileX; tile (0, 0) is top-left.
+        const std::vector<ClusterRange>& getClusters() const { return m_clusters; }
+        const std::vector<uint32_t>& getLightIndices() const { return m_lightIndices; }
+        const ClusterParams& getParams() const { return m_params; }
+        const LightClusterStats& getStats() const { return m_stats; }
+
+        // Smallest light contribution worth shading, in output units.
+        static constexpr float kLightCutoff = 1.0f / 256.0f;
+
+    private:
+        // Per-slice working set, kept across frames so building does not allocate.
+        struct Slice
+        {
+            std::vector<float> candidates; // x, y, z, radius^2 in blocks of four lights (SoA)
+            std::vector<uint32_t> candidateLights;
+            std::vector<float> rowCandidates;
+            std::vector<uint32_t> rowCandidateLights;
+            std::vector<uint32_t> indices;
+            uint32_t maxLightsPerCluster = 0;
+        };
+
+        void buildSlice(uint32_t slice, const ClusterView& view);
+
+        uint32_t m_tilesX = 16;
+        uint32_t m_tilesY = 9;
+        uint32_t m_sliceCount = 24;
+        std::vector<ClusterLight> m_lights;
+        std::vector<ClusterRange> m_clusters;
+        std::vector<uint32_t> m_lightIndices;
+        std::vector<Slice> m_slices;
+        ClusterParams m_params;
+        LightClusterStats m_stats;
+    };
+} // namespace Pinnacle
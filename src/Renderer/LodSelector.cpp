@@ -0,0 +1,87 @@
+#include "LodSelector.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // Guards against a camera inside the bounds projecting an infinite error.
+        const float kMinDistance = 1e-4f;
+    } // namespace
+
+    void LodSelector::setViewport(float viewportHeight, float fieldOfView)
+    {
+        const float halfTan = std::tan(fieldOfView * 0.5f);
+        m_projectionScale = halfTan > 0.0f ? viewportHeight / (2.0f * halfTan) : 1.0f;
+    }
+
+    float LodSelector::getScreenError(float objectError, float worldScale, float distance) const
+    {
+        return objectError * worldScale * m_projectionScale / std::max(distance, kMinDistance);
+    }
+
+    uint32_t LodSelector::select(size_t instance, const PrimitiveData& primitive, const std::vector<LodData>& lods,
+                                 float worldScale, float distance)
+    {
+        if (instance >= m_levels.size())
+        {
+            m_levels.resize(instance + 1, 0);
+        }
+        const uint32_t levelCount = primitive.lodCount + 1;
+        auto levelError = [&](uint32_t level) {
+            return level == 0 ? 0.0f : getScreenError(lods[primitive.firstLod + level - 1].error, worldScale, distance);
+        };
+
+        // Coarsest level whose projected error is still under the threshold.
+        uint32_t desired = 0;
+        while (desired + 1 < levelCount && levelError(desired + 1) <= m_pixelErrorThreshold)
+        {
+            ++desired;
+        }
+
+        uint32_t current = std::min<uint32_t>(m_levels[instance], levelCount - 1);
+        if (desired > current)
+        {
+            // Coarsen only once the coarser level is comfortably under the threshold.
+            while (current < desired && levelError(current + 1) <= m_pixelErrorThreshold * (1.0f - m_hysteresis))
+            {
+                ++current;
+            }
+        }
+        else if (desired < current)
+        {
+            // Refine only once the current level is clearly over the threshold.
+            while (current > desired && levelError(current) > m_pixelErrorThreshold * (1.0f + m_hysteresis))
+            {
+                --current;
+            }
+        }
+
+        m_levels[instance] = static_cast<uint8_t>(current);
+        return current;
+    }
+
+    float LodSelector::maxAxisScale(const float matrix[16])
+    {
+        float scale = 0.0f;
+        for (int column = 0; column < 3; ++column)
+        {
+            const float* pAxis = matrix + column * 4;
+            scale = std::max(scale, pAxis[0] * pAxis[0] + pAxis[1] * pAxis[1] + pAxis[2] * pAxis[2]);
+        }
+        return std::sqrt(scale);
+    }
+
+    float LodSelector::distanceToBounds(const float point[3], const Bounds& bounds)
+    {
+        float distance = 0.0f;
+        for (int i = 0; i < 3; ++i)
+        {
+            const float d = std::max(std::max(bounds.min[i] - point[i], point[i] - bounds.max[i]), 0.0f);
+            distance += d * d;
+        }
+        return std::sqrt(distance);
+    }
+} // namespace Pinnacle
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Picks a discrete LOD per draw instance from the projected size of each
+    // level's simplification error. Remembers the previous choice per
+    // instance and only switches once the error crosses the threshold by the
+    // hysteresis margin, so objects near a boundary do not flicker.
+    class LodSelector
+    {
+    public:
+        // Vertical field of view in radians.
+        void setViewport(float viewportHeight, float fieldOfView);
+        void setPixelErrorThreshold(float pixels) { m_pixelErrorThreshold = pixels; }
+        void setHysteresis(float fraction) { m_hysteresis = fraction; }
+
+        // Forgets every previous choice; call when the instance set changes.
+        void reset() { m_levels.clear(); }
+
+        // Returns 0 for full detail or k for primitive LOD firstLod + k - 1.
+        // `worldScale` is the node's largest axis scale, `distance` the view
+        // distance to the primitive's world bounds.
+        uint32_t select(size_t instance, const PrimitiveData& primitive, const std::vector<LodData>& lods,
+                        float worldScale, float distance);
+
+        float getScreenError(float objectError, float worldScale, float distance) const;
+
+        static float maxAxisScale(const float matrix[16]);
+        static float distanceToBounds(const float point[3], const Bounds& bounds);
+
+    private:
+        std::vector<uint8_t> m_levels;
+        float m_projectionScale = 1.0f; // Pixels per unit at distance 1
+        float m_pixelErrorThreshold = 1.0f;
+        float m_hysteresis = 0.25f;
+    };
+} // namespace Pinnacle
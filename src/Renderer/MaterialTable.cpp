@@ -0,0 +1,146 @@
+#include "MaterialTable.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        static_assert(sizeof(GpuMaterial) == 208, "GpuMaterial must match triangle.metal");
+        static_assert(std::is_trivially_copyable<GpuMaterial>::value, "GpuMaterial is uploaded as raw bytes");
+
+        int32_t getTexture(const MaterialData& material, int slot)
+        {
+            const int32_t textures[5] = { material.baseColorTexture, material.metallicRoughnessTexture, material.normalTexture,
+                                          material.occlusionTexture, material.emissiveTexture };
+            return textures[slot];
+        }
+    } // namespace
+
+    void MaterialTable::reset(const ModelData& model)
+    {
+        m_materials = model.materials;
+        m_materials.push_back(MaterialData());
+        m_resident.assign(model.textures.size(), 0);
+        m_textureUsers.assign(model.textures.size(), std::vector<uint32_t>());
+        m_records.assign(m_materials.size(), GpuMaterial());
+        m_dirty.assign(m_materials.size(), 1);
+        for (uint32_t i = 0; i < m_materials.size(); ++i)
+        {
+            linkTextures(i, true);
+            repack(i);
+            m_dirty[i] = 1; // Nothing is on the GPU yet
+        }
+    }
+
+    void MaterialTable::setMaterial(uint32_t index, const MaterialData& material)
+    {
+        if (index + 1 >= m_materials.size())
+        {
+            return;
+        }
+        linkTextures(index, false);
+        m_materials[index] = material;
+        linkTextures(index, true);
+        repack(index);
+    }
+
+    void MaterialTable::setTextureResident(uint32_t texture, bool resident)
+    {
+        if (texture >= m_resident.size() || (m_resident[texture] != 0) == resident)
+        {
+            return;
+        }
+        m_resident[texture] = resident ? 1 : 0;
+        for (uint32_t material : m_textureUsers[texture])
+        {
+            repack(material);
+        }
+    }
+
+    void MaterialTable::takeDirtyRanges(std::vector<MaterialRange>& outRanges)
+    {
+        outRanges.clear();
+        for (uint32_t i = 0; i < m_dirty.size(); ++i)
+        {
+            if (!m_dirty[i])
+            {
+                continue;
+            }
+            m_dirty[i] = 0;
+            if (!outRanges.empty() && outRanges.back().first + outRanges.back().count == i)
+            {
+                outRanges.back().count++;
+            }
+            else
+            {
+                outRanges.push_back({ i, 1 });
+            }
+        }
+    }
+
+    uint32_t MaterialTable::getTextureSlot(int32_t texture, TextureTableSlot fallback) const
+    {
+        const bool resident = texture >= 0 && static_cast<size_t>(texture) < m_resident.size() && m_resident[texture];
+        const uint32_t slot = kFirstModelTextureSlot + static_cast<uint32_t>(texture);
+        return resident && slot < kTextureTableCapacity ? slot : fallback;
+    }
+
+    void MaterialTable::linkTextures(uint32_t index, bool link)
+    {
+        for (int slot = 0; slot < 5; ++slot)
+        {
+            const int32_t texture = getTexture(m_materials[index], slot);
+            if (texture < 0 || static_cast<size_t>(texture) >= m_textureUsers.size())
+            {
+                continue;
+            }
+            std::vector<uint32_t>& users = m_textureUsers[texture];
+            const auto found = std::find(users.begin(), users.end(), index);
+            if (link && found == users.end())
+            {
+                users.push_back(index);
+            }
+            else if (!link && found != users.end())
+            {
+                users.erase(found);
+            }
+        }
+    }
+
+    void MaterialTable::repack(uint32_t index)
+    {
+        const MaterialData& material = m_materials[index];
+        GpuMaterial record = {};
+        std::memcpy(record.baseColorFactor, material.baseColorFactor, sizeof(record.baseColorFactor));
+        for (int c = 0; c < 3; ++c)
+        {
+            record.emissiveFactor[c] = material.emissiveFactor[c] * material.emissiveStrength;
+        }
+        record.alphaCutoff = material.alphaCutoff;
+        record.metallicFactor = material.metallicFactor;
+        record.roughnessFactor = material.roughnessFactor;
+        record.normalScale = material.normalScale;
+        record.occlusionStrength = material.occlusionStrength;
+        record.baseColorTexture = getTextureSlot(material.baseColorTexture, kTextureSlotWhite);
+        record.metallicRoughnessTexture = getTextureSlot(material.metallicRoughnessTexture, kTextureSlotWhite);
+        record.normalTexture = getTextureSlot(material.normalTexture, kTextureSlotFlatNormal);
+        record.occlusionTexture = getTextureSlot(material.occlusionTexture, kTextureSlotWhite);
+        // Black until resident, so emission does not flash in at full strength
+        record.emissiveTexture = getTextureSlot(material.emissiveTexture, kTextureSlotBlack);
+        record.clearcoatFactor = material.clearcoatFactor;
+        record.clearcoatRoughnessFactor = material.clearcoatRoughnessFactor;
+        for (uint32_t slot = 0; slot < kMaterialTextureCount; ++slot)
+        {
+            std::memcpy(record.textureTransforms[slot], material.textureTransforms[slot].matrix, sizeof(record.textureTransforms[slot]));
+        }
+
+        if (std::memcmp(&record, &m_records[index], sizeof(record)) != 0)
+        {
+            m_records[index] = record;
+            m_dirty[index] = 1;
+        }
+    }
+} // namespace Pinnacle
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Matches GpuMaterial in triangle.metal. Texture fields are slots in the
+    // renderer's texture table, never -1. Extension parameters are read only
+    // by the shader variants their MaterialFlag selects.
+    struct GpuMaterial
+    {
+        float baseColorFactor[4];
+        float emissiveFactor[3]; // Times MaterialData::emissiveStrength
+        float alphaCutoff;
+        float metallicFactor;
+        float roughnessFactor;
+        float normalScale;
+        float occlusionStrength;
+        uint32_t baseColorTexture;
+        uint32_t metallicRoughnessTexture;
+        uint32_t normalTexture;
+        uint32_t occlusionTexture;
+        uint32_t emissiveTexture;
+        float clearcoatFactor;
+        float clearcoatRoughnessFactor;
+        uint32_t padding0;
+        float textureTransforms[kMaterialTextureCount][6]; // TextureTransform::matrix per MaterialTexture slot
+        uint32_t padding1[2];
+    };
+
+    // Size of TextureTable in triangle.metal. Model textures beyond it draw
+    // as their fallback.
+    const uint32_t kTextureTableCapacity = 4096;
+
+    // Fixed slots at the start of the texture table, standing in for
+    // textures that are absent or not resident.
+    enum TextureTableSlot : uint32_t
+    {
+        kTextureSlotWhite,
+        kTextureSlotBlack,
+        kTextureSlotFlatNormal,
+        kFirstModelTextureSlot // ModelData texture i sits at kFirstModelTextureSlot + i
+    };
+
+    struct MaterialRange
+    {
+        uint32_t first = 0;
+        uint32_t count = 0;
+    };
+
+    // CPU side of the material buffer: one GpuMaterial per ModelData
+    // material, plus a default record for primitives without one. A record
+    // is repacked when its material or the residency of one of its textures
+    // changes, and handed out for upload only if its bytes differ.
+    class MaterialTable
+    {
+    public:
+        void reset(const ModelData& model);
+        void setMaterial(uint32_t index, const MaterialData& material);
+        void setTextureResident(uint32_t texture, bool resident);
+
+        // Coalesced ranges of records changed since the last call.
+        void takeDirtyRanges(std::vector<MaterialRange>& outRanges);
+
+        const std::vector<GpuMaterial>& getRecords() const { return m_records; }
+        // Record drawn for a primitive's ModelData material index.
+        uint32_t getRecordIndex(int32_t material) const
+        {
+            const uint32_t defaultRecord = static_cast<uint32_t>(m_records.size()) - 1;
+            return material >= 0 && static_cast<uint32_t>(material) < defaultRecord ? static_cast<uint32_t>(material) : defaultRecord;
+        }
+        uint32_t getTextureSlotCount() const
+        {
+            return std::min<uint32_t>(kFirstModelTextureSlot + static_cast<uint32_t>(m_resident.size()), kTextureTableCapacity);
+        }
+
+    private:
+        uint32_t getTextureSlot(int32_t texture, TextureTableSlot fallback) const;
+        void linkTextures(uint32_t index, bool link);
+        void repack(uint32_t index);
+
+        std::vector<MaterialData> m_materials; // The last one is the default material
+        std::vector<GpuMaterial> m_records;
+        std::vector<uint8_t> m_dirty;
+        std::vector<uint8_t> m_resident;
+        std::vector<std::vector<uint32_t>> m_textureUsers; // Materials sampling each texture
+    };
+} // namespace Pinnacle
@@ -0,0 +1,72 @@
+#include "MeshletCuller.hpp"
+
+#include <cmath>
+
+namespace Pinnacle
+{
+    void extractFrustumPlanes(const float m[16], float outPlanes[6][4])
+    {
+        // Rows of the column-major matrix.
+        float row[4][4];
+        for (int r = 0; r < 4; ++r)
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                row[r][c] = m[c * 4 + r];
+            }
+        }
+
+        // Metal clip volume: -w <= x, y <= w and 0 <= z <= w.
+        for (int i = 0; i < 4; ++i)
+        {
+            outPlanes[0][i] = row[3][i] + row[0][i]; // Left
+            outPlanes[1][i] = row[3][i] - row[0][i]; // Right
+            outPlanes[2][i] = row[3][i] + row[1][i]; // Bottom
+            outPlanes[3][i] = row[3][i] - row[1][i]; // Top
+            outPlanes[4][i] = row[2][i];             // Near
+            outPlanes[5][i] = row[3][i] - row[2][i]; // Far
+        }
+
+        for (int p = 0; p < 6; ++p)
+        {
+            const float length = std::sqrt(outPlanes[p][0] * outPlanes[p][0] + outPlanes[p][1] * outPlanes[p][1] +
+                                           outPlanes[p][2] * outPlanes[p][2]);
+            const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            for (int i = 0; i < 4; ++i)
+            {
+                outPlanes[p][i] *= scale;
+            }
+        }
+    }
+
+    size_t cullMeshlets(const MeshletData* pMeshlets, size_t count, const float planes[6][4],
+                        const float cameraPosition[3], bool coneCulling, uint32_t* pVisible)
+    {
+        size_t visibleCount = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const MeshletData& meshlet = pMeshlets[i];
+            const float* c = meshlet.center;
+
+            bool visible = true;
+            for (int p = 0; p < 6 && visible; ++p)
+            {
+                visible = planes[p][0] * c[0] + planes[p][1] * c[1] + planes[p][2] * c[2] + planes[p][3] >= -meshlet.radius;
+            }
+
+            if (visible && coneCulling && meshlet.coneCutoff < 1.0f)
+            {
+                const float d[3] = { c[0] - cameraPosition[0], c[1] - cameraPosition[1], c[2] - cameraPosition[2] };
+                const float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                const float along = d[0] * meshlet.coneAxis[0] + d[1] * meshlet.coneAxis[1] + d[2] * meshlet.coneAxis[2];
+                visible = along < meshlet.coneCutoff * distance + meshlet.radius;
+            }
+
+            if (visible)
+            {
+                pVisible[visibleCount++] = static_cast<uint32_t>(i);
+            }
+        }
+        return visibleCount;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Pinnacle
+{
+    enum class ClusterCullingMode
+    {
+        Disabled,
+        Cpu, // Cull on the CPU and draw the surviving index ranges
+        Gpu  // Compact surviving meshlets into an index buffer on the GPU, draw indirect
+    };
+
+    // Normalized frustum planes (xyz = normal pointing inwards, w = distance)
+    // of a model-view-projection in Metal clip space. Taken from an MVP the
+    // planes are in object space, so meshlet bounds can be tested untransformed.
+    void extractFrustumPlanes(const float modelViewProjection[16], float outPlanes[6][4]);
+
+    // Frustum and backface-cone test of each meshlet's bounds, in object
+    // space. `cameraPosition` is the eye in the same object space. Writes the
+    // indices of the visible meshlets (relative to pMeshlets) and returns how
+    // many there are.
+    size_t cullMeshlets(const MeshletData* pMeshlets, size_t count, const float planes[6][4],
+                        const float cameraPosition[3], bool coneCulling, uint32_t* pVisible);
+} // namespace Pinnacle
@@ -0,0 +1,448 @@
+#include "OcclusionCuller.hpp"
+
+#include "../Core/Memory.hpp"
+#include "../Core/Simd.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double millisecondsSince(Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        void transformPoint(const float m[16], float x, float y, float z, float out[4])
+        {
+            out[0] = m[0] * x + m[4] * y + m[8] * z + m[12];
+            out[1] = m[1] * x + m[5] * y + m[9] * z + m[13];
+            out[2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+            out[3] = m[3] * x + m[7] * y + m[11] * z + m[15];
+        }
+
+        void boundsCorner(const Bounds& bounds, int corner, float out[3])
+        {
+            out[0] = (corner & 1) ? bounds.max[0] : bounds.min[0];
+            out[1] = (corner & 2) ? bounds.max[1] : bounds.min[1];
+            out[2] = (corner & 4) ? bounds.max[2] : bounds.min[2];
+        }
+
+        const float kMinClipW = 1e-5f;
+    } // namespace
+
+    void DepthPyramid::clear()
+    {
+        m_levels.clear();
+        m_data.clear();
+    }
+
+    void DepthPyramid::build(const float* pDepth, uint32_t width, uint32_t height)
+    {
+        clear();
+        if (!pDepth || width == 0 || height == 0)
+        {
+            return;
+        }
+
+        size_t total = 0;
+        for (uint32_t w = width, h = height;; w = (w + 1) / 2, h = (h + 1) / 2)
+        {
+            m_levels.push_back({ w, h, total });
+            total += static_cast<size_t>(w) * h;
+            if (w == 1 && h == 1)
+            {
+                break;
+            }
+        }
+
+        m_data.resize(total);
+        std::memcpy(m_data.data(), pDepth, sizeof(float) * width * height);
+
+        for (size_t level = 1; level < m_levels.size(); ++level)
+        {
+            const Level& source = m_levels[level - 1];
+            const Level& target = m_levels[level];
+            const float* pSource = m_data.data() + source.offset;
+            float* pTarget = m_data.data() + target.offset;
+
+            for (uint32_t y = 0; y < target.height; ++y)
+            {
+                const uint32_t y0 = y * 2;
+                const uint32_t y1 = std::min(y0 + 1, source.height - 1);
+                for (uint32_t x = 0; x < target.width; ++x)
+                {
+                    const uint32_t x0 = x * 2;
+                    const uint32_t x1 = std::min(x0 + 1, source.width - 1);
+                    const float a = std::max(pSource[y0 * source.width + x0], pSource[y0 * source.width + x1]);
+                    const float b = std::max(pSource[y1 * source.width + x0], pSource[y1 * source.width + x1]);
+                    pTarget[y * target.width + x] = std::max(a, b);
+                }
+            }
+        }
+    }
+
+    float DepthPyramid::getMaxDepth(uint32_t level, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) const
+    {
+        const Level& info = m_levels[level];
+        const float* pLevel = m_data.data() + info.offset;
+        x1 = std::min(x1, info.width - 1);
+        y1 = std::min(y1, info.height - 1);
+
+        float result = 0.0f;
+        for (uint32_t y = y0; y <= y1; ++y)
+        {
+            for (uint32_t x = x0; x <= x1; ++x)
+            {
+                result = std::max(result, pLevel[y * info.width + x]);
+            }
+        }
+        return result;
+    }
+
+    void OccluderRasterizer::resize(uint32_t width, uint32_t height)
+    {
+        m_width = (std::max(width, 4u) + 3u) & ~3u;
+        m_height = std::max(height, 1u);
+        m_depth.assign(static_cast<size_t>(m_width) * m_height, 1.0f);
+    }
+
+    void OccluderRasterizer::clear()
+    {
+        std::fill(m_depth.begin(), m_depth.end(), 1.0f);
+    }
+
+    uint32_t OccluderRasterizer::rasterize(const float* pPositions, size_t positionStride, const uint32_t* pIndices,
+                                           size_t indexCount, const float modelViewProjection[16])
+    {
+        if (m_depth.empty())
+        {
+            return 0;
+        }
+
+        const float width = static_cast<float>(m_width);
+        const float height = static_cast<float>(m_height);
+        const unsigned char* pBytes = reinterpret_cast<const unsigned char*>(pPositions);
+        uint32_t drawn = 0;
+
+        for (size_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            float sx[3], sy[3], sz[3];
+            bool behindNear = false;
+            for (int v = 0; v < 3; ++v)
+            {
+                const float* p = reinterpret_cast<const float*>(pBytes + pIndices[i + v] * positionStride);
+                float clip[4];
+                transformPoint(modelViewProjection, p[0], p[1], p[2], clip);
+                if (clip[3] < kMinClipW || clip[2] < 0.0f)
+                {
+                    behindNear = true;
+                    break;
+                }
+                const float inverseW = 1.0f / clip[3];
+                sx[v] = (clip[0] * inverseW * 0.5f + 0.5f) * width;
+                sy[v] = (0.5f - clip[1] * inverseW * 0.5f) * height;
+                sz[v] = std::min(clip[2] * inverseW, 1.0f);
+            }
+            if (behindNear)
+            {
+                continue;
+            }
+
+            // Two-sided: flip winding so the signed area is positive.
+            float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sy[1] - sy[0]) * (sx[2] - sx[0]);
+            if (std::fabs(area) < 1e-8f)
+            {
+                continue;
+            }
+            if (area < 0.0f)
+            {
+                std::swap(sx[1], sx[2]);
+                std::swap(sy[1], sy[2]);
+                std::swap(sz[1], sz[2]);
+                area = -area;
+            }
+
+            const int minX = std::max(0, static_cast<int>(std::floor(std::min({ sx[0], sx[1], sx[2] })))) & ~3;
+            const int maxX = std::min(static_cast<int>(m_width) - 1, static_cast<int>(std::ceil(std::max({ sx[0], sx[1], sx[2] }))));
+            const int minY = std::max(0, static_cast<int>(std::floor(std::min({ sy[0], sy[1], sy[2] }))));
+            const int maxY = std::min(static_cast<int>(m_height) - 1, static_cast<int>(std::ceil(std::max({ sy[0], sy[1], sy[2] }))));
+            if (minX > maxX || minY > maxY)
+            {
+                continue;
+            }
+
+            // Edge functions E_ab(p) = (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x),
+            // non-negative inside once the winding is positive.
+            float edgeDx[3], edgeDy[3], edgeOrigin[3];
+            for (int e = 0; e < 3; ++e)
+            {
+                const int a = e;
+                const int b = (e + 1) % 3;
+                edgeDx[e] = -(sy[b] - sy[a]);
+                edgeDy[e] = sx[b] - sx[a];
+                edgeOrigin[e] = -(sx[b] - sx[a]) * sy[a] + (sy[b] - sy[a]) * sx[a]; // E at (0, 0)
+            }
+
+            // Depth is affine in screen space: z = z0 + w1 * (z1 - z0) + w2 * (z2 - z0),
+            // with w1 = E_20 / area and w2 = E_01 / area.
+            const float inverseArea = 1.0f / area;
+            const float dz1 = (sz[1] - sz[0]) * inverseArea;
+            const float dz2 = (sz[2] - sz[0]) * inverseArea;
+            const float depthDx = dz1 * edgeDx[2] + dz2 * edgeDx[0];
+            const float depthDy = dz1 * edgeDy[2] + dz2 * edgeDy[0];
+            const float depthOrigin = sz[0] + dz1 * edgeOrigin[2] + dz2 * edgeOrigin[0];
+
+            const Simd::Float4 laneOffsets = Simd::make(0.5f, 1.5f, 2.5f, 3.5f);
+            const Simd::Float4 zero = Simd::splat(0.0f);
+            const Simd::Float4 step[3] = { Simd::splat(edgeDx[0] * 4.0f), Simd::splat(edgeDx[1] * 4.0f), Simd::splat(edgeDx[2] * 4.0f) };
+            const Simd::Float4 depthStep = Simd::splat(depthDx * 4.0f);
+
+            for (int y = minY; y <= maxY; ++y)
+            {
+                const float py = static_cast<float>(y) + 0.5f;
+                const Simd::Float4 px = Simd::add(Simd::splat(static_cast<float>(minX)), laneOffsets);
+
+                Simd::Float4 edge[3];
+                for (int e = 0; e < 3; ++e)
+                {
+                    edge[e] = Simd::madd(px, Simd::splat(edgeDx[e]), Simd::splat(edgeOrigin[e] + edgeDy[e] * py));
+                }
+                Simd::Float4 depth = Simd::madd(px, Simd::splat(depthDx), Simd::splat(depthOrigin + depthDy * py));
+
+                float* pRow = m_depth.data() + static_cast<size_t>(y) * m_width;
+                for (int x = minX; x <= maxX; x += 4)
+                {
+                    const Simd::Mask4 inside = Simd::maskAnd(Simd::maskAnd(Simd::greaterEqual(edge[0], zero), Simd::greaterEqual(edge[1], zero)),
+                                                             Simd::greaterEqual(edge[2], zero));
+                    if (Simd::maskBits(inside))
+                    {
+                        const Simd::Float4 current = Simd::load(pRow + x);
+                        const Simd::Mask4 closer = Simd::maskAnd(inside, Simd::lessThan(depth, current));
+                        Simd::store(pRow + x, Simd::select(closer, Simd::max(depth, zero), current));
+                    }
+
+                    edge[0] = Simd::add(edge[0], step[0]);
+                    edge[1] = Simd::add(edge[1], step[1]);
+                    edge[2] = Simd::add(edge[2], step[2]);
+                    depth = Simd::add(depth, depthStep);
+                }
+            }
+            ++drawn;
+        }
+        return drawn;
+    }
+
+    OcclusionCuller::OcclusionCuller()
+    {
+        std::memset(m_pyramidViewProjection, 0, sizeof(m_pyramidViewProjection));
+        m_rasterizer.resize(256, 128);
+    }
+
+    void OcclusionCuller::beginFrame()
+    {
+        m_stats = OcclusionStats();
+        m_pyramid.clear();
+    }
+
+    void OcclusionCuller::buildFromDepth(const float* pDepth, uint32_t width, uint32_t height, const float viewProjection[16])
+    {
+        const Clock::time_point start = Clock::now();
+        m_pyramid.build(pDepth, width, height);
+        std::memcpy(m_pyramidViewProjection, viewProjection, sizeof(m_pyramidViewProjection));
+        m_stats.pyramidMilliseconds += millisecondsSince(start);
+    }
+
+    void OcclusionCuller::buildFromOccluders(const ModelData& model, const float viewProjection[16], uint32_t triangleBudget)
+    {
+        Clock::time_point start = Clock::now();
+
+        struct Candidate
+        {
+            float score;
+            uint32_t node;
+            uint32_t primitive;
+        };
+        ScratchScope scratch;
+        ArenaVector<Candidate> candidates(&scratch.getArena());
+
+        for (uint32_t nodeIndex = 0; nodeIndex < model.nodes.size(); ++nodeIndex)
+        {
+            const NodeData& node = model.nodes[nodeIndex];
+            if (node.mesh < 0 || node.mesh >= static_cast<int32_t>(model.meshes.size()))
+            {
+                continue;
+            }
+            if (node.skin >= 0)
+            {
+                continue; // Skinned vertices move away from the bind pose the occluder would rasterize
+            }
+            const MeshData& mesh = model.meshes[node.mesh];
+            for (uint32_t i = 0; i < mesh.primitiveCount; ++i)
+            {
+                const uint32_t primitiveIndex = mesh.firstPrimitive + i;
+                const PrimitiveData& primitive = model.primitives[primitiveIndex];
+                const uint32_t triangles = primitive.indexCount / 3;
+                // Morph targets likewise move the vertices away from rest
+                if (triangles == 0 || triangles > m_maxOccluderTriangles || primitive.morphTargetCount > 0)
+                {
+                    continue;
+                }
+
+                // Score by projected bounding-sphere size: radius / clip w.
+                const Bounds world = transformBounds(node.worldMatrix, primitive.bounds);
+                const float center[3] = { (world.min[0] + world.max[0]) * 0.5f, (world.min[1] + world.max[1]) * 0.5f,
+                                          (world.min[2] + world.max[2]) * 0.5f };
+                const float extent[3] = { world.max[0] - center[0], world.max[1] - center[1], world.max[2] - center[2] };
+                const float radius = std::sqrt(extent[0] * extent[0] + extent[1] * extent[1] + extent[2] * extent[2]);
+                float clip[4];
+                transformPoint(viewProjection, center[0], center[1], center[2], clip);
+                if (clip[3] <= radius)
+                {
+                    continue; // Camera inside or behind; near-plane clipping makes it useless as an occluder
+                }
+                candidates.push_back({ radius / clip[3], nodeIndex, primitiveIndex });
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+
+        m_rasterizer.clear();
+        uint32_t remaining = triangleBudget;
+        for (const Candidate& candidate : candidates)
+        {
+            const PrimitiveData& primitive = model.primitives[candidate.primitive];
+            const uint32_t triangles = primitive.indexCount / 3;
+            if (triangles > remaining)
+            {
+                continue;
+            }
+
+            float modelViewProjection[16];
+            multiplyMatrices(viewProjection, model.nodes[candidate.node].worldMatrix, modelViewProjection);
+            m_stats.occluderTriangles += m_rasterizer.rasterize(model.vertices[primitive.vertexOffset].position, sizeof(ModelVertex),
+                                                                model.indices.data() + primitive.indexOffset, primitive.indexCount,
+                                                                modelViewProjection);
+            remaining -= triangles;
+        }
+        m_stats.rasterizeMilliseconds += millisecondsSince(start);
+
+        start = Clock::now();
+        m_pyramid.build(m_rasterizer.getDepth(), m_rasterizer.getWidth(), m_rasterizer.getHeight());
+        std::memcpy(m_pyramidViewProjection, viewProjection, sizeof(m_pyramidViewProjection));
+        m_stats.pyramidMilliseconds += millisecondsSince(start);
+    }
+
+    size_t OcclusionCuller::cull(const Bounds* pWorldBounds, size_t count, const float viewProjection[16], CullResult* pResults)
+    {
+        const Clock::time_point start = Clock::now();
+        size_t visible = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const CullResult result = cullOne(pWorldBounds[i], viewProjection);
+            pResults[i] = result;
+            switch (result)
+            {
+                case CullResult::Visible:
+                    ++visible;
+                    break;
+                case CullResult::FrustumCulled:
+                    ++m_stats.frustumCulled;
+                    break;
+                case CullResult::Occluded:
+                    ++m_stats.occlusionCulled;
+                    break;
+            }
+        }
+        m_stats.tested += static_cast<uint32_t>(count);
+        m_stats.testMilliseconds += millisecondsSince(start);
+        return visible;
+    }
+
+    CullResult OcclusionCuller::cullOne(const Bounds& worldBounds, const float viewProjection[16]) const
+    {
+        if (!worldBounds.isValid())
+        {
+            return CullResult::Visible;
+        }
+
+        // Outside if all eight corners are beyond the same clip plane.
+        unsigned outsideAll = 0x3f;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            float p[3], clip[4];
+            boundsCorner(worldBounds, corner, p);
+            transformPoint(viewProjection, p[0], p[1], p[2], clip);
+            unsigned outside = 0;
+            outside |= (clip[0] < -clip[3]) ? 0x01u : 0u;
+            outside |= (clip[0] > clip[3]) ? 0x02u : 0u;
+            outside |= (clip[1] < -clip[3]) ? 0x04u : 0u;
+            outside |= (clip[1] > clip[3]) ? 0x08u : 0u;
+            outside |= (clip[2] < 0.0f) ? 0x10u : 0u;
+            outside |= (clip[2] > clip[3]) ? 0x20u : 0u;
+            outsideAll &= outside;
+        }
+        if (outsideAll)
+        {
+            return CullResult::FrustumCulled;
+        }
+
+        return (!m_pyramid.empty() && isOccluded(worldBounds)) ? CullResult::Occluded : CullResult::Visible;
+    }
+
+    bool OcclusionCuller::isOccluded(const Bounds& worldBounds) const
+    {
+        float minX = 1.0f, minY = 1.0f, maxX = -1.0f, maxY = -1.0f;
+        float minDepth = 1.0f;
+        for (int corner = 0; corner < 8; ++corner)
+        {
+            float p[3], clip[4];
+            boundsCorner(worldBounds, corner, p);
+            transformPoint(m_pyramidViewProjection, p[0], p[1], p[2], clip);
+            if (clip[3] < kMinClipW)
+            {
+                return false; // Crosses the camera plane; too close to cull safely
+            }
+            const float inverseW = 1.0f / clip[3];
+            const float x = clip[0] * inverseW;
+            const float y = clip[1] * inverseW;
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            minDepth = std::min(minDepth, clip[2] * inverseW);
+        }
+        if (minDepth <= 0.0f)
+        {
+            return false;
+        }
+
+        const float width = static_cast<float>(m_pyramid.getWidth());
+        const float height = static_cast<float>(m_pyramid.getHeight());
+        const float left = std::max((minX * 0.5f + 0.5f) * width, 0.0f);
+        const float right = std::min((maxX * 0.5f + 0.5f) * width, width - 1.0f);
+        const float top = std::max((0.5f - maxY * 0.5f) * height, 0.0f);
+        const float bottom = std::min((0.5f - minY * 0.5f) * height, height - 1.0f);
+        if (left > right || top > bottom)
+        {
+            return false; // Off the pyramid; the frustum test owns this case
+        }
+
+        // Pick the level at which the rectangle spans at most 2x2 texels.
+        const float extent = std::max(std::max(right - left, bottom - top), 1.0f);
+        uint32_t level = static_cast<uint32_t>(std::ceil(std::log2(extent)));
+        level = std::min(level, m_pyramid.getLevelCount() - 1);
+
+        const uint32_t x0 = static_cast<uint32_t>(left) >> level;
+        const uint32_t x1 = static_cast<uint32_t>(right) >> level;
+        const uint32_t y0 = static_cast<uint32_t>(top) >> level;
+        const uint32_t y1 = static_cast<uint32_t>(bottom) >> level;
+        return minDepth > m_pyramid.getMaxDepth(level, x0, y0, x1, y1);
+    }
+} // namespace Pinnacle
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    // Depth convention throughout: Metal NDC, 0 = near plane, 1 = far plane,
+    // texel (0, 0) at the top-left of the screen.
+
+    // Max-reduced depth mip chain. Level sizes are ceil(previous / 2), so texel
+    // (x, y) of level L always covers level-0 pixels [x << L, ((x + 1) << L) - 1].
+    class DepthPyramid
+    {
+    public:
+        void build(const float* pDepth, uint32_t width, uint32_t height);
+        void clear();
+
+        bool empty() const { return m_levels.empty(); }
+        uint32_t getLevelCount() const { return static_cast<uint32_t>(m_levels.size()); }
+        uint32_t getWidth(uint32_t level = 0) const { return m_levels[level].width; }
+        uint32_t getHeight(uint32_t level = 0) const { return m_levels[level].height; }
+        const float* getLevel(uint32_t level) const { return m_data.data() + m_levels[level].offset; }
+
+        // Farthest depth over an inclusive texel rectangle of one level.
+        float getMaxDepth(uint32_t level, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) const;
+
+    private:
+        struct Level
+        {
+            uint32_t width;
+            uint32_t height;
+            size_t offset;
+        };
+
+        std::vector<Level> m_levels;
+        std::vector<float> m_data;
+    };
+
+    // Small software depth rasterizer for occluder geometry. Evaluates four
+    // pixels per step with Simd::Float4; triangles are rasterized two-sided
+    // and any triangle crossing the near plane is skipped (it simply does not
+    // occlude).
+    class OccluderRasterizer
+    {
+    public:
+        void resize(uint32_t width, uint32_t height); // Width is rounded up to a multiple of 4
+        void clear();
+
+        // Rasterizes an indexed triangle list. Positions are three floats at
+        // `positionStride` bytes apart. Returns the number of triangles drawn.
+        uint32_t rasterize(const float* pPositions, size_t positionStride, const uint32_t* pIndices, size_t indexCount,
+                           const float modelViewProjection[16]);
+
+        const float* getDepth() const { return m_depth.data(); }
+        uint32_t getWidth() const { return m_width; }
+        uint32_t getHeight() const { return m_height; }
+
+    private:
+        std::vector<float> m_depth;
+        uint32_t m_width = 0;
+        uint32_t m_height = 0;
+    };
+
+    enum class OcclusionMode
+    {
+        Disabled,
+        GpuPreviousFrame, // Pyramid built from last frame's depth buffer (read back from the GPU)
+        CpuOccluders      // Pyramid built from a CPU-rasterized set of large, cheap occluders
+    };
+
+    enum class CullResult
+    {
+        Visible,
+        FrustumCulled,
+        Occluded
+    };
+
+    struct OcclusionStats
+    {
+        uint32_t tested = 0;
+        uint32_t frustumCulled = 0;
+        uint32_t occlusionCulled = 0;
+        uint32_t occluderTriangles = 0;
+        double rasterizeMilliseconds = 0.0;
+        double pyramidMilliseconds = 0.0;
+        double testMilliseconds = 0.0;
+    };
+
+    class OcclusionCuller
+    {
+    public:
+        OcclusionCuller();
+
+        void beginFrame();
+
+        // GPU path: a (downsampled) depth buffer and the view-projection it
+        // was rendered with.
+        void buildFromDepth(const float* pDepth, uint32_t width, uint32_t height, const float viewProjection[16]);
+
+        // CPU path: picks the primitives with the largest projected size whose
+        // triangle count fits the budget and rasterizes them as occluders.
+        void buildFromOccluders(const ModelData& model, const float viewProjection[16], uint32_t triangleBudget);
+
+        // Frustum test against the current view-projection, then an occlusion
+        // test against the pyramid (if one was built this frame). Returns the
+        // number of visible entries.
+        size_t cull(const Bounds* pWorldBounds, size_t count, const float viewProjection[16], CullResult* pResults);
+
+        void setRasterizerSize(uint32_t width, uint32_t height) { m_rasterizer.resize(width, height); }
+        void setMaxOccluderTriangles(uint32_t maxTriangles) { m_maxOccluderTriangles = maxTriangles; }
+
+        bool hasPyramid() const { return !m_pyramid.empty(); }
+        const DepthPyramid& getPyramid() const { return m_pyramid; }
+        const OcclusionStats& getStats() const { return m_stats; }
+
+    private:
+        CullResult cullOne(const Bounds& worldBounds, const float viewProjection[16]) const;
+        bool isOccluded(const Bounds& worldBounds) const;
+
+        DepthPyramid m_pyramid;
+        OccluderRasterizer m_rasterizer;
+        float m_pyramidViewProjection[16];
+        uint32_t m_maxOccluderTriangles = 4096; // Per occluder primitive
+        OcclusionStats m_stats;
+    };
+} // namespace Pinnacle
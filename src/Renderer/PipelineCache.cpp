@@ -0,0 +1,161 @@
+#include "PipelineCache.hpp"
+
+#include "../Asset/AssetCache.hpp"
+#include "../Asset/ImportCache.hpp"
+#include "../Core/Hash.hpp"
+#include "../Core/MappedFile.hpp"
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // Bump when PipelineDescription or the file layout changes.
+        const uint32_t kManifestVersion = 1;
+        const uint32_t kManifestMagic = 0x45504950; // "PIPE"
+
+        void addAttribute(VertexLayout& layout, VertexAttributeFormat format, uint32_t offset, uint32_t buffer)
+        {
+            VertexAttributeLayout& attribute = layout.attributes[layout.attributeCount];
+            attribute.location = layout.attributeCount;
+            attribute.format = format;
+            attribute.offset = offset;
+            attribute.buffer = buffer;
+            layout.attributeCount++;
+        }
+    } // namespace
+
+    VertexLayout getVertexLayout(const ShaderVariant& variant)
+    {
+        VertexLayout layout;
+        if (variant.vertexFormat == VertexFormat::Quantized)
+        {
+            addAttribute(layout, VertexAttributeFormat::UShort4Normalized, offsetof(QuantizedVertex, position), 0);
+            addAttribute(layout, VertexAttributeFormat::Short2Normalized, offsetof(QuantizedVertex, normal), 0);
+            addAttribute(layout, VertexAttributeFormat::Half2, offsetof(QuantizedVertex, texCoords), 0);
+            layout.strides[0] = sizeof(QuantizedVertex);
+        }
+        else
+        {
+            addAttribute(layout, VertexAttributeFormat::Float3, offsetof(ModelVertex, position), 0);
+            addAttribute(layout, VertexAttributeFormat::Float3, offsetof(ModelVertex, normal), 0);
+            addAttribute(layout, VertexAttributeFormat::Float2, offsetof(ModelVertex, texCoords), 0);
+            layout.strides[0] = sizeof(ModelVertex);
+        }
+        if (variant.features & kFeatureVertexColors)
+        {
+            addAttribute(layout, VertexAttributeFormat::UChar4Normalized, 0, 2);
+            layout.strides[2] = sizeof(uint32_t);
+        }
+        return layout;
+    }
+
+    uint64_t hashPipeline(const PipelineDescription& description)
+    {
+        const VertexLayout layout = getVertexLayout(ShaderVariant::fromKey(description.variantKey));
+        return hashCombine(hashValue(layout), hashValue(description));
+    }
+
+    PipelineCache::PipelineCache(const std::string& directory)
+        : m_directory(directory.empty() ? AssetCache::getDefaultDirectory() + "/pipelines" : directory)
+    {
+    }
+
+    bool PipelineCache::load(uint64_t shaderHash)
+    {
+        MappedFile file;
+        std::vector<uint8_t> data;
+        if (file.open(getManifestPath()) && file.size() > 0)
+        {
+            data.assign(file.data(), file.data() + file.size());
+        }
+        return deserialize(data, shaderHash);
+    }
+
+    bool PipelineCache::save()
+    {
+        const std::string path = getManifestPath();
+        std::error_code filesystemError;
+        std::filesystem::create_directories(m_directory, filesystemError);
+
+        // Temporary + rename, as in ImportCache, so a crash never leaves a partial manifest.
+        const std::string temporaryPath = makeTemporaryPath(path);
+        {
+            const std::vector<uint8_t> data = serialize();
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file.flush())
+            {
+                file.close();
+                std::filesystem::remove(temporaryPath, filesystemError);
+                return false;
+            }
+        }
+        std::filesystem::rename(temporaryPath, path, filesystemError);
+        if (filesystemError)
+        {
+            std::filesystem::remove(temporaryPath, filesystemError);
+            return false;
+        }
+        m_dirty = false;
+        return true;
+    }
+
+    bool PipelineCache::add(const PipelineDescription& description)
+    {
+        if (!m_keys.insert(hashPipeline(description)).second)
+        {
+            return false;
+        }
+        m_pipelines.push_back(description);
+        m_dirty = true;
+        return true;
+    }
+
+    void PipelineCache::clear()
+    {
+        m_pipelines.clear();
+        m_keys.clear();
+        m_dirty = true;
+    }
+
+    std::vector<uint8_t> PipelineCache::serialize() const
+    {
+        ChunkWriter writer;
+        writer.write(kManifestMagic);
+        writer.write(kManifestVersion);
+        writer.write(m_shaderHash);
+        writer.writeArray(m_pipelines);
+        return std::move(writer.getData());
+    }
+
+    bool PipelineCache::deserialize(const std::vector<uint8_t>& data, uint64_t shaderHash)
+    {
+        m_shaderHash = shaderHash;
+        m_pipelines.clear();
+        m_keys.clear();
+        m_dirty = false;
+
+        ChunkReader reader(data);
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        uint64_t savedShaderHash = 0;
+        std::vector<PipelineDescription> pipelines;
+        if (!reader.read(magic) || !reader.read(version) || !reader.read(savedShaderHash) || !reader.readArray(pipelines) ||
+            !reader.atEnd() || magic != kManifestMagic || version != kManifestVersion || savedShaderHash != shaderHash)
+        {
+            return false;
+        }
+        for (const PipelineDescription& description : pipelines)
+        {
+            if (m_keys.insert(hashPipeline(description)).second)
+            {
+                m_pipelines.push_back(description);
+            }
+        }
+        return true;
+    }
+} // namespace Pinnacle
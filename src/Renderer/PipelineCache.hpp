@@ -0,0 +1,101 @@
+#pragma once
+
+#include "ShaderVariant.hpp"
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Pinnacle
+{
+    enum class VertexAttributeFormat : uint32_t
+    {
+        Float2,
+        Float3,
+        Half2,
+        UShort4Normalized,
+        Short2Normalized,
+        UChar4Normalized
+    };
+
+    struct VertexAttributeLayout
+    {
+        uint32_t location = 0;
+        VertexAttributeFormat format = VertexAttributeFormat::Float3;
+        uint32_t offset = 0;
+        uint32_t buffer = 0;
+    };
+
+    // Vertex input of a shading variant: vertices in buffer 0, the vertex
+    // color stream in buffer 2. A stride of 0 leaves the buffer unused.
+    struct VertexLayout
+    {
+        static const uint32_t kMaxAttributes = 4;
+        static const uint32_t kMaxBuffers = 3;
+
+        VertexAttributeLayout attributes[kMaxAttributes];
+        uint32_t attributeCount = 0;
+        uint32_t strides[kMaxBuffers] = {};
+    };
+
+    VertexLayout getVertexLayout(const ShaderVariant& variant);
+
+    enum PipelineFlags : uint32_t
+    {
+        kPipelineDepthOnly = 1u << 0 // Vertex stage only, no color writes
+    };
+
+    // Everything a render pipeline is built from. Pixel formats are the
+    // backend's values (MTLPixelFormat); 0 means no attachment.
+    struct PipelineDescription
+    {
+        uint32_t variantKey = 0; // ShaderVariant::getKey()
+        uint32_t colorFormat = 0;
+        uint32_t depthFormat = 0;
+        uint32_t flags = 0; // PipelineFlags
+    };
+
+    // Identity of a pipeline: its description and the vertex layout its
+    // variant implies, so a layout change never reuses a stale binary.
+    uint64_t hashPipeline(const PipelineDescription& description);
+
+    // The pipelines built by earlier runs, kept on disk so the next launch
+    // can compile them up front and in parallel instead of on first use.
+    // The manifest belongs to one shader binary and device (`shaderHash`);
+    // any other hash discards it. The backend keeps its compiled binaries
+    // next to it at getArchivePath().
+    class PipelineCache
+    {
+    public:
+        // An empty directory selects AssetCache::getDefaultDirectory()/pipelines.
+        explicit PipelineCache(const std::string& directory = std::string());
+
+        // Replaces the entries with the saved ones for `shaderHash`; false
+        // (and empty) when there are none or they were built for other shaders.
+        bool load(uint64_t shaderHash);
+        bool save();
+
+        // Records a built pipeline; false if it was already known.
+        bool add(const PipelineDescription& description);
+        void clear();
+
+        const std::vector<PipelineDescription>& getPipelines() const { return m_pipelines; }
+        bool isDirty() const { return m_dirty; }
+
+        const std::string& getDirectory() const { return m_directory; }
+        std::string getManifestPath() const { return m_directory + "/manifest.bin"; }
+        std::string getArchivePath() const { return m_directory + "/archive.bin"; }
+
+        // Manifest file contents, independent of the backend.
+        std::vector<uint8_t> serialize() const;
+        bool deserialize(const std::vector<uint8_t>& data, uint64_t shaderHash);
+
+    private:
+        std::string m_directory;
+        uint64_t m_shaderHash = 0;
+        std::vector<PipelineDescription> m_pipelines;
+        std::unordered_set<uint64_t> m_keys;
+        bool m_dirty = false;
+    };
+} // namespace Pinnacle
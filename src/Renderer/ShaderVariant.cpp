@@ -0,0 +1,61 @@
+#include "ShaderVariant.hpp"
+
+namespace Pinnacle
+{
+    namespace
+    {
+        // `feature` when `enabled`, else no bits; keeps the conditionals
+        // below in uint32_t rather than mixing the enum with a plain 0.
+        uint32_t featureIf(bool enabled, ShaderFeature feature)
+        {
+            return enabled ? static_cast<uint32_t>(feature) : 0u;
+        }
+    } // namespace
+
+    ShaderVariant ShaderVariant::fromKey(uint32_t key)
+    {
+        ShaderVariant variant;
+        variant.features = key & 0xFFFFu;
+        variant.vertexFormat = static_cast<VertexFormat>(key >> 16);
+        return variant;
+    }
+
+    ShaderVariant getShaderVariant(const ModelData& model, const PrimitiveData& primitive)
+    {
+        ShaderVariant variant;
+        variant.vertexFormat = primitive.vertexFormat;
+        variant.features |= featureIf(primitive.hasVertexColors, kFeatureVertexColors);
+        if (primitive.material < 0 || primitive.material >= static_cast<int32_t>(model.materials.size()))
+        {
+            return variant;
+        }
+
+        const MaterialData& material = model.materials[primitive.material];
+        auto usable = [&model](int32_t texture)
+        {
+            return texture >= 0 && texture < static_cast<int32_t>(model.textures.size()) && model.textures[texture].mipCount > 0;
+        };
+        variant.features |= featureIf(usable(material.baseColorTexture), kFeatureBaseColorTexture);
+        variant.features |= featureIf(material.alphaMode == AlphaMode::Mask, kFeatureAlphaMask);
+        variant.features |= featureIf(material.alphaMode == AlphaMode::Blend, kFeatureAlphaBlend);
+        if (material.flags & kMaterialUnlit)
+        {
+            // Nothing but the base color is shaded, so the other inputs must
+            // not split variants
+            variant.features |= kFeatureUnlit;
+            if ((variant.features & kFeatureBaseColorTexture) &&
+                !material.textureTransforms[kMaterialBaseColorTexture].isIdentity())
+            {
+                variant.features |= kFeatureTextureTransform;
+            }
+            return variant;
+        }
+        variant.features |= featureIf(usable(material.metallicRoughnessTexture), kFeatureMetallicRoughnessTexture);
+        variant.features |= featureIf(usable(material.normalTexture), kFeatureNormalTexture);
+        variant.features |= featureIf(usable(material.occlusionTexture), kFeatureOcclusionTexture);
+        variant.features |= featureIf(usable(material.emissiveTexture), kFeatureEmissiveTexture);
+        variant.features |= featureIf((material.flags & kMaterialClearcoat) != 0, kFeatureClearcoat);
+        variant.features |= featureIf((material.flags & kMaterialTextureTransform) != 0, kFeatureTextureTransform);
+        return variant;
+    }
+} // namespace Pinnacle
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstdint>
+
+namespace Pinnacle
+{
+    // Optional parts of the shading pipeline. Bit i is function constant i
+    // in triangle.metal, so a variant's specialization is just its bit set.
+    enum ShaderFeature : uint32_t
+    {
+        kFeatureBaseColorTexture = 1u << 0,
+        kFeatureMetallicRoughnessTexture = 1u << 1,
+        kFeatureNormalTexture = 1u << 2,
+        kFeatureOcclusionTexture = 1u << 3,
+        kFeatureEmissiveTexture = 1u << 4,
+        kFeatureAlphaMask = 1u << 5,
+        kFeatureAlphaBlend = 1u << 6, // Also turns on blending in the pipeline state
+        kFeatureVertexColors = 1u << 7,
+        kFeatureUnlit = 1u << 8,           // Base color (and alpha) only; no texture but the base color's
+        kFeatureClearcoat = 1u << 9,       // Dielectric specular layer over the base
+        kFeatureTextureTransform = 1u << 10 // Per-texture UV transforms from GpuMaterial
+    };
+
+    const uint32_t kShaderFeatureCount = 11;
+
+    // Everything a shading pipeline is specialized on. Primitives with equal
+    // keys share one compiled pipeline.
+    struct ShaderVariant
+    {
+        uint32_t features = 0;
+        VertexFormat vertexFormat = VertexFormat::Float;
+
+        uint32_t getKey() const { return features | (static_cast<uint32_t>(vertexFormat) << 16); }
+        static ShaderVariant fromKey(uint32_t key);
+    };
+
+    // Variant for drawing `primitive` with its material. Textures that could
+    // not be decoded count as absent. Extension features follow from
+    // MaterialData::flags alone.
+    ShaderVariant getShaderVariant(const ModelData& model, const PrimitiveData& primitive);
+} // namespace Pinnacle
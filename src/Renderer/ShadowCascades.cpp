@@ -0,0 +1,221 @@
+#include "ShadowCascades.hpp"
+
+#include "MeshletCuller.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double millisecondsSince(Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        float dot(const float a[3], const float b[3])
+        {
+            return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+        }
+
+        void normalize(float v[3])
+        {
+            const float length = std::sqrt(dot(v, v));
+            const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+            v[0] *= scale;
+            v[1] *= scale;
+            v[2] *= scale;
+        }
+
+        void cross(const float a[3], const float b[3], float out[3])
+        {
+            out[0] = a[1] * b[2] - a[2] * b[1];
+            out[1] = a[2] * b[0] - a[0] * b[2];
+            out[2] = a[0] * b[1] - a[1] * b[0];
+        }
+
+        // World position of view-space point `p`; the camera's view matrix is rigid.
+        void viewToWorld(const float viewMatrix[16], const float p[3], float out[3])
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                out[j] = 0.0f;
+                for (int i = 0; i < 3; ++i)
+                {
+                    out[j] += viewMatrix[j * 4 + i] * (p[i] - viewMatrix[12 + i]);
+                }
+            }
+        }
+
+        // False when the box is entirely behind one of the planes.
+        bool intersectsPlanes(const Bounds& bounds, const float planes[6][4])
+        {
+            for (int p = 0; p < 6; ++p)
+            {
+                const float* plane = planes[p];
+                // Corner furthest along the plane normal.
+                const float x = plane[0] >= 0.0f ? bounds.max[0] : bounds.min[0];
+                const float y = plane[1] >= 0.0f ? bounds.max[1] : bounds.min[1];
+                const float z = plane[2] >= 0.0f ? bounds.max[2] : bounds.min[2];
+                if (plane[0] * x + plane[1] * y + plane[2] * z + plane[3] < 0.0f)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+    } // namespace
+
+    void ShadowCascades::setCascadeCount(uint32_t count)
+    {
+        m_cascadeCount = std::min(std::max(count, 1u), kMaxCascades);
+    }
+
+    void ShadowCascades::update(const float viewMatrix[16], float fieldOfView, float aspectRatio, float nearPlane,
+                                float farPlane, const float lightDirection[3], const Bounds& sceneBounds)
+    {
+        const Clock::time_point start = Clock::now();
+        m_stats = ShadowStats();
+        m_stats.cascades = m_cascadeCount;
+
+        // Light basis: z points back towards the light, as a view matrix would.
+        float forward[3] = { lightDirection[0], lightDirection[1], lightDirection[2] };
+        normalize(forward);
+        const float back[3] = { -forward[0], -forward[1], -forward[2] };
+        const float worldUp[3] = { 0.0f, std::fabs(forward[1]) > 0.99f ? 0.0f : 1.0f, std::fabs(forward[1]) > 0.99f ? 1.0f : 0.0f };
+        float right[3];
+        float up[3];
+        cross(worldUp, back, right);
+        normalize(right);
+        cross(back, right, up);
+
+        // Depth along the light covered by the scene, for the caster range.
+        float sceneNear = 0.0f;
+        float sceneFar = 0.0f;
+        if (sceneBounds.isValid())
+        {
+            sceneNear = INFINITY;
+            sceneFar = -INFINITY;
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                const float p[3] = { (corner & 1) ? sceneBounds.max[0] : sceneBounds.min[0],
+                                     (corner & 2) ? sceneBounds.max[1] : sceneBounds.min[1],
+                                     (corner & 4) ? sceneBounds.max[2] : sceneBounds.min[2] };
+                sceneNear = std::min(sceneNear, dot(p, forward));
+                sceneFar = std::max(sceneFar, dot(p, forward));
+            }
+        }
+
+        const float tanHalfY = std::tan(fieldOfView * 0.5f);
+        const float tanHalfX = tanHalfY * aspectRatio;
+        const float tanSquared = tanHalfX * tanHalfX + tanHalfY * tanHalfY;
+        const float shadowNear = std::max(nearPlane, 1e-4f);
+        const float shadowFar = std::max(m_maxDistance > 0.0f ? std::min(m_maxDistance, farPlane) : farPlane, shadowNear * 1.001f);
+
+        float splitNear = shadowNear;
+        for (uint32_t c = 0; c < m_cascadeCount; ++c)
+        {
+            const float t = float(c + 1) / m_cascadeCount;
+            const float logarithmic = shadowNear * std::pow(shadowFar / shadowNear, t);
+            const float uniform = shadowNear + (shadowFar - shadowNear) * t;
+            const float splitFar = c + 1 == m_cascadeCount ? shadowFar : m_splitBlend * logarithmic + (1.0f - m_splitBlend) * uniform;
+
+            // Smallest sphere around the split: its center sits on the view
+            // axis, so its size does not change as the camera turns.
+            const float centerDepth = std::min(0.5f * (splitNear + splitFar) * (1.0f + tanSquared), splitFar);
+            const float nearOffset = splitNear - centerDepth;
+            const float farOffset = splitFar - centerDepth;
+            float radius = std::sqrt(std::max(nearOffset * nearOffset + splitNear * splitNear * tanSquared,
+                                              farOffset * farOffset + splitFar * splitFar * tanSquared));
+            // Rounded up so float noise in the radius cannot change the texel size.
+            radius = std::ceil(radius * 16.0f) / 16.0f;
+
+            const float viewCenter[3] = { 0.0f, 0.0f, -centerDepth };
+            float center[3];
+            viewToWorld(viewMatrix, viewCenter, center);
+
+            // Snap the center to whole texels in light space.
+            const float texelSize = 2.0f * radius / m_resolution;
+            const float centerX = std::floor(dot(center, right) / texelSize) * texelSize;
+            const float centerY = std::floor(dot(center, up) / texelSize) * texelSize;
+            const float centerDepthAlongLight = dot(center, forward);
+            const float depthNear = std::min(sceneNear, centerDepthAlongLight - radius);
+            const float depthFar = std::max(std::min(sceneFar, centerDepthAlongLight + radius), depthNear + 1e-3f);
+            const float depthScale = 1.0f / (depthFar - depthNear);
+
+            // Rows: right / radius, up / radius, forward into 0..1 depth.
+            ShadowCascade& cascade = m_cascades[c];
+            float* m = cascade.viewProjection;
+            for (int i = 0; i < 3; ++i)
+            {
+                m[i * 4 + 0] = right[i] / radius;
+                m[i * 4 + 1] = up[i] / radius;
+                m[i * 4 + 2] = forward[i] * depthScale;
+                m[i * 4 + 3] = 0.0f;
+            }
+            m[12] = -centerX / radius;
+            m[13] = -centerY / radius;
+            m[14] = -depthNear * depthScale;
+            m[15] = 1.0f;
+            extractFrustumPlanes(m, cascade.planes);
+            cascade.splitNear = splitNear;
+            cascade.splitFar = splitFar;
+            cascade.texelSize = texelSize;
+
+            splitNear = splitFar;
+        }
+        m_stats.cullMilliseconds = millisecondsSince(start);
+    }
+
+    void ShadowCascades::cullCasters(const Bounds* pWorldBounds, size_t count, uint8_t* pOutMasks)
+    {
+        const Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint8_t mask = 0;
+            for (uint32_t c = 0; c < m_cascadeCount; ++c)
+            {
+                mask |= intersectsPlanes(pWorldBounds[i], m_cascades[c].planes) ? uint8_t(1u << c) : uint8_t(0);
+            }
+            pOutMasks[i] = mask;
+            m_stats.casters += mask != 0 ? 1 : 0;
+        }
+        m_stats.casterTests += static_cast<uint32_t>(count);
+        m_stats.cullMilliseconds += millisecondsSince(start);
+    }
+
+    uint32_t ShadowCascades::selectCasterLod(const PrimitiveData& primitive, const std::vector<LodData>& lods,
+                                             float worldScale, uint32_t cascade) const
+    {
+        const float maxError = m_cascades[cascade].texelSize;
+        uint32_t level = 0;
+        while (level < primitive.lodCount && lods[primitive.firstLod + level].error * worldScale <= maxError)
+        {
+            ++level;
+        }
+        return level;
+    }
+
+    bool findShadowLight(const ModelData& model, float outDirection[3])
+    {
+        for (const LightData& light : model.lights)
+        {
+            if (light.type != LightType::Directional || light.node < 0 || light.node >= static_cast<int32_t>(model.nodes.size()))
+            {
+                continue;
+            }
+            // Lights shine down their node's -Z axis.
+            const float* world = model.nodes[light.node].worldMatrix;
+            outDirection[0] = -world[8];
+            outDirection[1] = -world[9];
+            outDirection[2] = -world[10];
+            normalize(outDirection);
+            return dot(outDirection, outDirection) > 0.0f;
+        }
+        return false;
+    }
+} // namespace Pinnacle
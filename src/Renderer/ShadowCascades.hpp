@@ -0,0 +1,82 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    struct ShadowCascade
+    {
+        float viewProjection[16]; // World to shadow clip space: Metal NDC, depth 0..1
+        float planes[6][4];       // World-space frustum planes of viewProjection
+        float splitNear = 0.0f;   // View depth range of the camera frustum this cascade covers
+        float splitFar = 0.0f;
+        float texelSize = 0.0f; // World units per shadow-map texel
+    };
+
+    struct ShadowStats
+    {
+        uint32_t cascades = 0;
+        uint32_t casterTests = 0; // Bounds tested against every cascade
+        uint32_t casters = 0;     // Tested bounds inside at least one cascade
+        uint32_t drawCalls = 0;   // Shadow passes only; FrameStats::drawCalls is the main view
+        uint64_t triangles = 0;
+        double cullMilliseconds = 0.0; // Fitting and caster culling
+    };
+
+    // Cascaded shadow maps for one directional light. The camera frustum is
+    // cut into depth splits between a uniform and a logarithmic spread; each
+    // split is enclosed in a bounding sphere whose size only depends on the
+    // projection, and the light's orthographic frustum around it is snapped to
+    // whole texels. Shadow edges therefore stay put while the camera moves or
+    // turns. Depth ranges reach back to the scene bounds so casters between
+    // the light and the split are never clipped.
+    class ShadowCascades
+    {
+    public:
+        static constexpr uint32_t kMaxCascades = 4;
+
+        void setCascadeCount(uint32_t count);
+        void setResolution(uint32_t texels) { m_resolution = texels > 0 ? texels : 1; }
+        // 0 = uniform splits, 1 = logarithmic.
+        void setSplitBlend(float blend) { m_splitBlend = blend; }
+        // Shadows end at this view depth; 0 = the camera's far plane.
+        void setMaxDistance(float distance) { m_maxDistance = distance; }
+
+        // Fits the cascades to the camera (`viewMatrix` world to view,
+        // vertical field of view in radians) for a light shining along
+        // `lightDirection` (world space) over `sceneBounds`.
+        void update(const float viewMatrix[16], float fieldOfView, float aspectRatio, float nearPlane, float farPlane,
+                    const float lightDirection[3], const Bounds& sceneBounds);
+
+        // Sets bit c of pOutMasks[i] when world bounds i may cast a shadow
+        // into cascade c.
+        void cullCasters(const Bounds* pWorldBounds, size_t count, uint8_t* pOutMasks);
+
+        // Coarsest LOD whose error stays under a shadow-map texel of `cascade`:
+        // 0 for full detail or k for primitive LOD firstLod + k - 1.
+        uint32_t selectCasterLod(const PrimitiveData& primitive, const std::vector<LodData>& lods, float worldScale,
+                                 uint32_t cascade) const;
+
+        uint32_t getCascadeCount() const { return m_cascadeCount; }
+        uint32_t getResolution() const { return m_resolution; }
+        const ShadowCascade& getCascade(uint32_t index) const { return m_cascades[index]; }
+        // Cull statistics of the last update; draw counts are left to the caller.
+        const ShadowStats& getStats() const { return m_stats; }
+
+    private:
+        ShadowCascade m_cascades[kMaxCascades];
+        uint32_t m_cascadeCount = 4;
+        uint32_t m_resolution = 2048;
+        float m_splitBlend = 0.75f;
+        float m_maxDistance = 0.0f;
+        ShadowStats m_stats;
+    };
+
+    // Direction (world space, normalized) of the first directional light of
+    // the model, the one that casts shadows; false if there is none.
+    bool findShadowLight(const ModelData& model, float outDirection[3]);
+} // namespace Pinnacle
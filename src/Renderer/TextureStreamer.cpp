@@ -0,0 +1,281 @@
+#include "TextureStreamer.hpp"
+
+#include "../Asset/MeshUtilities.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        const float kMinDistance = 1e-4f;
+    } // namespace
+
+    void TextureStreamer::reset(const ModelData& model)
+    {
+        m_textures.assign(model.textures.size(), TextureState());
+        m_materials.assign(model.materials.size(), MaterialState());
+        m_residentBytes = 0;
+        m_stats = TextureStreamingStats();
+        m_stats.budgetBytes = m_budget;
+
+        for (size_t i = 0; i < model.textures.size(); ++i)
+        {
+            const TextureData& source = model.textures[i];
+            TextureState& texture = m_textures[i];
+            texture.mipCount = source.mipCount;
+            texture.residentMip = source.mipCount;
+            texture.largestSide = std::max(source.width, source.height);
+            texture.tailMip = source.mipCount > 0 ? source.mipCount - 1 : 0;
+            for (uint32_t mip = 0; mip < source.mipCount; ++mip)
+            {
+                const TextureMipData& level = model.textureMips[source.firstMip + mip];
+                texture.mipBytes.push_back(level.size);
+                if (std::max(level.width, level.height) <= m_tailSize)
+                {
+                    texture.tailMip = std::min(texture.tailMip, mip);
+                }
+            }
+        }
+
+        for (size_t i = 0; i < model.materials.size(); ++i)
+        {
+            const MaterialData& material = model.materials[i];
+            for (int32_t texture : { material.baseColorTexture, material.metallicRoughnessTexture, material.normalTexture,
+                                     material.occlusionTexture, material.emissiveTexture })
+            {
+                std::vector<uint32_t>& textures = m_materials[i].textures;
+                if (texture >= 0 && texture < static_cast<int32_t>(m_textures.size()) && m_textures[texture].mipCount > 0 &&
+                    std::find(textures.begin(), textures.end(), static_cast<uint32_t>(texture)) == textures.end())
+                {
+                    textures.push_back(static_cast<uint32_t>(texture));
+                }
+            }
+        }
+        for (const PrimitiveData& primitive : model.primitives)
+        {
+            if (primitive.material < 0 || primitive.material >= static_cast<int32_t>(m_materials.size()) ||
+                m_materials[primitive.material].textures.empty())
+            {
+                continue;
+            }
+            const float density = computeUvDensity(model.vertices.data() + primitive.vertexOffset,
+                                                   model.indices.data() + primitive.indexOffset, primitive.indexCount);
+            float& materialDensity = m_materials[primitive.material].uvDensity;
+            materialDensity = std::max(materialDensity, density);
+        }
+
+        // KHR_texture_transform scales repeat textures that many more times
+        for (size_t i = 0; i < model.materials.size(); ++i)
+        {
+            float largestScale = 1.0f;
+            for (const TextureTransform& transform : model.materials[i].textureTransforms)
+            {
+                const float* m = transform.matrix;
+                largestScale = std::max(largestScale, std::sqrt(std::max(m[0] * m[0] + m[3] * m[3], m[1] * m[1] + m[4] * m[4])));
+            }
+            m_materials[i].uvDensity *= largestScale;
+        }
+    }
+
+    void TextureStreamer::setViewport(float viewportHeight, float fieldOfView)
+    {
+        const float halfTan = std::tan(fieldOfView * 0.5f);
+        m_projectionScale = halfTan > 0.0f ? viewportHeight / (2.0f * halfTan) : 1.0f;
+    }
+
+    void TextureStreamer::requestMaterial(int32_t material, float worldScale, float distance)
+    {
+        if (material < 0 || material >= static_cast<int32_t>(m_materials.size()))
+        {
+            return;
+        }
+        const MaterialState& state = m_materials[material];
+        for (uint32_t textureIndex : state.textures)
+        {
+            const TextureState& texture = m_textures[textureIndex];
+            // Texels per world unit over pixels per world unit at this distance.
+            const float texelsPerPixel = state.uvDensity * texture.largestSide * std::max(distance, kMinDistance) /
+                                         (std::max(worldScale, 1e-6f) * m_projectionScale);
+            uint32_t mip = texture.mipCount - 1;
+            if (texelsPerPixel > 0.0f)
+            {
+                const float level = std::floor(std::log2(texelsPerPixel) + m_mipBias);
+                mip = static_cast<uint32_t>(std::min(std::max(level, 0.0f), static_cast<float>(texture.mipCount - 1)));
+            }
+            requestMip(textureIndex, mip);
+        }
+    }
+
+    void TextureStreamer::requestMip(uint32_t textureIndex, uint32_t mip)
+    {
+        if (textureIndex >= m_textures.size() || m_textures[textureIndex].mipCount == 0)
+        {
+            return;
+        }
+        TextureState& texture = m_textures[textureIndex];
+        mip = std::min(mip, texture.mipCount - 1);
+        texture.wantedMip = texture.requested ? std::min(texture.wantedMip, mip) : mip;
+        texture.requested = true;
+        texture.lastUsedFrame = m_frame;
+    }
+
+    uint64_t TextureStreamer::getRangeBytes(const TextureState& texture, uint32_t firstMip, uint32_t endMip) const
+    {
+        uint64_t bytes = 0;
+        for (uint32_t mip = firstMip; mip < endMip; ++mip)
+        {
+            bytes += texture.mipBytes[mip];
+        }
+        return bytes;
+    }
+
+    uint64_t TextureStreamer::getEvictableBytes(const TextureState& texture) const
+    {
+        // Textures in use this frame only give up levels finer than they want.
+        const uint32_t floor = texture.lastUsedFrame == m_frame ? texture.wantedMip : texture.mipCount;
+        return texture.residentMip < floor ? getRangeBytes(texture, texture.residentMip, floor) : 0;
+    }
+
+    bool TextureStreamer::makeRoom(uint64_t bytes, size_t requester)
+    {
+        if (m_residentBytes + bytes <= m_budget)
+        {
+            return true;
+        }
+
+        // Evict nothing unless enough can go to fit the request.
+        uint64_t evictable = 0;
+        for (size_t i = 0; i < m_textures.size(); ++i)
+        {
+            evictable += i == requester ? 0 : getEvictableBytes(m_textures[i]);
+        }
+        if (bytes > 0 && m_residentBytes - std::min(evictable, m_residentBytes) + bytes > m_budget)
+        {
+            return false;
+        }
+
+        while (m_residentBytes + bytes > m_budget)
+        {
+            // Least recently used first.
+            size_t victim = m_textures.size();
+            for (size_t i = 0; i < m_textures.size(); ++i)
+            {
+                if (i == requester || getEvictableBytes(m_textures[i]) == 0)
+                {
+                    continue;
+                }
+                const TextureState& texture = m_textures[i];
+                if (victim == m_textures.size() || texture.lastUsedFrame < m_textures[victim].lastUsedFrame)
+                {
+                    victim = i;
+                }
+            }
+            if (victim == m_textures.size())
+            {
+                return false;
+            }
+
+            // Drop the finest level; an unused texture's tail goes out as one piece.
+            TextureState& texture = m_textures[victim];
+            const bool dropTail = texture.lastUsedFrame != m_frame && texture.residentMip >= texture.tailMip;
+            const uint32_t next = dropTail ? texture.mipCount : texture.residentMip + 1;
+            m_residentBytes -= getRangeBytes(texture, texture.residentMip, next);
+            m_stats.levelsEvicted += next - texture.residentMip;
+            texture.residentMip = next;
+            texture.changed = true;
+        }
+        return true;
+    }
+
+    void TextureStreamer::update(std::vector<StreamingCommand>& outCommands)
+    {
+        outCommands.clear();
+        m_stats.uploadedBytes = 0;
+        m_stats.levelsLoaded = 0;
+        m_stats.levelsEvicted = 0;
+        m_stats.budgetBytes = m_budget;
+
+        // Rounds of one step per wanting texture, starved textures first, so
+        // every visible texture has its tail before any gains detail.
+        bool uploadBudgetSpent = false;
+        while (!uploadBudgetSpent)
+        {
+            m_wanting.clear();
+            for (size_t i = 0; i < m_textures.size(); ++i)
+            {
+                const TextureState& texture = m_textures[i];
+                if (texture.requested && texture.residentMip > texture.wantedMip)
+                {
+                    m_wanting.push_back(i);
+                }
+            }
+            std::sort(m_wanting.begin(), m_wanting.end(), [this](size_t a, size_t b)
+            {
+                const TextureState& first = m_textures[a];
+                const TextureState& second = m_textures[b];
+                const bool firstEmpty = first.residentMip == first.mipCount;
+                const bool secondEmpty = second.residentMip == second.mipCount;
+                if (firstEmpty != secondEmpty)
+                {
+                    return firstEmpty;
+                }
+                const uint32_t firstGap = first.residentMip - first.wantedMip;
+                const uint32_t secondGap = second.residentMip - second.wantedMip;
+                return firstGap != secondGap ? firstGap > secondGap : a < b;
+            });
+
+            bool progressed = false;
+            for (size_t index : m_wanting)
+            {
+                TextureState& texture = m_textures[index];
+                const bool empty = texture.residentMip == texture.mipCount;
+                const uint32_t target = empty ? std::max(texture.tailMip, texture.wantedMip) : texture.residentMip - 1;
+                const uint64_t bytes = getRangeBytes(texture, target, texture.residentMip);
+                if (m_stats.uploadedBytes > 0 && m_stats.uploadedBytes + bytes > m_uploadBudget)
+                {
+                    uploadBudgetSpent = true;
+                    break;
+                }
+                if (!makeRoom(bytes, index))
+                {
+                    continue;
+                }
+                m_residentBytes += bytes;
+                m_stats.uploadedBytes += bytes;
+                m_stats.levelsLoaded += texture.residentMip - target;
+                texture.residentMip = target;
+                texture.changed = true;
+                progressed = true;
+            }
+            if (!progressed)
+            {
+                break;
+            }
+        }
+
+        // The budget may have shrunk since the last update.
+        makeRoom(0, m_textures.size());
+
+        m_stats.residentBytes = m_residentBytes;
+        m_stats.texturesResident = 0;
+        m_stats.texturesWanting = 0;
+        for (size_t i = 0; i < m_textures.size(); ++i)
+        {
+            TextureState& texture = m_textures[i];
+            m_stats.texturesResident += texture.residentMip < texture.mipCount ? 1 : 0;
+            m_stats.texturesWanting += texture.requested && texture.residentMip > texture.wantedMip ? 1 : 0;
+            if (texture.changed)
+            {
+                StreamingCommand command;
+                command.texture = static_cast<uint32_t>(i);
+                command.firstMip = texture.residentMip;
+                outCommands.push_back(command);
+            }
+            texture.changed = false;
+            texture.requested = false;
+        }
+        m_frame++;
+    }
+} // namespace Pinnacle
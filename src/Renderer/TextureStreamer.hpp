@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../Asset/ModelData.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pinnacle
+{
+    struct TextureStreamingStats
+    {
+        uint64_t residentBytes = 0;
+        uint64_t budgetBytes = 0;
+        uint64_t uploadedBytes = 0;   // Last update
+        uint32_t levelsLoaded = 0;    // Last update
+        uint32_t levelsEvicted = 0;   // Last update
+        uint32_t texturesResident = 0;
+        uint32_t texturesWanting = 0; // Used last frame but coarser than requested
+    };
+
+    // A texture's resident range changed to mips [firstMip, mipCount); the
+    // GPU copy should be rebuilt from those levels. firstMip == mipCount
+    // means the texture is no longer resident at all.
+    struct StreamingCommand
+    {
+        uint32_t texture = 0;
+        uint32_t firstMip = 0;
+    };
+
+    // Texture residency policy; pure CPU, owns no GPU objects. Each frame the
+    // renderer requests materials it draws, with their distance and scale;
+    // the streamer turns the material's screen-space texel density into a
+    // wanted mip per texture. update() then streams textures in coarse to
+    // fine (a newly seen texture first gets its small mip tail, then every
+    // wanting texture gains one level per round) within an upload budget,
+    // and keeps the resident total under the memory budget by evicting
+    // least-recently-used textures a level at a time, finest level first.
+    class TextureStreamer
+    {
+    public:
+        // Registers every texture and material of `model`; nothing is resident.
+        void reset(const ModelData& model);
+
+        // Vertical field of view in radians, as for LodSelector.
+        void setViewport(float viewportHeight, float fieldOfView);
+        void setBudget(uint64_t bytes) { m_budget = bytes; }
+        void setUploadBudget(uint64_t bytesPerUpdate) { m_uploadBudget = bytesPerUpdate; }
+        // Levels this small (largest side, in texels) load together as the tail.
+        void setTailSize(uint32_t texels) { m_tailSize = texels; }
+        // Positive values trade sharpness for memory, in mip levels.
+        void setMipBias(float levels) { m_mipBias = levels; }
+
+        // Requests every texture of `material` for a draw at `distance` with
+        // the node's largest axis scale `worldScale`.
+        void requestMaterial(int32_t material, float worldScale, float distance);
+        // Requests mip `mip` (finest wanted level) of a texture directly.
+        void requestMip(uint32_t texture, uint32_t mip);
+
+        // Applies this frame's requests and starts the next frame. Returns
+        // the textures whose resident range changed.
+        void update(std::vector<StreamingCommand>& outCommands);
+
+        uint32_t getResidentMip(uint32_t texture) const { return m_textures[texture].residentMip; }
+        uint32_t getMipCount(uint32_t texture) const { return m_textures[texture].mipCount; }
+        const TextureStreamingStats& getStats() const { return m_stats; }
+
+    private:
+        struct TextureState
+        {
+            std::vector<uint64_t> mipBytes;
+            uint32_t mipCount = 0;
+            uint32_t tailMip = 0;     // First level of the tail
+            uint32_t residentMip = 0; // mipCount when nothing is resident
+            uint32_t wantedMip = 0;   // Finest level requested this frame
+            uint32_t largestSide = 0;
+            uint64_t lastUsedFrame = 0;
+            bool requested = false;
+            bool changed = false;
+        };
+
+        struct MaterialState
+        {
+            std::vector<uint32_t> textures;
+            float uvDensity = 0.0f; // Largest UV units per object unit among its primitives
+        };
+
+        uint64_t getRangeBytes(const TextureState& texture, uint32_t firstMip, uint32_t endMip) const;
+        uint64_t getEvictableBytes(const TextureState& texture) const;
+        bool makeRoom(uint64_t bytes, size_t requester);
+
+        std::vector<TextureState> m_textures;
+        std::vector<MaterialState> m_materials;
+        TextureStreamingStats m_stats;
+        uint64_t m_frame = 1;
+        uint64_t m_residentBytes = 0;
+        uint64_t m_budget = 256ull << 20;
+        uint64_t m_uploadBudget = 16ull << 20;
+        uint32_t m_tailSize = 64;
+        float m_mipBias = 0.0f;
+        float m_projectionScale = 1.0f; // Pixels per unit at distance 1
+        std::vector<size_t> m_wanting;
+    };
+} // namespace Pinnacle
@@ -1,13 +1,18 @@
 #pragma once
 
+#include "../Core/SlotMap.hpp"
+
 #include <simd/simd.h>
 #include <string>
 #include <vector>
-#include <memory>
 
 namespace Pinnacle
 {
     class Texture;
+    class Material;
+
+    using TextureHandle = Handle<Texture>;
+    using MaterialHandle = Handle<Material>;
 
     struct PBRMaterial
     {
@@ -15,11 +20,12 @@ namespace Pinnacle
         float metallicFactor = 1.0f;
         float roughnessFactor = 1.0f;
 
-        std::shared_ptr<Pinnacle::Texture> baseColorTexture;
-        std::shared_ptr<Pinnacle::Texture> metallicRoughnessTexture;
-        std::shared_ptr<Pinnacle::Texture> normalTexture;
-        std::shared_ptr<Pinnacle::Texture> occlusionTexture;
-        std::shared_ptr<Pinnacle::Texture> emissiveTexture;
+        // Into Scene::getTextures(); invalid when the slot is unused
+        TextureHandle baseColorTexture;
+        TextureHandle metallicRoughnessTexture;
+        TextureHandle normalTexture;
+        TextureHandle occlusionTexture;
+        TextureHandle emissiveTexture;
     };
 
     class Material
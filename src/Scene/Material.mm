@@ -0,0 +1,12 @@
+#include "Material.hpp"
+
+namespace Pinnacle
+{
+    Material::Material()
+    {
+    }
+
+    Material::~Material()
+    {
+    }
+} // namespace Pinnacle
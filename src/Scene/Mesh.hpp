@@ -1,8 +1,9 @@
 #pragma once
 
+#include "Material.hpp"
+
 #include <simd/simd.h>
 #include <vector>
-#include <memory>
 
 // Forward declarations for Metal types
 namespace MTL
@@ -18,8 +19,6 @@ namespace NS
 
 namespace Pinnacle
 {
-    class Material;
-
     struct Vertex
     {
         simd_float3 position;
@@ -30,18 +29,27 @@ namespace Pinnacle
     class Mesh
     {
     public:
-        Mesh(MTL::Device* pDevice, const std::vector<Vertex>& vertices, const std::vector<uint16_t>& indices, std::shared_ptr<Pinnacle::Material> pMaterial);
+        // Indices are 32-bit, as in ModelData.
+        Mesh(MTL::Device* pDevice, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, MaterialHandle material);
         ~Mesh();
 
+        // Meshes live in a SlotMap, which relocates them; the buffers move with the object.
+        Mesh(Mesh&& other) noexcept;
+        Mesh& operator=(Mesh&& other) noexcept;
+        Mesh(const Mesh&) = delete;
+        Mesh& operator=(const Mesh&) = delete;
+
         MTL::Buffer* getVertexBuffer() const { return m_pVertexBuffer; }
         MTL::Buffer* getIndexBuffer() const { return m_pIndexBuffer; }
         NS::UInteger getIndexCount() const { return m_indexCount; }
-        std::shared_ptr<Pinnacle::Material> getMaterial() const { return m_pMaterial; }
+        MaterialHandle getMaterial() const { return m_material; }
 
     private:
         MTL::Buffer* m_pVertexBuffer;
         MTL::Buffer* m_pIndexBuffer;
         NS::UInteger m_indexCount;
-        std::shared_ptr<Pinnacle::Material> m_pMaterial;
+        MaterialHandle m_material;
     };
+
+    using MeshHandle = Handle<Mesh>;
 } // namespace Pinnacle
@@ -0,0 +1,64 @@
+// metal-cpp's out-of-line definitions are emitted by this translation unit;
+// the other scene sources include the headers alone.
+#define NS_PRIVATE_IMPLEMENTATION
+#define MTL_PRIVATE_IMPLEMENTATION
+#include <Metal/Metal.hpp>
+
+#include "Mesh.hpp"
+
+#include <utility>
+
+namespace Pinnacle
+{
+    Mesh::Mesh(MTL::Device* pDevice, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, MaterialHandle material)
+        : m_pVertexBuffer(vertices.empty() ? nullptr
+                                           : pDevice->newBuffer(vertices.data(), vertices.size() * sizeof(Vertex),
+                                                                MTL::ResourceStorageModeShared))
+        , m_pIndexBuffer(indices.empty() ? nullptr
+                                         : pDevice->newBuffer(indices.data(), indices.size() * sizeof(uint32_t),
+                                                              MTL::ResourceStorageModeShared))
+        , m_indexCount(indices.size())
+        , m_material(material)
+    {
+    }
+
+    Mesh::~Mesh()
+    {
+        if (m_pVertexBuffer)
+        {
+            m_pVertexBuffer->release();
+        }
+        if (m_pIndexBuffer)
+        {
+            m_pIndexBuffer->release();
+        }
+    }
+
+    Mesh::Mesh(Mesh&& other) noexcept
+        : m_pVertexBuffer(std::exchange(other.m_pVertexBuffer, nullptr))
+        , m_pIndexBuffer(std::exchange(other.m_pIndexBuffer, nullptr))
+        , m_indexCount(std::exchange(other.m_indexCount, 0))
+        , m_material(other.m_material)
+    {
+    }
+
+    Mesh& Mesh::operator=(Mesh&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (m_pVertexBuffer)
+            {
+                m_pVertexBuffer->release();
+            }
+            if (m_pIndexBuffer)
+            {
+                m_pIndexBuffer->release();
+            }
+            m_pVertexBuffer = std::exchange(other.m_pVertexBuffer, nullptr);
+            m_pIndexBuffer = std::exchange(other.m_pIndexBuffer, nullptr);
+            m_indexCount = std::exchange(other.m_indexCount, 0);
+            m_material = other.m_material;
+        }
+        return *this;
+    }
+} // namespace Pinnacle
@@ -3,11 +3,9 @@
 #include "Node.hpp"
 #include "Texture.hpp"
 #include "Material.hpp"
-#include "tiny_gltf.h"
 
 #include <vector>
 #include <string>
-#include <memory>
 
 // Forward declarations for Metal types
 namespace MTL
@@ -17,22 +15,37 @@ namespace MTL
 
 namespace Pinnacle
 {
+    class Scene;
+
+    // A loaded glTF. Its nodes, meshes, materials and textures are created
+    // in the scene's slot maps; the model only keeps handles to them, and
+    // Scene::removeModel() frees them. Imported through GltfImporter, one
+    // Mesh per primitive and one Node per glTF node at its world transform.
     class Model
     {
     public:
-        Model(MTL::Device* pDevice, const std::string& path);
+        Model(MTL::Device* pDevice, const std::string& path, Scene& scene);
         ~Model();
 
-        const std::vector<std::shared_ptr<Node>>& getNodes() const { return m_nodes; }
-        const std::vector<std::shared_ptr<Material>>& getMaterials() const { return m_materials; }
+        Model(Model&&) noexcept = default;
+        Model& operator=(Model&&) noexcept = default;
+
+        bool isLoaded() const { return m_error.empty(); }
+        const std::string& getError() const { return m_error; }
+
+        const std::vector<NodeHandle>& getNodes() const { return m_nodes; }
+        const std::vector<MeshHandle>& getMeshes() const { return m_meshes; }
+        const std::vector<MaterialHandle>& getMaterials() const { return m_materials; }
+        const std::vector<TextureHandle>& getTextures() const { return m_textures; }
 
     private:
-        void loadModel(MTL::Device* pDevice, const std::string& path);
+        void loadModel(MTL::Device* pDevice, const std::string& path, Scene& scene);
 
-        std::vector<std::shared_ptr<Node>> m_nodes;
-        std::vector<std::shared_ptr<Texture>> m_textures;
-        std::vector<std::shared_ptr<Material>> m_materials;
-        std::unique_ptr<tinygltf::Model> m_gltfModel;
-        std::shared_ptr<Texture> m_pDefaultTexture;
+        std::vector<NodeHandle> m_nodes;
+        std::vector<MeshHandle> m_meshes;
+        std::vector<TextureHandle> m_textures; // m_defaultTexture first
+        std::vector<MaterialHandle> m_materials;
+        TextureHandle m_defaultTexture; // 1x1 white, for images that could not be decoded
+        std::string m_error;
     };
 } // namespace Pinnacle
@@ -0,0 +1,117 @@
+#include "Model.hpp"
+
+#include "../Asset/GltfImporter.hpp"
+#include "../Core/Scene.hpp"
+
+#include <cstring>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        TextureHandle getTexture(const std::vector<TextureHandle>& textures, int32_t index)
+        {
+            return index >= 0 && index < static_cast<int32_t>(textures.size()) ? textures[index] : TextureHandle();
+        }
+    } // namespace
+
+    Model::Model(MTL::Device* pDevice, const std::string& path, Scene& scene)
+    {
+        loadModel(pDevice, path, scene);
+    }
+
+    Model::~Model()
+    {
+    }
+
+    void Model::loadModel(MTL::Device* pDevice, const std::string& path, Scene& scene)
+    {
+        // Default settings: float vertices and one RGBA8 level per image.
+        GltfImporter importer;
+        ModelData modelData;
+        if (!importer.importFile(path, modelData))
+        {
+            m_error = importer.getError();
+            return;
+        }
+
+        const unsigned char white[4] = { 255, 255, 255, 255 };
+        m_defaultTexture = scene.getTextures().emplace(pDevice, white, 1, 1, 4);
+        m_textures.push_back(m_defaultTexture);
+        std::vector<TextureHandle> textures; // Per ModelData texture
+        for (const TextureData& texture : modelData.textures)
+        {
+            if (texture.mipCount == 0 || isBlockCompressed(texture.format))
+            {
+                textures.push_back(m_defaultTexture);
+                continue;
+            }
+            const TextureMipData& level = modelData.textureMips[texture.firstMip];
+            textures.push_back(scene.getTextures().emplace(pDevice, modelData.getTexels(texture) + level.offset,
+                                                           static_cast<int>(level.width), static_cast<int>(level.height), 4,
+                                                           texture.format == TextureFormat::RGBA8Srgb));
+            m_textures.push_back(textures.back());
+        }
+
+        for (const MaterialData& source : modelData.materials)
+        {
+            Material material;
+            PBRMaterial& pbr = material.getPBRMaterial();
+            pbr.baseColorFactor = simd_make_float4(source.baseColorFactor[0], source.baseColorFactor[1], source.baseColorFactor[2],
+                                                   source.baseColorFactor[3]);
+            pbr.metallicFactor = source.metallicFactor;
+            pbr.roughnessFactor = source.roughnessFactor;
+            pbr.baseColorTexture = getTexture(textures, source.baseColorTexture);
+            pbr.metallicRoughnessTexture = getTexture(textures, source.metallicRoughnessTexture);
+            pbr.normalTexture = getTexture(textures, source.normalTexture);
+            pbr.occlusionTexture = getTexture(textures, source.occlusionTexture);
+            pbr.emissiveTexture = getTexture(textures, source.emissiveTexture);
+            m_materials.push_back(scene.getMaterials().insert(std::move(material)));
+        }
+
+        // One Mesh per primitive; nodes drawing the same glTF mesh share them.
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        std::vector<uint32_t> firstMesh; // Per ModelData mesh, into m_meshes
+        for (const MeshData& mesh : modelData.meshes)
+        {
+            firstMesh.push_back(static_cast<uint32_t>(m_meshes.size()));
+            for (uint32_t p = mesh.firstPrimitive; p < mesh.firstPrimitive + mesh.primitiveCount; ++p)
+            {
+                const PrimitiveData& primitive = modelData.primitives[p];
+                vertices.clear();
+                for (uint32_t v = 0; v < primitive.vertexCount; ++v)
+                {
+                    const ModelVertex& source = modelData.vertices[primitive.vertexOffset + v];
+                    Vertex vertex;
+                    vertex.position = simd_make_float3(source.position[0], source.position[1], source.position[2]);
+                    vertex.normal = simd_make_float3(source.normal[0], source.normal[1], source.normal[2]);
+                    vertex.texCoords = simd_make_float2(source.texCoords[0], source.texCoords[1]);
+                    vertices.push_back(vertex);
+                }
+                indices.assign(modelData.indices.begin() + primitive.indexOffset,
+                               modelData.indices.begin() + primitive.indexOffset + primitive.indexCount);
+                const MaterialHandle material =
+                    primitive.material >= 0 && primitive.material < static_cast<int32_t>(m_materials.size()) ? m_materials[primitive.material]
+                                                                                                            : MaterialHandle();
+                m_meshes.push_back(scene.getMeshes().emplace(pDevice, vertices, indices, material));
+            }
+        }
+
+        for (const NodeData& source : modelData.nodes)
+        {
+            Node node;
+            simd_float4x4 transformation;
+            std::memcpy(&transformation, source.worldMatrix, sizeof(source.worldMatrix)); // Both column-major
+            node.setTransformation(transformation);
+            if (source.mesh >= 0 && source.mesh < static_cast<int32_t>(modelData.meshes.size()))
+            {
+                for (uint32_t m = 0; m < modelData.meshes[source.mesh].primitiveCount; ++m)
+                {
+                    node.addMesh(m_meshes[firstMesh[source.mesh] + m]);
+                }
+            }
+            m_nodes.push_back(scene.getNodes().insert(std::move(node)));
+        }
+    }
+} // namespace Pinnacle
@@ -4,7 +4,6 @@
 
 #include <simd/simd.h>
 #include <vector>
-#include <memory>
 
 namespace Pinnacle
 {
@@ -14,14 +13,19 @@ namespace Pinnacle
         Node();
         ~Node();
 
+        Node(Node&&) noexcept = default;
+        Node& operator=(Node&&) noexcept = default;
+
         void setTransformation(const simd_float4x4& transformation);
         const simd_float4x4& getTransformation() const;
 
-        void addMesh(const std::shared_ptr<Pinnacle::Mesh>& mesh);
-        const std::vector<std::shared_ptr<Pinnacle::Mesh>>& getMeshes() const;
+        void addMesh(MeshHandle mesh);
+        const std::vector<MeshHandle>& getMeshes() const { return m_meshes; } // Into Scene::getMeshes()
 
     private:
         simd_float4x4 m_transformation;
-        std::vector<std::shared_ptr<Pinnacle::Mesh>> m_meshes;
+        std::vector<MeshHandle> m_meshes;
     };
+
+    using NodeHandle = Handle<Node>;
 } // namespace Pinnacle
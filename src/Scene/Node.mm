@@ -0,0 +1,21 @@
+#include "Node.hpp"
+
+namespace Pinnacle
+{
+    Node::Node()
+        : m_transformation(matrix_identity_float4x4)
+    {
+    }
+
+    Node::~Node()
+    {
+    }
+
+    void Node::setTransformation(const simd_float4x4& transformation) { m_transformation = transformation; }
+    const simd_float4x4& Node::getTransformation() const { return m_transformation; }
+
+    void Node::addMesh(MeshHandle mesh)
+    {
+        m_meshes.push_back(mesh);
+    }
+} // namespace Pinnacle
@@ -22,8 +22,9 @@ namespace Pinnacle
     class Texture
     {
     public:
-        Texture(MTL::Device* pDevice, const std::string& path);
-        Texture(MTL::Device* pDevice, const unsigned char* pData, int width, int height, int channels);
+        // RGBA8 without mips; `srgb` for colour data (base color, emissive).
+        Texture(MTL::Device* pDevice, const std::string& path, bool srgb = false);
+        Texture(MTL::Device* pDevice, const unsigned char* pData, int width, int height, int channels, bool srgb = false);
         ~Texture();
 
         MTL::Texture* getMTLTexture() const { return m_pTexture.get(); }
@@ -0,0 +1,71 @@
+#include "Texture.hpp"
+
+#include <Metal/Metal.hpp>
+
+#include "stb_image.h"
+
+#include <vector>
+
+namespace Pinnacle
+{
+    namespace
+    {
+        MTL::Texture* createTexture(MTL::Device* pDevice, const unsigned char* pData, int width, int height, int channels, bool srgb)
+        {
+            if (!pDevice || !pData || width <= 0 || height <= 0 || channels < 1 || channels > 4)
+            {
+                return nullptr;
+            }
+
+            // Grey, grey-alpha and RGB images are widened to RGBA.
+            std::vector<unsigned char> expanded;
+            const unsigned char* pTexels = pData;
+            if (channels != 4)
+            {
+                const size_t texelCount = static_cast<size_t>(width) * height;
+                expanded.resize(texelCount * 4);
+                for (size_t i = 0; i < texelCount; ++i)
+                {
+                    const unsigned char* pSource = pData + i * channels;
+                    unsigned char* pTarget = expanded.data() + i * 4;
+                    pTarget[0] = pSource[0];
+                    pTarget[1] = channels >= 3 ? pSource[1] : pSource[0];
+                    pTarget[2] = channels >= 3 ? pSource[2] : pSource[0];
+                    pTarget[3] = channels == 2 ? pSource[1] : 255;
+                }
+                pTexels = expanded.data();
+            }
+
+            MTL::TextureDescriptor* pDescriptor = MTL::TextureDescriptor::texture2DDescriptor(
+                srgb ? MTL::PixelFormatRGBA8Unorm_sRGB : MTL::PixelFormatRGBA8Unorm, width, height, false);
+            pDescriptor->setUsage(MTL::TextureUsageShaderRead);
+            MTL::Texture* pTexture = pDevice->newTexture(pDescriptor);
+            if (pTexture)
+            {
+                pTexture->replaceRegion(MTL::Region(0, 0, width, height), 0, pTexels, static_cast<NS::UInteger>(width) * 4);
+            }
+            return pTexture;
+        }
+    } // namespace
+
+    Texture::Texture(MTL::Device* pDevice, const std::string& path, bool srgb)
+    {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        if (unsigned char* pData = stbi_load(path.c_str(), &width, &height, &channels, 4))
+        {
+            m_pTexture = NS::TransferPtr(createTexture(pDevice, pData, width, height, 4, srgb));
+            stbi_image_free(pData);
+        }
+    }
+
+    Texture::Texture(MTL::Device* pDevice, const unsigned char* pData, int width, int height, int channels, bool srgb)
+        : m_pTexture(NS::TransferPtr(createTexture(pDevice, pData, width, height, channels, srgb)))
+    {
+    }
+
+    Texture::~Texture()
+    {
+    }
+} // namespace Pinnacle
@@ -2,23 +2,497 @@
 using namespace metal;
 
 struct Uniforms {
-    float4 modelColor;
+    float4x4 modelViewProjection;
+    float4x4 modelView;
+    float4 positionOffset; // Dequantizes QuantizedVertex positions against the primitive bounds
+    float4 positionScale;
+};
+
+// Material features a pipeline is specialized on; indices match the
+// Pinnacle::ShaderFeature bits.
+constant bool kHasBaseColorTexture [[function_constant(0)]];
+constant bool kHasMetallicRoughnessTexture [[function_constant(1)]];
+constant bool kHasNormalTexture [[function_constant(2)]];
+constant bool kHasOcclusionTexture [[function_constant(3)]];
+constant bool kHasEmissiveTexture [[function_constant(4)]];
+constant bool kAlphaMask [[function_constant(5)]];
+constant bool kAlphaBlend [[function_constant(6)]];
+constant bool kHasVertexColors [[function_constant(7)]];
+constant bool kUnlit [[function_constant(8)]];
+constant bool kClearcoat [[function_constant(9)]];
+constant bool kTextureTransform [[function_constant(10)]];
+
+struct VertexIn {
+    float3 position [[attribute(0)]];
+    float3 normal [[attribute(1)]];
+    float2 texCoords [[attribute(2)]];
+    float4 color [[attribute(3), function_constant(kHasVertexColors)]];
 };
 
 struct VertexOut {
-    float4 position [[position]];
-    float4 color;
+    float4 position [[position, invariant]]; // Shared by the depth pre-pass and shading pipelines
+    float4 color; // Vertex color, white without one
+    float2 texCoords;
+    float3 viewPosition;
+    float3 viewNormal;
 };
 
-vertex VertexOut vertexShader(device const float3* positions [[buffer(0)]],
-                              constant Uniforms& uniforms [[buffer(1)]],
-                              unsigned int vertexId [[vertex_id]]) {
+vertex VertexOut vertexShader(VertexIn in [[stage_in]],
+                              constant Uniforms& uniforms [[buffer(1)]]) {
     VertexOut out;
-    out.position = float4(positions[vertexId], 1.0);
-    out.color = uniforms.modelColor;
+    out.position = uniforms.modelViewProjection * float4(in.position, 1.0);
+    out.color = kHasVertexColors ? in.color : float4(1.0);
+    out.texCoords = in.texCoords;
+    out.viewPosition = (uniforms.modelView * float4(in.position, 1.0)).xyz;
+    out.viewNormal = (uniforms.modelView * float4(in.normal, 0.0)).xyz;
     return out;
 }
 
-fragment float4 fragmentShader(VertexOut in [[stage_in]]) {
-    return in.color;
-}
\ No newline at end of file
+// Matches Pinnacle::QuantizedVertex; the vertex descriptor unpacks the
+// normalized and half formats.
+struct QuantizedVertexIn {
+    float4 position [[attribute(0)]];
+    float2 normal [[attribute(1)]];
+    float2 texCoords [[attribute(2)]];
+    float4 color [[attribute(3), function_constant(kHasVertexColors)]];
+};
+
+// Inverse of Pinnacle::encodeOctahedral.
+float3 decodeOctahedral(float2 e) {
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * select(float2(-1.0), float2(1.0), n.xy >= 0.0);
+    }
+    return normalize(n);
+}
+
+vertex VertexOut vertexShaderQuantized(QuantizedVertexIn in [[stage_in]],
+                                       constant Uniforms& uniforms [[buffer(1)]]) {
+    VertexOut out;
+    const float3 position = uniforms.positionOffset.xyz + in.position.xyz * uniforms.positionScale.xyz;
+    out.position = uniforms.modelViewProjection * float4(position, 1.0);
+    out.color = kHasVertexColors ? in.color : float4(1.0);
+    out.texCoords = in.texCoords;
+    out.viewPosition = (uniforms.modelView * float4(position, 1.0)).xyz;
+    out.viewNormal = (uniforms.modelView * float4(decodeOctahedral(in.normal), 0.0)).xyz;
+    return out;
+}
+
+// Matches Pinnacle::ClusterLight (view space)
+struct ClusterLight {
+    packed_float3 position;
+    float range;
+    packed_float3 color;
+    uint type;
+    packed_float3 direction;
+    float spotScale;
+    float spotOffset;
+    float padding[3];
+};
+
+// Matches Pinnacle::ClusterParams
+struct ClusterParams {
+    uint tilesX;
+    uint tilesY;
+    uint slices;
+    uint directionalLightCount;
+    float tileScaleX;
+    float tileScaleY;
+    float sliceScale;
+    float sliceBias;
+};
+
+// Matches ShadowParams in PinnacleMetalImplementation.mm
+struct ShadowParams {
+    float4x4 viewToShadow[4];
+    float4 splitDepths;
+    float4 normalOffsets;
+    uint cascadeCount;
+};
+
+// Pinnacle::TextureTransform: uv' = (dot(row0, (uv, 1)), dot(row1, (uv, 1))).
+struct UvTransform {
+    packed_float3 row0;
+    packed_float3 row1;
+};
+
+// Matches Pinnacle::GpuMaterial; texture fields index TextureTable.
+struct GpuMaterial {
+    float4 baseColorFactor;
+    packed_float3 emissiveFactor;
+    float alphaCutoff;
+    float metallicFactor;
+    float roughnessFactor;
+    float normalScale;
+    float occlusionStrength;
+    uint baseColorTexture;
+    uint metallicRoughnessTexture;
+    uint normalTexture;
+    uint occlusionTexture;
+    uint emissiveTexture;
+    float clearcoatFactor;
+    float clearcoatRoughnessFactor;
+    uint padding0;
+    UvTransform textureTransforms[5]; // Per Pinnacle::MaterialTexture slot
+    uint padding1[2];
+};
+
+// Pinnacle::MaterialTexture
+constant uint kBaseColorSlot = 0;
+constant uint kMetallicRoughnessSlot = 1;
+constant uint kNormalSlot = 2;
+constant uint kOcclusionSlot = 3;
+constant uint kEmissiveSlot = 4;
+
+// UVs of material texture `slot` (KHR_texture_transform); the identity
+// unless the variant has the feature.
+float2 materialUv(const device GpuMaterial& material, uint slot, float2 uv) {
+    if (!kTextureTransform) {
+        return uv;
+    }
+    const UvTransform transform = material.textureTransforms[slot];
+    return float2(dot(float3(transform.row0), float3(uv, 1.0)), dot(float3(transform.row1), float3(uv, 1.0)));
+}
+
+// Every material texture of the model (argument buffer, tier 2); size is
+// Pinnacle::kTextureTableCapacity.
+struct TextureTable {
+    array<texture2d<float>, 4096> textures [[id(0)]];
+};
+
+constant float kAmbient = 0.1;
+
+// Lit fraction for the shadow light: 3x3 taps of hardware-filtered PCF in
+// the first cascade whose split contains the fragment.
+float sampleShadow(float3 viewPosition, float3 normal, constant ShadowParams& shadow,
+                   depth2d_array<float> shadowMap) {
+    const float depth = -viewPosition.z;
+    uint cascade = 0;
+    while (cascade < shadow.cascadeCount && depth > shadow.splitDepths[cascade]) {
+        ++cascade;
+    }
+    if (cascade == shadow.cascadeCount) {
+        return 1.0; // No cascades, or beyond the shadow distance
+    }
+
+    const float4 clip = shadow.viewToShadow[cascade] * float4(viewPosition + normal * shadow.normalOffsets[cascade], 1.0);
+    const float2 uv = float2(clip.x * 0.5 + 0.5, 0.5 - clip.y * 0.5);
+    const float2 texel = 1.0 / float2(shadowMap.get_width(), shadowMap.get_height());
+    constexpr sampler compareSampler(coord::normalized, filter::linear, address::clamp_to_edge,
+                                     compare_func::less_equal);
+    float lit = 0.0;
+    for (int y = -1; y <= 1; ++y) {
+        for (int x = -1; x <= 1; ++x) {
+            lit += shadowMap.sample_compare(compareSampler, uv + float2(x, y) * texel, cascade, saturate(clip.z));
+        }
+    }
+    return lit / 9.0;
+}
+
+// Windowed inverse-square falloff that reaches zero at the range. Returns
+// the light reaching `position` and the direction towards the light in l.
+float3 localLightRadiance(ClusterLight light, float3 position, thread float3& l) {
+    const float3 toLight = float3(light.position) - position;
+    const float distanceSquared = max(dot(toLight, toLight), 1e-4);
+    l = toLight * rsqrt(distanceSquared);
+    const float ratio = distanceSquared / (light.range * light.range);
+    const float window = saturate(1.0 - ratio * ratio);
+    float attenuation = window * window / distanceSquared;
+    const float spot = saturate(dot(-l, float3(light.direction)) * light.spotScale + light.spotOffset);
+    attenuation *= spot * spot;
+    return float3(light.color) * attenuation;
+}
+
+// GGX distribution times height-correlated Smith visibility.
+float specularGgx(float nl, float nv, float nh, float roughness) {
+    const float a2 = roughness * roughness * roughness * roughness;
+    const float d = nh * nh * (a2 - 1.0) + 1.0;
+    const float distribution = a2 / (M_PI_F * d * d);
+    const float visibility = 0.5 / (nl * sqrt(nv * nv * (1.0 - a2) + a2) + nv * sqrt(nl * nl * (1.0 - a2) + a2) + 1e-5);
+    return distribution * visibility;
+}
+
+// glTF metallic-roughness BRDF times N.L: Lambert diffuse, GGX distribution,
+// height-correlated Smith visibility and Schlick Fresnel.
+float3 shadeSurface(float3 n, float3 v, float3 l, float3 albedo, float metallic, float roughness) {
+    const float3 h = normalize(v + l);
+    const float nl = saturate(dot(n, l));
+    const float nv = max(dot(n, v), 1e-4);
+    const float nh = saturate(dot(n, h));
+    const float vh = saturate(dot(v, h));
+
+    const float3 f0 = mix(float3(0.04), albedo, metallic);
+    const float3 fresnel = f0 + (1.0 - f0) * pow(1.0 - vh, 5.0);
+
+    const float3 diffuse = (1.0 - fresnel) * (1.0 - metallic) * albedo / M_PI_F;
+    return (diffuse + fresnel * specularGgx(nl, nv, nh, roughness)) * nl;
+}
+
+// KHR_materials_clearcoat: a dielectric (f0 = 0.04) GGX layer on the
+// geometric normal, with its Fresnel dimming the base beneath it.
+struct Clearcoat {
+    float3 normal;
+    float factor;
+    float roughness;
+    float baseScale; // 1 - factor * Fresnel(N.V)
+};
+
+float3 shadeClearcoat(Clearcoat coat, float3 v, float3 l, float3 base) {
+    const float3 h = normalize(v + l);
+    const float nl = saturate(dot(coat.normal, l));
+    const float nv = max(dot(coat.normal, v), 1e-4);
+    const float nh = saturate(dot(coat.normal, h));
+    const float fresnel = 0.04 + 0.96 * pow(1.0 - saturate(dot(v, h)), 5.0);
+    return base * coat.baseScale + coat.factor * fresnel * specularGgx(nl, nv, nh, coat.roughness) * nl;
+}
+
+// Tangent-space normal map applied in a frame built from screen-space
+// derivatives of position and texture coordinates, so meshes need no
+// tangent attribute.
+float3 perturbNormal(float3 normal, float3 position, float2 uv, float3 texel, float scale) {
+    const float3 dpdx = dfdx(position);
+    const float3 dpdy = dfdy(position);
+    const float2 duvdx = dfdx(uv);
+    const float2 duvdy = dfdy(uv);
+    const float3 dpdyPerp = cross(dpdy, normal);
+    const float3 dpdxPerp = cross(normal, dpdx);
+    const float3 t = dpdyPerp * duvdx.x + dpdxPerp * duvdy.x;
+    const float3 b = dpdyPerp * duvdx.y + dpdxPerp * duvdy.y;
+    const float frameScale = rsqrt(max(max(dot(t, t), dot(b, b)), 1e-20));
+    const float3 m = float3((texel.xy * 2.0 - 1.0) * scale, texel.z * 2.0 - 1.0);
+    return normalize((t * m.x + b * m.y) * frameScale + normal * m.z);
+}
+
+// Metallic-roughness PBR. Directional lights apply everywhere, the first one
+// shadowed by the cascades; point and spot lights come from the fragment's
+// froxel in the cluster grid. Unused material inputs are compiled out by
+// the function constants.
+fragment float4 fragmentShader(VertexOut in [[stage_in]],
+                               bool frontFacing [[front_facing]],
+                               device const ClusterLight* lights [[buffer(0)]],
+                               device const uint2* clusters [[buffer(1)]],
+                               device const uint* lightIndices [[buffer(2)]],
+                               constant ClusterParams& params [[buffer(3)]],
+                               constant uint& lightCount [[buffer(4)]],
+                               constant ShadowParams& shadow [[buffer(5)]],
+                               constant uint& materialIndex [[buffer(6)]],
+                               device const GpuMaterial* materials [[buffer(7)]],
+                               device const TextureTable& textureTable [[buffer(8)]],
+                               depth2d_array<float> shadowMap [[texture(0)]]) {
+    constexpr sampler materialSampler(filter::linear, mip_filter::linear, address::repeat);
+    const device GpuMaterial& material = materials[materialIndex];
+
+    float4 baseColor = in.color * material.baseColorFactor;
+    if (kHasBaseColorTexture) {
+        baseColor *= textureTable.textures[material.baseColorTexture].sample(materialSampler, materialUv(material, kBaseColorSlot, in.texCoords));
+    }
+    if (kAlphaMask && baseColor.a < material.alphaCutoff) {
+        discard_fragment();
+    }
+    const float alpha = kAlphaBlend ? baseColor.a : 1.0;
+    if (kUnlit) {
+        return float4(baseColor.rgb, alpha);
+    }
+    float3 emissive = float3(material.emissiveFactor);
+    if (kHasEmissiveTexture) {
+        emissive *= textureTable.textures[material.emissiveTexture].sample(materialSampler, materialUv(material, kEmissiveSlot, in.texCoords)).rgb;
+    }
+    if (lightCount == 0) {
+        return float4(baseColor.rgb + emissive, alpha); // Unlit models keep their base color
+    }
+
+    float metallic = material.metallicFactor;
+    float roughness = material.roughnessFactor;
+    if (kHasMetallicRoughnessTexture) {
+        const float4 metallicRoughness =
+            textureTable.textures[material.metallicRoughnessTexture].sample(materialSampler, materialUv(material, kMetallicRoughnessSlot, in.texCoords));
+        roughness *= metallicRoughness.g;
+        metallic *= metallicRoughness.b;
+    }
+    roughness = clamp(roughness, 0.045, 1.0); // Keeps highlights from collapsing to a point
+    float occlusion = 1.0;
+    if (kHasOcclusionTexture) {
+        const float2 uv = materialUv(material, kOcclusionSlot, in.texCoords);
+        occlusion = mix(1.0, textureTable.textures[material.occlusionTexture].sample(materialSampler, uv).r, material.occlusionStrength);
+    }
+
+    // Back faces (only drawn for double-sided materials) light their inside
+    float3 normal = normalize(in.viewNormal) * (frontFacing ? 1.0 : -1.0);
+    const float3 geometricNormal = normal;
+    if (kHasNormalTexture) {
+        const float2 uv = materialUv(material, kNormalSlot, in.texCoords);
+        normal = perturbNormal(normal, in.viewPosition, uv,
+                               textureTable.textures[material.normalTexture].sample(materialSampler, uv).xyz, material.normalScale);
+    }
+    const float3 view = normalize(-in.viewPosition);
+
+    Clearcoat coat;
+    coat.baseScale = 1.0;
+    if (kClearcoat) {
+        coat.normal = geometricNormal;
+        coat.factor = material.clearcoatFactor;
+        coat.roughness = clamp(material.clearcoatRoughnessFactor, 0.045, 1.0);
+        coat.baseScale = 1.0 - coat.factor * (0.04 + 0.96 * pow(1.0 - saturate(dot(coat.normal, view)), 5.0));
+    }
+
+    float3 color = (kAmbient * baseColor.rgb * occlusion + emissive) * coat.baseScale;
+    for (uint i = 0; i < params.directionalLightCount; ++i) {
+        const float visibility = i == 0 ? sampleShadow(in.viewPosition, geometricNormal, shadow, shadowMap) : 1.0;
+        const float3 l = -float3(lights[i].direction);
+        float3 radiance = shadeSurface(normal, view, l, baseColor.rgb, metallic, roughness);
+        if (kClearcoat) {
+            radiance = shadeClearcoat(coat, view, l, radiance);
+        }
+        color += float3(lights[i].color) * visibility * radiance;
+    }
+
+    const uint tileX = min(uint(in.position.x * params.tileScaleX), params.tilesX - 1);
+    const uint tileY = min(uint(in.position.y * params.tileScaleY), params.tilesY - 1);
+    const float slice = floor(log(max(-in.viewPosition.z, 1e-4)) * params.sliceScale + params.sliceBias);
+    const uint sliceIndex = uint(clamp(slice, 0.0, float(params.slices - 1)));
+    const uint2 cluster = clusters[(sliceIndex * params.tilesY + tileY) * params.tilesX + tileX];
+    for (uint i = 0; i < cluster.y; ++i) {
+        float3 l;
+        const float3 radiance = localLightRadiance(lights[lightIndices[cluster.x + i]], in.viewPosition, l);
+        float3 shaded = shadeSurface(normal, view, l, baseColor.rgb, metallic, roughness);
+        if (kClearcoat) {
+            shaded = shadeClearcoat(coat, view, l, shaded);
+        }
+        color += radiance * shaded;
+    }
+    return float4(color, alpha);
+}
+
+// Max-reduces the depth buffer into a small grid for Hi-Z occlusion culling.
+// Each output texel covers its whole (rounded-out) footprint so the result
+// stays conservative for any output size.
+kernel void downsampleDepth(depth2d<float, access::read> depthTexture [[texture(0)]],
+                            device float* output [[buffer(0)]],
+                            constant uint2& outputSize [[buffer(1)]],
+                            uint2 gid [[thread_position_in_grid]]) {
+    if (gid.x >= outputSize.x || gid.y >= outputSize.y) {
+        return;
+    }
+
+    const uint2 inputSize = uint2(depthTexture.get_width(), depthTexture.get_height());
+    const uint2 start = (gid * inputSize) / outputSize;
+    const uint2 end = min(((gid + 1) * inputSize + outputSize - 1) / outputSize, inputSize);
+
+    float maxDepth = 0.0;
+    for (uint y = start.y; y < end.y; ++y) {
+        for (uint x = start.x; x < end.x; ++x) {
+            maxDepth = max(maxDepth, depthTexture.read(uint2(x, y)));
+        }
+    }
+    output[gid.y * outputSize.x + gid.x] = maxDepth;
+}
+
+// Matches Pinnacle::MeshletData
+struct MeshletData {
+    packed_float3 center;
+    float radius;
+    packed_float3 coneAxis;
+    float coneCutoff;
+    uint indexOffset;
+    uint triangleCount;
+    uint vertexCount;
+    uint reserved;
+};
+
+// Matches PinnacleMetalRenderer::GpuCullJob
+struct MeshletCullParams {
+    float4 planes[6];
+    float4 cameraPosition;
+    uint firstMeshlet;
+    uint meshletCount;
+    uint outputOffset;
+    uint argumentsIndex;
+    uint coneCulling;
+};
+
+// Layout of MTLDrawIndexedPrimitivesIndirectArguments
+struct DrawIndexedArguments {
+    atomic_uint indexCount;
+    uint instanceCount;
+    uint indexStart;
+    int baseVertex;
+    uint baseInstance;
+};
+
+// One thread per meshlet: frustum and backface-cone test in object space,
+// then survivors append their indices to the draw's compacted range.
+kernel void cullMeshlets(device const MeshletData* meshlets [[buffer(0)]],
+                         device const uint* indices [[buffer(1)]],
+                         device uint* outputIndices [[buffer(2)]],
+                         device DrawIndexedArguments* arguments [[buffer(3)]],
+                         constant MeshletCullParams& params [[buffer(4)]],
+                         uint gid [[thread_position_in_grid]]) {
+    if (gid >= params.meshletCount) {
+        return;
+    }
+
+    const MeshletData meshlet = meshlets[params.firstMeshlet + gid];
+    const float3 center = float3(meshlet.center);
+    for (uint i = 0; i < 6; ++i) {
+        if (dot(params.planes[i].xyz, center) + params.planes[i].w < -meshlet.radius) {
+            return;
+        }
+    }
+
+    if (params.coneCulling != 0 && meshlet.coneCutoff < 1.0) {
+        const float3 toCenter = center - params.cameraPosition.xyz;
+        if (dot(toCenter, float3(meshlet.coneAxis)) >= meshlet.coneCutoff * length(toCenter) + meshlet.radius) {
+            return;
+        }
+    }
+
+    const uint count = meshlet.triangleCount * 3;
+    const uint start = atomic_fetch_add_explicit(&arguments[params.argumentsIndex].indexCount, count, memory_order_relaxed);
+    device uint* output = outputIndices + params.outputOffset + start;
+    for (uint i = 0; i < count; ++i) {
+        output[i] = indices[meshlet.indexOffset + i];
+    }
+}
+
+// Matches Pinnacle::ModelVertex
+struct ModelVertex {
+    packed_float3 position;
+    packed_float3 normal;
+    float2 texCoords;
+};
+
+// Matches Pinnacle::SkinVertex; weights are unorm16
+struct SkinVertex {
+    ushort4 joints;
+    ushort4 weights;
+};
+
+// One thread per vertex: blends the joint matrices by weight and writes the
+// world-space vertex the frame's passes draw. Same math as Pinnacle::skinVertices.
+kernel void skinVertices(device const ModelVertex* vertices [[buffer(0)]],
+                         device const SkinVertex* skin [[buffer(1)]],
+                         device const float4x4* jointMatrices [[buffer(2)]],
+                         device ModelVertex* output [[buffer(3)]],
+                         constant uint& vertexCount [[buffer(4)]],
+                         uint gid [[thread_position_in_grid]]) {
+    if (gid >= vertexCount) {
+        return;
+    }
+
+    const SkinVertex influence = skin[gid];
+    const float4 weights = float4(influence.weights) / 65535.0;
+    float4x4 blend = float4x4(0.0);
+    for (uint i = 0; i < 4; ++i) {
+        if (weights[i] > 0.0) {
+            blend += jointMatrices[influence.joints[i]] * weights[i];
+        }
+    }
+
+    const ModelVertex vertex = vertices[gid];
+    ModelVertex result;
+    result.position = (blend * float4(float3(vertex.position), 1.0)).xyz;
+    const float3 normal = (blend * float4(float3(vertex.normal), 0.0)).xyz;
+    result.normal = length_squared(normal) > 0.0 ? normalize(normal) : float3(0.0);
+    result.texCoords = vertex.texCoords;
+    output[gid] = result;
+}
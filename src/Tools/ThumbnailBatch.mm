@@ -0,0 +1,285 @@
+// Command-line batch thumbnail renderer.
+//
+// Usage: PinnacleThumbnail [options] <model.gltf>...
+//   --list <file>   Read model paths from a file, one per line
+//   --out <dir>     Output directory (default: current directory); thumbnails are
+//                   named after each model's path below the inputs' common directory
+//   --size <px>     Thumbnail width and height (default: 256)
+//   --jobs <n>      Number of parallel loader threads (default: hardware concurrency)
+//   --queue <n>     Maximum number of imported models waiting for the GPU (default: 2 * jobs)
+//   --no-cache      Always import from source instead of the baked model cache
+//
+// Loader threads parse and import models into Pinnacle::ModelData in parallel;
+// the main thread owns the Metal renderer and uploads, frames and renders one
+// model at a time. The bounded queue between the two caps how many decoded
+// models are held in memory when loading outpaces rendering.
+
+#import <Foundation/Foundation.h>
+#import <MetalKit/MetalKit.h>
+
+#include "../PinnacleMetalRenderer.h"
+#include "../Asset/AssetCache.hpp"
+#include "../Asset/GltfImporter.hpp"
+#include "../Core/BoundedQueue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    struct LoadedModel
+    {
+        size_t index = 0;
+        bool succeeded = false;
+        std::string error;
+        Pinnacle::ModelData modelData;
+    };
+
+    std::vector<std::string> splitPath(const std::string& path)
+    {
+        std::vector<std::string> components;
+        size_t start = 0;
+        while (start <= path.size())
+        {
+            const size_t slash = std::min(path.find('/', start), path.size());
+            if (slash > start)
+            {
+                components.push_back(path.substr(start, slash - start));
+            }
+            start = slash + 1;
+        }
+        return components;
+    }
+
+    // Names each thumbnail after its model's path below the directory all
+    // inputs share, with '/' turned into '_' and the extension dropped, so
+    // d1/scene.gltf and d2/scene.gltf become d1_scene.png and d2_scene.png.
+    // Fails, naming both inputs, if two of them still map to one file.
+    bool assignOutputPaths(const std::string& outputDirectory, const std::vector<std::string>& modelPaths,
+                           std::vector<std::string>& outputPaths, std::string& error)
+    {
+        std::vector<std::vector<std::string>> components;
+        size_t commonCount = std::numeric_limits<size_t>::max();
+        for (const std::string& modelPath : modelPaths)
+        {
+            components.push_back(splitPath(modelPath));
+            const std::vector<std::string>& path = components.back();
+            const std::vector<std::string>& first = components.front();
+            size_t shared = 0;
+            while (shared + 1 < path.size() && shared + 1 < first.size() && path[shared] == first[shared])
+            {
+                ++shared;
+            }
+            commonCount = std::min(commonCount, shared);
+        }
+
+        std::unordered_map<std::string, size_t> owners;
+        outputPaths.clear();
+        for (size_t i = 0; i < modelPaths.size(); ++i)
+        {
+            std::vector<std::string>& path = components[i];
+            const size_t dot = path.empty() ? std::string::npos : path.back().find_last_of('.');
+            if (dot != std::string::npos && dot > 0)
+            {
+                path.back().resize(dot);
+            }
+            std::string name;
+            for (size_t c = commonCount; c < path.size(); ++c)
+            {
+                name += (name.empty() ? "" : "_") + path[c];
+            }
+            outputPaths.push_back(outputDirectory + "/" + name + ".png");
+
+            const auto inserted = owners.emplace(outputPaths.back(), i);
+            if (!inserted.second)
+            {
+                error = modelPaths[inserted.first->second] + " and " + modelPaths[i] + " both map to " + outputPaths.back();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void printUsage()
+    {
+        std::cerr << "Usage: PinnacleThumbnail [--list file] [--out dir] [--size px] [--jobs n] [--queue n] [--no-cache] [model.gltf ...]" << std::endl;
+    }
+} // namespace
+
+int main(int argc, const char* argv[])
+{
+    @autoreleasepool
+    {
+        std::vector<std::string> modelPaths;
+        std::string outputDirectory = ".";
+        unsigned int size = 256;
+        unsigned int jobs = std::max(1u, std::thread::hardware_concurrency());
+        unsigned int queueCapacity = 0;
+        Pinnacle::AssetCache assetCache;
+        assetCache.setResourceCache(&Pinnacle::ResourceCache::getShared());
+
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (argument == "--list" && hasValue)
+            {
+                std::ifstream list(argv[++i]);
+                std::string line;
+                while (std::getline(list, line))
+                {
+                    if (!line.empty() && line[0] != '#')
+                    {
+                        modelPaths.push_back(line);
+                    }
+                }
+            }
+            else if (argument == "--out" && hasValue)
+            {
+                outputDirectory = argv[++i];
+            }
+            else if (argument == "--size" && hasValue)
+            {
+                size = (unsigned int)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (argument == "--jobs" && hasValue)
+            {
+                jobs = (unsigned int)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (argument == "--queue" && hasValue)
+            {
+                queueCapacity = (unsigned int)std::max(1, std::atoi(argv[++i]));
+            }
+            else if (argument == "--no-cache")
+            {
+                assetCache.setEnabled(false);
+            }
+            else if (argument.rfind("--", 0) == 0)
+            {
+                printUsage();
+                return 1;
+            }
+            else
+            {
+                modelPaths.push_back(argument);
+            }
+        }
+
+        if (modelPaths.empty())
+        {
+            printUsage();
+            return 1;
+        }
+
+        std::vector<std::string> outputPaths;
+        std::string outputError;
+        if (!assignOutputPaths(outputDirectory, modelPaths, outputPaths, outputError))
+        {
+            std::cerr << "Conflicting outputs: " << outputError << std::endl;
+            return 1;
+        }
+
+        jobs = std::min<unsigned int>(jobs, (unsigned int)modelPaths.size());
+        if (queueCapacity == 0)
+        {
+            queueCapacity = jobs * 2;
+        }
+
+        PinnacleMetalRenderer renderer;
+
+        Pinnacle::BoundedQueue<LoadedModel> loadedModels(queueCapacity);
+        std::atomic<size_t> nextModel(0);
+        std::atomic<unsigned int> activeLoaders(jobs);
+
+        std::vector<std::thread> loaders;
+        for (unsigned int j = 0; j < jobs; ++j)
+        {
+            loaders.emplace_back([&]() {
+                for (size_t index = nextModel++; index < modelPaths.size(); index = nextModel++)
+                {
+                    LoadedModel loaded;
+                    loaded.index = index;
+
+                    Pinnacle::GltfImporter importer;
+                    loaded.succeeded = assetCache.loadModel(modelPaths[index], importer, loaded.modelData);
+                    loaded.error = importer.getError();
+
+                    if (!loadedModels.push(std::move(loaded)))
+                    {
+                        break;
+                    }
+                }
+                if (--activeLoaders == 0)
+                {
+                    loadedModels.close();
+                }
+            });
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        size_t rendered = 0;
+        size_t failed = 0;
+
+        LoadedModel loaded;
+        while (loadedModels.pop(loaded))
+        {
+            @autoreleasepool
+            {
+                const std::string& modelPath = modelPaths[loaded.index];
+                if (!loaded.succeeded)
+                {
+                    std::cerr << "FAILED " << modelPath << ": " << loaded.error << std::endl;
+                    ++failed;
+                    continue;
+                }
+
+                renderer.setModelData(std::move(loaded.modelData));
+                renderer.frameModel();
+
+                const std::string& outputPath = outputPaths[loaded.index];
+                if (renderer.renderToImage(outputPath.c_str(), size, size))
+                {
+                    std::cout << outputPath << std::endl;
+                    ++rendered;
+                }
+                else
+                {
+                    std::cerr << "FAILED " << modelPath << ": could not render or write " << outputPath << std::endl;
+                    ++failed;
+                }
+            }
+        }
+
+        for (std::thread& loader : loaders)
+        {
+            loader.join();
+        }
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << rendered << " thumbnails, " << failed << " failures in " << seconds << " s ("
+                  << (seconds > 0.0 ? rendered / seconds : 0.0) << " models/s, " << jobs << " loaders, "
+                  << assetCache.getHitCount() << " cache hits)" << std::endl;
+        const Pinnacle::ImportCacheStats chunks = assetCache.getImportCache().getStats();
+        std::cout << "import cache:";
+        for (size_t kind = 0; kind < static_cast<size_t>(Pinnacle::ChunkKind::Count); ++kind)
+        {
+            std::cout << " " << Pinnacle::ImportCache::getKindName(static_cast<Pinnacle::ChunkKind>(kind)) << " "
+                      << chunks.hits[kind] << "/" << chunks.misses[kind] << ",";
+        }
+        std::cout << " reused/rebuilt, " << chunks.bufferViewsHashed << " buffer views hashed" << std::endl;
+        const Pinnacle::ResourceCacheStats resources = Pinnacle::ResourceCache::getShared().getStats();
+        std::cout << "shared textures: " << resources.hits << " reused, " << resources.misses << " new, "
+                  << resources.bytesSaved / (1024 * 1024) << " MB saved" << std::endl;
+
+        return failed == 0 ? 0 : 2;
+    }
+}
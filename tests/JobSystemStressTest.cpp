@@ -0,0 +1,202 @@
+// Stress test for JobSystem: nested fan-out with wait() inside jobs,
+// runAfter() dependencies, nested parallelFor() and main-thread jobs queued
+// from workers. Every job bumps its own slot, so lost or repeated jobs show
+// up as a slot that is not exactly 1. Pools are deliberately larger than
+// the machine so workers are preempted mid-job.
+
+#include "TestHarness.hpp"
+
+#include "Core/JobSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    using Slots = std::vector<std::atomic<uint32_t>>;
+
+    bool allOnce(const Slots& slots)
+    {
+        for (const std::atomic<uint32_t>& slot : slots)
+        {
+            if (slot.load() != 1)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Job `id` of a tree `fanout` wide and `depth` deep; children of job i
+    // are i * fanout + 1 ... i * fanout + fanout. Inner jobs wait on their
+    // children from inside the pool.
+    void runTree(JobSystem& jobs, Slots& slots, uint32_t id, uint32_t fanout, uint32_t depth)
+    {
+        slots[id]++;
+        if (depth == 0)
+        {
+            return;
+        }
+        JobCounter children;
+        for (uint32_t c = 1; c <= fanout; ++c)
+        {
+            const uint32_t child = id * fanout + c;
+            jobs.run([&jobs, &slots, child, fanout, depth]() { runTree(jobs, slots, child, fanout, depth - 1); }, &children);
+        }
+        jobs.wait(children);
+    }
+
+    void testNestedWait(JobSystem& jobs, uint32_t fanout, uint32_t depth, int rounds)
+    {
+        uint32_t count = 0;
+        for (uint32_t level = 0, width = 1; level <= depth; ++level, width *= fanout)
+        {
+            count += width;
+        }
+        for (int round = 0; round < rounds; ++round)
+        {
+            Slots slots(count);
+            runTree(jobs, slots, 0, fanout, depth);
+            PINNACLE_CHECK(allOnce(slots));
+        }
+    }
+
+    void testDependencies(JobSystem& jobs)
+    {
+        for (int round = 0; round < 50; ++round)
+        {
+            const uint32_t count = 200;
+            Slots first(count);
+            Slots second(count);
+            std::atomic<uint32_t> early{ 0 };
+            JobCounter firstDone;
+            JobCounter secondDone;
+
+            // The gate holds the first stage open while second-stage jobs are
+            // parked on it before, between and after the first-stage jobs.
+            std::atomic<bool> released{ false };
+            jobs.run([&released]()
+            {
+                while (!released.load())
+                {
+                    std::this_thread::yield();
+                }
+            }, &firstDone);
+            auto parkSecond = [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    jobs.runAfter(firstDone, [&, i]() { early += allOnce(first) ? 0 : 1; second[i]++; }, &secondDone);
+                }
+            };
+            parkSecond(0, count / 2);
+            for (uint32_t i = 0; i < count; ++i)
+            {
+                jobs.run([&, i]() { first[i]++; }, &firstDone);
+            }
+            parkSecond(count / 2, count);
+            released = true;
+            jobs.wait(secondDone);
+            PINNACLE_CHECK(firstDone.isDone());
+            PINNACLE_CHECK(allOnce(first));
+            PINNACLE_CHECK(allOnce(second));
+            PINNACLE_CHECK(early.load() == 0);
+        }
+    }
+
+    void testNestedParallelFor(JobSystem& jobs)
+    {
+        const uint32_t outer = 64;
+        const uint32_t inner = 1000;
+        for (size_t grain : { size_t(1), size_t(7), size_t(64), size_t(5000) })
+        {
+            Slots slots(outer * inner);
+            jobs.parallelFor(outer, 1, [&](size_t o)
+            {
+                jobs.parallelFor(inner, grain, [&, o](size_t i) { slots[o * inner + i]++; });
+            });
+            PINNACLE_CHECK(allOnce(slots));
+        }
+
+        // maxThreads caps helpers but every item still runs.
+        Slots capped(10000);
+        jobs.parallelFor(capped.size(), 3, [&](size_t i) { capped[i]++; }, 2);
+        PINNACLE_CHECK(allOnce(capped));
+    }
+
+    void testMainThreadJobs(JobSystem& jobs)
+    {
+        const std::thread::id mainThread = std::this_thread::get_id();
+        const uint32_t count = 2000;
+        Slots slots(count);
+        std::atomic<uint32_t> offMain{ 0 };
+        JobCounter done;
+        jobs.parallelFor(count, 16, [&](size_t i)
+        {
+            jobs.runOnMainThread([&, i]()
+            {
+                offMain += std::this_thread::get_id() == mainThread ? 0 : 1;
+                slots[i]++;
+            }, &done);
+        });
+        // wait() on the main thread pumps the main-thread queue.
+        jobs.wait(done);
+        PINNACLE_CHECK(allOnce(slots));
+        PINNACLE_CHECK(offMain.load() == 0);
+    }
+
+    // Jobs that spawn a random number of children and never wait, all
+    // tracked by one counter: the counter must not reach zero early.
+    void testDetachedSpawning(JobSystem& jobs)
+    {
+        const uint32_t capacity = 200000;
+        Slots slots(capacity);
+        std::atomic<uint32_t> nextId{ 1 };
+        JobCounter all;
+        std::function<void(uint32_t)> spawn = [&](uint32_t id)
+        {
+            slots[id]++;
+            const uint32_t children = ((id + 1) * 2654435761u >> 28) % 4;
+            for (uint32_t c = 0; c < children; ++c)
+            {
+                const uint32_t child = nextId++;
+                if (child < capacity)
+                {
+                    jobs.run([&spawn, child]() { spawn(child); }, &all);
+                }
+            }
+        };
+        jobs.run([&spawn]() { spawn(0); }, &all);
+        jobs.wait(all);
+        const uint32_t spawned = std::min(nextId.load(), capacity);
+        uint32_t wrong = 0;
+        for (uint32_t i = 0; i < spawned; ++i)
+        {
+            wrong += slots[i].load() == 1 ? 0 : 1;
+        }
+        PINNACLE_CHECK(spawned > 1000);
+        PINNACLE_CHECK(wrong == 0);
+    }
+} // namespace
+
+int main()
+{
+    for (unsigned int workers : { 1u, 3u, 8u })
+    {
+        JobSystem jobs(workers);
+        PINNACLE_CHECK(jobs.getWorkerCount() == workers);
+        testNestedWait(jobs, 6, 5, 10);
+        // Wide enough that unbounded helping in wait() overflows the stack.
+        testNestedWait(jobs, 8, 6, 5);
+        testDependencies(jobs);
+        testNestedParallelFor(jobs);
+        testMainThreadJobs(jobs);
+        testDetachedSpawning(jobs);
+    }
+    return Test::finish("JobSystemStressTest");
+}
@@ -0,0 +1,190 @@
+// PipelineCache: hashPipeline() identity, the manifest round trip in memory
+// and through save()/load(), and rejection of manifests that are
+// truncated, from another version, with the wrong magic or for other
+// shaders.
+
+#include "TestHarness.hpp"
+
+#include "Core/MappedFile.hpp"
+#include "Renderer/PipelineCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <vector>
+
+using namespace Pinnacle;
+
+namespace
+{
+    const uint64_t kShaderHash = 0x0123456789ABCDEFull;
+
+    PipelineDescription makeDescription(uint32_t features, VertexFormat vertexFormat, uint32_t flags = 0)
+    {
+        ShaderVariant variant;
+        variant.features = features;
+        variant.vertexFormat = vertexFormat;
+        PipelineDescription description;
+        description.variantKey = variant.getKey();
+        description.colorFormat = 81; // MTLPixelFormatBGRA8Unorm_sRGB
+        description.depthFormat = 252; // MTLPixelFormatDepth32Float
+        description.flags = flags;
+        return description;
+    }
+
+    bool samePipelines(const std::vector<PipelineDescription>& a, const std::vector<PipelineDescription>& b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (a[i].variantKey != b[i].variantKey || a[i].colorFormat != b[i].colorFormat ||
+                a[i].depthFormat != b[i].depthFormat || a[i].flags != b[i].flags)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void fillCache(PipelineCache& cache)
+    {
+        cache.add(makeDescription(0, VertexFormat::Float));
+        cache.add(makeDescription(kFeatureBaseColorTexture | kFeatureNormalTexture, VertexFormat::Float));
+        cache.add(makeDescription(kFeatureBaseColorTexture | kFeatureVertexColors, VertexFormat::Quantized));
+        cache.add(makeDescription(kFeatureAlphaBlend, VertexFormat::Quantized));
+        cache.add(makeDescription(0, VertexFormat::Quantized, kPipelineDepthOnly));
+    }
+
+    void testHashIdentity()
+    {
+        const PipelineDescription base = makeDescription(kFeatureBaseColorTexture, VertexFormat::Float);
+        PINNACLE_CHECK(hashPipeline(base) == hashPipeline(base));
+        PINNACLE_CHECK(hashPipeline(base) == hashPipeline(makeDescription(kFeatureBaseColorTexture, VertexFormat::Float)));
+
+        // Every field is part of the identity.
+        PipelineDescription changed = base;
+        changed.variantKey = makeDescription(kFeatureBaseColorTexture | kFeatureAlphaMask, VertexFormat::Float).variantKey;
+        PINNACLE_CHECK(hashPipeline(changed) != hashPipeline(base));
+        changed = base;
+        changed.variantKey = makeDescription(kFeatureBaseColorTexture, VertexFormat::Quantized).variantKey;
+        PINNACLE_CHECK(hashPipeline(changed) != hashPipeline(base));
+        changed = base;
+        changed.colorFormat = 80; // MTLPixelFormatBGRA8Unorm
+        PINNACLE_CHECK(hashPipeline(changed) != hashPipeline(base));
+        changed = base;
+        changed.depthFormat = 0;
+        PINNACLE_CHECK(hashPipeline(changed) != hashPipeline(base));
+        changed = base;
+        changed.flags = kPipelineDepthOnly;
+        PINNACLE_CHECK(hashPipeline(changed) != hashPipeline(base));
+
+        // Vertex colors change the layout as well as the key.
+        const VertexLayout plain = getVertexLayout(ShaderVariant::fromKey(base.variantKey));
+        const VertexLayout colored = getVertexLayout(
+            ShaderVariant::fromKey(makeDescription(kFeatureBaseColorTexture | kFeatureVertexColors, VertexFormat::Float).variantKey));
+        PINNACLE_CHECK(colored.attributeCount == plain.attributeCount + 1);
+        PINNACLE_CHECK(plain.strides[2] == 0 && colored.strides[2] == sizeof(uint32_t));
+
+        // Distinct variants stay distinct across the whole feature space.
+        std::vector<uint64_t> hashes;
+        for (uint32_t features = 0; features < (1u << 11); ++features)
+        {
+            hashes.push_back(hashPipeline(makeDescription(features, VertexFormat::Float)));
+            hashes.push_back(hashPipeline(makeDescription(features, VertexFormat::Quantized)));
+        }
+        std::sort(hashes.begin(), hashes.end());
+        PINNACLE_CHECK(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+    }
+
+    void testRoundTrip()
+    {
+        PipelineCache cache("unused");
+        PINNACLE_CHECK(!cache.deserialize(std::vector<uint8_t>(), kShaderHash)); // Nothing saved yet
+        fillCache(cache);
+        PINNACLE_CHECK(cache.getPipelines().size() == 5);
+        PINNACLE_CHECK(cache.isDirty());
+        PINNACLE_CHECK(!cache.add(makeDescription(0, VertexFormat::Float))); // Already known
+
+        PipelineCache restored("unused");
+        PINNACLE_CHECK(restored.deserialize(cache.serialize(), kShaderHash));
+        PINNACLE_CHECK(samePipelines(restored.getPipelines(), cache.getPipelines()));
+        PINNACLE_CHECK(!restored.isDirty());
+        PINNACLE_CHECK(!restored.add(makeDescription(kFeatureAlphaBlend, VertexFormat::Quantized)));
+        PINNACLE_CHECK(restored.serialize() == cache.serialize());
+
+        // Through the file system, in a directory of its own.
+        const std::string directory =
+            makeTemporaryPath((std::filesystem::temp_directory_path() / "PinnaclePipelineCacheTest").string());
+        {
+            PipelineCache saved(directory);
+            saved.deserialize(std::vector<uint8_t>(), kShaderHash);
+            fillCache(saved);
+            PINNACLE_CHECK(saved.save());
+            PINNACLE_CHECK(!saved.isDirty());
+
+            PipelineCache loaded(directory);
+            PINNACLE_CHECK(loaded.load(kShaderHash));
+            PINNACLE_CHECK(samePipelines(loaded.getPipelines(), saved.getPipelines()));
+
+            // Other shaders: nothing is reused.
+            PipelineCache otherShaders(directory);
+            PINNACLE_CHECK(!otherShaders.load(kShaderHash + 1));
+            PINNACLE_CHECK(otherShaders.getPipelines().empty());
+        }
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+    }
+
+    void testRejection()
+    {
+        PipelineCache cache("unused");
+        cache.deserialize(std::vector<uint8_t>(), kShaderHash);
+        fillCache(cache);
+        const std::vector<uint8_t> manifest = cache.serialize();
+
+        // Every proper prefix is refused and leaves the cache empty.
+        uint32_t accepted = 0;
+        for (size_t size = 0; size < manifest.size(); ++size)
+        {
+            PipelineCache truncated("unused");
+            fillCache(truncated);
+            const bool loaded = truncated.deserialize(std::vector<uint8_t>(manifest.begin(), manifest.begin() + size), kShaderHash);
+            accepted += loaded || !truncated.getPipelines().empty() ? 1 : 0;
+        }
+        PINNACLE_CHECK(accepted == 0);
+
+        std::vector<uint8_t> padded = manifest;
+        padded.push_back(0);
+        PINNACLE_CHECK(!PipelineCache("unused").deserialize(padded, kShaderHash));
+
+        // Layout: magic, version, shader hash, then the array.
+        std::vector<uint8_t> wrongMagic = manifest;
+        wrongMagic[0] ^= 0xFF;
+        PINNACLE_CHECK(!PipelineCache("unused").deserialize(wrongMagic, kShaderHash));
+
+        uint32_t currentVersion = 0;
+        std::memcpy(&currentVersion, &manifest[4], sizeof(currentVersion));
+        for (uint32_t version : { currentVersion - 1, currentVersion + 1, ~currentVersion })
+        {
+            std::vector<uint8_t> wrongVersion = manifest;
+            std::memcpy(&wrongVersion[4], &version, sizeof(version));
+            PipelineCache rejected("unused");
+            PINNACLE_CHECK(!rejected.deserialize(wrongVersion, kShaderHash));
+            PINNACLE_CHECK(rejected.getPipelines().empty());
+        }
+
+        PINNACLE_CHECK(!PipelineCache("unused").deserialize(manifest, kShaderHash ^ 1));
+        PINNACLE_CHECK(PipelineCache("unused").deserialize(manifest, kShaderHash));
+    }
+} // namespace
+
+int main()
+{
+    testHashIdentity();
+    testRoundTrip();
+    testRejection();
+    return Test::finish("PipelineCacheTest");
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdio>
+
+namespace Pinnacle
+{
+    namespace Test
+    {
+        inline int& getFailureCount()
+        {
+            static int s_failures = 0;
+            return s_failures;
+        }
+
+        inline bool check(bool condition, const char* pExpression, const char* pFile, int line)
+        {
+            if (!condition)
+            {
+                std::printf("%s:%d: check failed: %s\n", pFile, line, pExpression);
+                ++getFailureCount();
+            }
+            return condition;
+        }
+
+        // Prints the outcome and returns the process exit code.
+        inline int finish(const char* pName)
+        {
+            const int failures = getFailureCount();
+            std::printf("%s: %s (%d failures)\n", pName, failures == 0 ? "passed" : "FAILED", failures);
+            return failures == 0 ? 0 : 1;
+        }
+    } // namespace Test
+} // namespace Pinnacle
+
+// Records a failure and carries on; the test's exit code reports it. Not
+// thread-safe: check results on the thread that runs the test.
+#define PINNACLE_CHECK(condition) ::Pinnacle::Test::check((condition), #condition, __FILE__, __LINE__)